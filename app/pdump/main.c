@@ -0,0 +1,410 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <getopt.h>
+#include <sys/time.h>
+
+#include <rte_eal.h>
+#include <rte_config.h>
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_pdump.h>
+
+/* Maximum long option length for option parsing. */
+#define MAX_LONG_OPT_SZ 64
+
+#define PDUMP_RING_SIZE 16384
+#define PDUMP_NB_MBUFS 65535
+#define PDUMP_MBUF_CACHE_SIZE 250
+#define PDUMP_BURST_SIZE 32
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_VERSION_MAJOR 2
+#define PCAP_VERSION_MINOR 4
+#define PCAP_SNAPLEN 65535
+#define PCAP_LINKTYPE_ETHERNET 1
+
+/* pcap file format headers */
+struct pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_pkt_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t caplen;
+	uint32_t len;
+};
+
+/* capture of one direction */
+struct pdump_dir {
+	const char *file_name;
+	FILE *file;
+	struct rte_ring *ring;
+	uint64_t nb_pkts;
+};
+
+/**< port to capture */
+static uint8_t port_id;
+/**< queue to capture */
+static uint16_t queue_id = RTE_PDUMP_ALL_QUEUES;
+/**< ring size */
+static unsigned ring_size = PDUMP_RING_SIZE;
+/**< number of mbufs used for the clones */
+static unsigned nb_mbufs = PDUMP_NB_MBUFS;
+/**< RX and TX captures */
+static struct pdump_dir rx_dir, tx_dir;
+
+static volatile int quit_signal;
+
+/**< display usage */
+static void
+pdump_usage(const char *prgname)
+{
+	printf("%s [EAL options] -- --rx-file FILE | --tx-file FILE\n"
+		"  --port PORT: port to capture, 0 by default\n"
+		"  --queue QUEUE: queue to capture, all queues if not set\n"
+		"  --rx-file FILE: pcap file to write received packets to\n"
+		"  --tx-file FILE: pcap file to write sent packets to, can be "
+			"the same as the RX file\n"
+		"  --ring-size SIZE: size of the capture rings, %u by default\n"
+		"  --mbufs NUM: number of mbufs for the clones, %u by default\n",
+		prgname, PDUMP_RING_SIZE, PDUMP_NB_MBUFS);
+}
+
+static int
+parse_uint(const char *arg, unsigned long max, unsigned long *val)
+{
+	char *end = NULL;
+
+	errno = 0;
+	*val = strtoul(arg, &end, 0);
+	if (arg[0] == '\0' || end == NULL || *end != '\0' || errno != 0 ||
+			*val > max)
+		return -1;
+
+	return 0;
+}
+
+/* Parse the argument given in the command line of the application */
+static int
+pdump_parse_args(int argc, char **argv)
+{
+	int opt;
+	int option_index;
+	unsigned long val;
+	char *prgname = argv[0];
+	static struct option long_option[] = {
+		{"port", 1, NULL, 0},
+		{"queue", 1, NULL, 0},
+		{"rx-file", 1, NULL, 0},
+		{"tx-file", 1, NULL, 0},
+		{"ring-size", 1, NULL, 0},
+		{"mbufs", 1, NULL, 0},
+		{NULL, 0, 0, 0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "", long_option,
+			&option_index)) != EOF) {
+		if (opt != 0) {
+			pdump_usage(prgname);
+			return -1;
+		}
+
+		if (!strncmp(long_option[option_index].name, "port",
+				MAX_LONG_OPT_SZ)) {
+			if (parse_uint(optarg, RTE_MAX_ETHPORTS - 1, &val) < 0)
+				goto invalid;
+			port_id = val;
+		} else if (!strncmp(long_option[option_index].name, "queue",
+				MAX_LONG_OPT_SZ)) {
+			if (parse_uint(optarg, RTE_MAX_QUEUES_PER_PORT - 1,
+					&val) < 0)
+				goto invalid;
+			queue_id = val;
+		} else if (!strncmp(long_option[option_index].name, "rx-file",
+				MAX_LONG_OPT_SZ))
+			rx_dir.file_name = optarg;
+		else if (!strncmp(long_option[option_index].name, "tx-file",
+				MAX_LONG_OPT_SZ))
+			tx_dir.file_name = optarg;
+		else if (!strncmp(long_option[option_index].name,
+				"ring-size", MAX_LONG_OPT_SZ)) {
+			if (parse_uint(optarg, RTE_RING_SZ_MASK, &val) < 0 ||
+					!rte_is_power_of_2(val))
+				goto invalid;
+			ring_size = val;
+		} else if (!strncmp(long_option[option_index].name, "mbufs",
+				MAX_LONG_OPT_SZ)) {
+			if (parse_uint(optarg, UINT32_MAX, &val) < 0 ||
+					val == 0)
+				goto invalid;
+			nb_mbufs = val;
+		}
+	}
+
+	if (rx_dir.file_name == NULL && tx_dir.file_name == NULL) {
+		printf("No capture file given\n");
+		pdump_usage(prgname);
+		return -1;
+	}
+
+	return 0;
+
+invalid:
+	printf("Invalid value for --%s: %s\n",
+		long_option[option_index].name, optarg);
+	pdump_usage(prgname);
+	return -1;
+}
+
+static void
+signal_handler(int sig_num)
+{
+	if (sig_num == SIGINT || sig_num == SIGTERM)
+		quit_signal = 1;
+}
+
+static FILE *
+pcap_open(const char *file_name)
+{
+	struct pcap_file_hdr hdr;
+	FILE *f;
+
+	f = fopen(file_name, "w");
+	if (f == NULL)
+		return NULL;
+
+	hdr.magic = PCAP_MAGIC;
+	hdr.version_major = PCAP_VERSION_MAJOR;
+	hdr.version_minor = PCAP_VERSION_MINOR;
+	hdr.thiszone = 0;
+	hdr.sigfigs = 0;
+	hdr.snaplen = PCAP_SNAPLEN;
+	hdr.linktype = PCAP_LINKTYPE_ETHERNET;
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+		fclose(f);
+		return NULL;
+	}
+
+	return f;
+}
+
+static void
+pcap_write(FILE *f, const struct timeval *tv, const struct rte_mbuf *m)
+{
+	struct pcap_pkt_hdr hdr;
+	uint32_t left;
+
+	hdr.ts_sec = tv->tv_sec;
+	hdr.ts_usec = tv->tv_usec;
+	hdr.len = rte_pktmbuf_pkt_len(m);
+	hdr.caplen = RTE_MIN(hdr.len, (uint32_t)PCAP_SNAPLEN);
+	fwrite(&hdr, sizeof(hdr), 1, f);
+
+	for (left = hdr.caplen; m != NULL && left != 0; m = m->next) {
+		uint32_t len = RTE_MIN(left, (uint32_t)m->data_len);
+
+		fwrite(rte_pktmbuf_mtod(m, const void *), len, 1, f);
+		left -= len;
+	}
+}
+
+/* Dequeue the captured packets of one direction and write them */
+static unsigned
+pdump_dir_poll(struct pdump_dir *dir)
+{
+	struct rte_mbuf *pkts[PDUMP_BURST_SIZE];
+	struct timeval tv;
+	unsigned i, nb;
+
+	if (dir->ring == NULL)
+		return 0;
+
+	nb = rte_ring_sc_dequeue_burst(dir->ring, (void **)pkts,
+			PDUMP_BURST_SIZE);
+	if (nb == 0)
+		return 0;
+
+	gettimeofday(&tv, NULL);
+	for (i = 0; i < nb; i++) {
+		pcap_write(dir->file, &tv, pkts[i]);
+		rte_pktmbuf_free(pkts[i]);
+	}
+	dir->nb_pkts += nb;
+
+	return nb;
+}
+
+static struct rte_ring *
+pdump_ring_get(const char *prefix)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_ring *r;
+
+	snprintf(name, sizeof(name), "%s_%u", prefix, port_id);
+	r = rte_ring_lookup(name);
+	if (r == NULL)
+		r = rte_ring_create(name, ring_size, rte_socket_id(),
+				RING_F_SC_DEQ);
+	if (r == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create ring %s\n", name);
+
+	return r;
+}
+
+static void
+pdump_dir_open(struct pdump_dir *dir, const char *ring_prefix,
+		const struct pdump_dir *other)
+{
+	if (dir->file_name == NULL)
+		return;
+
+	dir->ring = pdump_ring_get(ring_prefix);
+	/* RX and TX can share the same file */
+	if (other->file != NULL &&
+			strcmp(dir->file_name, other->file_name) == 0)
+		dir->file = other->file;
+	else
+		dir->file = pcap_open(dir->file_name);
+	if (dir->file == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot open %s: %s\n", dir->file_name,
+			strerror(errno));
+}
+
+int
+main(int argc, char **argv)
+{
+	struct rte_mempool *mp;
+	char mp_name[RTE_MEMPOOL_NAMESIZE];
+	char mp_flag[] = "--proc-type=secondary";
+	char *argp[argc + 1];
+	int ret;
+	int i;
+
+	argp[0] = argv[0];
+	argp[1] = mp_flag;
+	for (i = 1; i < argc; i++)
+		argp[i + 1] = argv[i];
+	argc += 1;
+
+	ret = rte_eal_init(argc, argp);
+	if (ret < 0)
+		rte_panic("Cannot init EAL\n");
+
+	argc -= ret;
+	argv += (ret - 1);
+
+	/* parse app arguments */
+	ret = pdump_parse_args(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Invalid argument\n");
+
+	snprintf(mp_name, sizeof(mp_name), "pdump_pool_%u", port_id);
+	mp = rte_mempool_lookup(mp_name);
+	if (mp == NULL)
+		/* clones are indirect mbufs, they need no data room */
+		mp = rte_pktmbuf_pool_create(mp_name, nb_mbufs,
+				PDUMP_MBUF_CACHE_SIZE, 0, 0, rte_socket_id());
+	if (mp == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create mempool\n");
+
+	pdump_dir_open(&rx_dir, "pdump_rx", &tx_dir);
+	pdump_dir_open(&tx_dir, "pdump_tx", &rx_dir);
+
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	if (rx_dir.ring != NULL) {
+		ret = rte_pdump_enable(port_id, queue_id, RTE_PDUMP_FLAG_RX,
+				rx_dir.ring, mp);
+		if (ret < 0)
+			rte_exit(EXIT_FAILURE, "Cannot enable RX capture: %s\n",
+				strerror(-ret));
+	}
+	if (tx_dir.ring != NULL) {
+		ret = rte_pdump_enable(port_id, queue_id, RTE_PDUMP_FLAG_TX,
+				tx_dir.ring, mp);
+		if (ret < 0) {
+			if (rx_dir.ring != NULL)
+				rte_pdump_disable(port_id, queue_id,
+						RTE_PDUMP_FLAG_RX);
+			rte_exit(EXIT_FAILURE, "Cannot enable TX capture: %s\n",
+				strerror(-ret));
+		}
+	}
+
+	printf("Capturing port %u, press Ctrl-C to stop\n", port_id);
+	while (!quit_signal) {
+		pdump_dir_poll(&rx_dir);
+		pdump_dir_poll(&tx_dir);
+	}
+
+	if (rx_dir.ring != NULL)
+		rte_pdump_disable(port_id, queue_id, RTE_PDUMP_FLAG_RX);
+	if (tx_dir.ring != NULL)
+		rte_pdump_disable(port_id, queue_id, RTE_PDUMP_FLAG_TX);
+
+	/* write what was captured before the callbacks were removed */
+	while (pdump_dir_poll(&rx_dir) + pdump_dir_poll(&tx_dir) != 0)
+		;
+
+	printf("\nRX packets: %"PRIu64", TX packets: %"PRIu64"\n",
+		rx_dir.nb_pkts, tx_dir.nb_pkts);
+
+	if (rx_dir.file != NULL)
+		fclose(rx_dir.file);
+	if (tx_dir.file != NULL && tx_dir.file != rx_dir.file)
+		fclose(tx_dir.file);
+
+	return 0;
+}
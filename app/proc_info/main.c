@@ -58,6 +58,15 @@
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_string_fns.h>
+#ifdef RTE_LIBRTE_LATENCY_STATS
+#include <rte_latencystats.h>
+#endif
+#ifdef RTE_LIBRTE_BITRATE
+#include <rte_bitrate.h>
+#endif
+#ifdef RTE_LIBRTE_METRICS
+#include <rte_metrics.h>
+#endif
 
 /* Maximum long option length for option parsing. */
 #define MAX_LONG_OPT_SZ 64
@@ -75,6 +84,14 @@ static uint32_t reset_stats;
 static uint32_t reset_xstats;
 /**< Enable memory info. */
 static uint32_t mem_info;
+/**< Enable latency stats. */
+static uint32_t enable_latency_stats;
+/**< Enable latency stats reset. */
+static uint32_t reset_latency_stats;
+/**< Enable bitrate stats. */
+static uint32_t enable_bitrate_stats;
+/**< Enable metrics. */
+static uint32_t enable_metrics;
 
 /**< display usage */
 static void
@@ -87,7 +104,11 @@ proc_info_usage(const char *prgname)
 		"  --xstats: to display extended port statistics, disabled by "
 			"default\n"
 		"  --stats-reset: to reset port statistics\n"
-		"  --xstats-reset: to reset port extended statistics\n",
+		"  --xstats-reset: to reset port extended statistics\n"
+		"  --latency-stats: to display RX to TX latency statistics\n"
+		"  --latency-stats-reset: to reset latency statistics\n"
+		"  --bitrate-stats: to display port bit rates\n"
+		"  --metrics: to display global and port metrics\n",
 		prgname);
 }
 
@@ -129,6 +150,10 @@ proc_info_parse_args(int argc, char **argv)
 		{"stats-reset", 0, NULL, 0},
 		{"xstats", 0, NULL, 0},
 		{"xstats-reset", 0, NULL, 0},
+		{"latency-stats", 0, NULL, 0},
+		{"latency-stats-reset", 0, NULL, 0},
+		{"bitrate-stats", 0, NULL, 0},
+		{"metrics", 0, NULL, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -168,6 +193,22 @@ proc_info_parse_args(int argc, char **argv)
 			else if (!strncmp(long_option[option_index].name, "xstats-reset",
 					MAX_LONG_OPT_SZ))
 				reset_xstats = 1;
+			/* Print latency stats */
+			else if (!strncmp(long_option[option_index].name,
+					"latency-stats", MAX_LONG_OPT_SZ))
+				enable_latency_stats = 1;
+			/* Reset latency stats */
+			else if (!strncmp(long_option[option_index].name,
+					"latency-stats-reset", MAX_LONG_OPT_SZ))
+				reset_latency_stats = 1;
+			/* Print bitrate stats */
+			else if (!strncmp(long_option[option_index].name,
+					"bitrate-stats", MAX_LONG_OPT_SZ))
+				enable_bitrate_stats = 1;
+			/* Print metrics */
+			else if (!strncmp(long_option[option_index].name,
+					"metrics", MAX_LONG_OPT_SZ))
+				enable_metrics = 1;
 			break;
 
 		default:
@@ -286,6 +327,132 @@ nic_xstats_clear(uint8_t port_id)
 	printf("\n  NIC extended statistics for port %d cleared\n", port_id);
 }
 
+static void
+latency_stats_display(uint8_t port_id)
+{
+#ifdef RTE_LIBRTE_LATENCY_STATS
+	struct rte_latencystats stats;
+	static const char *nic_stats_border = "########################";
+
+	if (rte_latencystats_get(port_id, &stats) < 0) {
+		printf("Cannot get latency stats for port %d\n", port_id);
+		return;
+	}
+
+	printf("\n  %s Latency statistics for port %-2d %s\n",
+		   nic_stats_border, port_id, nic_stats_border);
+	printf("  Samples: %-10"PRIu64"\n", stats.samples);
+	printf("  Min-ns:  %-10"PRIu64"  Avg-ns:  %-10"PRIu64
+	       "  Max-ns:  %-10"PRIu64"\n", stats.min_ns, stats.avg_ns,
+	       stats.max_ns);
+	printf("  Jitter-ns: %-10"PRIu64"\n", stats.jitter_ns);
+	printf("  %s############################%s\n",
+		   nic_stats_border, nic_stats_border);
+#else
+	printf("Latency stats not compiled in, port %d\n", port_id);
+#endif
+}
+
+static void
+latency_stats_clear(uint8_t port_id)
+{
+#ifdef RTE_LIBRTE_LATENCY_STATS
+	printf("\n Clearing latency stats for port %d\n", port_id);
+	if (rte_latencystats_reset(port_id) < 0)
+		printf("\n  Cannot clear latency stats for port %d\n", port_id);
+	else
+		printf("\n  Latency statistics for port %d cleared\n",
+			port_id);
+#else
+	printf("Latency stats not compiled in, port %d\n", port_id);
+#endif
+}
+
+static void
+bitrate_stats_display(uint8_t port_id)
+{
+#ifdef RTE_LIBRTE_BITRATE
+	struct rte_stats_bitrate stats;
+	static const char *nic_stats_border = "########################";
+
+	if (rte_stats_bitrate_get(port_id, &stats) < 0) {
+		printf("Cannot get bitrate stats for port %d\n", port_id);
+		return;
+	}
+
+	printf("\n  %s Bit rates for port %-2d %s\n",
+		   nic_stats_border, port_id, nic_stats_border);
+	printf("  RX-mean: %-12"PRIu64"  RX-ewma: %-12"PRIu64
+	       "  RX-peak: %-12"PRIu64"\n", stats.mean_ibits,
+	       stats.ewma_ibits, stats.peak_ibits);
+	printf("  TX-mean: %-12"PRIu64"  TX-ewma: %-12"PRIu64
+	       "  TX-peak: %-12"PRIu64"\n", stats.mean_obits,
+	       stats.ewma_obits, stats.peak_obits);
+	printf("  %s############################%s\n",
+		   nic_stats_border, nic_stats_border);
+#else
+	printf("Bitrate stats not compiled in, port %d\n", port_id);
+#endif
+}
+
+static void
+metrics_display(int port_id)
+{
+#ifdef RTE_LIBRTE_METRICS
+	struct rte_metric_value *values;
+	struct rte_metric_name *names;
+	int len, ret, i;
+	static const char *nic_stats_border = "########################";
+
+	len = rte_metrics_get_names(NULL, 0);
+	if (len < 0) {
+		printf("Cannot get metrics count\n");
+		return;
+	}
+	if (len == 0) {
+		printf("No metrics registered\n");
+		return;
+	}
+
+	names = malloc(sizeof(struct rte_metric_name) * len);
+	values = malloc(sizeof(struct rte_metric_value) * len);
+	if (names == NULL || values == NULL) {
+		printf("Cannot allocate memory for metrics\n");
+		free(names);
+		free(values);
+		return;
+	}
+
+	if (rte_metrics_get_names(names, len) != len) {
+		printf("Cannot get metrics names\n");
+		goto out;
+	}
+	ret = rte_metrics_get_values(port_id, values, len);
+	if (ret < 0 || ret > len) {
+		printf("Cannot get metrics values\n");
+		goto out;
+	}
+
+	if (port_id == RTE_METRICS_GLOBAL)
+		printf("\n  %s Global metrics %s\n",
+			   nic_stats_border, nic_stats_border);
+	else
+		printf("\n  %s Metrics for port %-2d %s\n",
+			   nic_stats_border, port_id, nic_stats_border);
+	for (i = 0; i < ret; i++)
+		printf("  %s: %"PRIu64"\n", names[values[i].key].name,
+		       values[i].value);
+	printf("  %s############################%s\n",
+		   nic_stats_border, nic_stats_border);
+
+out:
+	free(names);
+	free(values);
+#else
+	printf("Metrics not compiled in, port %d\n", port_id);
+#endif
+}
+
 int
 main(int argc, char **argv)
 {
@@ -336,6 +503,11 @@ main(int argc, char **argv)
 	if (enabled_port_mask == 0)
 		enabled_port_mask = 0xffff;
 
+#ifdef RTE_LIBRTE_METRICS
+	if (enable_metrics)
+		metrics_display(RTE_METRICS_GLOBAL);
+#endif
+
 	for (i = 0; i < nb_ports; i++) {
 		if (enabled_port_mask & (1 << i)) {
 			if (enable_stats)
@@ -346,6 +518,14 @@ main(int argc, char **argv)
 				nic_stats_clear(i);
 			else if (reset_xstats)
 				nic_xstats_clear(i);
+			else if (enable_latency_stats)
+				latency_stats_display(i);
+			else if (reset_latency_stats)
+				latency_stats_clear(i);
+			else if (enable_bitrate_stats)
+				bitrate_stats_display(i);
+			else if (enable_metrics)
+				metrics_display(i);
 		}
 	}
 
@@ -66,6 +66,7 @@
 #define	OPT_BLD_CATEGORIES	"bldcat"
 #define	OPT_RUN_CATEGORIES	"runcat"
 #define	OPT_MAX_SIZE		"maxsize"
+#define	OPT_BLD_THREADS		"bldthreads"
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
@@ -101,6 +102,15 @@ static const struct acl_alg acl_alg[] = {
 		.name = "avx2",
 		.alg = RTE_ACL_CLASSIFY_AVX2,
 	},
+	{
+		.name = "avx512",
+		.alg = RTE_ACL_CLASSIFY_AVX512,
+	},
+	{
+		/* each of the above supported by the CPU. */
+		.name = "all",
+		.alg = RTE_ACL_CLASSIFY_NUM,
+	},
 };
 
 static struct {
@@ -110,6 +120,7 @@ static struct {
 	size_t              max_size;
 	uint32_t            bld_categories;
 	uint32_t            run_categories;
+	uint32_t            bld_threads;
 	uint32_t            nb_rules;
 	uint32_t            nb_traces;
 	uint32_t            trace_step;
@@ -124,6 +135,7 @@ static struct {
 } config = {
 	.bld_categories = 3,
 	.run_categories = 1,
+	.bld_threads = 1,
 	.nb_rules = RULE_NUM,
 	.nb_traces = TRACE_DEFAULT_NUM,
 	.trace_step = TRACE_STEP_DEF,
@@ -773,6 +785,42 @@ add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
 	return 0;
 }
 
+/*
+ * Build the context with 1, 2, 4, ... threads up to the requested number,
+ * and print the build time for each of them.
+ */
+static void
+build_scaling(struct rte_acl_config *cfg)
+{
+	int ret;
+	uint32_t n;
+	uint64_t hz, tm, tm1;
+
+	hz = rte_get_tsc_hz();
+	tm1 = 0;
+
+	for (n = 1; n != 0; n = (n == config.bld_threads) ? 0 :
+			RTE_MIN(n * 2, config.bld_threads)) {
+
+		cfg->num_threads = n;
+		tm = rte_rdtsc();
+		ret = rte_acl_build(config.acx, cfg);
+		tm = rte_rdtsc() - tm;
+
+		if (ret != 0)
+			rte_exit(ret, "failed to build search context "
+				"with %u threads\n", n);
+		if (n == 1)
+			tm1 = tm;
+
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_build(%u) with %u threads: "
+			"%" PRIu64 " cycles, %.3Lf sec, speedup: %.2Lf\n",
+			config.bld_categories, n, tm, (long double)tm / hz,
+			(long double)tm1 / tm);
+	}
+}
+
 static void
 acx_init(void)
 {
@@ -802,7 +850,8 @@ acx_init(void)
 		rte_exit(rte_errno, "failed to create ACL context\n");
 
 	/* set default classify method for this context. */
-	if (config.alg.alg != RTE_ACL_CLASSIFY_DEFAULT) {
+	if (config.alg.alg != RTE_ACL_CLASSIFY_DEFAULT &&
+			config.alg.alg != RTE_ACL_CLASSIFY_NUM) {
 		ret = rte_acl_set_ctx_classify(config.acx, config.alg.alg);
 		if (ret != 0)
 			rte_exit(ret, "failed to setup %s method "
@@ -821,7 +870,12 @@ acx_init(void)
 
 	fclose(f);
 
+	/* report how the build time scales with the number of threads. */
+	if (config.bld_threads > 1)
+		build_scaling(&cfg);
+
 	/* perform build. */
+	cfg.num_threads = config.bld_threads;
 	ret = rte_acl_build(config.acx, &cfg);
 
 	dump_verbose(DUMP_NONE, stdout,
@@ -894,14 +948,57 @@ search_ip5tuples(__attribute__((unused)) void *arg)
 
 	tm = rte_rdtsc() - start;
 	dump_verbose(DUMP_NONE, stdout,
-		"%s  @lcore %u: %" PRIu32 " iterations, %" PRIu64 " pkts, %"
-		PRIu32 " categories, %" PRIu64 " cycles, %#Lf cycles/pkt\n",
-		__func__, lcore, i, pkt, config.run_categories,
-		tm, (long double)tm / pkt);
+		"%s(%s)  @lcore %u: %" PRIu32 " iterations, %" PRIu64 " pkts, %"
+		PRIu32 " categories, %" PRIu64 " cycles, %#Lf cycles/pkt, "
+		"%.3Lf Mpps\n",
+		__func__, config.alg.name, lcore, i, pkt,
+		config.run_categories, tm, (long double)tm / pkt,
+		(long double)pkt * rte_get_tsc_hz() / tm / 1e6);
 
 	return 0;
 }
 
+static void
+search_all_lcores(void)
+{
+	uint32_t lcore;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
+
+	search_ip5tuples(NULL);
+
+	rte_eal_mp_wait_lcore();
+}
+
+/*
+ * Run the search with each classify method the CPU supports,
+ * to compare their throughput.
+ */
+static void
+search_all_algs(void)
+{
+	int ret;
+	uint32_t i;
+
+	for (i = 0; i != RTE_DIM(acl_alg); i++) {
+
+		if (acl_alg[i].alg == RTE_ACL_CLASSIFY_NUM)
+			continue;
+
+		ret = rte_acl_set_ctx_classify(config.acx, acl_alg[i].alg);
+		if (ret != 0) {
+			dump_verbose(DUMP_NONE, stdout,
+				"%s method is not supported: %d, skipped\n",
+				acl_alg[i].name, ret);
+			continue;
+		}
+
+		config.alg = acl_alg[i];
+		search_all_lcores();
+	}
+}
+
 static unsigned long
 get_ulong_opt(const char *opt, const char *name, size_t min, size_t max)
 {
@@ -970,6 +1067,9 @@ print_usage(const char *prgname)
 		"[--" OPT_MAX_SIZE
 			"=<size limit (in bytes) for runtime ACL strucutures> "
 			"leave 0 for default behaviour]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build with> "
+			"build time for 1, 2, 4... threads is reported]\n"
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
@@ -991,6 +1091,7 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_BLD_CATEGORIES, config.bld_categories);
 	fprintf(f, "%s:%u\n", OPT_RUN_CATEGORIES, config.run_categories);
 	fprintf(f, "%s:%zu\n", OPT_MAX_SIZE, config.max_size);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
 	fprintf(f, "%s:%u\n", OPT_ITER_NUM, config.iter_num);
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
@@ -1018,6 +1119,7 @@ get_input_opts(int argc, char **argv)
 		{OPT_TRACE_NUM, 1, 0, 0},
 		{OPT_RULE_NUM, 1, 0, 0},
 		{OPT_MAX_SIZE, 1, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
 		{OPT_TRACE_STEP, 1, 0, 0},
 		{OPT_BLD_CATEGORIES, 1, 0, 0},
 		{OPT_RUN_CATEGORIES, 1, 0, 0},
@@ -1047,6 +1149,9 @@ get_input_opts(int argc, char **argv)
 		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_SIZE) == 0) {
 			config.max_size = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 0, SIZE_MAX);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 1, RTE_MAX_LCORE);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_TRACE_NUM) == 0) {
 			config.nb_traces = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 1, UINT32_MAX);
@@ -1085,7 +1190,6 @@ int
 main(int argc, char **argv)
 {
 	int ret;
-	uint32_t lcore;
 
 	ret = rte_eal_init(argc, argv);
 	if (ret < 0)
@@ -1105,12 +1209,10 @@ main(int argc, char **argv)
 	if (config.trace_file != NULL)
 		tracef_init();
 
-	RTE_LCORE_FOREACH_SLAVE(lcore)
-		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
-
-	search_ip5tuples(NULL);
-
-	rte_eal_mp_wait_lcore();
+	if (config.alg.alg == RTE_ACL_CLASSIFY_NUM)
+		search_all_algs();
+	else
+		search_all_lcores();
 
 	rte_acl_free(config.acx);
 	return 0;
@@ -75,6 +75,9 @@
 #ifdef RTE_LIBRTE_PMD_XENVIRT
 #include <rte_eth_xenvirt.h>
 #endif
+#ifdef RTE_LIBRTE_PDUMP
+#include <rte_pdump.h>
+#endif
 
 #include "testpmd.h"
 #include "mempool_osdep.h"
@@ -1580,6 +1583,10 @@ pmd_test_exit(void)
 	if (test_done == 0)
 		stop_packet_forwarding();
 
+#ifdef RTE_LIBRTE_PDUMP
+	rte_pdump_uninit();
+#endif
+
 	FOREACH_PORT(pt_id, ports) {
 		printf("Stopping port %d...", pt_id);
 		fflush(stdout);
@@ -2014,6 +2021,12 @@ main(int argc, char** argv)
 	if (start_port(RTE_PORT_ALL) != 0)
 		rte_exit(EXIT_FAILURE, "Start ports failed\n");
 
+#ifdef RTE_LIBRTE_PDUMP
+	/* allow capturing traffic with the pdump tool */
+	if (rte_pdump_init() < 0)
+		RTE_LOG(WARNING, EAL, "Cannot initialize packet capture\n");
+#endif
+
 	/* set all ports to promiscuous mode by default */
 	FOREACH_PORT(port_id, ports)
 		rte_eth_promiscuous_enable(port_id);
@@ -173,6 +173,24 @@ parallel_test_group_list = [
 		 "Func" :	default_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"RCU QSBR autotest",
+		 "Command" : 	"rcu_qsbr_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"RIB autotest",
+		 "Command" : 	"rib_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"FIB autotest",
+		 "Command" : 	"fib_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"IVSHMEM autotest",
 		 "Command" : 	"ivshmem_autotest",
@@ -410,6 +428,32 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix":	"lpm_full_table_perf",
+	"Memory" :	per_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"LPM full table performance autotest",
+		 "Command" : 	"lpm_full_table_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
+{
+	"Prefix":	"fib_perf",
+	"Memory" :	per_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"FIB performance autotest",
+		 "Command" : 	"fib_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix" :      "power",
 	"Memory" :      per_sockets(512),
@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 
 #include "test.h"
 
@@ -41,7 +42,9 @@
 #include <rte_byteorder.h>
 #include <rte_ip.h>
 #include <rte_acl.h>
+#include <rte_acl_delta.h>
 #include <rte_common.h>
+#include <rte_random.h>
 
 #include "test_acl.h"
 
@@ -475,6 +478,123 @@ test_classify(void)
 	return ret;
 }
 
+/*
+ * Save a built context and load it into another one, which should
+ * classify as expected. Invalid files should leave the context unchanged.
+ */
+static int
+test_save_load(void)
+{
+	FILE *f;
+	uint32_t version, saved_version;
+	int ret;
+	struct rte_acl_param prm;
+	struct rte_acl_ctx *acx, *ldx;
+
+	prm = acl_param;
+	prm.name = "acl_load";
+
+	acx = rte_acl_create(&acl_param);
+	ldx = rte_acl_create(&prm);
+	f = tmpfile();
+	if (acx == NULL || ldx == NULL || f == NULL) {
+		printf("Line %i: Error creating ACL contexts or file!\n",
+			__LINE__);
+		ret = -1;
+		goto out;
+	}
+
+	/* nothing to save before the build. */
+	ret = rte_acl_save(acx, f);
+	if (ret != -EINVAL) {
+		printf("Line %i: saving an unbuilt context returned %d\n",
+			__LINE__, ret);
+		ret = -1;
+		goto out;
+	}
+
+	ret = test_classify_buid(acx, acl_test_rules,
+		RTE_DIM(acl_test_rules));
+	if (ret == 0)
+		ret = rte_acl_save(acx, f);
+	if (ret != 0) {
+		printf("Line %i: Error building or saving ACL context: %d\n",
+			__LINE__, ret);
+		goto out;
+	}
+
+	/* the loaded context doesn't depend on the saved one. */
+	rte_acl_free(acx);
+	acx = NULL;
+
+	rewind(f);
+	ret = rte_acl_load(ldx, f);
+	if (ret != 0) {
+		printf("Line %i: Error loading ACL context: %d\n",
+			__LINE__, ret);
+		goto out;
+	}
+
+	ret = test_classify_run(ldx);
+	if (ret != 0) {
+		printf("Line %i: loaded context classify failed!\n",
+			__LINE__);
+		goto out;
+	}
+
+	/* an unknown version is rejected. */
+	version = UINT32_MAX;
+	if (fseek(f, sizeof(uint32_t), SEEK_SET) != 0 ||
+			fread(&saved_version, sizeof(saved_version), 1,
+				f) != 1 ||
+			fseek(f, sizeof(uint32_t), SEEK_SET) != 0 ||
+			fwrite(&version, sizeof(version), 1, f) != 1) {
+		printf("Line %i: Error writing file!\n", __LINE__);
+		ret = -1;
+		goto out;
+	}
+	rewind(f);
+	ret = rte_acl_load(ldx, f);
+	if (ret != -EINVAL) {
+		printf("Line %i: loading an unknown version returned %d\n",
+			__LINE__, ret);
+		ret = -1;
+		goto out;
+	}
+
+	/* so is a truncated file. */
+	if (fseek(f, sizeof(uint32_t), SEEK_SET) != 0 ||
+			fwrite(&saved_version, sizeof(saved_version), 1,
+				f) != 1 ||
+			fseek(f, 0, SEEK_END) != 0 ||
+			fflush(f) != 0 ||
+			ftruncate(fileno(f), ftell(f) - 1) != 0) {
+		printf("Line %i: Error writing file!\n", __LINE__);
+		ret = -1;
+		goto out;
+	}
+	rewind(f);
+	ret = rte_acl_load(ldx, f);
+	if (ret != -EIO) {
+		printf("Line %i: loading a truncated file returned %d\n",
+			__LINE__, ret);
+		ret = -1;
+		goto out;
+	}
+
+	ret = test_classify_run(ldx);
+	if (ret != 0)
+		printf("Line %i: classify failed after a failed load!\n",
+			__LINE__);
+
+out:
+	if (f != NULL)
+		fclose(f);
+	rte_acl_free(acx);
+	rte_acl_free(ldx);
+	return ret;
+}
+
 static int
 test_build_ports_range(void)
 {
@@ -1631,6 +1751,645 @@ test_invalid_parameters(void)
 	return 0;
 }
 
+/*
+ * Test incremental updates: classification through an ACL delta object
+ * must give the same results as a context built with all the rules.
+ */
+
+#define	DELTA_MAX_RULES		1024
+#define	DELTA_MAX_DELTA		256
+#define	DELTA_NUM_RULES		512
+#define	DELTA_LOAD_BURST	128
+#define	DELTA_UPDATE_BURST	8
+#define	DELTA_ROUNDS		16
+#define	DELTA_MERGE_ROUNDS	4
+#define	DELTA_NUM_PKTS		256
+#define	DELTA_CATEGORIES	RTE_ACL_RESULTS_MULTIPLIER
+#define	DELTA_ADDR_MASK		0xfff
+#define	DELTA_PORT_MAX		64
+#define	DELTA_PORT_RANGE	8
+
+struct delta_test {
+	struct rte_acl_delta *d;
+	struct rte_acl_ctx *ref;
+	struct rte_acl_config cfg;
+	uint32_t num_rules;
+	uint32_t num_deleted;
+	uint32_t next_userdata;
+	struct rte_acl_ipv4vlan_rule rules[DELTA_MAX_RULES];
+	struct rte_acl_ipv4vlan_rule deleted[DELTA_MAX_RULES];
+	struct ipv4_7tuple pkts[DELTA_NUM_PKTS];
+};
+
+static void
+delta_gen_rule(struct rte_acl_ipv4vlan_rule *r, uint32_t userdata)
+{
+	memset(r, 0, sizeof(*r));
+
+	/* unique priorities, not in the order of the updates. */
+	r->data.userdata = userdata;
+	r->data.priority = (userdata * UINT32_C(0x9e3779b1)) &
+		RTE_ACL_MAX_PRIORITY;
+	r->data.category_mask = 1 + rte_rand() % RTE_LEN2MASK(
+		DELTA_CATEGORIES, uint32_t);
+
+	r->proto = (rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+	r->proto_mask = (rte_rand() & 1) ? UINT8_MAX : 0;
+
+	r->src_mask_len = 20 + rte_rand() % 9;
+	r->src_addr = (IPv4(10, 0, 0, 0) | (rte_rand() & DELTA_ADDR_MASK)) &
+		RTE_ACL_MASKLEN_TO_BITMASK(r->src_mask_len, sizeof(uint32_t));
+	r->dst_mask_len = 20 + rte_rand() % 9;
+	r->dst_addr = (IPv4(192, 168, 0, 0) | (rte_rand() & DELTA_ADDR_MASK)) &
+		RTE_ACL_MASKLEN_TO_BITMASK(r->dst_mask_len, sizeof(uint32_t));
+
+	/* aligned port ranges keep the tries small. */
+	r->src_port_low = rte_rand() % DELTA_PORT_MAX & ~(DELTA_PORT_RANGE - 1);
+	r->src_port_high = r->src_port_low + DELTA_PORT_RANGE - 1;
+	r->dst_port_low = rte_rand() % DELTA_PORT_MAX & ~(DELTA_PORT_RANGE - 1);
+	r->dst_port_high = r->dst_port_low + DELTA_PORT_RANGE - 1;
+}
+
+static int
+delta_add(struct delta_test *t, uint32_t num)
+{
+	uint32_t i;
+	int ret;
+	struct acl_ipv4vlan_rule rv[DELTA_LOAD_BURST];
+
+	for (i = 0; i != num; i++) {
+		delta_gen_rule(t->rules + t->num_rules + i, t->next_userdata++);
+		acl_ipv4vlan_convert_rule(t->rules + t->num_rules + i, rv + i);
+	}
+
+	ret = rte_acl_delta_add_rules(t->d, (struct rte_acl_rule *)rv, num);
+	if (ret != 0) {
+		printf("Line %i: adding %u rules failed: %d\n",
+			__LINE__, num, ret);
+		return -1;
+	}
+
+	t->num_rules += num;
+	return 0;
+}
+
+static int
+delta_del(struct delta_test *t, uint32_t num)
+{
+	uint32_t i, k;
+	int ret;
+	uint32_t userdata[DELTA_UPDATE_BURST];
+
+	for (i = 0; i != num; i++) {
+		k = rte_rand() % t->num_rules;
+		userdata[i] = t->rules[k].data.userdata;
+		t->deleted[t->num_deleted++ % DELTA_MAX_RULES] = t->rules[k];
+		t->rules[k] = t->rules[--t->num_rules];
+	}
+
+	ret = rte_acl_delta_del_rules(t->d, userdata, num);
+	if (ret != 0) {
+		printf("Line %i: deleting %u rules failed: %d\n",
+			__LINE__, num, ret);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Packets in network order: a quarter of them within a random rule,
+ * another quarter within a deleted rule, the others anywhere around
+ * the rules.
+ */
+static void
+delta_gen_pkts(struct delta_test *t)
+{
+	uint32_t i;
+	struct ipv4_7tuple *p;
+	const struct rte_acl_ipv4vlan_rule *r;
+
+	for (i = 0; i != DELTA_NUM_PKTS; i++) {
+		p = t->pkts + i;
+		p->proto = (rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+		p->ip_src = IPv4(10, 0, 0, 0) | (rte_rand() & DELTA_ADDR_MASK);
+		p->ip_dst = IPv4(192, 168, 0, 0) |
+			(rte_rand() & DELTA_ADDR_MASK);
+		p->port_src = rte_rand() % DELTA_PORT_MAX;
+		p->port_dst = rte_rand() % DELTA_PORT_MAX;
+
+		if ((i & 3) == 0 && t->num_rules != 0)
+			r = t->rules + rte_rand() % t->num_rules;
+		else if ((i & 3) == 1 && t->num_deleted != 0)
+			r = t->deleted + rte_rand() % RTE_MIN(t->num_deleted,
+				(uint32_t)DELTA_MAX_RULES);
+		else
+			continue;
+
+		if (r->proto_mask != 0)
+			p->proto = r->proto;
+		p->ip_src = r->src_addr | (p->ip_src &
+			~RTE_ACL_MASKLEN_TO_BITMASK(r->src_mask_len,
+			sizeof(uint32_t)));
+		p->ip_dst = r->dst_addr | (p->ip_dst &
+			~RTE_ACL_MASKLEN_TO_BITMASK(r->dst_mask_len,
+			sizeof(uint32_t)));
+		p->port_src = r->src_port_low + rte_rand() % DELTA_PORT_RANGE;
+		p->port_dst = r->dst_port_low + rte_rand() % DELTA_PORT_RANGE;
+	}
+
+	bswap_test_data(t->pkts, DELTA_NUM_PKTS, 1);
+}
+
+/* Compare with a full build of the live rules. */
+static int
+delta_check(struct delta_test *t)
+{
+	uint32_t i;
+	int ret;
+	const uint8_t *data[DELTA_NUM_PKTS];
+	uint32_t res[DELTA_NUM_PKTS * DELTA_CATEGORIES];
+	uint32_t ref[DELTA_NUM_PKTS * DELTA_CATEGORIES];
+
+	delta_gen_pkts(t);
+	for (i = 0; i != RTE_DIM(data); i++)
+		data[i] = (const uint8_t *)(t->pkts + i);
+
+	/* a context without rules can not be built, and matches nothing. */
+	memset(ref, 0, sizeof(ref));
+	if (t->num_rules != 0) {
+		rte_acl_reset_rules(t->ref);
+		ret = rte_acl_ipv4vlan_add_rules(t->ref, t->rules,
+			t->num_rules);
+		if (ret == 0)
+			ret = rte_acl_build(t->ref, &t->cfg);
+		if (ret != 0) {
+			printf("Line %i: building reference context "
+				"failed: %d\n", __LINE__, ret);
+			return -1;
+		}
+
+		ret = rte_acl_classify(t->ref, data, ref, RTE_DIM(data),
+			DELTA_CATEGORIES);
+		if (ret != 0) {
+			printf("Line %i: classify failed: %d\n",
+				__LINE__, ret);
+			return -1;
+		}
+	}
+
+	ret = rte_acl_delta_classify(t->d, data, res, RTE_DIM(data),
+		DELTA_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: classify failed: %d\n", __LINE__, ret);
+		return -1;
+	}
+
+	for (i = 0; i != RTE_DIM(res); i++) {
+		if (res[i] != ref[i]) {
+			printf("Line %i: packet %u category %u: "
+				"expected %u, got %u (%u rules, %u in delta)\n",
+				__LINE__, (uint32_t)(i / DELTA_CATEGORIES),
+				(uint32_t)(i % DELTA_CATEGORIES), ref[i], res[i],
+				t->num_rules, rte_acl_delta_count(t->d));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_delta_run(struct delta_test *t)
+{
+	uint32_t i, userdata;
+	struct acl_ipv4vlan_rule rv;
+
+	/* fill the delta context. */
+	for (i = 0; i != DELTA_MAX_DELTA; i += DELTA_LOAD_BURST) {
+		if (delta_add(t, DELTA_LOAD_BURST) != 0)
+			return -1;
+	}
+
+	delta_gen_rule(t->rules + t->num_rules, t->next_userdata++);
+	acl_ipv4vlan_convert_rule(t->rules + t->num_rules, &rv);
+	if (rte_acl_delta_add_rules(t->d, (struct rte_acl_rule *)&rv, 1) !=
+			-ENOSPC || rte_acl_delta_count(t->d) != DELTA_MAX_DELTA) {
+		printf("Line %i: adding to a full delta context succeeded\n",
+			__LINE__);
+		return -1;
+	}
+
+	if (delta_check(t) != 0 || rte_acl_delta_merge(t->d) != 0)
+		return -1;
+
+	/* load the other rules, merging after each burst. */
+	for (i = DELTA_MAX_DELTA; i != DELTA_NUM_RULES;
+			i += DELTA_LOAD_BURST) {
+		if (delta_add(t, DELTA_LOAD_BURST) != 0 ||
+				delta_check(t) != 0)
+			return -1;
+		if (rte_acl_delta_merge(t->d) != 0 ||
+				rte_acl_delta_count(t->d) != 0) {
+			printf("Line %i: merge failed\n", __LINE__);
+			return -1;
+		}
+	}
+	if (delta_check(t) != 0)
+		return -1;
+
+	for (i = 0; i != DELTA_ROUNDS; i++) {
+		if (delta_add(t, DELTA_UPDATE_BURST) != 0 ||
+				delta_check(t) != 0 ||
+				delta_del(t, DELTA_UPDATE_BURST) != 0 ||
+				delta_check(t) != 0)
+			return -1;
+
+		if ((i + 1) % DELTA_MERGE_ROUNDS == 0) {
+			if (rte_acl_delta_merge(t->d) != 0 ||
+					rte_acl_delta_count(t->d) != 0) {
+				printf("Line %i: merge failed\n", __LINE__);
+				return -1;
+			}
+			if (delta_check(t) != 0)
+				return -1;
+		}
+	}
+
+	/* failed updates leave the rules unchanged. */
+	acl_ipv4vlan_convert_rule(t->rules, &rv);
+	if (rte_acl_delta_add_rules(t->d, (struct rte_acl_rule *)&rv, 1) !=
+			-EEXIST) {
+		printf("Line %i: adding an existing rule succeeded\n",
+			__LINE__);
+		return -1;
+	}
+
+	userdata = t->next_userdata;
+	if (rte_acl_delta_del_rules(t->d, &userdata, 1) != -ENOENT) {
+		printf("Line %i: deleting a missing rule succeeded\n",
+			__LINE__);
+		return -1;
+	}
+
+	return delta_check(t);
+}
+
+static int
+test_delta(void)
+{
+	int ret;
+	struct delta_test *t;
+	struct rte_acl_param prm;
+	struct rte_acl_delta_param dprm;
+
+	t = rte_zmalloc(NULL, sizeof(*t), 0);
+	if (t == NULL) {
+		printf("Line %i: allocation failed\n", __LINE__);
+		return -1;
+	}
+
+	acl_ipv4vlan_config(&t->cfg, ipv4_7tuple_layout, DELTA_CATEGORIES);
+
+	memset(&dprm, 0, sizeof(dprm));
+	dprm.name = "acl_delta";
+	dprm.socket_id = SOCKET_ID_ANY;
+	dprm.rule_size = RTE_ACL_IPV4VLAN_RULE_SZ;
+	dprm.max_rule_num = DELTA_MAX_RULES;
+	dprm.max_delta_rule_num = DELTA_MAX_DELTA;
+	dprm.cfg = &t->cfg;
+
+	prm = acl_param;
+	prm.name = "acl_delta_ref";
+	prm.max_rule_num = DELTA_MAX_RULES;
+
+	t->d = rte_acl_delta_create(&dprm);
+	t->ref = rte_acl_create(&prm);
+	if (t->d == NULL || t->ref == NULL) {
+		printf("Line %i: error creating ACL contexts\n", __LINE__);
+		ret = -1;
+		goto out;
+	}
+
+	t->next_userdata = 1;
+
+	/* an empty object matches nothing. */
+	ret = delta_check(t);
+
+	if (ret == 0)
+		ret = test_delta_run(t);
+
+out:
+	rte_acl_delta_free(t->d);
+	rte_acl_free(t->ref);
+	rte_free(t);
+	return ret;
+}
+
+/*
+ * Rules with arbitrary port ranges, so that they are split in a few tries,
+ * and packets half of which are within a random rule.
+ */
+
+#define	SPLIT_NUM_RULES		1024
+#define	SPLIT_NUM_PKTS		256
+#define	SPLIT_CATEGORIES	RTE_ACL_RESULTS_MULTIPLIER
+#define	SPLIT_ADDR_MASK		0xfff
+
+struct split_test {
+	struct rte_acl_ctx *ctx;
+	struct rte_acl_config cfg;
+	struct rte_acl_ipv4vlan_rule rules[SPLIT_NUM_RULES];
+	struct ipv4_7tuple pkts[SPLIT_NUM_PKTS];
+	const uint8_t *data[SPLIT_NUM_PKTS];
+};
+
+static void
+split_gen_rule(struct rte_acl_ipv4vlan_rule *r, uint32_t userdata)
+{
+	memset(r, 0, sizeof(*r));
+
+	/* unique priorities, so that the results do not depend on the tries. */
+	r->data.userdata = userdata;
+	r->data.priority = (userdata * UINT32_C(0x9e3779b1)) &
+		RTE_ACL_MAX_PRIORITY;
+	r->data.category_mask = 1 + rte_rand() % RTE_LEN2MASK(
+		SPLIT_CATEGORIES, uint32_t);
+
+	r->proto = (rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+	r->proto_mask = (rte_rand() & 1) ? UINT8_MAX : 0;
+
+	r->src_mask_len = 20 + rte_rand() % 9;
+	r->src_addr = (IPv4(10, 0, 0, 0) | (rte_rand() & SPLIT_ADDR_MASK)) &
+		RTE_ACL_MASKLEN_TO_BITMASK(r->src_mask_len, sizeof(uint32_t));
+	r->dst_mask_len = 20 + rte_rand() % 9;
+	r->dst_addr = (IPv4(192, 168, 0, 0) | (rte_rand() & SPLIT_ADDR_MASK)) &
+		RTE_ACL_MASKLEN_TO_BITMASK(r->dst_mask_len, sizeof(uint32_t));
+
+	r->src_port_low = rte_rand();
+	r->src_port_high = r->src_port_low +
+		rte_rand() % (UINT16_MAX - r->src_port_low + 1);
+	r->dst_port_low = rte_rand();
+	r->dst_port_high = r->dst_port_low +
+		rte_rand() % (UINT16_MAX - r->dst_port_low + 1);
+}
+
+static void
+split_gen_pkt(struct ipv4_7tuple *p, const struct rte_acl_ipv4vlan_rule *r)
+{
+	p->proto = (rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+	p->ip_src = IPv4(10, 0, 0, 0) | (rte_rand() & SPLIT_ADDR_MASK);
+	p->ip_dst = IPv4(192, 168, 0, 0) | (rte_rand() & SPLIT_ADDR_MASK);
+	p->port_src = rte_rand();
+	p->port_dst = rte_rand();
+
+	if (r == NULL)
+		return;
+
+	if (r->proto_mask != 0)
+		p->proto = r->proto;
+	p->ip_src = r->src_addr | (p->ip_src &
+		~RTE_ACL_MASKLEN_TO_BITMASK(r->src_mask_len, sizeof(uint32_t)));
+	p->ip_dst = r->dst_addr | (p->ip_dst &
+		~RTE_ACL_MASKLEN_TO_BITMASK(r->dst_mask_len, sizeof(uint32_t)));
+	p->port_src = r->src_port_low +
+		rte_rand() % (r->src_port_high - r->src_port_low + 1);
+	p->port_dst = r->dst_port_low +
+		rte_rand() % (r->dst_port_high - r->dst_port_low + 1);
+}
+
+static void
+split_test_free(struct split_test *t)
+{
+	rte_acl_free(t->ctx);
+	rte_free(t);
+}
+
+/* Create a context with the rules added, and the packets to classify. */
+static struct split_test *
+split_test_create(const char *name)
+{
+	uint32_t i;
+	int ret;
+	struct split_test *t;
+	struct rte_acl_param prm;
+
+	t = rte_zmalloc(NULL, sizeof(*t), 0);
+	if (t == NULL) {
+		printf("Line %i: allocation failed\n", __LINE__);
+		return NULL;
+	}
+
+	acl_ipv4vlan_config(&t->cfg, ipv4_7tuple_layout, SPLIT_CATEGORIES);
+
+	prm = acl_param;
+	prm.name = name;
+	prm.max_rule_num = SPLIT_NUM_RULES;
+
+	t->ctx = rte_acl_create(&prm);
+	if (t->ctx == NULL) {
+		printf("Line %i: error creating ACL context\n", __LINE__);
+		split_test_free(t);
+		return NULL;
+	}
+
+	for (i = 0; i != SPLIT_NUM_RULES; i++)
+		split_gen_rule(t->rules + i, i + 1);
+
+	ret = rte_acl_ipv4vlan_add_rules(t->ctx, t->rules, SPLIT_NUM_RULES);
+	if (ret != 0) {
+		printf("Line %i: adding rules failed: %d\n", __LINE__, ret);
+		split_test_free(t);
+		return NULL;
+	}
+
+	for (i = 0; i != SPLIT_NUM_PKTS; i++) {
+		split_gen_pkt(t->pkts + i, (i & 1) ? NULL :
+			t->rules + rte_rand() % SPLIT_NUM_RULES);
+		t->data[i] = (const uint8_t *)(t->pkts + i);
+	}
+	bswap_test_data(t->pkts, SPLIT_NUM_PKTS, 1);
+
+	return t;
+}
+
+/*
+ * Build the same rules with a different number of threads:
+ * the results should be the same.
+ */
+static int
+test_build_threads(void)
+{
+	static const uint32_t num_threads[] = {2, 3, 4, 8};
+
+	int ret;
+	uint32_t i, j;
+	struct split_test *t;
+	uint32_t res[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+	uint32_t ref[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+
+	t = split_test_create("acl_threads");
+	if (t == NULL)
+		return -1;
+
+	ret = rte_acl_build(t->ctx, &t->cfg);
+	if (ret == 0)
+		ret = rte_acl_classify(t->ctx, t->data, ref, SPLIT_NUM_PKTS,
+			SPLIT_CATEGORIES);
+	if (ret != 0)
+		printf("Line %i: single thread build failed: %d\n",
+			__LINE__, ret);
+
+	for (i = 0; ret == 0 && i != RTE_DIM(num_threads); i++) {
+
+		t->cfg.num_threads = num_threads[i];
+		ret = rte_acl_build(t->ctx, &t->cfg);
+		if (ret == 0)
+			ret = rte_acl_classify(t->ctx, t->data, res,
+				SPLIT_NUM_PKTS, SPLIT_CATEGORIES);
+		if (ret != 0) {
+			printf("Line %i: build with %u threads failed: %d\n",
+				__LINE__, num_threads[i], ret);
+			break;
+		}
+
+		for (j = 0; j != RTE_DIM(res); j++) {
+			if (res[j] != ref[j]) {
+				printf("Line %i: %u threads, packet %u "
+					"category %u: expected %u, got %u\n",
+					__LINE__, num_threads[i],
+					(uint32_t)(j / SPLIT_CATEGORIES),
+					(uint32_t)(j % SPLIT_CATEGORIES),
+					ref[j], res[j]);
+				ret = -1;
+				break;
+			}
+		}
+	}
+
+	split_test_free(t);
+	return ret;
+}
+
+/*
+ * Compare each classify method the CPU supports with the scalar one,
+ * for rules split in several tries and bursts of various sizes.
+ */
+static int
+test_classify_algs_split(struct split_test *t)
+{
+	static const uint32_t nums[] = {SPLIT_NUM_PKTS, 47, 33, 32, 31, 17};
+
+	int ret;
+	uint32_t i, j, k;
+	uint32_t res[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+	uint32_t ref[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+
+	ret = rte_acl_build(t->ctx, &t->cfg);
+	if (ret == 0)
+		ret = rte_acl_classify_alg(t->ctx, t->data, ref,
+			SPLIT_NUM_PKTS, SPLIT_CATEGORIES,
+			RTE_ACL_CLASSIFY_SCALAR);
+	if (ret != 0) {
+		printf("Line %i: scalar classify failed: %d\n",
+			__LINE__, ret);
+		return -1;
+	}
+
+	for (i = RTE_ACL_CLASSIFY_SSE; i != RTE_ACL_CLASSIFY_NUM; i++) {
+
+		if (rte_acl_set_ctx_classify(t->ctx, i) != 0)
+			continue;
+
+		for (j = 0; j != RTE_DIM(nums); j++) {
+			memset(res, 0, sizeof(res));
+			ret = rte_acl_classify(t->ctx, t->data, res, nums[j],
+				SPLIT_CATEGORIES);
+			if (ret != 0) {
+				printf("Line %i: method %u classify failed: "
+					"%d\n", __LINE__, i, ret);
+				return -1;
+			}
+
+			for (k = 0; k != nums[j] * SPLIT_CATEGORIES; k++) {
+				if (res[k] != ref[k]) {
+					printf("Line %i: method %u, burst %u, "
+						"packet %u category %u: "
+						"expected %u, got %u\n",
+						__LINE__, i, nums[j],
+						(uint32_t)(k / SPLIT_CATEGORIES),
+						(uint32_t)(k % SPLIT_CATEGORIES),
+						ref[k], res[k]);
+					return -1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Run the classify test with each method the CPU supports.
+ * Unsupported ones should not be selected.
+ */
+static int
+test_classify_algs(void)
+{
+	int ret;
+	uint32_t i;
+	struct split_test *t;
+	struct rte_acl_ctx *acx;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	ret = test_classify_buid(acx, acl_test_rules,
+		RTE_DIM(acl_test_rules));
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		rte_acl_free(acx);
+		return -1;
+	}
+
+	for (i = RTE_ACL_CLASSIFY_SCALAR; i != RTE_ACL_CLASSIFY_NUM; i++) {
+
+		ret = rte_acl_set_ctx_classify(acx, RTE_ACL_CLASSIFY_SCALAR);
+		if (ret == 0)
+			ret = rte_acl_set_ctx_classify(acx, i);
+		if (ret == -ENOTSUP) {
+			printf("%s: classify method %u is not supported\n",
+				__func__, i);
+
+			/* the context still classifies with scalar. */
+			ret = test_classify_run(acx);
+		} else if (ret == 0)
+			ret = test_classify_run(acx);
+
+		if (ret != 0) {
+			printf("Line %i: classify method %u failed!\n",
+				__LINE__, i);
+			break;
+		}
+	}
+
+	rte_acl_free(acx);
+	if (ret != 0)
+		return -1;
+
+	t = split_test_create("acl_algs");
+	if (t == NULL)
+		return -1;
+
+	ret = test_classify_algs_split(t);
+	split_test_free(t);
+	return ret;
+}
+
 /**
  * Various tests that don't test much but improve coverage
  */
@@ -1659,6 +2418,159 @@ test_misc(void)
 	return 0;
 }
 
+/*
+ * Check that the build report describes the tries,
+ * and the split under a memory limit.
+ */
+static int
+check_build_report(const struct rte_acl_build_report *rep,
+	uint32_t num_rules, size_t max_size)
+{
+	uint32_t i, n;
+	size_t sz;
+	const struct rte_acl_trie_report *tr;
+
+	if (rep->num_tries == 0 || rep->num_tries > RTE_ACL_MAX_TRIES ||
+			rep->num_builds == 0 || rep->node_max == 0 ||
+			rep->max_size != max_size) {
+		printf("Line %i: invalid report: %u tries, %u builds, "
+			"node_max %u, max_size %zu\n", __LINE__,
+			rep->num_tries, rep->num_builds, rep->node_max,
+			rep->max_size);
+		return -1;
+	}
+
+	n = 0;
+	sz = 0;
+	for (i = 0; i != rep->num_tries; i++) {
+		tr = rep->trie + i;
+		if (tr->num_rules == 0 || tr->depth == 0 ||
+				tr->num_match == 0 ||
+				tr->dfa_mem != tr->num_dfa_gr64 *
+				64 * sizeof(uint64_t) ||
+				tr->quad_mem != tr->num_quad_vectors *
+				sizeof(uint64_t)) {
+			printf("Line %i: invalid report for trie %u\n",
+				__LINE__, i);
+			return -1;
+		}
+		n += tr->num_rules;
+		sz += tr->dfa_mem + tr->quad_mem + tr->single_mem +
+			tr->match_mem;
+	}
+
+	if (n != num_rules || sz > rep->mem_sz) {
+		printf("Line %i: report of %u rules, %zu bytes, "
+			"expected %u rules, at most %zu bytes\n",
+			__LINE__, n, sz, num_rules, rep->mem_sz);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_build_report(void)
+{
+	int ret;
+	size_t max_size;
+	struct split_test *t;
+	struct rte_acl_build_report rep, min, max;
+	uint32_t res[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+	uint32_t ref[SPLIT_NUM_PKTS * SPLIT_CATEGORIES];
+
+	t = split_test_create("acl_report");
+	if (t == NULL)
+		return -1;
+
+	ret = rte_acl_get_build_report(t->ctx, &rep);
+	if (ret != -ENOENT) {
+		printf("Line %i: report before build returned %d\n",
+			__LINE__, ret);
+		ret = -1;
+	} else
+		ret = 0;
+
+	/* no limit: smallest tries, one build. */
+	if (ret == 0)
+		ret = rte_acl_build(t->ctx, &t->cfg);
+	if (ret == 0)
+		ret = rte_acl_classify(t->ctx, t->data, ref, SPLIT_NUM_PKTS,
+			SPLIT_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_get_build_report(t->ctx, &min);
+	if (ret == 0)
+		ret = check_build_report(&min, SPLIT_NUM_RULES, 0);
+	if (ret == 0 && min.num_builds != 1) {
+		printf("Line %i: %u builds without limit\n",
+			__LINE__, min.num_builds);
+		ret = -1;
+	}
+
+	/* limit that is never reached: biggest tries, one build. */
+	if (ret == 0) {
+		t->cfg.max_size = SIZE_MAX;
+		ret = rte_acl_build(t->ctx, &t->cfg);
+	}
+	if (ret == 0)
+		ret = rte_acl_get_build_report(t->ctx, &max);
+	if (ret == 0)
+		ret = check_build_report(&max, SPLIT_NUM_RULES, SIZE_MAX);
+	if (ret == 0 && (max.num_builds != 1 ||
+			max.num_tries > min.num_tries)) {
+		printf("Line %i: %u builds, %u tries, %u tries without "
+			"limit\n", __LINE__, max.num_builds, max.num_tries,
+			min.num_tries);
+		ret = -1;
+	}
+
+	/* limit in between: the tries fit, and still classify the same. */
+	if (ret == 0 && max.mem_sz > min.mem_sz) {
+		max_size = (min.mem_sz + max.mem_sz) / 2;
+		t->cfg.max_size = max_size;
+		ret = rte_acl_build(t->ctx, &t->cfg);
+		if (ret == 0)
+			ret = rte_acl_classify(t->ctx, t->data, res,
+				SPLIT_NUM_PKTS, SPLIT_CATEGORIES);
+		if (ret == 0)
+			ret = rte_acl_get_build_report(t->ctx, &rep);
+		if (ret == 0)
+			ret = check_build_report(&rep, SPLIT_NUM_RULES, max_size);
+		if (ret == 0 && (rep.mem_sz > max_size ||
+				rep.num_tries < max.num_tries ||
+				memcmp(res, ref, sizeof(res)) != 0)) {
+			printf("Line %i: build with max_size %zu: "
+				"%zu bytes, %u tries\n",
+				__LINE__, max_size, rep.mem_sz,
+				rep.num_tries);
+			ret = -1;
+		}
+	}
+
+	/* limit too small: the report tells what was needed. */
+	if (ret == 0) {
+		t->cfg.max_size = 1;
+		ret = rte_acl_build(t->ctx, &t->cfg);
+		if (ret != -ERANGE) {
+			printf("Line %i: build with max_size 1 returned %d\n",
+				__LINE__, ret);
+			ret = -1;
+		} else
+			ret = rte_acl_get_build_report(t->ctx, &rep);
+		if (ret == 0)
+			ret = check_build_report(&rep, SPLIT_NUM_RULES, 1);
+		if (ret == 0 && (rep.mem_sz <= 1 || rep.num_builds < 2)) {
+			printf("Line %i: report of a failed build: "
+				"%zu bytes, %u builds\n",
+				__LINE__, rep.mem_sz, rep.num_builds);
+			ret = -1;
+		}
+	}
+
+	split_test_free(t);
+	return ret;
+}
+
 static int
 test_acl(void)
 {
@@ -1676,8 +2588,18 @@ test_acl(void)
 		return -1;
 	if (test_build_ports_range() < 0)
 		return -1;
+	if (test_save_load() < 0)
+		return -1;
 	if (test_convert() < 0)
 		return -1;
+	if (test_delta() < 0)
+		return -1;
+	if (test_build_threads() < 0)
+		return -1;
+	if (test_classify_algs() < 0)
+		return -1;
+	if (test_build_report() < 0)
+		return -1;
 
 	return 0;
 }
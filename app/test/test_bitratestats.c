@@ -0,0 +1,202 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_bitrate.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+#include "virtual_pmd.h"
+#include "test.h"
+
+#define BURST 32
+#define NB_MBUF 512
+#define PKT_LEN 1000
+#define CALC_PERIOD_MS 100
+
+static struct rte_mempool *bitrate_pool;
+static int bitrate_port = -1;
+
+static int
+test_bitrate_setup(void)
+{
+	struct ether_addr mac_addr = { { 0x02, 0, 0, 0, 0, 0x42 } };
+	struct rte_eth_conf null_conf;
+
+	if (bitrate_port >= 0)
+		return 0;
+
+	bitrate_pool = rte_pktmbuf_pool_create("BITRATE_MBUF_POOL", NB_MBUF,
+			BURST, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (bitrate_pool == NULL) {
+		printf("%s: Error creating mempool\n", __func__);
+		return -1;
+	}
+
+	bitrate_port = virtual_ethdev_create("eth_virt_bitrate", &mac_addr,
+			rte_socket_id(), 0);
+	if (bitrate_port < 0) {
+		printf("%s: Error creating virtual port\n", __func__);
+		return -1;
+	}
+
+	memset(&null_conf, 0, sizeof(null_conf));
+	if (rte_eth_dev_configure(bitrate_port, 1, 1, &null_conf) < 0 ||
+			rte_eth_rx_queue_setup(bitrate_port, 0, BURST,
+				rte_socket_id(), NULL, bitrate_pool) < 0 ||
+			rte_eth_tx_queue_setup(bitrate_port, 0, BURST,
+				rte_socket_id(), NULL) < 0 ||
+			rte_eth_dev_start(bitrate_port) < 0) {
+		printf("%s: Error configuring virtual port\n", __func__);
+		return -1;
+	}
+	virtual_ethdev_set_link_status(bitrate_port, 1);
+
+	return 0;
+}
+
+static int
+test_bitrate_create_free(void)
+{
+	struct rte_stats_bitrates *bitrate_data;
+	struct rte_stats_bitrate stats;
+
+	TEST_ASSERT_EQUAL(rte_stats_bitrate_get(bitrate_port, &stats), -ENOENT,
+			"Stats available before create");
+
+	bitrate_data = rte_stats_bitrate_create();
+	TEST_ASSERT_NOT_NULL(bitrate_data, "Create failed");
+	TEST_ASSERT((rte_stats_bitrate_create() == NULL) &&
+			(rte_errno == EEXIST), "No error on second create");
+
+	TEST_ASSERT_EQUAL(rte_stats_bitrate_calc(NULL, bitrate_port), -EINVAL,
+			"No error on calc with NULL data");
+	TEST_ASSERT_EQUAL(rte_stats_bitrate_get(bitrate_port, NULL), -EINVAL,
+			"No error on get with NULL stats");
+
+	rte_stats_bitrate_free(bitrate_data);
+	TEST_ASSERT_EQUAL(rte_stats_bitrate_get(bitrate_port, &stats), -ENOENT,
+			"Stats available after free");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_bitrate_calc(void)
+{
+	struct rte_stats_bitrates *bitrate_data;
+	struct rte_stats_bitrate stats;
+	struct rte_mbuf *pkts[BURST];
+	const uint64_t max_bits = (uint64_t)BURST * PKT_LEN * 8 *
+		1000 / CALC_PERIOD_MS;
+	unsigned i;
+
+	bitrate_data = rte_stats_bitrate_create();
+	TEST_ASSERT_NOT_NULL(bitrate_data, "Create failed");
+
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_calc(bitrate_data, bitrate_port),
+			"First calc failed");
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_get(bitrate_port, &stats),
+			"Cannot get stats");
+	TEST_ASSERT_EQUAL(stats.mean_obits, 0, "Rate after a single sample");
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = rte_pktmbuf_alloc(bitrate_pool);
+		TEST_ASSERT_NOT_NULL(pkts[i], "Cannot allocate mbuf");
+		TEST_ASSERT_NOT_NULL(rte_pktmbuf_append(pkts[i], PKT_LEN),
+				"Cannot set packet length");
+	}
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(bitrate_port, 0, pkts, BURST),
+			BURST, "Cannot send packets");
+
+	rte_delay_ms(CALC_PERIOD_MS);
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_calc(bitrate_data, bitrate_port),
+			"Second calc failed");
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_get(bitrate_port, &stats),
+			"Cannot get stats");
+	printf("TX mean %"PRIu64" ewma %"PRIu64" peak %"PRIu64" bps\n",
+		stats.mean_obits, stats.ewma_obits, stats.peak_obits);
+
+	/* elapsed time is at least the delay, and not much more */
+	TEST_ASSERT(stats.mean_obits <= max_bits &&
+			stats.mean_obits >= max_bits / 2,
+			"Unexpected mean TX rate");
+	TEST_ASSERT_EQUAL(stats.peak_obits, stats.mean_obits,
+			"Peak differs from the only sample");
+	TEST_ASSERT_EQUAL(stats.mean_ibits, 0, "Unexpected RX rate");
+
+	/* no more traffic: mean and average go down, peak stays */
+	rte_delay_ms(CALC_PERIOD_MS);
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_calc(bitrate_data, bitrate_port),
+			"Third calc failed");
+	TEST_ASSERT_SUCCESS(rte_stats_bitrate_get(bitrate_port, &stats),
+			"Cannot get stats");
+	TEST_ASSERT(stats.mean_obits < stats.peak_obits &&
+			stats.ewma_obits < stats.peak_obits,
+			"Rates did not decrease without traffic");
+
+	virtual_ethdev_get_mbufs_from_tx_queue(bitrate_port, pkts, BURST);
+	for (i = 0; i < BURST; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	rte_stats_bitrate_free(bitrate_data);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite bitratestats_test_suite  = {
+	.setup = test_bitrate_setup,
+	.suite_name = "Bitrate Stats Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_bitrate_create_free),
+		TEST_CASE(test_bitrate_calc),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_bitratestats(void)
+{
+	return unit_test_suite_runner(&bitratestats_test_suite);
+}
+
+static struct test_command bitratestats_cmd = {
+	.command = "bitratestats_autotest",
+	.callback = test_bitratestats,
+};
+REGISTER_TEST_COMMAND(bitratestats_cmd);
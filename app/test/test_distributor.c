@@ -40,6 +40,7 @@
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_distributor.h>
+#include <rte_distributor_burst.h>
 
 #define ITER_POWER 20 /* log 2 of how many iterations we do when timing. */
 #define BURST 32
@@ -239,6 +240,82 @@ sanity_test(struct rte_distributor *d, struct rte_mempool *p)
 	return 0;
 }
 
+/* test of the worker statistics:
+ * - send 32 packets with the same tag, so that most of them are queued in the
+ *   backlog of the worker processing the tag, and check that the statistics
+ *   account for them when collected, or are zero otherwise
+ * - check that the statistics are cleared on request
+ */
+static int
+stats_test(struct rte_distributor *d, struct rte_mempool *p)
+{
+	struct rte_distributor_stats stats;
+	struct rte_mbuf *bufs[BURST];
+	const unsigned nb_workers = rte_lcore_count() - 1;
+	uint64_t handled = 0, pinned = 0, backlog = 0, waits = 0;
+	unsigned i, j;
+
+	printf("=== Distributor statistics test ===\n");
+	if (rte_distributor_stats_read(d, nb_workers, &stats, 0) != -EINVAL) {
+		printf("Line %d: Error, invalid worker id accepted\n",
+				__LINE__);
+		return -1;
+	}
+	for (i = 0; i < nb_workers; i++)
+		rte_distributor_stats_read(d, i, NULL, 1);
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BURST; i++)
+		bufs[i]->hash.usr = 0;
+	rte_distributor_process(d, bufs, BURST);
+	rte_distributor_flush(d);
+	rte_mempool_put_bulk(p, (void *)bufs, BURST);
+
+	for (i = 0; i < nb_workers; i++) {
+		rte_distributor_stats_read(d, i, &stats, 1);
+		printf("Worker %u: %"PRIu64" handled, %"PRIu64" pinned, "
+				"%"PRIu64" backlog full, %"PRIu64" idle polls\n",
+				i, stats.handled_pkts, stats.pinned_pkts,
+				stats.backlog_full, stats.idle_polls);
+		handled += stats.handled_pkts;
+		pinned += stats.pinned_pkts;
+		for (j = 0; j < RTE_DISTRIB_STATS_BACKLOG_HIST; j++)
+			backlog += stats.backlog_hist[j];
+		for (j = 0; j < RTE_DISTRIB_STATS_WAIT_HIST; j++)
+			waits += stats.wait_hist[j];
+	}
+#ifdef RTE_DISTRIBUTOR_STATS_COLLECT
+	if (handled != BURST || pinned == 0 || backlog != pinned ||
+			waits == 0) {
+		printf("Line %d: Error, %"PRIu64" packets handled, "
+				"%"PRIu64" pinned, %"PRIu64" in backlog "
+				"histogram, %"PRIu64" waits\n", __LINE__,
+				handled, pinned, backlog, waits);
+		return -1;
+	}
+#else
+	if (handled != 0 || pinned != 0 || backlog != 0 || waits != 0) {
+		printf("Line %d: Error, statistics not collected but not "
+				"zero\n", __LINE__);
+		return -1;
+	}
+#endif
+
+	for (i = 0; i < nb_workers; i++) {
+		rte_distributor_stats_read(d, i, &stats, 0);
+		if (stats.handled_pkts != 0 || stats.pinned_pkts != 0) {
+			printf("Line %d: Error, statistics of worker %u not "
+					"cleared\n", __LINE__, i);
+			return -1;
+		}
+	}
+	printf("Statistics test done\n\n");
+	return 0;
+}
+
 
 /* to test that the distributor does not lose packets, we use this worker
  * function which frees mbufs when it gets them. The distributor thread does
@@ -478,6 +555,281 @@ int test_error_distributor_create_numworkers(void)
 }
 
 
+#define NB_FLOWS 16
+
+/* per flow sequence number expected by the burst workers */
+static volatile uint64_t flow_seq[NB_FLOWS];
+static volatile unsigned flow_errors;
+static volatile int check_flows;
+
+/* for the burst worker shutdown test: the worker given the held flow waits
+ * for hold to be cleared */
+static volatile int hold;
+static volatile int held_id = -1;
+
+/* checks that the packets of each flow are processed in sequence */
+static void
+check_flow_order(struct rte_mbuf **pkts, unsigned num)
+{
+	unsigned i, flow;
+
+	for (i = 0; i < num; i++) {
+		flow = pkts[i]->hash.usr % NB_FLOWS;
+		if (pkts[i]->udata64 != flow_seq[flow])
+			flow_errors++;
+		flow_seq[flow] = pkts[i]->udata64 + 1;
+	}
+}
+
+/* burst worker function for the sanity tests, it returns the packets and
+ * counts them */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DIST_BURST_SIZE];
+	struct rte_distributor_burst *d = arg;
+	const unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	unsigned num;
+
+	num = rte_distributor_burst_get_pkt(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += num;
+		if (check_flows)
+			check_flow_order(pkts, num);
+		if (hold && held_id < 0) {
+			held_id = id;
+			while (hold)
+				rte_pause();
+		}
+		if (zero_quit && held_id == (int)id) {
+			/* return the packets once the distributor waits for
+			 * room in the backlog, and come back when asked to */
+			usleep(10000);
+			rte_distributor_burst_return_pkt(d, id, pkts, num);
+			while (zero_quit)
+				usleep(100);
+			num = 0;
+		}
+		num = rte_distributor_burst_get_pkt(d, id, pkts, pkts, num);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_burst_return_pkt(d, id, pkts, num);
+	return 0;
+}
+
+/* sanity tests of the burst distributor:
+ * - send 32 packets with the same tag and ensure they all go to one worker
+ * - send 1024 packets with different tags, gathering the returned packets as
+ *   we go, and verify that we got all the pointers back again
+ * - send 1024 packets of 16 flows, and verify that the workers processed the
+ *   packets of each flow in sequence
+ * - with 2 workers at least, hold the worker processing a flow while more
+ *   packets of the flow are queued for it, then make it return: its backlog
+ *   has to be processed by the other workers.
+ * - with 3 workers at least, do the same while the distributor waits for
+ *   room in the backlog of that worker: the flow has to move to one worker.
+ */
+static int
+sanity_test_burst(struct rte_distributor_burst *d, struct rte_mempool *p)
+{
+	struct rte_mbuf *many_bufs[BIG_BATCH], *return_bufs[BIG_BATCH];
+	unsigned i, j, num_returned = 0, nb_workers = rte_lcore_count() - 1;
+
+	printf("=== Burst distributor sanity tests ===\n");
+	clear_packet_count();
+	if (rte_mempool_get_bulk(p, (void *)many_bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+
+	/* all zero tags: one worker gets all the packets */
+	for (i = 0; i < BURST; i++)
+		many_bufs[i]->hash.usr = 0;
+	rte_distributor_burst_process(d, many_bufs, BURST);
+	rte_distributor_burst_flush(d);
+	for (i = 0; i < nb_workers; i++)
+		if (worker_stats[i].handled_packets != 0 &&
+				worker_stats[i].handled_packets != BURST) {
+			printf("Line %d: Error, worker %u handled %u packets\n",
+				__LINE__, i, worker_stats[i].handled_packets);
+			return -1;
+		}
+	if (total_packet_count() != BURST) {
+		printf("Line %d: Error, not all packets flushed. "
+				"Expected %u, got %u\n",
+				__LINE__, BURST, total_packet_count());
+		return -1;
+	}
+	printf("Sanity test with all zero hashes done.\n");
+
+	/* all different tags, check that all the packets come back */
+	clear_packet_count();
+	rte_distributor_burst_clear_returns(d);
+	for (i = 0; i < BIG_BATCH; i++)
+		many_bufs[i]->hash.usr = i << 2;
+	for (i = 0; i < BIG_BATCH / BURST; i++) {
+		rte_distributor_burst_process(d, &many_bufs[i * BURST], BURST);
+		num_returned += rte_distributor_burst_returned_pkts(d,
+				&return_bufs[num_returned],
+				BIG_BATCH - num_returned);
+	}
+	rte_distributor_burst_flush(d);
+	num_returned += rte_distributor_burst_returned_pkts(d,
+			&return_bufs[num_returned], BIG_BATCH - num_returned);
+	if (num_returned != BIG_BATCH) {
+		printf("line %d: Number returned is not the same as "
+				"number sent\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BIG_BATCH; i++) {
+		for (j = 0; j < BIG_BATCH; j++)
+			if (return_bufs[j] == many_bufs[i])
+				break;
+		if (j == BIG_BATCH) {
+			printf("Error: could not find source packet #%u\n", i);
+			return -1;
+		}
+	}
+	for (i = 0; i < nb_workers; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+	printf("Sanity test of returned packets done\n");
+
+	/* flows in sequence */
+	clear_packet_count();
+	memset((void *)(uintptr_t)flow_seq, 0, sizeof(flow_seq));
+	flow_errors = 0;
+	for (i = 0; i < BIG_BATCH; i++) {
+		many_bufs[i]->hash.usr = i % NB_FLOWS;
+		many_bufs[i]->udata64 = i / NB_FLOWS;
+	}
+	check_flows = 1;
+	for (i = 0; i < BIG_BATCH / BURST; i++)
+		rte_distributor_burst_process(d, &many_bufs[i * BURST], BURST);
+	rte_distributor_burst_flush(d);
+	check_flows = 0;
+	if (flow_errors != 0 || total_packet_count() != BIG_BATCH) {
+		printf("Line %d: Error, %u packets out of sequence, "
+				"%u packets handled\n", __LINE__,
+				flow_errors, total_packet_count());
+		return -1;
+	}
+	printf("Sanity test of flow sequences done\n");
+
+	if (nb_workers >= 2) {
+		/* the worker given the first burst of the flow holds it */
+		clear_packet_count();
+		for (i = 0; i < 2 * RTE_DIST_BURST_SIZE; i++)
+			many_bufs[i]->hash.usr = 1;
+		held_id = -1;
+		hold = 1;
+		rte_distributor_burst_process(d, many_bufs,
+				RTE_DIST_BURST_SIZE);
+		while (held_id < 0)
+			rte_distributor_burst_process(d, NULL, 0);
+
+		/* queue the next burst of the flow for it, then make it
+		 * return its packets instead of requesting more */
+		rte_distributor_burst_process(d,
+				&many_bufs[RTE_DIST_BURST_SIZE],
+				RTE_DIST_BURST_SIZE);
+		zero_quit = 1;
+		hold = 0;
+		rte_distributor_burst_flush(d);
+		if (total_packet_count() != 2 * RTE_DIST_BURST_SIZE ||
+				worker_stats[held_id].handled_packets !=
+					RTE_DIST_BURST_SIZE) {
+			printf("Line %d: Error, %u packets handled, %u by "
+				"the worker shutting down\n", __LINE__,
+				total_packet_count(),
+				worker_stats[held_id].handled_packets);
+			zero_quit = 0;
+			return -1;
+		}
+		zero_quit = 0;
+		printf("Sanity test with worker shutdown done\n");
+	}
+
+	if (nb_workers >= 3) {
+		clear_packet_count();
+		memset((void *)(uintptr_t)flow_seq, 0, sizeof(flow_seq));
+		flow_errors = 0;
+		for (i = 0; i < 3 * RTE_DIST_BURST_SIZE; i++) {
+			many_bufs[i]->hash.usr = 1;
+			many_bufs[i]->udata64 = i;
+		}
+		check_flows = 1;
+		held_id = -1;
+		hold = 1;
+		rte_distributor_burst_process(d, many_bufs,
+				RTE_DIST_BURST_SIZE);
+		while (held_id < 0)
+			rte_distributor_burst_process(d, NULL, 0);
+		rte_distributor_burst_process(d,
+				&many_bufs[RTE_DIST_BURST_SIZE],
+				RTE_DIST_BURST_SIZE);
+
+		/* the held worker shuts down while the next burst of the
+		 * flow waits for room in its full backlog */
+		zero_quit = 1;
+		hold = 0;
+		rte_distributor_burst_process(d,
+				&many_bufs[2 * RTE_DIST_BURST_SIZE],
+				RTE_DIST_BURST_SIZE);
+		rte_distributor_burst_flush(d);
+		check_flows = 0;
+		for (i = 0; i < nb_workers; i++)
+			if (worker_stats[i].handled_packets ==
+					2 * RTE_DIST_BURST_SIZE)
+				break;
+		if (flow_errors != 0 || i == nb_workers ||
+				worker_stats[held_id].handled_packets !=
+					RTE_DIST_BURST_SIZE) {
+			printf("Line %d: Error, %u packets out of sequence, "
+				"the flow was split after the shutdown\n",
+				__LINE__, flow_errors);
+			zero_quit = 0;
+			return -1;
+		}
+		zero_quit = 0;
+		printf("Sanity test with worker shutdown in a burst done\n");
+	}
+
+	rte_mempool_put_bulk(p, (void *)many_bufs, BIG_BATCH);
+	printf("\n");
+	return 0;
+}
+
+/* Ensures that all burst worker functions terminate */
+static void
+quit_workers_burst(struct rte_distributor_burst *d, struct rte_mempool *p)
+{
+	const unsigned num_workers = rte_lcore_count() - 1;
+	unsigned i, lcore, running;
+	struct rte_mbuf *bufs[RTE_MAX_LCORE];
+	rte_mempool_get_bulk(p, (void *)bufs, num_workers);
+
+	zero_quit = 0;
+	quit = 1;
+	for (i = 0; i < num_workers; i++)
+		bufs[i]->hash.usr = i << 1;
+	/* a worker rejoining after a shutdown may not be active yet, so keep
+	 * sending until all of them have seen a packet and exited */
+	do {
+		rte_distributor_burst_process(d, bufs, num_workers);
+		rte_distributor_burst_flush(d);
+		running = 0;
+		RTE_LCORE_FOREACH_SLAVE(lcore)
+			if (rte_eal_get_lcore_state(lcore) == RUNNING)
+				running++;
+	} while (running != 0);
+
+	rte_mempool_put_bulk(p, (void *)bufs, num_workers);
+	rte_eal_mp_wait_lcore();
+	quit = 0;
+	worker_idx = 0;
+}
+
 /* Useful function which ensures that all worker functions terminate */
 static void
 quit_workers(struct rte_distributor *d, struct rte_mempool *p)
@@ -506,6 +858,7 @@ static int
 test_distributor(void)
 {
 	static struct rte_distributor *d;
+	static struct rte_distributor_burst *db;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -539,6 +892,8 @@ test_distributor(void)
 	rte_eal_mp_remote_launch(handle_work, d, SKIP_MASTER);
 	if (sanity_test(d, p) < 0)
 		goto err;
+	if (stats_test(d, p) < 0)
+		goto err;
 	quit_workers(d, p);
 
 	rte_eal_mp_remote_launch(handle_work_with_free_mbufs, d, SKIP_MASTER);
@@ -563,6 +918,25 @@ test_distributor(void)
 		printf("Not enough cores to run tests for worker shutdown\n");
 	}
 
+	if (db == NULL) {
+		db = rte_distributor_burst_create("Test_dist_burst",
+				rte_socket_id(), rte_lcore_count() - 1);
+		if (db == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_burst_flush(db);
+		rte_distributor_burst_clear_returns(db);
+	}
+
+	rte_eal_mp_remote_launch(handle_work_burst, db, SKIP_MASTER);
+	if (sanity_test_burst(db, p) < 0) {
+		quit_workers_burst(db, p);
+		return -1;
+	}
+	quit_workers_burst(db, p);
+
 	if (test_error_distributor_create_numworkers() == -1 ||
 			test_error_distributor_create_name() == -1) {
 		printf("rte_distributor_create parameter check tests failed");
@@ -0,0 +1,405 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ip.h>
+#include <rte_random.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+
+#include "test.h"
+
+#define MAX_ROUTES	(1 << 12)
+#define NUMBER_TBL8S	(1 << 7)
+#define DEF_NH		100
+
+static const enum rte_fib_dir24_8_nh_sz nh_sizes[] = {
+	RTE_FIB_DIR24_8_1B,
+	RTE_FIB_DIR24_8_2B,
+	RTE_FIB_DIR24_8_4B,
+	RTE_FIB_DIR24_8_8B,
+};
+
+static void
+fib_conf_init(struct rte_fib_conf *config, enum rte_fib_type type,
+	enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	config->type = type;
+	config->default_nh = DEF_NH;
+	config->max_routes = MAX_ROUTES;
+	config->dir24_8.nh_sz = nh_sz;
+	config->dir24_8.num_tbl8 = NUMBER_TBL8S;
+}
+
+static int
+test_fib_create_invalid(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+
+	fib_conf_init(&config, RTE_FIB_DIR24_8, RTE_FIB_DIR24_8_1B);
+
+	fib = rte_fib_create(NULL, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with invalid name\n");
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, NULL);
+	TEST_ASSERT(fib == NULL, "Call succeeded with NULL config\n");
+
+	config.max_routes = 0;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with 0 routes\n");
+	config.max_routes = MAX_ROUTES;
+
+	config.type = RTE_FIB_TYPE_MAX;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with invalid type\n");
+	config.type = RTE_FIB_DIR24_8;
+
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_8B + 1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with invalid nh size\n");
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_1B;
+
+	config.dir24_8.num_tbl8 = 0;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with 0 tbl8 groups\n");
+
+	/* Group indexes must fit in 1-byte entries too. */
+	config.dir24_8.num_tbl8 = NUMBER_TBL8S + 1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with too many groups\n");
+	config.dir24_8.num_tbl8 = NUMBER_TBL8S;
+
+	config.default_nh = 1 << 7;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib == NULL, "Call succeeded with invalid default nh\n");
+	config.default_nh = DEF_NH;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	TEST_ASSERT(rte_fib_create(__func__, SOCKET_ID_ANY, &config) == NULL &&
+			rte_errno == EEXIST, "Created FIB with a used name\n");
+	TEST_ASSERT(rte_fib_find_existing(__func__) == fib,
+			"Failed to find FIB\n");
+	rte_fib_free(fib);
+	TEST_ASSERT(rte_fib_find_existing(__func__) == NULL,
+			"Found freed FIB\n");
+
+	rte_fib_free(NULL);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_fib_add_del_invalid(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	uint32_t ip = IPv4(10, 0, 0, 0);
+	uint64_t nh;
+
+	fib_conf_init(&config, RTE_FIB_DIR24_8, RTE_FIB_DIR24_8_1B);
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	TEST_ASSERT(rte_fib_add(NULL, ip, 8, 1) == -EINVAL,
+			"Call succeeded with invalid parameters\n");
+	TEST_ASSERT(rte_fib_add(fib, ip, RTE_FIB_MAXDEPTH + 1, 1) == -EINVAL,
+			"Call succeeded with invalid depth\n");
+	TEST_ASSERT(rte_fib_add(fib, ip, 8, 1 << 7) == -EINVAL,
+			"Call succeeded with too large next hop\n");
+	TEST_ASSERT(rte_fib_delete(NULL, ip, 8) == -EINVAL,
+			"Call succeeded with invalid parameters\n");
+	TEST_ASSERT(rte_fib_delete(fib, ip, RTE_FIB_MAXDEPTH + 1) == -EINVAL,
+			"Call succeeded with invalid depth\n");
+	TEST_ASSERT(rte_fib_delete(fib, ip, 8) == -ENOENT,
+			"Deleted a missing route\n");
+	TEST_ASSERT(rte_fib_lookup_bulk(fib, NULL, &nh, 1) == -EINVAL,
+			"Call succeeded with invalid parameters\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Add the routes of an IP with all the depths and check the lookups of
+ * addresses around it while they are deleted one by one.
+ */
+static int
+check_fib_nested(struct rte_fib *fib, uint64_t max_nh)
+{
+	uint32_t ip = IPv4(128, 255, 127, 128);
+	uint32_t ips[4];
+	uint64_t nhs[4], nh;
+	int depth;
+	unsigned i;
+
+	for (depth = 0; depth <= RTE_FIB_MAXDEPTH; depth++)
+		TEST_ASSERT_SUCCESS(rte_fib_add(fib, ip, depth,
+				max_nh - depth), "Failed to add /%d\n", depth);
+
+	for (depth = RTE_FIB_MAXDEPTH; depth >= 0; depth--) {
+		/* The address itself, and the first address outside each
+		 * of the 4 longest remaining routes. */
+		ips[0] = ip;
+		for (i = 1; i < RTE_DIM(ips); i++)
+			ips[i] = (depth >= (int)i) ?
+				ip ^ (UINT32_C(1) << (32 - depth + i - 1)) :
+				ip;
+		TEST_ASSERT_SUCCESS(rte_fib_lookup_bulk(fib, ips, nhs,
+				RTE_DIM(ips)), "Lookup failed\n");
+		for (i = 0; i < RTE_DIM(ips); i++) {
+			nh = max_nh - depth +
+				((depth >= (int)i) ? i : 0);
+			TEST_ASSERT(nhs[i] == nh, "Wrong next hop %"PRIu64
+				" for address %u at depth %d\n",
+				nhs[i], i, depth);
+		}
+
+		TEST_ASSERT_SUCCESS(rte_fib_delete(fib, ip, depth),
+				"Failed to delete /%d\n", depth);
+	}
+
+	TEST_ASSERT_SUCCESS(rte_fib_lookup_bulk(fib, ips, nhs, 1),
+			"Lookup failed\n");
+	TEST_ASSERT(nhs[0] == DEF_NH, "Route left after deletion\n");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_fib_nested(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	unsigned i;
+
+	fib_conf_init(&config, RTE_FIB_DUMMY, RTE_FIB_DIR24_8_1B);
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	TEST_ASSERT_SUCCESS(check_fib_nested(fib, 127), "Dummy FIB failed\n");
+	rte_fib_free(fib);
+
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		fib_conf_init(&config, RTE_FIB_DIR24_8, nh_sizes[i]);
+		fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+		TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+		TEST_ASSERT_SUCCESS(check_fib_nested(fib,
+				(UINT64_C(1) << ((8 << nh_sizes[i]) - 1)) - 1),
+				"DIR24_8 FIB with %u byte next hops failed\n",
+				1 << nh_sizes[i]);
+		rte_fib_free(fib);
+	}
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Only one tbl8 group is needed per /24 holding routes longer than 24
+ * bits, and it is available again once all of them are deleted.
+ */
+static int
+test_fib_tbl8_exhaustion(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+
+	fib_conf_init(&config, RTE_FIB_DIR24_8, RTE_FIB_DIR24_8_2B);
+	config.dir24_8.num_tbl8 = 2;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	TEST_ASSERT_SUCCESS(rte_fib_add(fib, IPv4(10, 0, 0, 0), 25, 1),
+			"Failed to add route\n");
+	TEST_ASSERT_SUCCESS(rte_fib_add(fib, IPv4(10, 0, 0, 128), 25, 2),
+			"Failed to add route\n");
+	TEST_ASSERT_SUCCESS(rte_fib_add(fib, IPv4(10, 0, 1, 0), 32, 3),
+			"Failed to add route\n");
+	TEST_ASSERT(rte_fib_add(fib, IPv4(10, 0, 2, 0), 32, 4) == -ENOSPC,
+			"Added a route without tbl8 group\n");
+
+	/* Routes up to /24 never need a group. */
+	TEST_ASSERT_SUCCESS(rte_fib_add(fib, IPv4(10, 0, 0, 0), 8, 5),
+			"Failed to add route\n");
+
+	TEST_ASSERT_SUCCESS(rte_fib_delete(fib, IPv4(10, 0, 0, 0), 25),
+			"Failed to delete route\n");
+	TEST_ASSERT(rte_fib_add(fib, IPv4(10, 0, 2, 0), 32, 4) == -ENOSPC,
+			"Added a route without tbl8 group\n");
+	TEST_ASSERT_SUCCESS(rte_fib_delete(fib, IPv4(10, 0, 0, 128), 25),
+			"Failed to delete route\n");
+	TEST_ASSERT_SUCCESS(rte_fib_add(fib, IPv4(10, 0, 2, 0), 32, 4),
+			"Failed to add route\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Load the same random routes in a dummy FIB, which looks up the RIB, and
+ * in a DIR-24-8 FIB, and compare the lookups of random addresses while the
+ * routes are added and deleted. The routes are drawn in a /16 so that they
+ * overlap, with depths from 12 to 32, and the addresses in the /12 around.
+ */
+#define RND_ROUTES	2000
+#define RND_LOOKUPS	(1 << 14)
+
+static int
+compare_fibs(struct rte_fib *ref, struct rte_fib *fib, uint32_t base)
+{
+	static uint32_t ips[RND_LOOKUPS];
+	static uint64_t ref_nhs[RND_LOOKUPS], nhs[RND_LOOKUPS];
+	unsigned i;
+
+	for (i = 0; i < RND_LOOKUPS; i++)
+		ips[i] = base | ((uint32_t)rte_rand() & 0xfffff);
+
+	TEST_ASSERT_SUCCESS(rte_fib_lookup_bulk(ref, ips, ref_nhs,
+			RND_LOOKUPS), "Lookup failed\n");
+	TEST_ASSERT_SUCCESS(rte_fib_lookup_bulk(fib, ips, nhs, RND_LOOKUPS),
+			"Lookup failed\n");
+	for (i = 0; i < RND_LOOKUPS; i++)
+		TEST_ASSERT(ref_nhs[i] == nhs[i], "Next hop %"PRIu64
+			" instead of %"PRIu64" for %08x\n",
+			nhs[i], ref_nhs[i], ips[i]);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_fib_random(void)
+{
+	static uint32_t route_ip[RND_ROUTES];
+	static uint8_t route_depth[RND_ROUTES];
+	const uint32_t base = IPv4(10, 0, 0, 0);
+	struct rte_fib *ref, *fib;
+	struct rte_fib_conf config;
+	uint64_t max_nh, nh;
+	unsigned i, j;
+	int ret;
+
+	fib_conf_init(&config, RTE_FIB_DUMMY, RTE_FIB_DIR24_8_1B);
+	config.max_routes = RND_ROUTES;
+	ref = rte_fib_create("test_fib_ref", SOCKET_ID_ANY, &config);
+	TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < RTE_DIM(nh_sizes); i++) {
+		max_nh = (UINT64_C(1) << ((8 << nh_sizes[i]) - 1)) - 1;
+		fib_conf_init(&config, RTE_FIB_DIR24_8, nh_sizes[i]);
+		config.max_routes = RND_ROUTES;
+		fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+		TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+		for (j = 0; j < RND_ROUTES; j++) {
+			route_depth[j] = 12 + rte_rand() % 21;
+			route_ip[j] = (base | ((uint32_t)rte_rand() & 0xffff)) &
+				rte_rib_depth_to_mask(route_depth[j]);
+			nh = rte_rand() & max_nh;
+			ret = rte_fib_add(fib, route_ip[j], route_depth[j], nh);
+			/* The groups may run out, the RIB must not. */
+			if (ret == -ENOSPC) {
+				route_depth[j] = 0;
+				continue;
+			}
+			TEST_ASSERT_SUCCESS(ret, "Failed to add route\n");
+			TEST_ASSERT_SUCCESS(rte_fib_add(ref, route_ip[j],
+					route_depth[j], nh),
+					"Failed to add route\n");
+		}
+		TEST_ASSERT_SUCCESS(compare_fibs(ref, fib, base),
+				"Lookups differ after add\n");
+
+		/* Delete half of the routes, then the rest. */
+		for (j = 0; j < RND_ROUTES; j++) {
+			if (j == RND_ROUTES / 2)
+				TEST_ASSERT_SUCCESS(compare_fibs(ref, fib, base),
+					"Lookups differ after delete\n");
+			if (route_depth[j] == 0)
+				continue;
+			/* The same route may have been drawn twice. */
+			ret = rte_fib_delete(fib, route_ip[j], route_depth[j]);
+			TEST_ASSERT(ret == 0 || ret == -ENOENT,
+					"Failed to delete route\n");
+			TEST_ASSERT(rte_fib_delete(ref, route_ip[j],
+					route_depth[j]) == ret,
+					"Delete results differ\n");
+		}
+		TEST_ASSERT_SUCCESS(compare_fibs(ref, fib, base),
+				"Lookups differ after delete\n");
+
+		/* Every tbl8 group is free again. */
+		for (j = 0; j < NUMBER_TBL8S; j++)
+			TEST_ASSERT_SUCCESS(rte_fib_add(fib,
+					IPv4(20, 0, j, 0), 32, 1),
+					"tbl8 group leaked\n");
+
+		rte_fib_free(fib);
+	}
+
+	rte_fib_free(ref);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib_tests = {
+	.suite_name = "fib autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_fib_create_invalid),
+		TEST_CASE(test_fib_add_del_invalid),
+		TEST_CASE(test_fib_nested),
+		TEST_CASE(test_fib_tbl8_exhaustion),
+		TEST_CASE(test_fib_random),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_fib(void)
+{
+	return unit_test_suite_runner(&fib_tests);
+}
+
+static struct test_command fib_cmd = {
+	.command = "fib_autotest",
+	.callback = test_fib,
+};
+REGISTER_TEST_COMMAND(fib_cmd);
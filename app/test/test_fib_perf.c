@@ -0,0 +1,213 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_branch_prediction.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+
+#include "test.h"
+
+#define TEST_FIB_ASSERT(cond) do {                                            \
+	if (!(cond)) {                                                        \
+		printf("Error at line %d:\n", __LINE__);                      \
+		return -1;                                                    \
+	}                                                                     \
+} while (0)
+
+#define ITERATIONS (1 << 10)
+#define BATCH_SIZE (1 << 12)
+#define BULK_SIZE 32
+#define UPDATES (1 << 17)
+#define NUMBER_TBL8S 80000
+#define DEF_NH 0
+
+/*
+ * Synthetic table of about one million routes, with the prefix length
+ * distribution of an Internet routing table, and 71000 routes longer
+ * than /24.
+ */
+static const struct {
+	uint8_t depth;
+	uint32_t n;
+} route_distribution[] = {
+	{  8,     16 }, {  9,     12 }, { 10,     32 }, { 11,     96 },
+	{ 12,    256 }, { 13,    512 }, { 14,   1024 }, { 15,   1800 },
+	{ 16,  14000 }, { 17,   8000 }, { 18,  14000 }, { 19,  30000 },
+	{ 20,  50000 }, { 21,  60000 }, { 22, 110000 }, { 23, 100000 },
+	{ 24, 540000 }, { 25,  10000 }, { 26,  10000 }, { 27,  10000 },
+	{ 28,  10000 }, { 29,  10000 }, { 30,  10000 }, { 31,   1000 },
+	{ 32,  10000 },
+};
+
+struct route {
+	uint32_t ip;
+	uint8_t depth;
+	uint64_t nh;
+};
+
+static double
+cycles_to_ns(double cycles)
+{
+	return cycles * 1E9 / rte_get_tsc_hz();
+}
+
+static int
+test_fib_perf(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	struct route *table;
+	uint64_t begin, total_time;
+	uint32_t i, j, n_routes = 0;
+	int64_t count = 0;
+	int status;
+
+	for (i = 0; i < RTE_DIM(route_distribution); i++)
+		n_routes += route_distribution[i].n;
+
+	table = rte_malloc(NULL, n_routes * sizeof(*table), 0);
+	TEST_FIB_ASSERT(table != NULL);
+
+	/* Fixed seed, so that runs can be compared with each other */
+	rte_srand(0x5eed);
+	for (i = 0, n_routes = 0; i < RTE_DIM(route_distribution); i++) {
+		uint8_t depth = route_distribution[i].depth;
+
+		for (j = 0; j < route_distribution[i].n; j++) {
+			table[n_routes].ip = (uint32_t)rte_rand() &
+					rte_rib_depth_to_mask(depth);
+			table[n_routes].depth = depth;
+			table[n_routes].nh = (uint32_t)rte_rand() &
+					((UINT32_C(1) << 31) - 1);
+			n_routes++;
+		}
+	}
+
+	config.type = RTE_FIB_DIR24_8;
+	config.default_nh = DEF_NH;
+	config.max_routes = n_routes;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = NUMBER_TBL8S;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_FIB_ASSERT(fib != NULL);
+
+	/* Measure add */
+	begin = rte_rdtsc();
+	for (i = 0; i < n_routes; i++) {
+		status = rte_fib_add(fib, table[i].ip, table[i].depth,
+				table[i].nh);
+		TEST_FIB_ASSERT(status == 0);
+	}
+	total_time = rte_rdtsc() - begin;
+
+	printf("Routes = %u\n", n_routes);
+	printf("Average FIB Add: %g cycles, %.1f ns\n",
+			(double)total_time / n_routes,
+			cycles_to_ns((double)total_time / n_routes));
+
+	/* Measure bulk lookup */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		static uint32_t ip_batch[BATCH_SIZE];
+		uint64_t next_hops[BULK_SIZE];
+
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE) {
+			unsigned k;
+
+			rte_fib_lookup_bulk(fib, &ip_batch[j], next_hops,
+					BULK_SIZE);
+			for (k = 0; k < BULK_SIZE; k++)
+				if (unlikely(next_hops[k] == DEF_NH))
+					count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("BULK FIB Lookup: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	/* Measure updates of random routes, delete and add back */
+	total_time = 0;
+	for (i = 0; i < UPDATES; i++) {
+		struct route *r = &table[rte_rand() % n_routes];
+
+		begin = rte_rdtsc();
+		status = rte_fib_delete(fib, r->ip, r->depth);
+		if (status == 0)
+			status = rte_fib_add(fib, r->ip, r->depth, r->nh);
+		total_time += rte_rdtsc() - begin;
+		TEST_FIB_ASSERT(status == 0);
+	}
+	printf("Average FIB Update: %g cycles, %.1f ns\n",
+			(double)total_time / (2 * UPDATES),
+			cycles_to_ns((double)total_time / (2 * UPDATES)));
+
+	/* Measure delete */
+	begin = rte_rdtsc();
+	for (i = 0; i < n_routes; i++) {
+		/* The same route may have been drawn twice. */
+		status = rte_fib_delete(fib, table[i].ip, table[i].depth);
+		TEST_FIB_ASSERT(status == 0 || status == -ENOENT);
+	}
+	total_time = rte_rdtsc() - begin;
+
+	printf("Average FIB Delete: %g cycles, %.1f ns\n",
+			(double)total_time / n_routes,
+			cycles_to_ns((double)total_time / n_routes));
+
+	rte_fib_free(fib);
+	rte_free(table);
+
+	return 0;
+}
+
+static struct test_command fib_perf_cmd = {
+	.command = "fib_perf_autotest",
+	.callback = test_fib_perf,
+};
+REGISTER_TEST_COMMAND(fib_perf_cmd);
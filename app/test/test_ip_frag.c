@@ -0,0 +1,599 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ip_frag.h>
+
+#define DGRAM_NUM 512
+#define FRAG_LEN 64
+#define MAX_CYCLES 1000
+#define NB_MBUF (2 * DGRAM_NUM)
+#define MBUF_DATA_SIZE (3648 + RTE_PKTMBUF_HEADROOM) /* largest packet */
+
+typedef struct rte_ip_frag_tbl *(*table_create_t)(uint32_t bucket_num,
+		uint32_t bucket_entries, uint32_t max_entries,
+		uint64_t max_cycles, int socket_id);
+
+#define IPV4_MTU_SIZE 1004  /* 984 bytes of payload per fragment */
+#define IPV6_MTU_SIZE 1008  /* 960 bytes of payload per fragment */
+#define MAX_PKT_BURST 8
+
+/* payload length of the packets fragmented, the last one in 2 segments */
+static const uint32_t burst_payload_len[] = {40, 984, 2000, 3600, 2500};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *indirect_pool;
+
+/* build the first fragment of datagram dgram */
+static struct rte_mbuf *
+build_first_fragment(unsigned dgram)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m,
+		sizeof(*eth) + sizeof(*ip) + FRAG_LEN);
+	memset(eth, 0, sizeof(*eth) + sizeof(*ip));
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *)(eth + 1);
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_LEN);
+	ip->packet_id = rte_cpu_to_be_16(1);
+	ip->fragment_offset = rte_cpu_to_be_16(IPV4_HDR_MF_FLAG);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1) + dgram);
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 1, 0, 1));
+
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip);
+	return m;
+}
+
+/*
+ * Add the first fragment of each datagram, datagram d arriving at d,
+ * then check that the table expires the entries older than its TTL,
+ * as far as the death row can hold their fragments.
+ */
+static int
+test_table_expire(const char *name, table_create_t create)
+{
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *m;
+	unsigned i, n, calls, total;
+
+	tbl = create(DGRAM_NUM, 4, 2 * DGRAM_NUM, MAX_CYCLES,
+		rte_socket_id());
+	TEST_ASSERT_NOT_NULL(tbl, "%s: cannot create table", name);
+
+	dr.cnt = 0;
+	for (i = 0; i != DGRAM_NUM; i++) {
+		m = build_first_fragment(i);
+		TEST_ASSERT_NOT_NULL(m, "%s: cannot allocate mbuf", name);
+		m = rte_ipv4_frag_reassemble_packet(tbl, &dr, m, i,
+			rte_pktmbuf_mtod_offset(m, struct ipv4_hdr *,
+				sizeof(struct ether_hdr)));
+		TEST_ASSERT(m == NULL && dr.cnt == 0,
+			"%s: fragment %u not added", name, i);
+	}
+	TEST_ASSERT_EQUAL(tbl->use_entries, DGRAM_NUM,
+		"%s: %u entries in use", name, tbl->use_entries);
+
+	/* no entry is older than its TTL yet */
+	n = rte_ip_frag_table_expire(tbl, MAX_CYCLES, &dr);
+	TEST_ASSERT(n == 0 && dr.cnt == 0,
+		"%s: %u entries expired before their TTL", name, n);
+
+	/* the first 100 datagrams time out */
+	n = rte_ip_frag_table_expire(tbl, MAX_CYCLES + 100, &dr);
+	TEST_ASSERT(n == 100 && dr.cnt == 100,
+		"%s: %u entries expired, %u mbufs on death row, expected 100",
+		name, n, dr.cnt);
+	TEST_ASSERT_EQUAL(tbl->use_entries, DGRAM_NUM - 100,
+		"%s: %u entries in use", name, tbl->use_entries);
+	rte_ip_frag_free_death_row(&dr, 0);
+
+	/* all the others, over several calls as the death row fills up */
+	total = 0;
+	calls = 0;
+	do {
+		n = rte_ip_frag_table_expire(tbl, 2 * MAX_CYCLES + DGRAM_NUM,
+			&dr);
+		TEST_ASSERT_EQUAL(dr.cnt, n,
+			"%s: %u entries expired, %u mbufs on death row",
+			name, n, dr.cnt);
+		rte_ip_frag_free_death_row(&dr, 0);
+		total += n;
+		calls++;
+	} while (n != 0);
+
+	TEST_ASSERT_EQUAL(total, DGRAM_NUM - 100,
+		"%s: %u entries expired, expected %u",
+		name, total, DGRAM_NUM - 100);
+	TEST_ASSERT(calls > 2, "%s: death row overflow not handled", name);
+	TEST_ASSERT_EQUAL(tbl->use_entries, 0,
+		"%s: %u entries in use", name, tbl->use_entries);
+
+	rte_ip_frag_table_destroy(tbl);
+	return 0;
+}
+
+/* build a packet with the given payload pattern, in one or two segments */
+static struct rte_mbuf *
+build_packet(int ipv6, uint32_t len, uint8_t seed, int chained)
+{
+	struct rte_mbuf *m, *seg;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	uint32_t i, hdr_len, seg_len;
+	uint8_t *p;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	hdr_len = ipv6 ? sizeof(*ip6) : sizeof(*ip4);
+	seg_len = chained ? len / 2 : len;
+	p = (uint8_t *)rte_pktmbuf_append(m, hdr_len + seg_len);
+	if (p == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	if (ipv6) {
+		ip6 = (struct ipv6_hdr *)p;
+		memset(ip6, 0, sizeof(*ip6));
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->payload_len = rte_cpu_to_be_16(len);
+		ip6->proto = IPPROTO_UDP;
+		ip6->hop_limits = 64;
+		ip6->src_addr[15] = seed;
+		ip6->dst_addr[15] = 1;
+	} else {
+		ip4 = (struct ipv4_hdr *)p;
+		memset(ip4, 0, sizeof(*ip4));
+		ip4->version_ihl = 0x45;
+		ip4->total_length = rte_cpu_to_be_16(sizeof(*ip4) + len);
+		ip4->packet_id = rte_cpu_to_be_16(seed);
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = IPPROTO_UDP;
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, seed));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(10, 1, 0, 1));
+	}
+
+	p += hdr_len;
+	for (i = 0; i != seg_len; i++)
+		p[i] = (uint8_t)(seed + i);
+
+	if (chained) {
+		seg = rte_pktmbuf_alloc(pkt_pool);
+		if (seg == NULL) {
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		p = (uint8_t *)rte_pktmbuf_append(seg, len - seg_len);
+		for (; i != len; i++)
+			p[i - seg_len] = (uint8_t)(seed + i);
+		m->next = seg;
+		m->nb_segs = 2;
+		m->pkt_len += seg->data_len;
+	}
+
+	return m;
+}
+
+/* check the payload pattern of a (reassembled) packet */
+static int
+check_payload(struct rte_mbuf *m, uint32_t hdr_len, uint32_t len,
+	uint8_t seed)
+{
+	const uint8_t *p;
+	uint32_t i, j, ofs;
+
+	if (m->pkt_len != hdr_len + len)
+		return -1;
+
+	i = 0;
+	ofs = hdr_len;
+	for (; m != NULL; m = m->next) {
+		p = rte_pktmbuf_mtod(m, const uint8_t *);
+		for (j = ofs; j < m->data_len; j++, i++)
+			if (p[j] != (uint8_t)(seed + i))
+				return -1;
+		ofs = (ofs > m->data_len) ? ofs - m->data_len : 0;
+	}
+
+	return (i == len) ? 0 : -1;
+}
+
+/*
+ * Fragment two IPv6 packets one at a time, check the offset and more
+ * fragments flag of the fragment headers, and check that reassembling
+ * their interleaved fragments gives back the packets. The source
+ * addresses of the packets only differ in their last byte.
+ */
+static int
+test_fragment_ipv6(void)
+{
+	struct rte_mbuf *pkts_out[2][MAX_PKT_BURST];
+	struct ipv6_extension_fragment *fh;
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct ipv6_hdr *ip6;
+	struct rte_mbuf *m;
+	uint32_t frag_size;
+	uint16_t frag_data;
+	int32_t i, k, n;
+
+	frag_size = IPV6_MTU_SIZE - sizeof(*ip6) -
+		sizeof(struct ipv6_extension_fragment);
+
+	for (k = 0; k != 2; k++) {
+		m = build_packet(1, 2000, k + 1, 0);
+		TEST_ASSERT_NOT_NULL(m, "cannot build packet");
+		n = rte_ipv6_fragment_packet(m, pkts_out[k], MAX_PKT_BURST,
+			IPV6_MTU_SIZE, pkt_pool, indirect_pool);
+		rte_pktmbuf_free(m);
+		TEST_ASSERT_EQUAL(n, 3, "%d fragments, expected 3", n);
+
+		for (i = 0; i != n; i++) {
+			m = pkts_out[k][i];
+			m->l2_len = 0;
+			m->l3_len = sizeof(*ip6) +
+				sizeof(struct ipv6_extension_fragment);
+			ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+			fh = rte_ipv6_frag_get_ipv6_fragment_header(ip6);
+			TEST_ASSERT_NOT_NULL(fh, "no header in fragment %d", i);
+			frag_data = rte_be_to_cpu_16(fh->frag_data);
+			TEST_ASSERT((frag_data & ~7U) == i * frag_size &&
+				(frag_data & 1U) == (i != n - 1),
+				"bad offset or flag in fragment %d: %#x", i,
+				frag_data);
+		}
+	}
+
+	tbl = rte_ip_frag_table_create(16, 4, 32, rte_get_tsc_hz(),
+		rte_socket_id());
+	TEST_ASSERT_NOT_NULL(tbl, "cannot create table");
+	dr.cnt = 0;
+
+	/* pass the fragments in reverse order, alternating packets */
+	for (i = n; i-- != 0; ) {
+		for (k = 0; k != 2; k++) {
+			m = pkts_out[k][i];
+			ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+			m = rte_ipv6_frag_reassemble_packet(tbl, &dr, m,
+				rte_rdtsc(), ip6,
+				rte_ipv6_frag_get_ipv6_fragment_header(ip6));
+			TEST_ASSERT((m == NULL) == (i != 0) && dr.cnt == 0,
+				"fragment %d of %d not reassembled", i, k);
+			if (m == NULL)
+				continue;
+			TEST_ASSERT_SUCCESS(check_payload(m, sizeof(*ip6),
+				2000, k + 1), "bad reassembled payload");
+			rte_pktmbuf_free(m);
+		}
+	}
+	rte_ip_frag_table_destroy(tbl);
+
+	TEST_ASSERT(rte_mempool_full(pkt_pool) &&
+		rte_mempool_full(indirect_pool), "mbufs leaked");
+	return 0;
+}
+
+/*
+ * Fragment a burst of packets, check the fragment headers, and check
+ * that reassembling the fragments gives back the packets.
+ */
+static int
+test_fragment_burst(int ipv6, uint32_t flags)
+{
+	struct rte_mbuf *pkts_in[RTE_DIM(burst_payload_len)];
+	struct rte_mbuf *pkts_out[MAX_PKT_BURST * 4];
+	struct rte_ip_frag_death_row dr;
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	const char *name;
+	uint32_t i, k, n, nb_frags, frag_size, hdr_len, mtu_size;
+	uint16_t nb_in, nb_out;
+
+	name = ipv6 ? "IPv6" : "IPv4";
+	nb_in = RTE_DIM(burst_payload_len);
+	hdr_len = ipv6 ? sizeof(*ip6) : sizeof(*ip4);
+	mtu_size = ipv6 ? IPV6_MTU_SIZE : IPV4_MTU_SIZE;
+	frag_size = ipv6 ? IPV6_MTU_SIZE - sizeof(*ip6) -
+		sizeof(struct ipv6_extension_fragment) :
+		IPV4_MTU_SIZE - sizeof(*ip4);
+
+	for (i = 0; i != nb_in; i++) {
+		pkts_in[i] = build_packet(ipv6, burst_payload_len[i], i + 1,
+			i == nb_in - 1U);
+		TEST_ASSERT_NOT_NULL(pkts_in[i], "%s: cannot build packet",
+			name);
+	}
+
+	nb_out = RTE_DIM(pkts_out);
+	if (ipv6)
+		n = rte_ipv6_fragment_burst(pkts_in, nb_in, pkts_out, &nb_out,
+			IPV6_MTU_SIZE, pkt_pool, indirect_pool, flags);
+	else
+		n = rte_ipv4_fragment_burst(pkts_in, nb_in, pkts_out, &nb_out,
+			IPV4_MTU_SIZE, pkt_pool, indirect_pool, flags);
+	TEST_ASSERT_EQUAL(n, nb_in, "%s, flags %#x: %u packets fragmented",
+		name, flags, n);
+
+	tbl = rte_ip_frag_table_create(16, 4, 32, rte_get_tsc_hz(),
+		rte_socket_id());
+	TEST_ASSERT_NOT_NULL(tbl, "%s: cannot create table", name);
+	dr.cnt = 0;
+
+	k = 0;
+	for (i = 0; i != nb_in; i++) {
+		/* a packet that fits in the MTU is passed through as is */
+		if (hdr_len + burst_payload_len[i] <= mtu_size) {
+			TEST_ASSERT(k < nb_out, "%s, flags %#x: %u fragments",
+				name, flags, nb_out);
+			m = pkts_out[k];
+			TEST_ASSERT(m == pkts_in[i] && m->nb_segs == 1 &&
+				(m->ol_flags & PKT_TX_IP_CKSUM) == 0,
+				"%s: packet %u not passed through", name, i);
+			TEST_ASSERT_SUCCESS(check_payload(m, hdr_len,
+				burst_payload_len[i], i + 1),
+				"%s: bad payload in packet %u", name, i);
+			rte_pktmbuf_free(m);
+			k++;
+			continue;
+		}
+
+		nb_frags = (burst_payload_len[i] + frag_size - 1) / frag_size;
+		TEST_ASSERT(k + nb_frags <= nb_out,
+			"%s, flags %#x: %u fragments", name, flags, nb_out);
+
+		/* a single-segment packet should be its own first fragment */
+		if ((flags & RTE_IP_FRAG_F_IN_PLACE) != 0 &&
+				i != nb_in - 1U)
+			TEST_ASSERT(pkts_out[k] == pkts_in[i],
+				"%s: packet %u not fragmented in place",
+				name, i);
+
+		for (n = 0; n != nb_frags; n++) {
+			m = pkts_out[k + n];
+			m->l2_len = 0;
+			if (ipv6) {
+				ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+				m->l3_len = sizeof(*ip6) +
+					sizeof(struct ipv6_extension_fragment);
+				TEST_ASSERT(ip6->proto == IPPROTO_FRAGMENT &&
+					rte_be_to_cpu_16(ip6->payload_len) ==
+					m->pkt_len - sizeof(*ip6),
+					"%s: bad header in fragment %u of %u",
+					name, n, i);
+			} else {
+				ip4 = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+				TEST_ASSERT(rte_be_to_cpu_16(
+					ip4->total_length) == m->pkt_len,
+					"%s: bad length in fragment %u of %u",
+					name, n, i);
+				if ((flags & RTE_IP_FRAG_F_IP_CKSUM) != 0)
+					TEST_ASSERT(rte_raw_cksum(ip4,
+						sizeof(*ip4)) == 0xffff,
+						"%s: bad checksum in fragment "
+						"%u of %u", name, n, i);
+				else
+					TEST_ASSERT(ip4->hdr_checksum == 0 &&
+						(m->ol_flags &
+						PKT_TX_IP_CKSUM) != 0,
+						"%s: no checksum offload in "
+						"fragment %u of %u",
+						name, n, i);
+			}
+		}
+
+		/* pass the fragments in reverse order */
+		m = NULL;
+		for (n = nb_frags; n-- != 0; ) {
+			m = pkts_out[k + n];
+			if (ipv6) {
+				ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+				m = rte_ipv6_frag_reassemble_packet(tbl, &dr,
+					m, rte_rdtsc(), ip6,
+					rte_ipv6_frag_get_ipv6_fragment_header(
+						ip6));
+			} else
+				m = rte_ipv4_frag_reassemble_packet(tbl, &dr,
+					m, rte_rdtsc(),
+					rte_pktmbuf_mtod(m, struct ipv4_hdr *));
+			TEST_ASSERT((m == NULL) == (n != 0) && dr.cnt == 0,
+				"%s: fragment %u of %u not reassembled",
+				name, n, i);
+		}
+		TEST_ASSERT_SUCCESS(check_payload(m, hdr_len,
+			burst_payload_len[i], i + 1),
+			"%s: bad reassembled payload in packet %u", name, i);
+		rte_pktmbuf_free(m);
+		k += nb_frags;
+	}
+
+	TEST_ASSERT_EQUAL(k, nb_out, "%s, flags %#x: %u fragments, expected %u",
+		name, flags, nb_out, k);
+	rte_ip_frag_table_destroy(tbl);
+
+	/* all the mbufs should be back in their pools */
+	TEST_ASSERT(rte_mempool_full(pkt_pool) &&
+		rte_mempool_full(indirect_pool),
+		"%s, flags %#x: mbufs leaked", name, flags);
+	return 0;
+}
+
+/* check that the burst stops at the packets that cannot be fragmented */
+static int
+test_fragment_burst_stop(void)
+{
+	struct rte_mbuf *pkts_in[3];
+	struct rte_mbuf *pkts_out[MAX_PKT_BURST];
+	struct ipv4_hdr *ip4;
+	uint16_t n, nb_out, cksum;
+
+	/*
+	 * the second and third packets have the Don't Fragment flag, only
+	 * the third one needs to be fragmented.
+	 */
+	pkts_in[0] = build_packet(0, 2000, 1, 0);
+	pkts_in[1] = build_packet(0, 100, 2, 0);
+	pkts_in[2] = build_packet(0, 2000, 3, 0);
+	TEST_ASSERT(pkts_in[0] != NULL && pkts_in[1] != NULL &&
+		pkts_in[2] != NULL, "cannot build packets");
+	for (n = 1; n != 3; n++) {
+		ip4 = rte_pktmbuf_mtod(pkts_in[n], struct ipv4_hdr *);
+		ip4->fragment_offset = rte_cpu_to_be_16(IPV4_HDR_DF_FLAG);
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	}
+	ip4 = rte_pktmbuf_mtod(pkts_in[1], struct ipv4_hdr *);
+	cksum = ip4->hdr_checksum;
+
+	nb_out = RTE_DIM(pkts_out);
+	n = rte_ipv4_fragment_burst(pkts_in, 3, pkts_out, &nb_out, IPV4_MTU_SIZE,
+		pkt_pool, indirect_pool, 0);
+	TEST_ASSERT(n == 2 && nb_out == 4 && rte_errno == ENOTSUP,
+		"DF packet fragmented: %u packets, %u fragments", n, nb_out);
+	TEST_ASSERT(pkts_out[3] == pkts_in[1] &&
+		ip4->hdr_checksum == cksum &&
+		(pkts_out[3]->ol_flags & PKT_TX_IP_CKSUM) == 0,
+		"small DF packet not passed through");
+	rte_pktmbuf_free(pkts_in[2]);
+	for (n = 0; n != nb_out; n++)
+		rte_pktmbuf_free(pkts_out[n]);
+
+	/* a small packet without Don't Fragment flag is not modified */
+	pkts_in[0] = build_packet(0, 100, 1, 0);
+	TEST_ASSERT(pkts_in[0] != NULL, "cannot build packets");
+	ip4 = rte_pktmbuf_mtod(pkts_in[0], struct ipv4_hdr *);
+	ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	cksum = ip4->hdr_checksum;
+
+	nb_out = RTE_DIM(pkts_out);
+	n = rte_ipv4_fragment_burst(pkts_in, 1, pkts_out, &nb_out, IPV4_MTU_SIZE,
+		pkt_pool, indirect_pool, RTE_IP_FRAG_F_IP_CKSUM);
+	TEST_ASSERT(n == 1 && nb_out == 1 && pkts_out[0] == pkts_in[0] &&
+		pkts_out[0]->nb_segs == 1 && ip4->hdr_checksum == cksum &&
+		(pkts_out[0]->ol_flags & PKT_TX_IP_CKSUM) == 0,
+		"small packet not passed through");
+	rte_pktmbuf_free(pkts_out[0]);
+
+	/* the fragments of the second packet do not fit */
+	pkts_in[0] = build_packet(1, 2000, 1, 0);
+	pkts_in[1] = build_packet(1, 2000, 2, 0);
+	TEST_ASSERT(pkts_in[0] != NULL && pkts_in[1] != NULL,
+		"cannot build packets");
+
+	nb_out = 4;
+	n = rte_ipv6_fragment_burst(pkts_in, 2, pkts_out, &nb_out, IPV6_MTU_SIZE,
+		pkt_pool, indirect_pool, RTE_IP_FRAG_F_IN_PLACE);
+	TEST_ASSERT(n == 1 && nb_out == 3 && rte_errno == ENOSPC,
+		"too many fragments: %u packets, %u fragments", n, nb_out);
+	rte_pktmbuf_free(pkts_in[1]);
+	for (n = 0; n != nb_out; n++)
+		rte_pktmbuf_free(pkts_out[n]);
+
+	TEST_ASSERT(rte_mempool_full(pkt_pool) &&
+		rte_mempool_full(indirect_pool), "mbufs leaked");
+	return 0;
+}
+
+static int
+test_ip_frag(void)
+{
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("IP_FRAG_TEST_POOL", NB_MBUF,
+			0, 0, MBUF_DATA_SIZE, rte_socket_id());
+		if (pkt_pool == NULL) {
+			printf("Error creating mbuf pool\n");
+			return -1;
+		}
+	}
+	if (indirect_pool == NULL) {
+		indirect_pool = rte_pktmbuf_pool_create("IP_FRAG_TEST_INDIRECT",
+			NB_MBUF, 0, 0, 0, rte_socket_id());
+		if (indirect_pool == NULL) {
+			printf("Error creating indirect mbuf pool\n");
+			return -1;
+		}
+	}
+
+	if (test_table_expire("Private table", rte_ip_frag_table_create) < 0)
+		return -1;
+	if (test_table_expire("Shared table",
+			rte_ip_frag_table_create_shared) < 0)
+		return -1;
+
+	if (test_fragment_ipv6() < 0)
+		return -1;
+
+	if (test_fragment_burst(0, 0) < 0 ||
+			test_fragment_burst(0, RTE_IP_FRAG_F_IN_PLACE) < 0 ||
+			test_fragment_burst(0, RTE_IP_FRAG_F_IN_PLACE |
+				RTE_IP_FRAG_F_IP_CKSUM) < 0 ||
+			test_fragment_burst(1, 0) < 0 ||
+			test_fragment_burst(1, RTE_IP_FRAG_F_IN_PLACE) < 0)
+		return -1;
+	if (test_fragment_burst_stop() < 0)
+		return -1;
+
+	return 0;
+}
+
+static struct test_command ip_frag_cmd = {
+	.command = "ip_frag_autotest",
+	.callback = test_ip_frag,
+};
+REGISTER_TEST_COMMAND(ip_frag_cmd);
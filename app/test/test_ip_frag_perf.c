@@ -0,0 +1,402 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <rte_atomic.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ip_frag.h>
+
+#define FRAG_NUM 4      /* fragments per datagram */
+#define FRAG_LEN 64     /* payload bytes per fragment */
+#define DGRAM_NUM 512   /* datagrams per round */
+#define ROUND_NUM 256
+#define BUCKET_ENTRIES 8
+#define NB_MBUF (2 * DGRAM_NUM * FRAG_NUM)
+#define MBUF_CACHE_SIZE 32
+
+#define FRAG_PKT_LEN 1400  /* payload bytes of the packets to fragment */
+#define FRAG_MTU_SIZE 1004 /* 2 fragments per packet */
+#define FRAG_BURST 32
+#define FRAG_ITER 1024
+
+struct worker_stats {
+	uint64_t cycles;        /* cycles spent in the reassembly calls */
+	unsigned frags;         /* fragments passed to the table */
+	unsigned reassembled;   /* datagrams returned by the table */
+	unsigned bad;           /* datagrams of a wrong length */
+} __rte_cache_aligned;
+
+static struct worker_stats worker_stats[RTE_MAX_LCORE];
+static unsigned worker_idx[RTE_MAX_LCORE];
+static unsigned nb_workers;
+static rte_atomic32_t rounds_done;
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *indirect_pool;
+static struct rte_ip_frag_tbl *frag_tbl;
+
+/* build fragment frag of datagram dgram sent in round */
+static struct rte_mbuf *
+build_fragment(unsigned round, unsigned dgram, unsigned frag)
+{
+	struct rte_mbuf *m;
+	struct ether_hdr *eth;
+	struct ipv4_hdr *ip;
+	uint16_t ofs;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	eth = (struct ether_hdr *)rte_pktmbuf_append(m,
+		sizeof(*eth) + sizeof(*ip) + FRAG_LEN);
+	memset(eth, 0, sizeof(*eth));
+	eth->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+
+	ip = (struct ipv4_hdr *)(eth + 1);
+	memset(ip, 0, sizeof(*ip));
+	ofs = (uint16_t)(frag * FRAG_LEN / IPV4_HDR_OFFSET_UNITS);
+	if (frag != FRAG_NUM - 1)
+		ofs |= IPV4_HDR_MF_FLAG;
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_LEN);
+	ip->packet_id = rte_cpu_to_be_16((uint16_t)round);
+	ip->fragment_offset = rte_cpu_to_be_16(ofs);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1) + dgram);
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 1, 0, 1));
+
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip);
+	return m;
+}
+
+/*
+ * Each worker passes the fragments assigned to it to the table, fragment
+ * f of datagram d going to worker (d + f) % nb_workers, so that the
+ * fragments of a datagram are spread over all the workers. The workers
+ * synchronise at the end of each round, so that the table never holds
+ * more than a round of datagrams.
+ */
+static int
+reassemble_worker(__attribute__((unused)) void *arg)
+{
+	struct rte_ip_frag_death_row dr;
+	struct worker_stats *ws;
+	struct rte_mbuf *m;
+	unsigned id, round, dgram, frag;
+	uint64_t start;
+
+	id = worker_idx[rte_lcore_id()];
+	ws = &worker_stats[id];
+	dr.cnt = 0;
+
+	for (round = 0; round != ROUND_NUM; round++) {
+		for (dgram = 0; dgram != DGRAM_NUM; dgram++) {
+			for (frag = 0; frag != FRAG_NUM; frag++) {
+				if ((dgram + frag) % nb_workers != id)
+					continue;
+
+				m = build_fragment(round, dgram, frag);
+				if (m == NULL)
+					return -1;
+
+				start = rte_rdtsc();
+				m = rte_ipv4_frag_reassemble_packet(frag_tbl,
+					&dr, m, start,
+					rte_pktmbuf_mtod_offset(m,
+						struct ipv4_hdr *,
+						sizeof(struct ether_hdr)));
+				ws->cycles += rte_rdtsc() - start;
+				ws->frags++;
+
+				if (m != NULL) {
+					ws->reassembled++;
+					if (m->pkt_len != sizeof(struct ether_hdr) +
+							sizeof(struct ipv4_hdr) +
+							FRAG_NUM * FRAG_LEN)
+						ws->bad++;
+					rte_pktmbuf_free(m);
+				}
+				if (dr.cnt != 0)
+					rte_ip_frag_free_death_row(&dr, 3);
+			}
+		}
+
+		rte_atomic32_inc(&rounds_done);
+		while ((unsigned)rte_atomic32_read(&rounds_done) <
+				(round + 1) * nb_workers)
+			rte_pause();
+	}
+
+	return 0;
+}
+
+/* run the workers on n lcores against the table, and report the results */
+static int
+run_reassembly(const char *name, struct rte_ip_frag_tbl *tbl, unsigned n)
+{
+	unsigned i, lcore_id, frags, reassembled, bad;
+	uint64_t cycles;
+	int ret;
+
+	memset(worker_stats, 0, sizeof(worker_stats));
+	rte_atomic32_init(&rounds_done);
+	frag_tbl = tbl;
+	nb_workers = n;
+
+	/* the master lcore is worker 0, the first n - 1 slaves the others. */
+	worker_idx[rte_get_master_lcore()] = 0;
+	ret = 0;
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (++i == n)
+			break;
+		worker_idx[lcore_id] = i;
+		rte_eal_remote_launch(reassemble_worker, NULL, lcore_id);
+	}
+	if (reassemble_worker(NULL) != 0)
+		ret = -1;
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (++i == n)
+			break;
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+	}
+
+	cycles = 0;
+	frags = 0;
+	reassembled = 0;
+	bad = 0;
+	for (i = 0; i != n; i++) {
+		cycles += worker_stats[i].cycles;
+		frags += worker_stats[i].frags;
+		reassembled += worker_stats[i].reassembled;
+		bad += worker_stats[i].bad;
+	}
+
+	printf("%s, %u lcores: %u fragments, %u datagrams reassembled, "
+		"%"PRIu64" cycles/fragment\n", name, n, frags, reassembled,
+		frags == 0 ? 0 : cycles / frags);
+
+	if (ret != 0) {
+		printf("%s: mbuf allocation failed\n", name);
+		return -1;
+	}
+	if (reassembled != ROUND_NUM * DGRAM_NUM || bad != 0) {
+		printf("%s: %u datagrams expected, %u reassembled, %u bad\n",
+			name, ROUND_NUM * DGRAM_NUM, reassembled, bad);
+		rte_ip_frag_table_statistics_dump(stdout, tbl);
+		return -1;
+	}
+	if (tbl->use_entries != 0) {
+		printf("%s: %u entries left in use\n", name, tbl->use_entries);
+		return -1;
+	}
+	return 0;
+}
+
+/* build a packet to fragment, starting with its IPv4 header */
+static struct rte_mbuf *
+build_packet(unsigned seq)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	ip = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(*ip) + FRAG_PKT_LEN);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_PKT_LEN);
+	ip->packet_id = rte_cpu_to_be_16((uint16_t)seq);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 1, 0, 1));
+
+	return m;
+}
+
+/*
+ * Time the fragmentation of bursts of packets, one packet at a time with
+ * rte_ipv4_fragment_packet(), or a burst at a time with the given flags.
+ */
+static int
+run_fragmentation(const char *name, int burst, uint32_t flags)
+{
+	struct rte_mbuf *pkts_in[FRAG_BURST];
+	struct rte_mbuf *pkts_out[FRAG_BURST * 2];
+	uint64_t start, cycles;
+	unsigned iter, i;
+	uint16_t n, nb_out;
+	int32_t ret;
+
+	cycles = 0;
+	for (iter = 0; iter != FRAG_ITER; iter++) {
+		for (i = 0; i != FRAG_BURST; i++) {
+			pkts_in[i] = build_packet(iter * FRAG_BURST + i);
+			if (pkts_in[i] == NULL) {
+				printf("%s: mbuf allocation failed\n", name);
+				return -1;
+			}
+		}
+
+		start = rte_rdtsc();
+		nb_out = RTE_DIM(pkts_out);
+		if (burst) {
+			n = rte_ipv4_fragment_burst(pkts_in, FRAG_BURST,
+				pkts_out, &nb_out, FRAG_MTU_SIZE, pkt_pool,
+				indirect_pool, flags);
+		} else {
+			nb_out = 0;
+			for (n = 0; n != FRAG_BURST; n++) {
+				ret = rte_ipv4_fragment_packet(pkts_in[n],
+					pkts_out + nb_out,
+					RTE_DIM(pkts_out) - nb_out,
+					FRAG_MTU_SIZE, pkt_pool,
+					indirect_pool);
+				if (ret < 0)
+					break;
+				rte_pktmbuf_free(pkts_in[n]);
+				nb_out += ret;
+			}
+		}
+		cycles += rte_rdtsc() - start;
+
+		for (i = 0; i != nb_out; i++)
+			rte_pktmbuf_free(pkts_out[i]);
+		if (n != FRAG_BURST || nb_out != FRAG_BURST * 2) {
+			printf("%s: %u packets fragmented into %u fragments\n",
+				name, n, nb_out);
+			for (i = n; i != FRAG_BURST; i++)
+				rte_pktmbuf_free(pkts_in[i]);
+			return -1;
+		}
+	}
+
+	printf("%s: %"PRIu64" cycles/packet\n", name,
+		cycles / (FRAG_ITER * FRAG_BURST));
+	return 0;
+}
+
+static int
+test_ip_frag_perf(void)
+{
+	struct rte_ip_frag_tbl *tbl;
+	uint64_t max_cycles;
+	int ret;
+
+	if (pkt_pool == NULL) {
+		pkt_pool = rte_pktmbuf_pool_create("IP_FRAG_PERF_POOL", NB_MBUF,
+			MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+		if (pkt_pool == NULL) {
+			printf("Error creating mbuf pool\n");
+			return -1;
+		}
+	}
+	if (indirect_pool == NULL) {
+		indirect_pool = rte_pktmbuf_pool_create("IP_FRAG_PERF_INDIRECT",
+			NB_MBUF, MBUF_CACHE_SIZE, 0, 0, rte_socket_id());
+		if (indirect_pool == NULL) {
+			printf("Error creating indirect mbuf pool\n");
+			return -1;
+		}
+	}
+
+	/* fragmentation, one packet or one burst at a time */
+	if (run_fragmentation("Per-packet fragmentation", 0, 0) != 0 ||
+			run_fragmentation("Burst fragmentation", 1, 0) != 0 ||
+			run_fragmentation("Burst in-place fragmentation", 1,
+				RTE_IP_FRAG_F_IN_PLACE) != 0 ||
+			run_fragmentation("Burst in-place fragmentation, "
+				"software checksum", 1,
+				RTE_IP_FRAG_F_IN_PLACE |
+				RTE_IP_FRAG_F_IP_CKSUM) != 0)
+		return -1;
+
+	/* entries live for a second, so that none is reclaimed. */
+	max_cycles = rte_get_tsc_hz();
+
+	/* baseline: private table, all the fragments on one lcore */
+	tbl = rte_ip_frag_table_create(DGRAM_NUM, BUCKET_ENTRIES,
+		2 * DGRAM_NUM, max_cycles, rte_socket_id());
+	if (tbl == NULL) {
+		printf("Error creating fragmentation table\n");
+		return -1;
+	}
+	ret = run_reassembly("Private table", tbl, 1);
+	rte_ip_frag_table_destroy(tbl);
+	if (ret != 0)
+		return -1;
+
+	/* shared table, with the fragments spread over all the lcores */
+	tbl = rte_ip_frag_table_create_shared(DGRAM_NUM, BUCKET_ENTRIES,
+		2 * DGRAM_NUM, max_cycles, rte_socket_id());
+	if (tbl == NULL) {
+		printf("Error creating shared fragmentation table\n");
+		return -1;
+	}
+	ret = run_reassembly("Shared table", tbl, 1);
+	if (ret == 0 && rte_lcore_count() > 1)
+		ret = run_reassembly("Shared table", tbl, rte_lcore_count());
+	rte_ip_frag_table_destroy(tbl);
+
+	return ret;
+}
+
+static struct test_command ip_frag_perf_cmd = {
+	.command = "ip_frag_perf_autotest",
+	.callback = test_ip_frag_perf,
+};
+REGISTER_TEST_COMMAND(ip_frag_perf_cmd);
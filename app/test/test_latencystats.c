@@ -0,0 +1,222 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_latencystats.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+
+#include "test.h"
+
+#define BURST 32
+#define NB_MBUF 512
+#define RING_SIZE 256
+#define NB_ITERATIONS 64
+#define TX_DELAY_US 10
+
+static struct rte_mempool *latency_pool;
+static struct rte_ring *latency_ring;
+static int latency_port = -1;
+
+static int
+test_latency_setup(void)
+{
+	struct rte_eth_conf null_conf;
+
+	if (latency_port >= 0)
+		return 0;
+
+	latency_pool = rte_pktmbuf_pool_create("LATENCY_MBUF_POOL", NB_MBUF,
+			BURST, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (latency_pool == NULL) {
+		printf("%s: Error creating mempool\n", __func__);
+		return -1;
+	}
+
+	latency_ring = rte_ring_create("LATENCY_RING", RING_SIZE,
+			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (latency_ring == NULL) {
+		printf("%s: Error creating ring\n", __func__);
+		return -1;
+	}
+
+	/* port looping back on itself: what is sent is received again */
+	latency_port = rte_eth_from_rings("eth_ring_latency", &latency_ring, 1,
+			&latency_ring, 1, rte_socket_id());
+	if (latency_port < 0) {
+		printf("%s: Error creating ring port\n", __func__);
+		return -1;
+	}
+
+	memset(&null_conf, 0, sizeof(null_conf));
+	if (rte_eth_dev_configure(latency_port, 1, 1, &null_conf) < 0 ||
+			rte_eth_rx_queue_setup(latency_port, 0, RING_SIZE,
+				rte_socket_id(), NULL, latency_pool) < 0 ||
+			rte_eth_tx_queue_setup(latency_port, 0, RING_SIZE,
+				rte_socket_id(), NULL) < 0 ||
+			rte_eth_dev_start(latency_port) < 0) {
+		printf("%s: Error configuring ring port\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_latency_init_uninit(void)
+{
+	struct rte_latencystats stats;
+
+	TEST_ASSERT_EQUAL(rte_latencystats_get(latency_port, &stats), -ENOENT,
+			"Stats available before init");
+	TEST_ASSERT_EQUAL(rte_latencystats_uninit(), -ENOENT,
+			"No error on uninit before init");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(0), "Init failed");
+	TEST_ASSERT_EQUAL(rte_latencystats_init(0), -EEXIST,
+			"No error on second init");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, &stats),
+			"Cannot get stats");
+	TEST_ASSERT_EQUAL(stats.samples, 0, "Samples before any traffic");
+	TEST_ASSERT_EQUAL(rte_latencystats_queue_get(latency_port, 1, &stats),
+			-EINVAL, "No error on invalid queue");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(), "Uninit failed");
+	TEST_ASSERT_EQUAL(rte_latencystats_get(latency_port, &stats), -ENOENT,
+			"Stats available after uninit");
+
+	return TEST_SUCCESS;
+}
+
+/* loops bursts back with a sampling interval, nb_samples packets of each
+ * burst being expected to be measured */
+static int
+latency_measure(uint64_t samp_intvl, unsigned nb_samples)
+{
+	struct rte_mbuf *pkts[BURST];
+	struct rte_latencystats stats;
+	unsigned i, j, nb_rx, nb_tx;
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(samp_intvl), "Init failed");
+
+	for (i = 0; i < NB_ITERATIONS; i++) {
+		for (j = 0; j < BURST; j++) {
+			pkts[j] = rte_pktmbuf_alloc(latency_pool);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot allocate mbuf");
+		}
+		rte_ring_enqueue_bulk(latency_ring, (void **)pkts, BURST);
+
+		nb_rx = rte_eth_rx_burst(latency_port, 0, pkts, BURST);
+		TEST_ASSERT_EQUAL(nb_rx, BURST, "Received %u packets", nb_rx);
+		for (j = 0; j < BURST; j++)
+			TEST_ASSERT(((pkts[j]->ol_flags & PKT_RX_TIMESTAMP)
+					!= 0) == (j < nb_samples),
+					"Wrong time stamp on packet %u", j);
+
+		rte_delay_us(TX_DELAY_US);
+
+		nb_tx = rte_eth_tx_burst(latency_port, 0, pkts, nb_rx);
+		TEST_ASSERT_EQUAL(nb_tx, nb_rx, "Sent %u packets", nb_tx);
+		TEST_ASSERT((pkts[0]->ol_flags & PKT_RX_TIMESTAMP) == 0,
+				"Time stamp flag not cleared on TX");
+
+		rte_ring_dequeue_bulk(latency_ring, (void **)pkts, BURST);
+		for (j = 0; j < BURST; j++)
+			rte_pktmbuf_free(pkts[j]);
+	}
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, &stats),
+			"Cannot get stats");
+	printf("samples %"PRIu64" min %"PRIu64"ns avg %"PRIu64"ns "
+		"max %"PRIu64"ns jitter %"PRIu64"ns\n", stats.samples,
+		stats.min_ns, stats.avg_ns, stats.max_ns, stats.jitter_ns);
+	TEST_ASSERT_EQUAL(stats.samples, NB_ITERATIONS * nb_samples,
+			"Wrong number of samples");
+	TEST_ASSERT(stats.min_ns >= TX_DELAY_US * 1000,
+			"Minimum latency lower than TX delay");
+	TEST_ASSERT(stats.min_ns <= stats.avg_ns &&
+			stats.avg_ns <= stats.max_ns, "Inconsistent stats");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_reset(latency_port),
+			"Reset failed");
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(latency_port, &stats),
+			"Cannot get stats");
+	TEST_ASSERT_EQUAL(stats.samples, 0, "Samples left after reset");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(), "Uninit failed");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_latency_measure(void)
+{
+	/* the bursts are more than 1us apart: their first packet is sampled */
+	return latency_measure(1000, 1);
+}
+
+static int
+test_latency_measure_all(void)
+{
+	return latency_measure(0, BURST);
+}
+
+static struct unit_test_suite latencystats_test_suite  = {
+	.setup = test_latency_setup,
+	.suite_name = "Latency Stats Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_latency_init_uninit),
+		TEST_CASE(test_latency_measure),
+		TEST_CASE(test_latency_measure_all),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_latencystats(void)
+{
+	return unit_test_suite_runner(&latencystats_test_suite);
+}
+
+static struct test_command latencystats_cmd = {
+	.command = "latencystats_autotest",
+	.callback = test_latencystats,
+};
+REGISTER_TEST_COMMAND(latencystats_cmd);
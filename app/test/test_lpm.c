@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/queue.h>
 
@@ -41,6 +42,8 @@
 #include <rte_cycles.h>
 #include <rte_memory.h>
 #include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
 #include <time.h>
@@ -48,6 +51,7 @@
 #include "test.h"
 
 #include "rte_lpm.h"
+#include "rte_rcu_qsbr.h"
 #include "test_lpm_routes.h"
 
 #define TEST_LPM_ASSERT(cond) do {                                            \
@@ -77,6 +81,11 @@ static int32_t test14(void);
 static int32_t test15(void);
 static int32_t test16(void);
 static int32_t test17(void);
+static int32_t test18(void);
+static int32_t test19(void);
+static int32_t test20(void);
+static int32_t test21(void);
+static int32_t test22(void);
 static int32_t perf_test(void);
 
 rte_lpm_test tests[] = {
@@ -99,12 +108,20 @@ rte_lpm_test tests[] = {
 	test15,
 	test16,
 	test17,
+	test18,
+	test19,
+	test20,
+	test21,
+	test22,
 	perf_test,
 };
 
 #define NUM_LPM_TESTS (sizeof(tests)/sizeof(tests[0]))
 #define MAX_DEPTH 32
 #define MAX_RULES 256
+#define NUMBER_TBL8S 256
+#define BURST_TEST_RULES 4096
+#define BURST_TEST_IPS (1 << 16)
 #define PASS 0
 
 /*
@@ -115,18 +132,39 @@ int32_t
 test0(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
 
 	/* rte_lpm_create: lpm name == NULL */
-	lpm = rte_lpm_create(NULL, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(NULL, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* rte_lpm_create: config == NULL */
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, NULL);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* socket_id < -1 is invalid */
+	lpm = rte_lpm_create(__func__, -2, &config);
 	TEST_LPM_ASSERT(lpm == NULL);
 
 	/* rte_lpm_create: max_rules = 0 */
 	/* Note: __func__ inserts the function name, in this case "test0". */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 0, 0);
+	config.max_rules = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm == NULL);
 
-	/* socket_id < -1 is invalid */
-	lpm = rte_lpm_create(__func__, -2, MAX_RULES, 0);
+	/* rte_lpm_create: number_tbl8s = 0 */
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* rte_lpm_create: number_tbl8s > RTE_LPM_MAX_TBL8_NUM_GROUPS */
+	config.number_tbl8s = RTE_LPM_MAX_TBL8_NUM_GROUPS + 1;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm == NULL);
 
 	return PASS;
@@ -140,11 +178,16 @@ int32_t
 test1(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	int32_t i;
 
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
 	/* rte_lpm_free: Free NULL */
 	for (i = 0; i < 100; i++) {
-		lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES - i, 0);
+		config.max_rules = MAX_RULES - i;
+		lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 		TEST_LPM_ASSERT(lpm != NULL);
 
 		rte_lpm_free(lpm);
@@ -164,8 +207,12 @@ int32_t
 test2(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	rte_lpm_free(lpm);
@@ -180,8 +227,10 @@ int32_t
 test3(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop = 100;
+	uint32_t next_hop = 100;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
 	/* rte_lpm_add: lpm == NULL */
@@ -189,7 +238,10 @@ test3(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_add: depth < 1 */
@@ -213,6 +265,7 @@ int32_t
 test4(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip = IPv4(0, 0, 0, 0);
 	uint8_t depth = 24;
 	int32_t status = 0;
@@ -222,7 +275,10 @@ test4(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_delete: depth < 1 */
@@ -247,8 +303,9 @@ test5(void)
 {
 #if defined(RTE_LIBRTE_LPM_DEBUG)
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	/* rte_lpm_lookup: lpm == NULL */
@@ -256,7 +313,10 @@ test5(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_lookup: depth < 1 */
@@ -277,11 +337,16 @@ int32_t
 test6(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -309,13 +374,18 @@ int32_t
 test7(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 32, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 32;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -325,10 +395,10 @@ test7(void)
 	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_add));
 
 	ipx4 = _mm_set_epi32(ip, ip + 0x100, ip - 0x100, ip);
-	rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+	rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 	TEST_LPM_ASSERT(hop[0] == next_hop_add);
-	TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
-	TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+	TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
+	TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 	TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 	status = rte_lpm_delete(lpm, ip, depth);
@@ -355,13 +425,18 @@ int32_t
 test8(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip1 = IPv4(127, 255, 255, 255), ip2 = IPv4(128, 0, 0, 0);
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Loop with rte_lpm_add. */
@@ -381,10 +456,10 @@ test8(void)
 			(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip2, ip1, ip2, ip1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 	}
 
@@ -409,16 +484,16 @@ test8(void)
 		TEST_LPM_ASSERT(status == -ENOENT);
 
 		ipx4 = _mm_set_epi32(ip1, ip1, ip2, ip2);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 		if (depth != 1) {
 			TEST_LPM_ASSERT(hop[0] == next_hop_add);
 			TEST_LPM_ASSERT(hop[1] == next_hop_add);
 		} else {
-			TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
-			TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
+			TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
+			TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
 		}
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
-		TEST_LPM_ASSERT(hop[3] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[3] == UINT32_MAX);
 	}
 
 	rte_lpm_free(lpm);
@@ -437,9 +512,10 @@ int32_t
 test9(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip, ip_1, ip_2;
-	uint8_t depth, depth_1, depth_2, next_hop_add, next_hop_add_1,
-		next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth, depth_1, depth_2;
 	int32_t status = 0;
 
 	/* Add & lookup to hit invalid TBL24 entry */
@@ -447,7 +523,10 @@ test9(void)
 	depth = 24;
 	next_hop_add = 100;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -601,13 +680,18 @@ test10(void)
 {
 
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add rule that covers a TBL24 range previously invalid & lookup
 	 * (& delete & lookup) */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -787,11 +871,16 @@ test11(void)
 {
 
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -851,13 +940,18 @@ int32_t
 test12(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -873,10 +967,10 @@ test12(void)
 				(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip, ip + 1, ip, ip - 1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 		status = rte_lpm_delete(lpm, ip, depth);
@@ -903,11 +997,16 @@ int32_t
 test13(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -965,12 +1064,17 @@ test14(void)
 	 * that we have enough storage for all rules at that depth*/
 
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add enough space for 256 rules for every depth */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 256 * 32, 0);
+	config.max_rules = 256 * 32;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	depth = 32;
@@ -1012,9 +1116,13 @@ int32_t
 test15(void)
 {
 	struct rte_lpm *lpm = NULL, *result = NULL;
+	struct rte_lpm_config config;
 
 	/* Create lpm  */
-	lpm = rte_lpm_create("lpm_find_existing", SOCKET_ID_ANY, 256 * 32, 0);
+	config.max_rules = 256 * 32;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create("lpm_find_existing", SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Try to find existing lpm */
@@ -1040,8 +1148,12 @@ int32_t
 test16(void)
 {
 	uint32_t ip;
-	struct rte_lpm *lpm = rte_lpm_create(__func__, SOCKET_ID_ANY,
-			256 * 32, 0);
+	struct rte_lpm_config config;
+
+	config.max_rules = 256 * 32;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	struct rte_lpm *lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 
 	/* ip loops through all possibilities for top 24 bits of address */
 	for (ip = 0; ip < 0xFFFFFF; ip++){
@@ -1051,10 +1163,10 @@ test16(void)
 			break;
 	}
 
-	if (ip != RTE_LPM_TBL8_NUM_GROUPS) {
+	if (ip != NUMBER_TBL8S) {
 		printf("Error, unexpected failure with filling tbl8 groups\n");
 		printf("Failed after %u additions, expected after %u\n",
-				(unsigned)ip, (unsigned)RTE_LPM_TBL8_NUM_GROUPS);
+				(unsigned)ip, (unsigned)NUMBER_TBL8S);
 	}
 
 	rte_lpm_free(lpm);
@@ -1072,19 +1184,23 @@ int32_t
 test17(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	const uint32_t ip_10_32 = IPv4(10, 10, 10, 2);
 	const uint32_t ip_10_24 = IPv4(10, 10, 10, 0);
 	const uint32_t ip_20_25 = IPv4(10, 10, 20, 2);
 	const uint8_t d_ip_10_32 = 32,
 			d_ip_10_24 = 24,
 			d_ip_20_25 = 25;
-	const uint8_t next_hop_ip_10_32 = 100,
+	const uint32_t next_hop_ip_10_32 = 100,
 			next_hop_ip_10_24 = 105,
 			next_hop_ip_20_25 = 111;
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	if ((status = rte_lpm_add(lpm, ip_10_32, d_ip_10_32,
@@ -1092,7 +1208,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_32, &next_hop_return);
-	uint8_t test_hop_10_32 = next_hop_return;
+	uint32_t test_hop_10_32 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_32);
 
@@ -1101,7 +1217,7 @@ test17(void)
 			return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_24, &next_hop_return);
-	uint8_t test_hop_10_24 = next_hop_return;
+	uint32_t test_hop_10_24 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_24);
 
@@ -1110,7 +1226,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_20_25, &next_hop_return);
-	uint8_t test_hop_20_25 = next_hop_return;
+	uint32_t test_hop_20_25 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_20_25);
 
@@ -1137,6 +1253,364 @@ test17(void)
 	return PASS;
 }
 
+/*
+ * Check the full next hop range:
+ *  - next hops wider than RTE_LPM_MAX_NEXT_HOP are rejected
+ *  - 24-bit next hops are returned unchanged by every lookup function,
+ *    both from tbl24 and from tbl8 entries
+ */
+int32_t
+test18(void)
+{
+	__m128i ipx4;
+	uint32_t hop[4];
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	uint32_t ip[4], next_hop_return;
+	uint32_t next_hop_24 = RTE_LPM_MAX_NEXT_HOP;
+	uint32_t next_hop_32 = 0x00ABCDEF;
+	uint32_t next_hops[4];
+	int32_t status = 0;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	ip[0] = IPv4(10, 0, 0, 1);
+	ip[1] = IPv4(10, 0, 1, 1);
+	ip[2] = IPv4(192, 168, 0, 1);
+	ip[3] = IPv4(10, 0, 0, 2);
+
+	status = rte_lpm_add(lpm, ip[0], 16, RTE_LPM_MAX_NEXT_HOP + 1);
+	TEST_LPM_ASSERT(status == -EINVAL);
+
+	status = rte_lpm_add(lpm, ip[0], 16, next_hop_24);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm_add(lpm, ip[0], 32, next_hop_32);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm_lookup(lpm, ip[0], &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_32));
+
+	status = rte_lpm_lookup(lpm, ip[1], &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_24));
+
+	status = rte_lpm_is_rule_present(lpm, ip[0], 32, &next_hop_return);
+	TEST_LPM_ASSERT((status == 1) && (next_hop_return == next_hop_32));
+
+	rte_lpm_lookup_bulk(lpm, ip, next_hops, RTE_DIM(ip));
+	TEST_LPM_ASSERT((next_hops[0] & RTE_LPM_LOOKUP_SUCCESS) &&
+			(next_hops[0] & RTE_LPM_NEXT_HOP_MASK) == next_hop_32);
+	TEST_LPM_ASSERT((next_hops[1] & RTE_LPM_LOOKUP_SUCCESS) &&
+			(next_hops[1] & RTE_LPM_NEXT_HOP_MASK) == next_hop_24);
+	TEST_LPM_ASSERT(!(next_hops[2] & RTE_LPM_LOOKUP_SUCCESS));
+	TEST_LPM_ASSERT((next_hops[3] & RTE_LPM_LOOKUP_SUCCESS) &&
+			(next_hops[3] & RTE_LPM_NEXT_HOP_MASK) == next_hop_24);
+
+	ipx4 = _mm_set_epi32(ip[3], ip[2], ip[1], ip[0]);
+	rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+	TEST_LPM_ASSERT(hop[0] == next_hop_32);
+	TEST_LPM_ASSERT(hop[1] == next_hop_24);
+	TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
+	TEST_LPM_ASSERT(hop[3] == next_hop_24);
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Use more tbl8 groups than the former fixed limit of 256: add one /32 rule
+ * in each of 4096 different /24 prefixes, check that every rule can be
+ * looked up, then that all groups are returned when the rules are deleted.
+ */
+int32_t
+test19(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	uint32_t ip, i, next_hop_return;
+	const uint32_t n_rules = 4096;
+	int32_t status = 0;
+
+	config.max_rules = n_rules;
+	config.number_tbl8s = n_rules;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	for (i = 0; i < n_rules; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		status = rte_lpm_add(lpm, ip, 32, i);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* All groups are in use, one more /24 needing a tbl8 must fail */
+	status = rte_lpm_add(lpm, IPv4(11, 0, 0, 1), 32, 0);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	for (i = 0; i < n_rules; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		status = rte_lpm_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == i));
+
+		status = rte_lpm_lookup(lpm, ip + 1, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+	}
+
+	for (i = 0; i < n_rules; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		status = rte_lpm_delete(lpm, ip, 32);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == n_rules);
+
+	/* The freed groups can be reused */
+	status = rte_lpm_add(lpm, IPv4(11, 0, 0, 1), 32, 0);
+	TEST_LPM_ASSERT(status == 0);
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Check the reclamation of tbl8 groups through RCU QSBR, with a single
+ * tbl8 group and a reader thread which is never scheduled:
+ *  - in defer queue mode, a freed group is reused only after the reader
+ *    reported a quiescent state
+ *  - in sync mode, a freed group is reused at once if the reader is offline
+ */
+int32_t
+test20(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	struct rte_lpm_rcu_config rcu_config;
+	struct rte_rcu_qsbr *qsv;
+	uint32_t ip1 = IPv4(10, 0, 0, 1), ip2 = IPv4(10, 0, 1, 1);
+	uint32_t next_hop_return;
+	const uint32_t reader_id = 0;
+	int32_t status = 0;
+
+	qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(1),
+			RTE_CACHE_LINE_SIZE);
+	TEST_LPM_ASSERT(qsv != NULL);
+	TEST_LPM_ASSERT(rte_rcu_qsbr_init(qsv, 1) == 0);
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 1;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	memset(&rcu_config, 0, sizeof(rcu_config));
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == -EINVAL);
+	rcu_config.v = qsv;
+	rcu_config.mode = RTE_LPM_QSBR_MODE_DQ;
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == 0);
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == -EEXIST);
+
+	TEST_LPM_ASSERT(rte_rcu_qsbr_thread_register(qsv, reader_id) == 0);
+	rte_rcu_qsbr_thread_online(qsv, reader_id);
+
+	status = rte_lpm_add(lpm, ip1, 32, 1);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_delete(lpm, ip1, 32);
+	TEST_LPM_ASSERT(status == 0);
+
+	/* The reader may still use the freed group. */
+	status = rte_lpm_add(lpm, ip2, 32, 2);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	rte_rcu_qsbr_quiescent(qsv, reader_id);
+
+	status = rte_lpm_add(lpm, ip2, 32, 2);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, ip2, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 2));
+	status = rte_lpm_lookup(lpm, ip1, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	/* Deleting all rules also empties the defer queue. */
+	status = rte_lpm_delete(lpm, ip2, 32);
+	TEST_LPM_ASSERT(status == 0);
+	rte_lpm_delete_all(lpm);
+	status = rte_lpm_add(lpm, ip1, 32, 1);
+	TEST_LPM_ASSERT(status == 0);
+
+	rte_lpm_free(lpm);
+
+	/* Sync mode, delete does not wait for an offline reader. */
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+	rcu_config.mode = RTE_LPM_QSBR_MODE_SYNC;
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == 0);
+
+	rte_rcu_qsbr_thread_offline(qsv, reader_id);
+
+	status = rte_lpm_add(lpm, ip1, 32, 1);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_delete(lpm, ip1, 32);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_add(lpm, ip2, 32, 2);
+	TEST_LPM_ASSERT(status == 0);
+
+	rte_lpm_free(lpm);
+	rte_free(qsv);
+
+	return PASS;
+}
+
+/*
+ * Check rte_lpm_lookup_burst() with every lookup method against
+ * rte_lpm_lookup(), for random rules of all depths with next hops over
+ * the whole range, bursts of any length and addresses missing the table.
+ */
+int32_t
+test21(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	static uint32_t ips[BURST_TEST_IPS];
+	static uint32_t next_hops[BURST_TEST_IPS];
+	uint32_t i, n, ip, next_hop_return;
+	const uint32_t defv = UINT32_MAX;
+	uint8_t depth;
+	int32_t alg, status = 0;
+
+	config.max_rules = BURST_TEST_RULES;
+	config.number_tbl8s = BURST_TEST_RULES;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	rte_srand(rte_rdtsc());
+
+	/* Rules within 10/8 only, so that lookups also miss. */
+	for (i = 0; i < BURST_TEST_RULES; i++) {
+		depth = 8 + rte_rand() % 25;
+		ip = (IPv4(10, 0, 0, 0) | ((uint32_t)rte_rand() >> 8)) &
+			(uint32_t)(UINT64_MAX << (32 - depth));
+		status = rte_lpm_add(lpm, ip, depth,
+			(uint32_t)rte_rand() & RTE_LPM_MAX_NEXT_HOP);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* Half of the addresses close to the rules, half anywhere. */
+	for (i = 0; i < BURST_TEST_IPS; i++) {
+		ips[i] = (uint32_t)rte_rand();
+		if (i & 1)
+			ips[i] = IPv4(10, 0, 0, 0) | (ips[i] >> 8);
+	}
+
+	for (alg = RTE_LPM_LOOKUP_DEFAULT; alg != RTE_LPM_LOOKUP_NUM; alg++) {
+
+		status = rte_lpm_set_lookup_alg(lpm, alg);
+		if (status == -ENOTSUP) {
+			printf("LPM lookup method %d is not supported\n", alg);
+			TEST_LPM_ASSERT(alg == RTE_LPM_LOOKUP_AVX2);
+			TEST_LPM_ASSERT(rte_lpm_lookup_burst_alg(lpm, ips,
+				next_hops, 1, defv, alg) == -ENOTSUP);
+			continue;
+		}
+		TEST_LPM_ASSERT(status == 0);
+
+		/* Every burst length up to 17, then the whole array. */
+		for (n = 0; n <= 17; n++) {
+			memset(next_hops, 0, sizeof(next_hops));
+			status = rte_lpm_lookup_burst(lpm, ips + n, next_hops,
+				n, defv);
+			TEST_LPM_ASSERT(status == 0);
+			TEST_LPM_ASSERT(next_hops[n] == 0);
+
+			for (i = 0; i < n; i++) {
+				if (rte_lpm_lookup(lpm, ips[n + i],
+						&next_hop_return) != 0)
+					next_hop_return = defv;
+				TEST_LPM_ASSERT(next_hops[i] == next_hop_return);
+			}
+		}
+
+		status = rte_lpm_lookup_burst_alg(lpm, ips, next_hops,
+			BURST_TEST_IPS, defv, alg);
+		TEST_LPM_ASSERT(status == 0);
+
+		for (i = 0; i < BURST_TEST_IPS; i++) {
+			if (rte_lpm_lookup(lpm, ips[i], &next_hop_return) != 0)
+				next_hop_return = defv;
+			TEST_LPM_ASSERT(next_hops[i] == next_hop_return);
+		}
+	}
+
+	/* Incorrect arguments. */
+	TEST_LPM_ASSERT(rte_lpm_set_lookup_alg(NULL,
+		RTE_LPM_LOOKUP_DEFAULT) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_set_lookup_alg(lpm,
+		RTE_LPM_LOOKUP_NUM) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_lookup_burst(NULL, ips, next_hops, 1,
+		defv) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_lookup_burst(lpm, NULL, next_hops, 1,
+		defv) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_lookup_burst(lpm, ips, NULL, 1,
+		defv) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_lookup_burst_alg(lpm, ips, next_hops, 1,
+		defv, RTE_LPM_LOOKUP_NUM) == -EINVAL);
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Create tables whose size does not fit in 32 bits: either the creation
+ * fails for lack of memory, or the whole table is usable.
+ */
+int32_t
+test22(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	uint32_t next_hop_return = 0;
+	int32_t status = 0;
+
+	/* The tbl8 groups take 4GB and 1KB. */
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = (1 << 22) + 1;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	if (lpm == NULL)
+		TEST_LPM_ASSERT(rte_errno == ENOMEM);
+	else {
+		status = rte_lpm_add(lpm, IPv4(10, 0, 0, 1), 32, 100);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm_lookup(lpm, IPv4(10, 0, 0, 1),
+				&next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == 100));
+
+		/* Clears the whole tbl8 array. */
+		rte_lpm_delete_all(lpm);
+		status = rte_lpm_lookup(lpm, IPv4(10, 0, 0, 1),
+				&next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+		rte_lpm_free(lpm);
+	}
+
+	/* The rules take 32GB. */
+	config.max_rules = UINT32_MAX;
+	config.number_tbl8s = NUMBER_TBL8S;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	if (lpm == NULL)
+		TEST_LPM_ASSERT(rte_errno == ENOMEM || rte_errno == EINVAL);
+	else
+		rte_lpm_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
@@ -1144,6 +1618,7 @@ test17(void)
 #define ITERATIONS (1 << 10)
 #define BATCH_SIZE (1 << 12)
 #define BULK_SIZE 32
+#define PERF_NUMBER_TBL8S (1 << 16)
 
 static void
 print_route_distribution(const struct route_rule *table, uint32_t n)
@@ -1169,13 +1644,69 @@ print_route_distribution(const struct route_rule *table, uint32_t n)
 	printf("\n");
 }
 
+static const char * const lookup_alg_name[RTE_LPM_LOOKUP_NUM] = {
+	[RTE_LPM_LOOKUP_DEFAULT] = "default",
+	[RTE_LPM_LOOKUP_SCALAR] = "scalar",
+	[RTE_LPM_LOOKUP_SSE] = "sse",
+	[RTE_LPM_LOOKUP_AVX2] = "avx2",
+};
+
+/* Measure burst lookup with each method supported. */
+static void
+perf_lookup_burst(const struct rte_lpm *lpm, const char *title)
+{
+	uint64_t begin, total_time;
+	int64_t count;
+	unsigned i, j, k;
+	int32_t alg;
+
+	for (alg = RTE_LPM_LOOKUP_SCALAR; alg != RTE_LPM_LOOKUP_NUM; alg++) {
+		total_time = 0;
+		count = 0;
+		for (i = 0; i < ITERATIONS; i++) {
+			static uint32_t ip_batch[BATCH_SIZE];
+			uint32_t next_hops[BULK_SIZE];
+
+			for (j = 0; j < BATCH_SIZE; j++)
+				ip_batch[j] = rte_rand();
+
+			begin = rte_rdtsc();
+			for (j = 0; j < BATCH_SIZE; j += BULK_SIZE) {
+				if (rte_lpm_lookup_burst_alg(lpm, &ip_batch[j],
+						next_hops, BULK_SIZE,
+						UINT32_MAX, alg) != 0)
+					break;
+				for (k = 0; k < BULK_SIZE; k++)
+					if (unlikely(next_hops[k] ==
+							UINT32_MAX))
+						count++;
+			}
+			total_time += rte_rdtsc() - begin;
+
+			if (j != BATCH_SIZE)
+				break;
+		}
+
+		if (i != ITERATIONS) {
+			printf("%sLPM Lookup burst %s: not supported\n",
+				title, lookup_alg_name[alg]);
+			continue;
+		}
+		printf("%sLPM Lookup burst %s: %.1f cycles (fails = %.1f%%)\n",
+			title, lookup_alg_name[alg],
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+	}
+}
+
 int32_t
 perf_test(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 	uint64_t begin, total_time, lpm_used_entries = 0;
 	unsigned i, j;
-	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
+	uint32_t next_hop_add = 0xAA, next_hop_return = 0;
 	int status = 0;
 	uint64_t cache_line_counter = 0;
 	int64_t count = 0;
@@ -1186,7 +1717,10 @@ perf_test(void)
 
 	print_route_distribution(large_route_table, (uint32_t) NUM_ROUTE_ENTRIES);
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 1000000, 0);
+	config.max_rules = 1000000;
+	config.number_tbl8s = PERF_NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Measue add. */
@@ -1252,7 +1786,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i ++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[BULK_SIZE];
+		uint32_t next_hops[BULK_SIZE];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j ++)
@@ -1279,7 +1813,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[4];
+		uint32_t next_hops[4];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j++)
@@ -1293,9 +1827,9 @@ perf_test(void)
 
 			ipx4 = _mm_loadu_si128((__m128i *)(ip_batch + j));
 			ipx4 = *(__m128i *)(ip_batch + j);
-			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT16_MAX);
+			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT32_MAX);
 			for (k = 0; k < RTE_DIM(next_hops); k++)
-				if (unlikely(next_hops[k] == UINT16_MAX))
+				if (unlikely(next_hops[k] == UINT32_MAX))
 					count++;
 		}
 
@@ -1305,6 +1839,8 @@ perf_test(void)
 			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
 			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
 
+	perf_lookup_burst(lpm, "");
+
 	/* Delete */
 	status = 0;
 	begin = rte_rdtsc();
@@ -1326,6 +1862,182 @@ perf_test(void)
 	return PASS;
 }
 
+/*
+ * Full table performance test
+ *
+ * Build a synthetic table with the size and prefix length distribution of
+ * a full Internet routing table, including tens of thousands of prefixes
+ * longer than /24, with next hops spread over the whole 24-bit range.
+ * Loading it takes tens of seconds, as rule insertion is linear in the
+ * number of rules of the same depth, so it is run as a separate command.
+ */
+
+static const struct {
+	uint8_t depth;
+	uint32_t n;
+} full_table_distribution[] = {
+	{  8,     16 }, {  9,     12 }, { 10,     32 }, { 11,     96 },
+	{ 12,    256 }, { 13,    512 }, { 14,   1024 }, { 15,   1800 },
+	{ 16,  12800 }, { 17,   6400 }, { 18,  10800 }, { 19,  20000 },
+	{ 20,  34000 }, { 21,  40000 }, { 22,  70000 }, { 23,  64000 },
+	{ 24, 310000 }, { 25,   4000 }, { 26,   4000 }, { 27,   4000 },
+	{ 28,   4000 }, { 29,   4000 }, { 30,   4000 }, { 31,   1000 },
+	{ 32,   4500 },
+};
+
+static int
+perf_test_full_table(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	struct rte_lpm_rule *table;
+	uint8_t *depths;
+	uint64_t begin, total_time;
+	uint32_t i, j, n_routes = 0, n_deep = 0, next_hop_return;
+	int64_t count = 0;
+	int32_t status = 0;
+
+	for (i = 0; i < RTE_DIM(full_table_distribution); i++) {
+		n_routes += full_table_distribution[i].n;
+		if (full_table_distribution[i].depth > 24)
+			n_deep += full_table_distribution[i].n;
+	}
+
+	table = rte_malloc(NULL, n_routes * sizeof(*table), 0);
+	depths = rte_malloc(NULL, n_routes, 0);
+	TEST_LPM_ASSERT(table != NULL && depths != NULL);
+
+	/* Fixed seed, so that runs can be compared with each other */
+	rte_srand(0x5eed);
+	for (i = 0, n_routes = 0; i < RTE_DIM(full_table_distribution); i++) {
+		uint8_t depth = full_table_distribution[i].depth;
+
+		for (j = 0; j < full_table_distribution[i].n; j++) {
+			table[n_routes].ip = (uint32_t)rte_rand() &
+					(uint32_t)(UINT64_MAX << (32 - depth));
+			table[n_routes].next_hop = (uint32_t)rte_rand() &
+					RTE_LPM_MAX_NEXT_HOP;
+			depths[n_routes] = depth;
+			n_routes++;
+		}
+	}
+
+	printf("Full table: %u routes, %u longer than /24\n",
+			n_routes, n_deep);
+
+	config.max_rules = n_routes;
+	config.number_tbl8s = PERF_NUMBER_TBL8S;
+	config.flags = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* Measure load */
+	begin = rte_rdtsc();
+	for (i = 0; i < n_routes; i++) {
+		status = rte_lpm_add(lpm, table[i].ip, depths[i],
+				table[i].next_hop);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	total_time = rte_rdtsc() - begin;
+
+	printf("Used tbl8 groups = %u of %u\n",
+			lpm->number_tbl8s - lpm->tbl8_free_count,
+			lpm->number_tbl8s);
+	printf("Full table load: %.1f ms, %g cycles per route\n",
+			(double)total_time * 1000 / rte_get_tsc_hz(),
+			(double)total_time / n_routes);
+
+	/* Every loaded prefix must now be covered */
+	for (i = 0; i < n_routes; i++) {
+		status = rte_lpm_lookup(lpm, table[i].ip, &next_hop_return);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* Measure single lookup */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		static uint32_t ip_batch[BATCH_SIZE];
+
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j++) {
+			if (rte_lpm_lookup(lpm, ip_batch[j],
+					&next_hop_return) != 0)
+				count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("Full table LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	/* Measure bulk lookup */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		static uint32_t ip_batch[BATCH_SIZE];
+		uint32_t next_hops[BULK_SIZE];
+
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE) {
+			unsigned k;
+
+			rte_lpm_lookup_bulk(lpm, &ip_batch[j], next_hops,
+					BULK_SIZE);
+			for (k = 0; k < BULK_SIZE; k++)
+				if (unlikely(!(next_hops[k] &
+						RTE_LPM_LOOKUP_SUCCESS)))
+					count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("Full table BULK LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	/* Measure LookupX4 */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		static uint32_t ip_batch[BATCH_SIZE];
+		uint32_t next_hops[4];
+
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += RTE_DIM(next_hops)) {
+			unsigned k;
+			__m128i ipx4;
+
+			ipx4 = _mm_loadu_si128((__m128i *)(ip_batch + j));
+			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT32_MAX);
+			for (k = 0; k < RTE_DIM(next_hops); k++)
+				if (unlikely(next_hops[k] == UINT32_MAX))
+					count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("Full table LPM LookupX4: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	perf_lookup_burst(lpm, "Full table ");
+
+	rte_lpm_delete_all(lpm);
+	rte_lpm_free(lpm);
+	rte_free(depths);
+	rte_free(table);
+
+	return PASS;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -1352,3 +2064,9 @@ static struct test_command lpm_cmd = {
 	.callback = test_lpm,
 };
 REGISTER_TEST_COMMAND(lpm_cmd);
+
+static struct test_command lpm_full_table_perf_cmd = {
+	.command = "lpm_full_table_perf_autotest",
+	.callback = perf_test_full_table,
+};
+REGISTER_TEST_COMMAND(lpm_full_table_perf_cmd);
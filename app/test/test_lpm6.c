@@ -88,6 +88,9 @@ static int32_t test24(void);
 static int32_t test25(void);
 static int32_t test26(void);
 static int32_t test27(void);
+static int32_t test28(void);
+static int32_t test29(void);
+static int32_t test30(void);
 static int32_t perf_test(void);
 
 rte_lpm6_test tests6[] = {
@@ -120,6 +123,9 @@ rte_lpm6_test tests6[] = {
 	test25,
 	test26,
 	test27,
+	test28,
+	test29,
+	test30,
 	perf_test,
 };
 
@@ -291,7 +297,8 @@ test4(void)
 	struct rte_lpm6_config config;
 
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth = 24, next_hop = 100;
+	uint8_t depth = 24;
+	uint32_t next_hop = 100;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -367,7 +374,7 @@ test6(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -405,7 +412,7 @@ test7(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[10][16];
-	int16_t next_hop_return[10];
+	int32_t next_hop_return[10];
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -482,7 +489,8 @@ test9(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth = 16, next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 16;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
 	int32_t status = 0;
 	uint8_t i;
 
@@ -526,7 +534,8 @@ test10(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth, next_hop_add = 100;
+	uint8_t depth;
+	uint32_t next_hop_add = 100;
 	int32_t status = 0;
 	int i;
 
@@ -570,7 +579,8 @@ test11(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth, next_hop_add = 100;
+	uint8_t depth;
+	uint32_t next_hop_add = 100;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -630,7 +640,8 @@ test12(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth, next_hop_add = 100;
+	uint8_t depth;
+	uint32_t next_hop_add = 100;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -668,7 +679,8 @@ test13(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth, next_hop_add = 100;
+	uint8_t depth;
+	uint32_t next_hop_add = 100;
 	int32_t status = 0;
 
 	config.max_rules = 2;
@@ -715,7 +727,8 @@ test14(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth = 25, next_hop_add = 100;
+	uint8_t depth = 25;
+	uint32_t next_hop_add = 100;
 	int32_t status = 0;
 	int i, j;
 
@@ -767,7 +780,8 @@ test15(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth = 24, next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 24;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -803,7 +817,8 @@ test16(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[] = {12,12,1,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth = 128, next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 128;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -847,7 +862,8 @@ test17(void)
 	uint8_t ip1[] = {127,255,255,255,255,255,255,255,255,
 			255,255,255,255,255,255,255};
 	uint8_t ip2[] = {128,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -876,7 +892,7 @@ test17(void)
 
 	/* Loop with rte_lpm6_delete. */
 	for (depth = 128; depth >= 1; depth--) {
-		next_hop_add = (uint8_t) (depth - 1);
+		next_hop_add = (uint32_t) (depth - 1);
 
 		status = rte_lpm6_delete(lpm, ip2, depth);
 		TEST_LPM_ASSERT(status == 0);
@@ -912,8 +928,8 @@ test18(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[16], ip_1[16], ip_2[16];
-	uint8_t depth, depth_1, depth_2, next_hop_add, next_hop_add_1,
-		next_hop_add_2, next_hop_return;
+	uint8_t depth, depth_1, depth_2;
+	uint32_t next_hop_add, next_hop_add_1, next_hop_add_2, next_hop_return;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1074,7 +1090,8 @@ test19(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[16];
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1272,7 +1289,8 @@ test20(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip[16];
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1339,8 +1357,9 @@ test21(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip_batch[4][16];
-	uint8_t depth, next_hop_add;
-	int16_t next_hop_return[4];
+	uint8_t depth;
+	uint32_t next_hop_add;
+	int32_t next_hop_return[4];
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1397,8 +1416,9 @@ test22(void)
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
 	uint8_t ip_batch[5][16];
-	uint8_t depth[5], next_hop_add;
-	int16_t next_hop_return[5];
+	uint8_t depth[5];
+	uint32_t next_hop_add;
+	int32_t next_hop_return[5];
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1514,7 +1534,8 @@ test23(void)
 	struct rte_lpm6_config config;
 	uint32_t i;
 	uint8_t ip[16];
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1598,7 +1619,8 @@ test25(void)
 	struct rte_lpm6_config config;
 	uint8_t ip[16];
 	uint32_t i;
-	uint8_t depth, next_hop_add, next_hop_return, next_hop_expected;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return, next_hop_expected;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1648,10 +1670,10 @@ test26(void)
 	uint8_t d_ip_10_32 = 32;
 	uint8_t	d_ip_10_24 = 24;
 	uint8_t	d_ip_20_25 = 25;
-	uint8_t next_hop_ip_10_32 = 100;
-	uint8_t	next_hop_ip_10_24 = 105;
-	uint8_t	next_hop_ip_20_25 = 111;
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_ip_10_32 = 100;
+	uint32_t next_hop_ip_10_24 = 105;
+	uint32_t next_hop_ip_20_25 = 111;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	config.max_rules = MAX_RULES;
@@ -1666,7 +1688,7 @@ test26(void)
 		return -1;
 
 	status = rte_lpm6_lookup(lpm, ip_10_32, &next_hop_return);
-	uint8_t test_hop_10_32 = next_hop_return;
+	uint32_t test_hop_10_32 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_32);
 
@@ -1675,7 +1697,7 @@ test26(void)
 			return -1;
 
 	status = rte_lpm6_lookup(lpm, ip_10_24, &next_hop_return);
-	uint8_t test_hop_10_24 = next_hop_return;
+	uint32_t test_hop_10_24 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_24);
 
@@ -1684,7 +1706,7 @@ test26(void)
 		return -1;
 
 	status = rte_lpm6_lookup(lpm, ip_20_25, &next_hop_return);
-	uint8_t test_hop_20_25 = next_hop_return;
+	uint32_t test_hop_20_25 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_20_25);
 
@@ -1723,7 +1745,8 @@ test27(void)
 		struct rte_lpm6 *lpm = NULL;
 		struct rte_lpm6_config config;
 		uint8_t ip[] = {128,128,128,128,128,128,128,128,128,128,128,128,128,128,0,0};
-		uint8_t depth = 128, next_hop_add = 100, next_hop_return;
+		uint8_t depth = 128;
+		uint32_t next_hop_add = 100, next_hop_return;
 		int32_t status = 0;
 		int i, j;
 
@@ -1761,12 +1784,286 @@ test27(void)
 		return PASS;
 }
 
+/*
+ * Check the next hop range and that tbl8 groups are given back on delete:
+ *  - a next hop above RTE_LPM6_MAX_NEXT_HOP is rejected
+ *  - a /128 rule takes 13 tbl8 groups, so a second one in another /24
+ *    fails with only 13 groups and leaves no rule behind
+ *  - once the first rule is deleted, the second one can be added
+ */
+int32_t
+test28(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t ip1[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	uint8_t ip2[] = {2,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	uint8_t depth = 128;
+	uint32_t next_hop_return = 0;
+	int32_t status = 0;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 13;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	status = rte_lpm6_add(lpm, ip1, depth, RTE_LPM6_MAX_NEXT_HOP + 1);
+	TEST_LPM_ASSERT(status == -EINVAL);
+
+	status = rte_lpm6_add(lpm, ip1, depth, RTE_LPM6_MAX_NEXT_HOP);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_lookup(lpm, ip1, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) &&
+			(next_hop_return == RTE_LPM6_MAX_NEXT_HOP));
+
+	status = rte_lpm6_add(lpm, ip2, depth, 200);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	status = rte_lpm6_is_rule_present(lpm, ip2, depth, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_lookup(lpm, ip2, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	status = rte_lpm6_lookup(lpm, ip1, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) &&
+			(next_hop_return == RTE_LPM6_MAX_NEXT_HOP));
+
+	status = rte_lpm6_delete(lpm, ip1, depth);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_add(lpm, ip2, depth, 200);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_lookup(lpm, ip2, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 200));
+
+	status = rte_lpm6_lookup(lpm, ip1, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+#define TEST29_NUM_RULES 512
+#define TEST29_NUM_IPS   4096
+
+struct test29_rule {
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t depth;
+	uint32_t next_hop;
+	int present;
+};
+
+/* Brute force longest prefix match over the rules which are present. */
+static int
+test29_lookup(const struct test29_rule *rules, const uint8_t *ip)
+{
+	int i, best = -1;
+	uint8_t bytes, bits;
+
+	for (i = 0; i < TEST29_NUM_RULES; i++) {
+		if (!rules[i].present ||
+				(best >= 0 && rules[i].depth <= rules[best].depth))
+			continue;
+
+		bytes = rules[i].depth / 8;
+		bits = rules[i].depth % 8;
+		if (memcmp(rules[i].ip, ip, bytes) != 0)
+			continue;
+		if (bits != 0 && ((rules[i].ip[bytes] ^ ip[bytes]) &
+				(uint8_t)(0xFF << (8 - bits))) != 0)
+			continue;
+		best = i;
+	}
+
+	return best;
+}
+
+/*
+ * Add and delete random overlapping rules, and check after each round
+ * that single and bulk lookups agree with a brute force search, and
+ * that deleting all the rules gives back all the tbl8 groups.
+ */
+int32_t
+test29(void)
+{
+	static struct test29_rule rules[TEST29_NUM_RULES];
+	static uint8_t ips[TEST29_NUM_IPS][RTE_LPM6_IPV6_ADDR_SIZE];
+	static int32_t next_hops[TEST29_NUM_IPS];
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint32_t next_hop_return = 0;
+	int32_t status = 0;
+	int i, j, k, round, best;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/*
+	 * Rules share a few leading bytes so that they overlap, their
+	 * depths spread over all the table levels.
+	 */
+	srand(1);
+	for (i = 0; i < TEST29_NUM_RULES; i++) {
+		do {
+			for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+				rules[i].ip[j] = (uint8_t)(j < 4 ?
+						rand() % 2 : rand());
+			rules[i].depth = (uint8_t)(1 +
+					rand() % RTE_LPM6_MAX_DEPTH);
+			for (j = rules[i].depth; j < RTE_LPM6_MAX_DEPTH; j++)
+				rules[i].ip[j / 8] &= (uint8_t)~(0x80 >> (j % 8));
+
+			/* Each rule must be unique. */
+			for (j = 0; j < i; j++)
+				if (rules[j].depth == rules[i].depth &&
+						memcmp(rules[j].ip, rules[i].ip,
+						RTE_LPM6_IPV6_ADDR_SIZE) == 0)
+					break;
+		} while (j < i);
+		rules[i].next_hop = (uint32_t)rand() % RTE_LPM6_MAX_NEXT_HOP;
+		rules[i].present = 0;
+	}
+
+	for (round = 0; round < 8; round++) {
+		for (i = 0; i < TEST29_NUM_RULES; i++) {
+			if (rand() % 2 == 0)
+				continue;
+			if (rules[i].present) {
+				status = rte_lpm6_delete(lpm, rules[i].ip,
+						rules[i].depth);
+				rules[i].present = 0;
+			} else {
+				status = rte_lpm6_add(lpm, rules[i].ip,
+						rules[i].depth, rules[i].next_hop);
+				rules[i].present = 1;
+			}
+			TEST_LPM_ASSERT(status == 0);
+		}
+
+		/* Addresses derived from the rules, plus random bits. */
+		for (k = 0; k < TEST29_NUM_IPS; k++) {
+			i = rand() % TEST29_NUM_RULES;
+			for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+				ips[k][j] = (uint8_t)(rules[i].ip[j] ^
+					((j * 8 + 8 > rules[i].depth + rand() % 24) ?
+					rand() : 0));
+		}
+
+		status = rte_lpm6_lookup_bulk_func(lpm, ips, next_hops,
+				TEST29_NUM_IPS);
+		TEST_LPM_ASSERT(status == 0);
+
+		for (k = 0; k < TEST29_NUM_IPS; k++) {
+			best = test29_lookup(rules, ips[k]);
+			status = rte_lpm6_lookup(lpm, ips[k], &next_hop_return);
+			if (best < 0) {
+				TEST_LPM_ASSERT(status == -ENOENT);
+				TEST_LPM_ASSERT(next_hops[k] == -1);
+			} else {
+				TEST_LPM_ASSERT((status == 0) &&
+					(next_hop_return == rules[best].next_hop));
+				TEST_LPM_ASSERT(next_hops[k] ==
+					(int32_t)rules[best].next_hop);
+			}
+		}
+	}
+
+	for (i = 0; i < TEST29_NUM_RULES; i++) {
+		if (rules[i].present) {
+			status = rte_lpm6_delete(lpm, rules[i].ip,
+					rules[i].depth);
+			TEST_LPM_ASSERT(status == 0);
+		}
+	}
+
+	/*
+	 * All the tbl8 groups must be free again: a /128 rule takes 13
+	 * groups, fill them all with rules in different /24s.
+	 */
+	memset(ips[0], 0xAA, RTE_LPM6_IPV6_ADDR_SIZE);
+	for (i = 0; i < NUMBER_TBL8S / 13; i++) {
+		ips[0][0] = (uint8_t)(i >> 16);
+		ips[0][1] = (uint8_t)(i >> 8);
+		ips[0][2] = (uint8_t)i;
+		status = rte_lpm6_add(lpm, ips[0], 128, 100);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Delete a rule below a tbl8 group filled by rules of the same depth and
+ * next hop, then delete one of those rules: the group must not be folded
+ * into its parent entry, which covers fewer bits than the rules.
+ */
+int32_t
+test30(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t ip[] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0};
+	uint32_t next_hop_return = 0;
+	int32_t status = 0;
+	unsigned i;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* 2001:db8:XX00::/40 for every XX, all with the same next hop. */
+	for (i = 0; i < 256; i++) {
+		ip[4] = (uint8_t)i;
+		status = rte_lpm6_add(lpm, ip, 40, 5);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* Add and delete a /48 below one of them. */
+	ip[4] = 0x10;
+	ip[5] = 0x20;
+	status = rte_lpm6_add(lpm, ip, 48, 6);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_delete(lpm, ip, 48);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_delete(lpm, ip, 40);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_is_rule_present(lpm, ip, 40, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	/* The other rules still match. */
+	ip[4] = 0x11;
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 5));
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
 
 #define ITERATIONS (1 << 10)
-#define BATCH_SIZE 100000
 
 static void
 print_route_distribution(const struct rules_tbl_entry *table, uint32_t n)
@@ -1799,9 +2096,10 @@ perf_test(void)
 	struct rte_lpm6_config config;
 	uint64_t begin, total_time;
 	unsigned i, j;
-	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
+	uint32_t next_hop_add = 0xAA, next_hop_return = 0;
 	int status = 0;
 	int64_t count = 0;
+	double single_cycles, bulk_cycles;
 
 	config.max_rules = 1000000;
 	config.number_tbl8s = NUMBER_TBL8S;
@@ -1847,16 +2145,18 @@ perf_test(void)
 		total_time += rte_rdtsc() - begin;
 
 	}
+	single_cycles = (double)total_time /
+			((double)ITERATIONS * NUM_IPS_ENTRIES);
 	printf("Average LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
-			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
-			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+			single_cycles,
+			(count * 100.0) / (double)(ITERATIONS * NUM_IPS_ENTRIES));
 
 	/* Measure bulk Lookup */
 	total_time = 0;
 	count = 0;
 
 	uint8_t ip_batch[NUM_IPS_ENTRIES][16];
-	int16_t next_hops[NUM_IPS_ENTRIES];
+	int32_t next_hops[NUM_IPS_ENTRIES];
 
 	for (i = 0; i < NUM_IPS_ENTRIES; i++)
 		memcpy(ip_batch[i], large_ips_table[i].ip, 16);
@@ -1872,9 +2172,13 @@ perf_test(void)
 			if (next_hops[j] < 0)
 				count++;
 	}
-	printf("BULK LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
-			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
-			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+	bulk_cycles = (double)total_time /
+			((double)ITERATIONS * NUM_IPS_ENTRIES);
+	printf("BULK LPM Lookup: %.1f cycles (fails = %.1f%%), "
+			"%.2fx the single lookup rate\n",
+			bulk_cycles,
+			(count * 100.0) / (double)(ITERATIONS * NUM_IPS_ENTRIES),
+			single_cycles / bulk_cycles);
 
 	/* Delete */
 	status = 0;
@@ -1886,7 +2190,7 @@ perf_test(void)
 				large_route_table[i].depth);
 	}
 
-	total_time += rte_rdtsc() - begin;
+	total_time = rte_rdtsc() - begin;
 
 	printf("Average LPM Delete: %g cycles\n",
 			(double)total_time / NUM_ROUTE_ENTRIES);
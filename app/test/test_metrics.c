@@ -0,0 +1,235 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_metrics.h>
+
+#include "test.h"
+
+static const char * const metrics_set_names[] = {
+	"rx_drops", "tx_drops", "table_hits",
+};
+
+static int
+test_metrics_setup(void)
+{
+	int ret = rte_metrics_init(SOCKET_ID_ANY);
+
+	if (ret == -EEXIST)
+		return 0;
+	return ret;
+}
+
+static int
+test_metrics_teardown(void)
+{
+	rte_metrics_uninit();
+	return 0;
+}
+
+static int
+test_metrics_init(void)
+{
+	TEST_ASSERT_EQUAL(rte_metrics_init(SOCKET_ID_ANY), -EEXIST,
+			"No error on second init");
+	TEST_ASSERT_SUCCESS(rte_metrics_uninit(), "Uninit failed");
+	TEST_ASSERT_EQUAL(rte_metrics_uninit(), -ENOENT,
+			"No error on second uninit");
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name("drops"), -ENOENT,
+			"No error on registration without registry");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(NULL, 0), -ENOENT,
+			"No error on get without registry");
+	TEST_ASSERT_SUCCESS(rte_metrics_init(SOCKET_ID_ANY), "Init failed");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(NULL, 0), 0,
+			"Registry not empty after init");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_register(void)
+{
+	char long_name[RTE_METRICS_MAX_NAME_LEN + 1];
+	const char *dup_names[] = { "new_metric", "new_metric" };
+	struct rte_metric_name names[RTE_METRICS_MAX_METRICS];
+	char name[RTE_METRICS_MAX_NAME_LEN];
+	int key, first, i;
+
+	TEST_ASSERT_SUCCESS(rte_metrics_uninit(), "Uninit failed");
+	TEST_ASSERT_SUCCESS(rte_metrics_init(SOCKET_ID_ANY), "Init failed");
+
+	key = rte_metrics_reg_name("global_metric");
+	TEST_ASSERT_EQUAL(key, 0, "Wrong key %d for first metric", key);
+	first = rte_metrics_reg_names(metrics_set_names,
+			RTE_DIM(metrics_set_names));
+	TEST_ASSERT_EQUAL(first, 1, "Wrong first key %d for set", first);
+
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name("tx_drops"), -EEXIST,
+			"No error on duplicated name");
+	TEST_ASSERT_EQUAL(rte_metrics_reg_names(dup_names, 2), -EEXIST,
+			"No error on duplicated name in set");
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(""), -EINVAL,
+			"No error on empty name");
+	memset(long_name, 'a', sizeof(long_name) - 1);
+	long_name[sizeof(long_name) - 1] = '\0';
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(long_name), -EINVAL,
+			"No error on too long name");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_key("table_hits"), 3,
+			"Wrong key for table_hits");
+	TEST_ASSERT_EQUAL(rte_metrics_get_key("new_metric"), -ENOENT,
+			"Failed registration was not rolled back");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(NULL, 0), 4,
+			"Wrong number of metrics");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(names, 2), 4,
+			"Wrong number of metrics with small array");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(names, RTE_DIM(names)), 4,
+			"Cannot get names");
+	TEST_ASSERT_SUCCESS(strcmp(names[0].name, "global_metric"),
+			"Wrong name for key 0");
+	for (i = 0; i < (int)RTE_DIM(metrics_set_names); i++)
+		TEST_ASSERT_SUCCESS(strcmp(names[first + i].name,
+				metrics_set_names[i]), "Wrong name for key %d",
+				first + i);
+
+	/* fill the registry */
+	for (i = 4; i < RTE_METRICS_MAX_METRICS; i++) {
+		snprintf(name, sizeof(name), "metric_%d", i);
+		TEST_ASSERT_EQUAL(rte_metrics_reg_name(name), i,
+				"Cannot register metric %d", i);
+	}
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name("one_too_many"), -ENOSPC,
+			"No error on full registry");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_update(void)
+{
+	struct rte_metric_value values[RTE_METRICS_MAX_METRICS];
+	uint64_t set_values[RTE_DIM(metrics_set_names)] = { 10, 20, 30 };
+	int global_key, first, ret, i;
+
+	TEST_ASSERT_SUCCESS(rte_metrics_uninit(), "Uninit failed");
+	TEST_ASSERT_SUCCESS(rte_metrics_init(SOCKET_ID_ANY), "Init failed");
+
+	global_key = rte_metrics_reg_name("global_metric");
+	first = rte_metrics_reg_names(metrics_set_names,
+			RTE_DIM(metrics_set_names));
+	TEST_ASSERT(global_key >= 0 && first >= 0, "Cannot register metrics");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(0, NULL, 0), 0,
+			"Values reported before any update");
+
+	TEST_ASSERT_SUCCESS(rte_metrics_update_value(RTE_METRICS_GLOBAL,
+			global_key, 42), "Cannot update global metric");
+	TEST_ASSERT_SUCCESS(rte_metrics_update_values(1, first, set_values,
+			RTE_DIM(set_values)), "Cannot update port metrics");
+	TEST_ASSERT_SUCCESS(rte_metrics_add_value(1, first, 5),
+			"Cannot add to port metric");
+	TEST_ASSERT_SUCCESS(rte_metrics_add_value(2, first + 2, 7),
+			"Cannot add to port metric");
+
+	TEST_ASSERT_EQUAL(rte_metrics_update_value(RTE_MAX_ETHPORTS,
+			global_key, 0), -EINVAL, "No error on invalid port");
+	TEST_ASSERT_EQUAL(rte_metrics_update_value(-2, global_key, 0),
+			-EINVAL, "No error on invalid port");
+	TEST_ASSERT_EQUAL(rte_metrics_update_value(0, first + 3, 0), -EINVAL,
+			"No error on unregistered key");
+	TEST_ASSERT_EQUAL(rte_metrics_update_values(0, first + 1, set_values,
+			RTE_DIM(set_values)), -EINVAL,
+			"No error on keys out of range");
+	TEST_ASSERT_EQUAL(rte_metrics_add_value(0, first + 3, 1), -EINVAL,
+			"No error on unregistered key");
+
+	ret = rte_metrics_get_values(RTE_METRICS_GLOBAL, values,
+			RTE_DIM(values));
+	TEST_ASSERT_EQUAL(ret, 1, "Wrong number of global values: %d", ret);
+	TEST_ASSERT(values[0].key == global_key && values[0].value == 42,
+			"Wrong global value");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(1, NULL, 0), 3,
+			"Wrong number of values for port 1");
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(1, values, 2), 3,
+			"Wrong number of values with small array");
+	ret = rte_metrics_get_values(1, values, RTE_DIM(values));
+	TEST_ASSERT_EQUAL(ret, 3, "Wrong number of values for port 1");
+	for (i = 0; i < ret; i++) {
+		TEST_ASSERT_EQUAL(values[i].key, first + i,
+				"Wrong key for port 1");
+		TEST_ASSERT_EQUAL(values[i].value,
+				set_values[i] + (i == 0 ? 5 : 0),
+				"Wrong value for key %u", values[i].key);
+	}
+
+	ret = rte_metrics_get_values(2, values, RTE_DIM(values));
+	TEST_ASSERT_EQUAL(ret, 1, "Wrong number of values for port 2");
+	TEST_ASSERT(values[0].key == first + 2 && values[0].value == 7,
+			"Wrong value for port 2");
+
+	TEST_ASSERT_EQUAL(rte_metrics_get_values(RTE_MAX_ETHPORTS, values,
+			RTE_DIM(values)), -EINVAL, "No error on invalid port");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite metrics_test_suite  = {
+	.setup = test_metrics_setup,
+	.teardown = test_metrics_teardown,
+	.suite_name = "Metrics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_metrics_init),
+		TEST_CASE(test_metrics_register),
+		TEST_CASE(test_metrics_update),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_metrics(void)
+{
+	return unit_test_suite_runner(&metrics_test_suite);
+}
+
+static struct test_command metrics_cmd = {
+	.command = "metrics_autotest",
+	.callback = test_metrics,
+};
+REGISTER_TEST_COMMAND(metrics_cmd);
@@ -0,0 +1,209 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_pdump.h>
+#include <rte_ring.h>
+
+#include "test.h"
+
+#define BURST 32
+#define NB_MBUF 512
+#define RING_SIZE 256
+
+static struct rte_mempool *pdump_pool;
+static struct rte_mempool *pdump_clone_pool;
+static struct rte_ring *pdump_port_ring;
+static struct rte_ring *pdump_capture_ring;
+static int pdump_port = -1;
+
+static int
+test_pdump_setup(void)
+{
+	struct rte_eth_conf null_conf;
+
+	if (pdump_port >= 0)
+		return 0;
+
+	pdump_pool = rte_pktmbuf_pool_create("PDUMP_MBUF_POOL", NB_MBUF,
+			BURST, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	pdump_clone_pool = rte_pktmbuf_pool_create("PDUMP_CLONE_POOL", NB_MBUF,
+			BURST, 0, 0, rte_socket_id());
+	if (pdump_pool == NULL || pdump_clone_pool == NULL) {
+		printf("%s: Error creating mempools\n", __func__);
+		return -1;
+	}
+
+	pdump_port_ring = rte_ring_create("PDUMP_PORT_RING", RING_SIZE,
+			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+	pdump_capture_ring = rte_ring_create("PDUMP_CAPTURE_RING", RING_SIZE,
+			rte_socket_id(), RING_F_SC_DEQ);
+	if (pdump_port_ring == NULL || pdump_capture_ring == NULL) {
+		printf("%s: Error creating rings\n", __func__);
+		return -1;
+	}
+
+	pdump_port = rte_eth_from_rings("eth_ring_pdump", &pdump_port_ring, 1,
+			&pdump_port_ring, 1, rte_socket_id());
+	if (pdump_port < 0) {
+		printf("%s: Error creating ring port\n", __func__);
+		return -1;
+	}
+
+	memset(&null_conf, 0, sizeof(null_conf));
+	if (rte_eth_dev_configure(pdump_port, 1, 1, &null_conf) < 0 ||
+			rte_eth_rx_queue_setup(pdump_port, 0, RING_SIZE,
+				rte_socket_id(), NULL, pdump_pool) < 0 ||
+			rte_eth_tx_queue_setup(pdump_port, 0, RING_SIZE,
+				rte_socket_id(), NULL) < 0 ||
+			rte_eth_dev_start(pdump_port) < 0) {
+		printf("%s: Error configuring ring port\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_pdump_init_uninit(void)
+{
+	TEST_ASSERT_EQUAL(rte_pdump_uninit(), -ENOENT,
+			"No error on uninit before init");
+	TEST_ASSERT_SUCCESS(rte_pdump_init(), "Init failed");
+	TEST_ASSERT_EQUAL(rte_pdump_init(), -EEXIST, "No error on second init");
+	TEST_ASSERT_SUCCESS(rte_pdump_uninit(), "Uninit failed");
+	TEST_ASSERT_EQUAL(rte_pdump_enable(pdump_port, 0, RTE_PDUMP_FLAG_RX,
+			pdump_capture_ring, pdump_clone_pool), -ENOENT,
+			"No error on enable after uninit");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pdump_capture(void)
+{
+	struct rte_mbuf *pkts[BURST], *clones[BURST];
+	unsigned i, nb;
+
+	TEST_ASSERT_SUCCESS(rte_pdump_init(), "Init failed");
+
+	TEST_ASSERT_EQUAL(rte_pdump_enable(pdump_port, 1, RTE_PDUMP_FLAG_RX,
+			pdump_capture_ring, pdump_clone_pool), -EINVAL,
+			"No error on invalid queue");
+	TEST_ASSERT_EQUAL(rte_pdump_enable(pdump_port, 0, 0,
+			pdump_capture_ring, pdump_clone_pool), -EINVAL,
+			"No error on invalid flags");
+	TEST_ASSERT_SUCCESS(rte_pdump_enable(pdump_port, RTE_PDUMP_ALL_QUEUES,
+			RTE_PDUMP_FLAG_RXTX, pdump_capture_ring,
+			pdump_clone_pool), "Cannot enable capture");
+	TEST_ASSERT_EQUAL(rte_pdump_enable(pdump_port, 0, RTE_PDUMP_FLAG_RX,
+			pdump_capture_ring, pdump_clone_pool), -EEXIST,
+			"No error on enabling capture twice");
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = rte_pktmbuf_alloc(pdump_pool);
+		TEST_ASSERT_NOT_NULL(pkts[i], "Cannot allocate mbuf");
+		TEST_ASSERT_NOT_NULL(rte_pktmbuf_append(pkts[i], 64),
+				"Cannot set packet length");
+	}
+	rte_ring_enqueue_bulk(pdump_port_ring, (void **)pkts, BURST);
+
+	nb = rte_eth_rx_burst(pdump_port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(nb, BURST, "Received %u packets", nb);
+	nb = rte_ring_dequeue_burst(pdump_capture_ring, (void **)clones,
+			BURST);
+	TEST_ASSERT_EQUAL(nb, BURST, "Captured %u RX packets", nb);
+	for (i = 0; i < BURST; i++) {
+		TEST_ASSERT(RTE_MBUF_INDIRECT(clones[i]),
+				"Captured packet is not a clone");
+		TEST_ASSERT_EQUAL(rte_pktmbuf_pkt_len(clones[i]), 64,
+				"Wrong captured length");
+		TEST_ASSERT_EQUAL(rte_mbuf_refcnt_read(pkts[i]), 2,
+				"Wrong reference count");
+		rte_pktmbuf_free(clones[i]);
+	}
+
+	nb = rte_eth_tx_burst(pdump_port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(nb, BURST, "Sent %u packets", nb);
+	nb = rte_ring_dequeue_burst(pdump_capture_ring, (void **)clones,
+			BURST);
+	TEST_ASSERT_EQUAL(nb, BURST, "Captured %u TX packets", nb);
+	for (i = 0; i < BURST; i++)
+		rte_pktmbuf_free(clones[i]);
+
+	TEST_ASSERT_SUCCESS(rte_pdump_disable(pdump_port, RTE_PDUMP_ALL_QUEUES,
+			RTE_PDUMP_FLAG_RXTX), "Cannot disable capture");
+
+	/* the packets sent are received again, without being captured */
+	nb = rte_eth_rx_burst(pdump_port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(nb, BURST, "Received %u packets", nb);
+	TEST_ASSERT_EQUAL(rte_ring_count(pdump_capture_ring), 0,
+			"Packets captured after disable");
+	for (i = 0; i < BURST; i++) {
+		TEST_ASSERT_EQUAL(rte_mbuf_refcnt_read(pkts[i]), 1,
+				"Wrong reference count after capture");
+		rte_pktmbuf_free(pkts[i]);
+	}
+
+	TEST_ASSERT_SUCCESS(rte_pdump_uninit(), "Uninit failed");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite pdump_test_suite  = {
+	.setup = test_pdump_setup,
+	.suite_name = "Packet Capture Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_pdump_init_uninit),
+		TEST_CASE(test_pdump_capture),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_pdump(void)
+{
+	return unit_test_suite_runner(&pdump_test_suite);
+}
+
+static struct test_command pdump_cmd = {
+	.command = "pdump_autotest",
+	.callback = test_pdump,
+};
+REGISTER_TEST_COMMAND(pdump_cmd);
@@ -0,0 +1,256 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+#define TEST_RCU_MAX_THREADS 128
+
+static struct rte_rcu_qsbr *v;
+
+static int
+test_rcu_qsbr_setup(void)
+{
+	size_t sz = rte_rcu_qsbr_get_memsize(TEST_RCU_MAX_THREADS);
+
+	v = rte_zmalloc("test_rcu_qsbr", sz, RTE_CACHE_LINE_SIZE);
+	if (v == NULL)
+		return -1;
+	return 0;
+}
+
+static int
+test_rcu_qsbr_teardown(void)
+{
+	rte_free(v);
+	v = NULL;
+	return 0;
+}
+
+static int
+test_rcu_qsbr_ut_setup(void)
+{
+	return rte_rcu_qsbr_init(v, TEST_RCU_MAX_THREADS);
+}
+
+static int
+test_rcu_qsbr_params(void)
+{
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_get_memsize(0), 0,
+			"Non-zero size for 0 threads");
+	TEST_ASSERT(rte_rcu_qsbr_get_memsize(1) >= sizeof(struct rte_rcu_qsbr) +
+			sizeof(struct rte_rcu_qsbr_cnt),
+			"Size too small for 1 thread");
+
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(NULL, 1), -EINVAL,
+			"No error on NULL variable");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(v, 0), -EINVAL,
+			"No error on 0 threads");
+
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_register(v,
+			TEST_RCU_MAX_THREADS), -EINVAL,
+			"No error on invalid thread ID");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_unregister(NULL, 0), -EINVAL,
+			"No error on NULL variable");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_dump(NULL, v), -EINVAL,
+			"No error on NULL file");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rcu_qsbr_check(void)
+{
+	uint64_t t;
+
+	/* No reader registered, any grace period is over. */
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+			"Grace period not over without readers");
+
+	/* Registered readers are offline until they go online. */
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 0),
+			"Cannot register thread 0");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 100),
+			"Cannot register thread 100");
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+			"Grace period not over with offline readers");
+
+	rte_rcu_qsbr_thread_online(v, 0);
+	rte_rcu_qsbr_thread_online(v, 100);
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+			"Grace period over before any quiescent state");
+
+	rte_rcu_qsbr_quiescent(v, 0);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+			"Grace period over before all quiescent states");
+
+	rte_rcu_qsbr_quiescent(v, 100);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+			"Grace period not over after all quiescent states");
+
+	/* A later grace period is not over yet. */
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+			"New grace period over before any quiescent state");
+
+	/* Going offline or being unregistered ends the wait for a reader. */
+	rte_rcu_qsbr_thread_offline(v, 0);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 100),
+			"Cannot unregister thread 100");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+			"Grace period not over without online readers");
+
+	/* A reader waiting for its own grace period reports its state. */
+	rte_rcu_qsbr_thread_online(v, 0);
+	rte_rcu_qsbr_synchronize(v, 0);
+	rte_rcu_qsbr_thread_offline(v, 0);
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dump(stdout, v), "Cannot dump");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Readers on the slave lcores repeatedly read an element published through
+ * a shared pointer and check it was not freed. The writer replaces it,
+ * waits for the grace period and poisons the old element.
+ */
+
+#define TEST_RCU_POISON UINT32_C(0xdeadbeef)
+#define TEST_RCU_WRITER_ITERATIONS 10000
+
+static uint32_t rcu_elems[2];
+static uint32_t * volatile rcu_shared;
+static volatile int rcu_stop;
+static volatile uint32_t rcu_errors;
+
+static int
+test_rcu_qsbr_reader(__attribute__((unused)) void *arg)
+{
+	uint32_t lcore_id = rte_lcore_id();
+	uint32_t *p;
+
+	rte_rcu_qsbr_thread_register(v, lcore_id);
+	rte_rcu_qsbr_thread_online(v, lcore_id);
+
+	while (!rcu_stop) {
+		p = rcu_shared;
+		if (*p == TEST_RCU_POISON)
+			rcu_errors++;
+		rte_rcu_qsbr_quiescent(v, lcore_id);
+	}
+
+	rte_rcu_qsbr_thread_offline(v, lcore_id);
+	rte_rcu_qsbr_thread_unregister(v, lcore_id);
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_multi_lcore(void)
+{
+	unsigned lcore_id;
+	uint32_t i, *old;
+	uint64_t t;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores, skipping multi-lcore test\n");
+		return TEST_SUCCESS;
+	}
+
+	rcu_elems[0] = 0;
+	rcu_shared = &rcu_elems[0];
+	rcu_stop = 0;
+	rcu_errors = 0;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(test_rcu_qsbr_reader, NULL, lcore_id);
+
+	for (i = 1; i <= TEST_RCU_WRITER_ITERATIONS; i++) {
+		old = rcu_shared;
+		rcu_elems[i & 1] = i;
+		rcu_shared = &rcu_elems[i & 1];
+
+		t = rte_rcu_qsbr_start(v);
+		rte_rcu_qsbr_check(v, t, 1);
+		*old = TEST_RCU_POISON;
+	}
+
+	rcu_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	TEST_ASSERT_EQUAL(rcu_errors, 0,
+			"Readers accessed %u freed elements", rcu_errors);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite rcu_qsbr_test_suite  = {
+	.setup = test_rcu_qsbr_setup,
+	.teardown = test_rcu_qsbr_teardown,
+	.suite_name = "RCU QSBR Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE_ST(test_rcu_qsbr_ut_setup, NULL,
+				test_rcu_qsbr_params),
+		TEST_CASE_ST(test_rcu_qsbr_ut_setup, NULL,
+				test_rcu_qsbr_check),
+		TEST_CASE_ST(test_rcu_qsbr_ut_setup, NULL,
+				test_rcu_qsbr_multi_lcore),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_rcu_qsbr(void)
+{
+	return unit_test_suite_runner(&rcu_qsbr_test_suite);
+}
+
+static struct test_command rcu_qsbr_cmd = {
+	.command = "rcu_qsbr_autotest",
+	.callback = test_rcu_qsbr,
+};
+REGISTER_TEST_COMMAND(rcu_qsbr_cmd);
@@ -333,6 +333,304 @@ exit:
 	return ret;
 }
 
+static int
+test_reorder_drain_timeout(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	struct rte_reorder_stats stats;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = 8;
+	const uint64_t long_age = rte_get_tsc_hz() * 10;
+	struct rte_mbuf *bufs[num_bufs], *drained[num_bufs];
+	uint32_t skipped;
+	int ret = 0;
+	unsigned i, cnt;
+
+	b = rte_reorder_create("test_drain_timeout", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, num_bufs);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	for (i = 0; i < num_bufs; i++)
+		bufs[i]->seqn = i;
+
+	/* OB[] = {0, 1, NULL, 3, 4, NULL, NULL, NULL} */
+	rte_reorder_insert(b, bufs[0]);
+	rte_reorder_insert(b, bufs[1]);
+	rte_reorder_insert(b, bufs[3]);
+	rte_reorder_insert(b, bufs[4]);
+
+	/* the gap is recent: only 0 and 1 are drained */
+	cnt = rte_reorder_drain_timeout(b, drained, num_bufs, long_age,
+			&skipped);
+	if (cnt != 2 || skipped != 0 || drained[1]->seqn != 1) {
+		printf("%s:%d: %u packets drained, %u skipped\n",
+				__func__, __LINE__, cnt, skipped);
+		ret = -1;
+		goto exit;
+	}
+
+	/* no waiting allowed: 2 is skipped */
+	cnt = rte_reorder_drain_timeout(b, drained, num_bufs, 0, &skipped);
+	if (cnt != 2 || skipped != 1 || drained[0]->seqn != 3 ||
+			drained[1]->seqn != 4) {
+		printf("%s:%d: %u packets drained, %u skipped\n",
+				__func__, __LINE__, cnt, skipped);
+		ret = -1;
+		goto exit;
+	}
+
+	/* 2 is now late, 5 is inserted twice */
+	ret = rte_reorder_insert(b, bufs[2]);
+	TEST_ASSERT((ret == -1) && (rte_errno == ERANGE),
+			"No error inserting skipped packet");
+	rte_reorder_insert(b, bufs[5]);
+	rte_reorder_insert(b, bufs[5]);
+
+	/* 6 is missing: skipped once it waited long enough */
+	rte_reorder_insert(b, bufs[7]);
+	cnt = rte_reorder_drain_timeout(b, drained, num_bufs,
+			rte_get_tsc_hz() / 100, &skipped);
+	if (cnt != 1 || skipped != 0 || drained[0]->seqn != 5) {
+		printf("%s:%d: %u packets drained, %u skipped\n",
+				__func__, __LINE__, cnt, skipped);
+		ret = -1;
+		goto exit;
+	}
+	rte_delay_ms(20);
+	cnt = rte_reorder_drain_timeout(b, drained, num_bufs,
+			rte_get_tsc_hz() / 100, &skipped);
+	if (cnt != 1 || skipped != 1 || drained[0]->seqn != 7) {
+		printf("%s:%d: %u packets drained, %u skipped\n",
+				__func__, __LINE__, cnt, skipped);
+		ret = -1;
+		goto exit;
+	}
+
+	rte_reorder_stats_read(b, &stats, 1);
+#ifdef RTE_REORDER_STATS_COLLECT
+	if (stats.late_pkts != 1 || stats.dup_pkts != 1 ||
+			stats.early_pkts != 0 || stats.skipped_seqn != 2) {
+#else
+	if (stats.late_pkts != 0 || stats.dup_pkts != 0 ||
+			stats.early_pkts != 0 || stats.skipped_seqn != 0) {
+#endif
+		printf("%s:%d: unexpected stats: %"PRIu64" late, %"PRIu64
+				" early, %"PRIu64" duplicate, %"PRIu64
+				" skipped\n", __func__, __LINE__,
+				stats.late_pkts, stats.early_pkts,
+				stats.dup_pkts, stats.skipped_seqn);
+		ret = -1;
+		goto exit;
+	}
+	rte_reorder_stats_read(b, &stats, 0);
+	TEST_ASSERT(stats.late_pkts == 0 && stats.dup_pkts == 0 &&
+			stats.skipped_seqn == 0, "Stats not cleared");
+
+	ret = 0;
+exit:
+	rte_mempool_put_bulk(p, (void *)bufs, num_bufs);
+	rte_reorder_free(b);
+	return ret;
+}
+
+static int
+test_reorder_ms_create(void)
+{
+	struct rte_reorder_ms_buffer *b = NULL, *b2;
+
+	b = rte_reorder_ms_create(NULL, rte_socket_id(), 4, 8);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on create() with NULL name");
+
+	b = rte_reorder_ms_create("PKT_MS", rte_socket_id(), 4, 6);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on create() with invalid window param.");
+
+	b = rte_reorder_ms_create("PKT_MS", rte_socket_id(), 4,
+			2 * RTE_REORDER_MS_MAX_WINDOW);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on create() with too large window param.");
+
+	b = rte_reorder_ms_create("PKT_MS", rte_socket_id(), 0, 8);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on create() with no stream.");
+
+	b = rte_reorder_ms_create("PKT_MS", rte_socket_id(), 4, 8);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	b2 = rte_reorder_ms_create("PKT_MS", rte_socket_id(), 4, 8);
+	TEST_ASSERT((b2 == NULL) && (rte_errno == EEXIST),
+			"New reorder instance created with already existing name");
+
+	rte_reorder_ms_free(b);
+
+	return 0;
+}
+
+/* checks that the drained packets are those of the given streams and
+ * sequence numbers, in the order of each stream */
+static int
+check_ms_drained(struct rte_mbuf **drained, unsigned cnt,
+		const unsigned *streams, const uint32_t *seqns, unsigned num)
+{
+	unsigned i, j, last;
+
+	if (cnt != num) {
+		printf("%s:%d: %u packets drained, expected %u\n",
+				__func__, __LINE__, cnt, num);
+		return -1;
+	}
+	for (i = 0; i < num; i++) {
+		/* no packet of the stream with a lower sequence number can
+		 * follow it */
+		for (j = 0; j < cnt; j++)
+			if (drained[j]->udata64 == streams[i] &&
+					drained[j]->seqn == seqns[i])
+				break;
+		if (j == cnt) {
+			printf("%s:%d: packet %u of stream %u not drained\n",
+					__func__, __LINE__, seqns[i],
+					streams[i]);
+			return -1;
+		}
+		for (last = j; last < cnt; last++)
+			if (drained[last]->udata64 == streams[i] &&
+					drained[last]->seqn < seqns[i]) {
+				printf("%s:%d: packet %u of stream %u drained "
+						"out of order\n", __func__,
+						__LINE__, seqns[i], streams[i]);
+				return -1;
+			}
+	}
+	return 0;
+}
+
+static int
+test_reorder_ms_drain(void)
+{
+	struct rte_reorder_ms_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int window = 4, nb_streams = 3;
+	const unsigned int num_bufs = 12;
+	struct rte_mbuf *bufs[num_bufs], *drained[num_bufs];
+	int ret = 0;
+	unsigned i, cnt, cnt2;
+
+	b = rte_reorder_ms_create("test_ms_drain", rte_socket_id(),
+			nb_streams, window);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, num_bufs);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	/* packets i, i + 3, i + 6, i + 9 are in stream i, seqn 10 to 13 */
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i]->udata64 = i % nb_streams;
+		bufs[i]->seqn = 10 + i / nb_streams;
+	}
+
+	/* Check no drained packets if reorder is empty */
+	cnt = rte_reorder_ms_drain(b, drained, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d: drained packets from empty reorder buffer\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/* stream 0: 10, 11, 12
+	 * stream 1: 10, 12, 13, missing 11 */
+	rte_reorder_ms_insert(b, 0, bufs[0]);
+	rte_reorder_ms_insert(b, 1, bufs[1]);
+	rte_reorder_ms_insert(b, 0, bufs[6]);
+	rte_reorder_ms_insert(b, 1, bufs[7]);
+	rte_reorder_ms_insert(b, 1, bufs[10]);
+	rte_reorder_ms_insert(b, 0, bufs[3]);
+
+	/* the missing packet of stream 1 does not block stream 0, and the
+	 * drain can be split */
+	cnt = rte_reorder_ms_drain(b, drained, 2);
+	cnt2 = rte_reorder_ms_drain(b, &drained[cnt], num_bufs - cnt);
+	{
+		const unsigned streams[] = { 0, 0, 0, 1 };
+		const uint32_t seqns[] = { 10, 11, 12, 10 };
+
+		if (cnt != 2 || check_ms_drained(drained, cnt + cnt2,
+				streams, seqns, RTE_DIM(seqns)) < 0) {
+			ret = -1;
+			goto exit;
+		}
+	}
+
+	/* the missing packet of stream 1 arrives */
+	rte_reorder_ms_insert(b, 1, bufs[4]);
+	cnt = rte_reorder_ms_drain(b, drained, num_bufs);
+	{
+		const unsigned streams[] = { 1, 1, 1 };
+		const uint32_t seqns[] = { 11, 12, 13 };
+
+		if (check_ms_drained(drained, cnt, streams, seqns,
+				RTE_DIM(seqns)) < 0) {
+			ret = -1;
+			goto exit;
+		}
+	}
+
+	/* stream 2: 10, then 12 and 15, moving the window past 11 */
+	rte_reorder_ms_insert(b, 2, bufs[2]);
+	rte_reorder_ms_insert(b, 2, bufs[8]);
+	bufs[11]->seqn = 10 + window + 1;
+	ret = rte_reorder_ms_insert(b, 2, bufs[11]);
+	TEST_ASSERT_SUCCESS(ret, "Failed to insert packet moving the window");
+	cnt = rte_reorder_ms_drain(b, drained, num_bufs);
+	{
+		const unsigned streams[] = { 2, 2 };
+		const uint32_t seqns[] = { 10, 12 };
+
+		if (check_ms_drained(drained, cnt, streams, seqns,
+				RTE_DIM(seqns)) < 0) {
+			ret = -1;
+			goto exit;
+		}
+	}
+
+	/* out of range packet, invalid stream */
+	bufs[5]->seqn = 100;
+	ret = rte_reorder_ms_insert(b, 2, bufs[5]);
+	TEST_ASSERT((ret == -1) && (rte_errno == ERANGE),
+			"No error on insert of out of range packet");
+	ret = rte_reorder_ms_insert(b, nb_streams, bufs[5]);
+	TEST_ASSERT((ret == -1) && (rte_errno == EINVAL),
+			"No error on insert in invalid stream");
+
+	/* fill the gap of stream 2 */
+	bufs[5]->seqn = 13;
+	rte_reorder_ms_insert(b, 2, bufs[5]);
+	bufs[9]->udata64 = 2;
+	bufs[9]->seqn = 14;
+	rte_reorder_ms_insert(b, 2, bufs[9]);
+	cnt = rte_reorder_ms_drain(b, drained, num_bufs);
+	{
+		const unsigned streams[] = { 2, 2, 2 };
+		const uint32_t seqns[] = { 13, 14, 15 };
+
+		if (check_ms_drained(drained, cnt, streams, seqns,
+				RTE_DIM(seqns)) < 0) {
+			ret = -1;
+			goto exit;
+		}
+	}
+
+	ret = 0;
+exit:
+	rte_mempool_put_bulk(p, (void *)bufs, num_bufs);
+	rte_reorder_ms_free(b);
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -372,6 +670,9 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_drain_timeout),
+		TEST_CASE(test_reorder_ms_create),
+		TEST_CASE(test_reorder_ms_drain),
 		TEST_CASES_END()
 	}
 };
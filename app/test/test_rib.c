@@ -0,0 +1,291 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ip.h>
+#include <rte_rib.h>
+
+#include "test.h"
+
+#define MAX_NODES	(1 << 10)
+
+static int
+test_rib_create_invalid(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_conf config;
+
+	config.ext_sz = 0;
+	config.max_nodes = MAX_NODES;
+
+	rib = rte_rib_create(NULL, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib == NULL, "Call succeeded with invalid name\n");
+
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, NULL);
+	TEST_ASSERT(rib == NULL, "Call succeeded with NULL config\n");
+
+	config.max_nodes = 0;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib == NULL, "Call succeeded with 0 nodes\n");
+
+	config.max_nodes = MAX_NODES;
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+	TEST_ASSERT(rte_rib_create(__func__, SOCKET_ID_ANY, &config) == NULL &&
+			rte_errno == EEXIST, "Created RIB with a used name\n");
+	TEST_ASSERT(rte_rib_find_existing(__func__) == rib,
+			"Failed to find RIB\n");
+	rte_rib_free(rib);
+	TEST_ASSERT(rte_rib_find_existing(__func__) == NULL,
+			"Found freed RIB\n");
+
+	rte_rib_free(NULL);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rib_insert_invalid(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_node *node;
+	struct rte_rib_conf config;
+	uint32_t ip = IPv4(10, 0, 0, 0);
+
+	config.ext_sz = 0;
+	config.max_nodes = 2;
+
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	node = rte_rib_insert(NULL, ip, 8);
+	TEST_ASSERT(node == NULL, "Call succeeded with invalid parameters\n");
+	node = rte_rib_insert(rib, ip, RTE_RIB_MAXDEPTH + 1);
+	TEST_ASSERT(node == NULL, "Call succeeded with invalid depth\n");
+
+	node = rte_rib_insert(rib, ip, 8);
+	TEST_ASSERT(node != NULL, "Failed to insert route\n");
+	node = rte_rib_insert(rib, ip, 8);
+	TEST_ASSERT(node == NULL && rte_errno == EEXIST,
+			"Inserted a route twice\n");
+
+	/* Two branches need a third, intermediate, node. */
+	node = rte_rib_insert(rib, IPv4(11, 0, 0, 0), 8);
+	TEST_ASSERT(node == NULL && rte_errno == ENOSPC,
+			"Inserted a route without enough nodes\n");
+
+	/* A covered route does not need an intermediate node. */
+	node = rte_rib_insert(rib, ip, 16);
+	TEST_ASSERT(node != NULL, "Failed to insert route\n");
+
+	rte_rib_free(rib);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rib_lookup(void)
+{
+	struct rte_rib *rib;
+	struct rte_rib_node *node;
+	struct rte_rib_conf config;
+	uint32_t ip = IPv4(10, 1, 1, 1), ip_ret;
+	uint64_t nh;
+	uint8_t depth, depth_ret;
+	int *ext;
+
+	config.ext_sz = sizeof(int);
+	config.max_nodes = MAX_NODES;
+
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	TEST_ASSERT(rte_rib_lookup(rib, ip) == NULL, "Lookup in empty RIB\n");
+
+	/* Insert the same prefix with increasing depths. */
+	for (depth = 0; depth <= RTE_RIB_MAXDEPTH; depth++) {
+		node = rte_rib_insert(rib, ip, depth);
+		TEST_ASSERT(node != NULL, "Failed to insert /%u\n", depth);
+		TEST_ASSERT_SUCCESS(rte_rib_set_nh(node, depth),
+				"Failed to set next hop\n");
+		ext = rte_rib_get_ext(node);
+		*ext = -depth;
+	}
+
+	/* Remove them from the most specific one, checking each lookup. */
+	for (depth = RTE_RIB_MAXDEPTH; ; depth--) {
+		node = rte_rib_lookup(rib, ip);
+		TEST_ASSERT(node != NULL, "Lookup failed\n");
+		rte_rib_get_nh(node, &nh);
+		rte_rib_get_ip(node, &ip_ret);
+		rte_rib_get_depth(node, &depth_ret);
+		ext = rte_rib_get_ext(node);
+		TEST_ASSERT(nh == depth && depth_ret == depth &&
+				ip_ret == (ip & rte_rib_depth_to_mask(depth)) &&
+				*ext == -depth,
+				"Wrong route for /%u\n", depth);
+
+		node = rte_rib_lookup_exact(rib, ip, depth);
+		TEST_ASSERT(node != NULL, "Exact lookup failed\n");
+		if (depth > 0) {
+			node = rte_rib_lookup_parent(node);
+			rte_rib_get_depth(node, &depth_ret);
+			TEST_ASSERT(depth_ret == depth - 1,
+					"Wrong parent for /%u\n", depth);
+		} else
+			TEST_ASSERT(rte_rib_lookup_parent(node) == NULL,
+					"Default route has a parent\n");
+
+		rte_rib_remove(rib, ip, depth);
+		TEST_ASSERT(rte_rib_lookup_exact(rib, ip, depth) == NULL,
+				"Route /%u not removed\n", depth);
+		if (depth == 0)
+			break;
+	}
+
+	TEST_ASSERT(rte_rib_lookup(rib, ip) == NULL, "Lookup in empty RIB\n");
+
+	rte_rib_free(rib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Routes split in two branches, checked in the order they are walked:
+ * increasing addresses, and covered routes before the route covering them.
+ */
+static int
+test_rib_get_nxt(void)
+{
+	static const struct {
+		uint32_t ip;
+		uint8_t depth;
+	} routes[] = {
+		{ IPv4(10, 0, 0, 0), 24 },
+		{ IPv4(10, 0, 1, 0), 24 },
+		{ IPv4(10, 0, 0, 0), 23 },
+		{ IPv4(10, 0, 128, 0), 24 },
+		{ IPv4(10, 0, 0, 0), 16 },
+		{ IPv4(10, 1, 0, 0), 16 },
+		{ IPv4(10, 0, 0, 0), 8 },
+		{ IPv4(11, 0, 0, 0), 8 },
+	};
+	static const unsigned cover[] = { 4, 5 };
+	struct rte_rib *rib;
+	struct rte_rib_node *node;
+	struct rte_rib_conf config;
+	uint32_t ip_ret;
+	uint8_t depth_ret;
+	unsigned i;
+
+	config.ext_sz = 0;
+	config.max_nodes = MAX_NODES;
+
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	for (i = RTE_DIM(routes); i != 0; i--)
+		TEST_ASSERT(rte_rib_insert(rib, routes[i - 1].ip,
+				routes[i - 1].depth) != NULL,
+				"Failed to insert route\n");
+
+	/* All the routes strictly inside 10.0.0.0/8 */
+	node = NULL;
+	for (i = 0; i < RTE_DIM(routes) - 2; i++) {
+		node = rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+				RTE_RIB_GET_NXT_ALL);
+		TEST_ASSERT(node != NULL, "Missing route %u\n", i);
+		rte_rib_get_ip(node, &ip_ret);
+		rte_rib_get_depth(node, &depth_ret);
+		TEST_ASSERT(ip_ret == routes[i].ip &&
+				depth_ret == routes[i].depth,
+				"Wrong route %u\n", i);
+	}
+	TEST_ASSERT(rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+			RTE_RIB_GET_NXT_ALL) == NULL, "Too many routes\n");
+
+	/* Only the routes not covered by another one */
+	node = NULL;
+	for (i = 0; i < RTE_DIM(cover); i++) {
+		node = rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+				RTE_RIB_GET_NXT_COVER);
+		TEST_ASSERT(node != NULL, "Missing route %u\n", i);
+		rte_rib_get_ip(node, &ip_ret);
+		rte_rib_get_depth(node, &depth_ret);
+		TEST_ASSERT(ip_ret == routes[cover[i]].ip &&
+				depth_ret == routes[cover[i]].depth,
+				"Wrong covering route %u\n", i);
+	}
+	TEST_ASSERT(rte_rib_get_nxt(rib, IPv4(10, 0, 0, 0), 8, node,
+			RTE_RIB_GET_NXT_COVER) == NULL, "Too many routes\n");
+
+	/* Nothing inside a /24 without more specific routes */
+	TEST_ASSERT(rte_rib_get_nxt(rib, IPv4(10, 0, 1, 0), 24, NULL,
+			RTE_RIB_GET_NXT_ALL) == NULL, "Route inside /24\n");
+	TEST_ASSERT(rte_rib_get_nxt(rib, IPv4(12, 0, 0, 0), 8, NULL,
+			RTE_RIB_GET_NXT_ALL) == NULL, "Route inside 12/8\n");
+
+	rte_rib_free(rib);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite rib_tests = {
+	.suite_name = "rib autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_rib_create_invalid),
+		TEST_CASE(test_rib_insert_invalid),
+		TEST_CASE(test_rib_lookup),
+		TEST_CASE(test_rib_get_nxt),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_rib(void)
+{
+	return unit_test_suite_runner(&rib_tests);
+}
+
+static struct test_command rib_cmd = {
+	.command = "rib_autotest",
+	.callback = test_rib,
+};
+REGISTER_TEST_COMMAND(rib_cmd);
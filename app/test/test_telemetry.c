@@ -0,0 +1,243 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_telemetry.h>
+#ifdef RTE_LIBRTE_METRICS
+#include <rte_metrics.h>
+#endif
+
+#include "test.h"
+
+#define TELEMETRY_TEST_PATH "/tmp/test_telemetry"
+#define TELEMETRY_TEST_MAX_REPLY 4096
+
+static int
+telemetry_connect(void)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s",
+			TELEMETRY_TEST_PATH);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/* Send a request and read its reply, without the end of line */
+static int
+telemetry_query(int fd, const char *req, char *reply, size_t size)
+{
+	size_t len = 0;
+	ssize_t ret;
+
+	/* the server may close the connection before reading everything */
+	if (send(fd, req, strlen(req), MSG_NOSIGNAL) != (ssize_t)strlen(req) ||
+			send(fd, "\n", 1, MSG_NOSIGNAL) != 1)
+		return -1;
+
+	while (len == 0 || reply[len - 1] != '\n') {
+		if (len == size)
+			return -1;
+		ret = read(fd, reply + len, size - len);
+		if (ret <= 0)
+			return -1;
+		len += ret;
+	}
+	reply[len - 1] = '\0';
+	return 0;
+}
+
+static int
+test_telemetry_init(void)
+{
+	TEST_ASSERT_EQUAL(rte_telemetry_uninit(), -ENOENT,
+			"No error on uninit before init");
+	TEST_ASSERT_SUCCESS(rte_telemetry_init(TELEMETRY_TEST_PATH),
+			"Init failed");
+	TEST_ASSERT_EQUAL(rte_telemetry_init(TELEMETRY_TEST_PATH), -EEXIST,
+			"No error on second init");
+	TEST_ASSERT_SUCCESS(rte_telemetry_uninit(), "Uninit failed");
+	TEST_ASSERT(access(TELEMETRY_TEST_PATH, F_OK) != 0,
+			"Socket not removed on uninit");
+	TEST_ASSERT(telemetry_connect() < 0, "Connected after uninit");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_telemetry_queries(void)
+{
+	char reply[TELEMETRY_TEST_MAX_REPLY];
+	char long_req[512];
+	struct rte_mempool *mp;
+	struct rte_ring *r;
+	void *obj;
+	int fd, fd2;
+
+	mp = rte_mempool_lookup("TELEMETRY_POOL");
+	if (mp == NULL)
+		mp = rte_mempool_create("TELEMETRY_POOL", 63, 64, 0, 0,
+				NULL, NULL, NULL, NULL, rte_socket_id(), 0);
+	r = rte_ring_lookup("TELEMETRY_RING");
+	if (r == NULL)
+		r = rte_ring_create("TELEMETRY_RING", 64, rte_socket_id(), 0);
+	TEST_ASSERT(mp != NULL && r != NULL, "Cannot create mempool and ring");
+	while (rte_ring_dequeue(r, &obj) == 0)
+		;
+	TEST_ASSERT_SUCCESS(rte_mempool_get(mp, &obj), "Cannot get object");
+	TEST_ASSERT_SUCCESS(rte_ring_enqueue(r, obj), "Cannot enqueue");
+
+	TEST_ASSERT_SUCCESS(rte_telemetry_init(TELEMETRY_TEST_PATH),
+			"Init failed");
+	fd = telemetry_connect();
+	fd2 = telemetry_connect();
+	TEST_ASSERT(fd >= 0 && fd2 >= 0, "Cannot connect");
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/help", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT(strncmp(reply, "{\"/help\":[\"/help\",", 18) == 0,
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd2, "/ethdev/list", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT(strncmp(reply, "{\"/ethdev/list\":[", 17) == 0,
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/ethdev/stats,255", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT_SUCCESS(strcmp(reply, "{\"error\":\"invalid port\"}"),
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/mempool/info,TELEMETRY_POOL",
+			reply, sizeof(reply)), "No reply");
+	TEST_ASSERT(strstr(reply, "\"size\":63,") != NULL &&
+			strstr(reply, "\"in_use\":1}") != NULL,
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/mempool/list", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT(strstr(reply, "\"TELEMETRY_POOL\"") != NULL,
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/ring/info,TELEMETRY_RING\r",
+			reply, sizeof(reply)), "No reply");
+	TEST_ASSERT_SUCCESS(strcmp(reply, "{\"/ring/info\":{\"size\":64,"
+			"\"count\":1,\"free\":62,\"watermark\":64}}"),
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/ring/list", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT(strstr(reply, "\"TELEMETRY_RING\"") != NULL,
+			"Wrong reply: %s", reply);
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/ring/info,NO_RING", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT_SUCCESS(strcmp(reply, "{\"error\":\"unknown ring\"}"),
+			"Wrong reply: %s", reply);
+
+#ifdef RTE_LIBRTE_METRICS
+	if (rte_metrics_init(rte_socket_id()) == 0) {
+		int key = rte_metrics_reg_name("telemetry_metric");
+
+		TEST_ASSERT_SUCCESS(rte_metrics_update_value(
+				RTE_METRICS_GLOBAL, key, 1234),
+				"Cannot update metric");
+		TEST_ASSERT_SUCCESS(telemetry_query(fd, "/metrics,global",
+				reply, sizeof(reply)), "No reply");
+		rte_metrics_uninit();
+		TEST_ASSERT_SUCCESS(strcmp(reply, "{\"/metrics\":"
+				"{\"telemetry_metric\":1234}}"),
+				"Wrong reply: %s", reply);
+	}
+#endif
+
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, "/unknown", reply,
+			sizeof(reply)), "No reply");
+	TEST_ASSERT_SUCCESS(strcmp(reply, "{\"error\":\"unknown command\"}"),
+			"Wrong reply: %s", reply);
+
+	/* a request longer than the limit closes the connection */
+	memset(long_req, 'a', sizeof(long_req) - 1);
+	long_req[sizeof(long_req) - 1] = '\0';
+	TEST_ASSERT(telemetry_query(fd2, long_req, reply, sizeof(reply)) < 0,
+			"Reply to a too long request");
+
+	close(fd);
+	close(fd2);
+	TEST_ASSERT_SUCCESS(rte_telemetry_uninit(), "Uninit failed");
+
+	rte_ring_dequeue(r, &obj);
+	rte_mempool_put(mp, obj);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite telemetry_test_suite  = {
+	.suite_name = "Telemetry Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_telemetry_init),
+		TEST_CASE(test_telemetry_queries),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_telemetry(void)
+{
+	return unit_test_suite_runner(&telemetry_test_suite);
+}
+
+static struct test_command telemetry_cmd = {
+	.command = "telemetry_autotest",
+	.callback = test_telemetry,
+};
+REGISTER_TEST_COMMAND(telemetry_cmd);
@@ -73,6 +73,48 @@
  *    - Again we check that the expected number of callbacks has occurred when
  *      we call timer-manage.
  *
+ * #. Wheel test.
+ *
+ *    This test checks the timing wheel backend, then runs the stress test 2
+ *    with it.
+ *
+ *    - The wheel is set up with a tick of one cycle, so that timers
+ *      expiring within 3 seconds span all its levels and the overflow list.
+ *    - A set of timers is reset at random times, then a third of them is
+ *      stopped and another third reset again.
+ *    - The master lcore calls rte_timer_manage() for 3 seconds and checks
+ *      that each timer still pending has its callback called exactly once,
+ *      not before its expiry time and at most 10 ms after it.
+ *    - After the wheel has been empty for 100 ms, a timer is reset, and
+ *      the first rte_timer_manage() must not take more than 1 ms.
+ *
+ * #. Timer data test.
+ *
+ *    This test checks that the timers of independent timer data instances
+ *    are only run by the rte_timer_alt_manage() of their instance.
+ *
+ *    - Two instances are allocated, one with the skiplist backend, and one
+ *      with the wheel backend.
+ *    - A timer is reset in each instance and in the default one, all
+ *      expiring at the same time.
+ *    - After their expiry, the lists are managed one at a time, checking
+ *      that only the timer of the instance managed has been called.
+ *    - Freeing an instance with a pending timer, or an invalid instance,
+ *      must fail.
+ *
+ * #. Remote request test.
+ *
+ *    This test checks the timers reset and stopped on another lcore through
+ *    its request ring.
+ *
+ *    - A timer data instance is allocated, with request rings smaller than
+ *      the number of timers, so that some updates take the lock instead.
+ *    - A slave lcore calls rte_timer_alt_manage() in a loop, while the
+ *      master lcore resets a set of timers on it, then stops a third of
+ *      them and resets another third.
+ *    - Once all the timers expired, it checks that each timer still pending
+ *      had its callback called exactly once, on the slave lcore.
+ *
  * #. Basic test.
  *
  *    This test performs basic functional checks of the timers. The test
@@ -120,6 +162,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <sys/queue.h>
 #include <math.h>
 
@@ -523,6 +566,351 @@ timer_basic_main_loop(__attribute__((unused)) void *arg)
 	return 0;
 }
 
+#define NB_WHEEL_TIMERS 4096
+
+struct wheel_timer {
+	struct rte_timer tim;
+	uint64_t expire;
+	unsigned count;
+};
+
+static volatile int wheel_failed;
+
+/* callback for the wheel test, on master lcore */
+static void
+timer_wheel_cb(struct rte_timer *tim __rte_unused, void *arg)
+{
+	struct wheel_timer *wt = arg;
+	uint64_t cur_time = rte_get_timer_cycles();
+
+	wt->count++;
+	if (cur_time < wt->expire ||
+			cur_time - wt->expire > rte_get_timer_hz() / 100) {
+		printf("- timer expiring at %"PRIu64" called at %"PRIu64"\n",
+			wt->expire, cur_time);
+		wheel_failed = 1;
+	}
+}
+
+static int
+timer_wheel_check(void)
+{
+	unsigned i, lcore_id = rte_lcore_id();
+	uint64_t delay, start, end, hz = rte_get_timer_hz();
+	struct wheel_timer *wt;
+	int ret;
+
+	wt = rte_zmalloc(NULL, sizeof(*wt) * NB_WHEEL_TIMERS, 0);
+	if (wt == NULL) {
+		printf("- Cannot allocate memory for timers\n");
+		return -1;
+	}
+
+	ret = rte_timer_subsystem_set_backend(RTE_TIMER_WHEEL, 1);
+	if (ret != 0) {
+		printf("- Cannot select the wheel backend: %d\n", ret);
+		rte_free(wt);
+		return -1;
+	}
+
+	wheel_failed = 0;
+	for (i = 0; i != NB_WHEEL_TIMERS; i++) {
+		rte_timer_init(&wt[i].tim);
+		delay = rte_rand() % (hz * 3);
+		wt[i].expire = rte_get_timer_cycles() + delay;
+		rte_timer_reset(&wt[i].tim, delay, SINGLE, lcore_id,
+			timer_wheel_cb, wt + i);
+	}
+
+	/* stop a third of the timers, reset another third */
+	for (i = 0; i != NB_WHEEL_TIMERS; i++) {
+		if (i % 3 == 0)
+			rte_timer_stop(&wt[i].tim);
+		else if (i % 3 == 1) {
+			delay = rte_rand() % (hz * 3);
+			wt[i].expire = rte_get_timer_cycles() + delay;
+			rte_timer_reset(&wt[i].tim, delay, SINGLE, lcore_id,
+				timer_wheel_cb, wt + i);
+		}
+	}
+
+	end = rte_get_timer_cycles() + hz * 3 + hz / 10;
+	while (rte_get_timer_cycles() < end) {
+		rte_timer_manage();
+		rte_delay_us(3);
+	}
+
+	for (i = 0; i != NB_WHEEL_TIMERS; i++) {
+		if (wt[i].count != (i % 3 != 0) ||
+				rte_timer_pending(&wt[i].tim)) {
+			printf("- timer %u called %u times\n", i,
+				wt[i].count);
+			wheel_failed = 1;
+		}
+	}
+
+	/* after the wheel was empty for a while, a new timer does not make
+	 * rte_timer_manage() walk the idle ticks */
+	rte_delay_ms(100);
+	wt[0].count = 0;
+	wt[0].expire = rte_get_timer_cycles() + hz / 100;
+	rte_timer_reset(&wt[0].tim, hz / 100, SINGLE, lcore_id,
+		timer_wheel_cb, wt);
+	start = rte_get_timer_cycles();
+	rte_timer_manage();
+	if (rte_get_timer_cycles() - start > hz / 1000) {
+		printf("- rte_timer_manage() took %"PRIu64" cycles after "
+			"the wheel was idle\n", rte_get_timer_cycles() - start);
+		wheel_failed = 1;
+	}
+	end = rte_get_timer_cycles() + hz / 10;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_manage();
+	if (wt[0].count != 1) {
+		printf("- timer called %u times after the wheel was idle\n",
+			wt[0].count);
+		wheel_failed = 1;
+	}
+
+	rte_free(wt);
+	ret = rte_timer_subsystem_set_backend(RTE_TIMER_SKIPLIST, 0);
+	if (ret != 0) {
+		printf("- Cannot select the skiplist backend: %d\n", ret);
+		return -1;
+	}
+
+	return wheel_failed ? -1 : 0;
+}
+
+#define NB_TIMER_DATA 3
+
+static unsigned timer_data_count[NB_TIMER_DATA];
+
+/* callback for the timer data test, counts the calls per instance */
+static void
+timer_data_cb(struct rte_timer *tim __rte_unused, void *arg)
+{
+	timer_data_count[(uintptr_t)arg]++;
+}
+
+/* check that the counts of calls per instance are the expected ones */
+static int
+timer_data_expect(unsigned c0, unsigned c1, unsigned c2)
+{
+	if (timer_data_count[0] != c0 || timer_data_count[1] != c1 ||
+			timer_data_count[2] != c2) {
+		printf("- timers called %u %u %u times, expected %u %u %u\n",
+			timer_data_count[0], timer_data_count[1],
+			timer_data_count[2], c0, c1, c2);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+timer_data_check(void)
+{
+	struct rte_timer tim[NB_TIMER_DATA];
+	uint32_t id[NB_TIMER_DATA];
+	unsigned i, lcore_id = rte_lcore_id();
+	uint64_t delay = rte_get_timer_hz() / 100;
+	int ret = -1;
+
+	id[0] = 0;
+	if (rte_timer_data_alloc(&id[1]) != 0) {
+		printf("- Cannot allocate timer data\n");
+		return -1;
+	}
+	if (rte_timer_data_alloc(&id[2]) != 0) {
+		printf("- Cannot allocate timer data\n");
+		rte_timer_data_dealloc(id[1]);
+		return -1;
+	}
+	if (id[1] == 0 || id[1] == id[2] ||
+			rte_timer_data_set_backend(id[2], RTE_TIMER_WHEEL,
+				0) != 0) {
+		printf("- Invalid timer data %u %u\n", id[1], id[2]);
+		goto out;
+	}
+
+	memset(timer_data_count, 0, sizeof(timer_data_count));
+	for (i = 0; i != NB_TIMER_DATA; i++) {
+		rte_timer_init(&tim[i]);
+		if (rte_timer_alt_reset(id[i], &tim[i], delay, SINGLE,
+				lcore_id, timer_data_cb,
+				(void *)(uintptr_t)i) != 0) {
+			printf("- Cannot reset timer %u\n", i);
+			goto out;
+		}
+	}
+
+	if (rte_timer_data_dealloc(id[1]) != -EBUSY ||
+			rte_timer_data_dealloc(0) != -EINVAL ||
+			rte_timer_alt_manage(RTE_TIMER_MAX_DATA) != -EINVAL) {
+		printf("- Invalid timer data not detected\n");
+		goto out;
+	}
+
+	/* wait for the 10 ms delay to elapse */
+	rte_delay_ms(20);
+
+	rte_timer_alt_manage(id[1]);
+	if (timer_data_expect(0, 1, 0) < 0)
+		goto out;
+	rte_timer_manage();
+	if (timer_data_expect(1, 1, 0) < 0)
+		goto out;
+	rte_timer_alt_manage(id[2]);
+	if (timer_data_expect(1, 1, 1) < 0)
+		goto out;
+
+	ret = 0;
+out:
+	for (i = 0; i != NB_TIMER_DATA; i++)
+		rte_timer_alt_stop(id[i], &tim[i]);
+	rte_timer_data_dealloc(id[1]);
+	rte_timer_data_dealloc(id[2]);
+	return ret;
+}
+
+#define NB_REMOTE_TIMERS 1024
+#define REMOTE_RING_SIZE 256
+
+struct remote_timer {
+	struct rte_timer tim;
+	unsigned count;
+	unsigned expected;
+};
+
+static uint32_t remote_id;
+static unsigned remote_lcore;
+static volatile int remote_done;
+
+/* callback for the remote test, on the slave lcore */
+static void
+timer_remote_cb(struct rte_timer *tim __rte_unused, void *arg)
+{
+	struct remote_timer *rt = arg;
+
+	rt->count++;
+	if (rte_lcore_id() != remote_lcore) {
+		printf("- timer called on lcore %u\n", rte_lcore_id());
+		test_failed = 1;
+	}
+}
+
+static int
+timer_remote_main_loop(__attribute__((unused)) void *arg)
+{
+	while (remote_done == 0) {
+		rte_timer_alt_manage(remote_id);
+		rte_delay_us(3);
+	}
+	return 0;
+}
+
+/* reset or stop a timer on the slave lcore, retrying while a previous
+ * request of the timer is not applied yet */
+static int
+timer_remote_update(struct remote_timer *rt, int stop)
+{
+	uint64_t delay = rte_get_timer_hz() / 10 +
+		rte_rand() % (rte_get_timer_hz() / 10);
+	int ret;
+
+	do {
+		if (stop)
+			ret = rte_timer_alt_stop(remote_id, &rt->tim);
+		else
+			ret = rte_timer_alt_reset(remote_id, &rt->tim, delay,
+				SINGLE, remote_lcore, timer_remote_cb, rt);
+		rte_pause();
+	} while (ret != 0 && rt->tim.status.state == RTE_TIMER_CONFIG);
+
+	return ret;
+}
+
+static int
+timer_remote_check(void)
+{
+	struct remote_timer *rt;
+	unsigned i;
+	uint64_t end;
+	int ret = -1;
+
+	rt = rte_zmalloc(NULL, sizeof(*rt) * NB_REMOTE_TIMERS, 0);
+	if (rt == NULL) {
+		printf("- Cannot allocate memory for timers\n");
+		return -1;
+	}
+	if (rte_timer_data_alloc(&remote_id) != 0) {
+		printf("- Cannot allocate timer data\n");
+		rte_free(rt);
+		return -1;
+	}
+	if (rte_timer_data_set_remote(remote_id, REMOTE_RING_SIZE - 1) !=
+			-EINVAL ||
+			rte_timer_data_set_remote(remote_id,
+				REMOTE_RING_SIZE) != 0) {
+		printf("- Cannot set the request rings\n");
+		goto out;
+	}
+
+	test_failed = 0;
+	remote_done = 0;
+	remote_lcore = rte_get_next_lcore(rte_lcore_id(), 0, 1);
+	rte_eal_remote_launch(timer_remote_main_loop, NULL, remote_lcore);
+
+	for (i = 0; i != NB_REMOTE_TIMERS; i++) {
+		rte_timer_init(&rt[i].tim);
+		if (timer_remote_update(&rt[i], 0) != 0) {
+			printf("- Cannot reset timer %u\n", i);
+			test_failed = 1;
+		}
+		rt[i].expected = 1;
+	}
+
+	/* stop a third of the timers, reset another third: a timer that
+	 * could be updated is not running, and its count is the final one,
+	 * plus one if it was reset */
+	for (i = 0; i != NB_REMOTE_TIMERS; i++) {
+		if (i % 3 == 0 && timer_remote_update(&rt[i], 1) == 0) {
+			rt[i].expected = rt[i].count;
+			/* stops are not posted, the timer can be freed */
+			if (rt[i].tim.status.state != RTE_TIMER_STOP) {
+				printf("- timer %u not stopped\n", i);
+				test_failed = 1;
+			}
+		} else if (i % 3 == 1 && timer_remote_update(&rt[i], 0) == 0)
+			rt[i].expected = rt[i].count + 1;
+	}
+
+	end = rte_get_timer_cycles() + rte_get_timer_hz() / 2;
+	while (rte_get_timer_cycles() < end)
+		rte_delay_us(100);
+	remote_done = 1;
+	rte_eal_wait_lcore(remote_lcore);
+
+	for (i = 0; i != NB_REMOTE_TIMERS; i++) {
+		if (rt[i].count != rt[i].expected ||
+				rte_timer_pending(&rt[i].tim)) {
+			printf("- timer %u called %u times, expected %u\n",
+				i, rt[i].count, rt[i].expected);
+			test_failed = 1;
+		}
+	}
+
+	if (rte_timer_data_set_remote(remote_id, 0) != 0) {
+		printf("- Cannot free the request rings\n");
+		goto out;
+	}
+	ret = test_failed ? -1 : 0;
+out:
+	rte_timer_data_dealloc(remote_id);
+	rte_free(rt);
+	return ret;
+}
+
 static int
 timer_sanity_check(void)
 {
@@ -606,6 +994,38 @@ test_timer(void)
 	if (test_failed)
 		return TEST_FAILED;
 
+	/* check the timing wheel, and run the stress tests 2 with it */
+	printf("\nStart timer wheel tests\n");
+	if (timer_wheel_check() < 0) {
+		printf("Test Failed\n");
+		return TEST_FAILED;
+	}
+	printf("Test OK\n");
+
+	if (rte_timer_subsystem_set_backend(RTE_TIMER_WHEEL, 0) != 0)
+		return TEST_FAILED;
+	rte_eal_mp_remote_launch(timer_stress2_main_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (rte_timer_subsystem_set_backend(RTE_TIMER_SKIPLIST, 0) != 0 ||
+			test_failed)
+		return TEST_FAILED;
+
+	/* check independent timer data instances */
+	printf("\nStart timer data tests\n");
+	if (timer_data_check() < 0) {
+		printf("Test Failed\n");
+		return TEST_FAILED;
+	}
+	printf("Test OK\n");
+
+	/* check the requests posted to another lcore */
+	printf("\nStart timer remote request tests\n");
+	if (timer_remote_check() < 0) {
+		printf("Test Failed\n");
+		return TEST_FAILED;
+	}
+	printf("Test OK\n");
+
 	/* calculate the "end of test" time */
 	cur_time = rte_get_timer_cycles();
 	hz = rte_get_timer_hz();
@@ -45,6 +45,9 @@
 
 #define MAX_ITERATIONS 1000000
 
+/* number of timers of the backend benchmark */
+#define NB_BENCH_TIMERS 10000000
+
 int outstanding_count = 0;
 
 static void
@@ -61,6 +64,70 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+/*
+ * Reset NB_BENCH_TIMERS timers to expire within DELAY_SECONDS, reset them
+ * all again while they are pending, and run them, with the given backend.
+ */
+static int
+test_timer_perf_backend(enum rte_timer_backend backend, const char *name)
+{
+	unsigned i;
+	int ret;
+	struct rte_timer *tms;
+	uint64_t start_tsc, end_tsc, delay_start;
+	unsigned lcore_id = rte_lcore_id();
+	const uint64_t ticks = rte_get_timer_hz() * DELAY_SECONDS;
+
+	tms = rte_malloc(NULL, sizeof(*tms) * NB_BENCH_TIMERS, 0);
+	if (tms == NULL) {
+		printf("Cannot allocate %u timers\n", NB_BENCH_TIMERS);
+		return -1;
+	}
+
+	ret = rte_timer_subsystem_set_backend(backend, 0);
+	if (ret != 0) {
+		printf("Cannot select %s backend: %d\n", name, ret);
+		rte_free(tms);
+		return -1;
+	}
+
+	for (i = 0; i < NB_BENCH_TIMERS; i++)
+		rte_timer_init(&tms[i]);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < NB_BENCH_TIMERS; i++)
+		rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+				timer_cb, NULL);
+	end_tsc = rte_rdtsc();
+	printf("%s: %u timers, cycles per reset of a stopped timer: %"PRIu64
+		"\n", name, NB_BENCH_TIMERS,
+		(end_tsc - start_tsc) / NB_BENCH_TIMERS);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < NB_BENCH_TIMERS; i++)
+		rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+				timer_cb, NULL);
+	end_tsc = rte_rdtsc();
+	printf("%s: %u timers, cycles per reset of a pending timer: %"PRIu64
+		"\n", name, NB_BENCH_TIMERS,
+		(end_tsc - start_tsc) / NB_BENCH_TIMERS);
+	outstanding_count = NB_BENCH_TIMERS;
+
+	delay_start = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() < delay_start + ticks)
+		do_delay();
+
+	start_tsc = rte_rdtsc();
+	while (outstanding_count)
+		rte_timer_manage();
+	end_tsc = rte_rdtsc();
+	printf("%s: %u timers, cycles per expiry: %"PRIu64"\n",
+		name, NB_BENCH_TIMERS, (end_tsc - start_tsc) / NB_BENCH_TIMERS);
+
+	rte_free(tms);
+	return rte_timer_subsystem_set_backend(RTE_TIMER_SKIPLIST, 0);
+}
+
 static int
 test_timer_perf(void)
 {
@@ -155,6 +222,14 @@ test_timer_perf(void)
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
 
+	rte_timer_stop(&tms[0]);
+	rte_free(tms);
+
+	printf("\n");
+	if (test_timer_perf_backend(RTE_TIMER_SKIPLIST, "skiplist") < 0 ||
+			test_timer_perf_backend(RTE_TIMER_WHEEL, "wheel") < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -256,9 +256,16 @@ static struct l3fwd_ipv6_route l3fwd_ipv6_route_array[] = {
 };
 
 #define LPM_MAX_RULES         1024
+#define LPM_NUMBER_TBL8S (1 << 8)
 #define LPM6_MAX_RULES         1024
 #define LPM6_NUMBER_TBL8S (1 << 16)
 
+struct rte_lpm_config lpm_config = {
+		.max_rules = LPM_MAX_RULES,
+		.number_tbl8s = LPM_NUMBER_TBL8S,
+		.flags = 0
+};
+
 struct rte_lpm6_config lpm6_config = {
 		.max_rules = LPM6_MAX_RULES,
 		.number_tbl8s = LPM6_NUMBER_TBL8S,
@@ -347,7 +354,8 @@ reassemble(struct rte_mbuf *m, uint8_t portid, uint32_t queue,
 	struct rte_ip_frag_death_row *dr;
 	struct rx_queue *rxq;
 	void *d_addr_bytes;
-	uint8_t next_hop, dst_port;
+	uint8_t dst_port;
+	uint32_t next_hop_ipv4, next_hop_ipv6;
 
 	rxq = &qconf->rx_queue_list[queue];
 
@@ -390,9 +398,9 @@ reassemble(struct rte_mbuf *m, uint8_t portid, uint32_t queue,
 		ip_dst = rte_be_to_cpu_32(ip_hdr->dst_addr);
 
 		/* Find destination port */
-		if (rte_lpm_lookup(rxq->lpm, ip_dst, &next_hop) == 0 &&
-				(enabled_port_mask & 1 << next_hop) != 0) {
-			dst_port = next_hop;
+		if (rte_lpm_lookup(rxq->lpm, ip_dst, &next_hop_ipv4) == 0 &&
+				(enabled_port_mask & 1 << next_hop_ipv4) != 0) {
+			dst_port = next_hop_ipv4;
 		}
 
 		eth_hdr->ether_type = rte_be_to_cpu_16(ETHER_TYPE_IPv4);
@@ -427,9 +435,10 @@ reassemble(struct rte_mbuf *m, uint8_t portid, uint32_t queue,
 		}
 
 		/* Find destination port */
-		if (rte_lpm6_lookup(rxq->lpm6, ip_hdr->dst_addr, &next_hop) == 0 &&
-				(enabled_port_mask & 1 << next_hop) != 0) {
-			dst_port = next_hop;
+		if (rte_lpm6_lookup(rxq->lpm6, ip_hdr->dst_addr,
+				&next_hop_ipv6) == 0 &&
+				(enabled_port_mask & 1 << next_hop_ipv6) != 0) {
+			dst_port = next_hop_ipv6;
 		}
 
 		eth_hdr->ether_type = rte_be_to_cpu_16(ETHER_TYPE_IPv6);
@@ -496,6 +505,14 @@ main_loop(__attribute__((unused)) void *dummy)
 					send_burst(qconf, 1, portid);
 			}
 
+			/* free the fragments of timed-out packets */
+			for (i = 0; i < qconf->n_rx_queue; ++i)
+				rte_ip_frag_table_expire(
+					qconf->rx_queue_list[i].frag_tbl,
+					cur_tsc, &qconf->death_row);
+			rte_ip_frag_free_death_row(&qconf->death_row,
+				PREFETCH_OFFSET);
+
 			prev_tsc = cur_tsc;
 		}
 
@@ -945,7 +962,7 @@ init_mem(void)
 			RTE_LOG(INFO, IP_RSMBL, "Creating LPM table on socket %i\n", socket);
 			snprintf(buf, sizeof(buf), "IP_RSMBL_LPM_%i", socket);
 
-			lpm = rte_lpm_create(buf, socket, LPM_MAX_RULES, 0);
+			lpm = rte_lpm_create(buf, socket, &lpm_config);
 			if (lpm == NULL) {
 				RTE_LOG(ERR, IP_RSMBL, "Cannot create LPM table\n");
 				return -1;
@@ -471,6 +471,7 @@ static struct ipv6_l3fwd_route ipv6_l3fwd_route_array[] = {
 	(sizeof(ipv6_l3fwd_route_array) / sizeof(ipv6_l3fwd_route_array[0]))
 
 #define IPV4_L3FWD_LPM_MAX_RULES         1024
+#define IPV4_L3FWD_LPM_NUMBER_TBL8S (1 << 8)
 #define IPV6_L3FWD_LPM_MAX_RULES         1024
 #define IPV6_L3FWD_LPM_NUMBER_TBL8S (1 << 16)
 
@@ -710,7 +711,7 @@ get_ipv6_dst_port(void *ipv6_hdr,  uint8_t portid, lookup_struct_t * ipv6_l3fwd_
 static inline uint8_t
 get_ipv4_dst_port(void *ipv4_hdr,  uint8_t portid, lookup_struct_t * ipv4_l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 
 	return (uint8_t) ((rte_lpm_lookup(ipv4_l3fwd_lookup_struct,
 		rte_be_to_cpu_32(((struct ipv4_hdr *)ipv4_hdr)->dst_addr),
@@ -720,7 +721,7 @@ get_ipv4_dst_port(void *ipv4_hdr,  uint8_t portid, lookup_struct_t * ipv4_l3fwd_
 static inline uint8_t
 get_ipv6_dst_port(void *ipv6_hdr,  uint8_t portid, lookup6_struct_t * ipv6_l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 	return (uint8_t) ((rte_lpm6_lookup(ipv6_l3fwd_lookup_struct,
 			((struct ipv6_hdr*)ipv6_hdr)->dst_addr, &next_hop) == 0)?
 			next_hop : portid);
@@ -1182,48 +1183,41 @@ static inline __attribute__((always_inline)) uint16_t
 get_dst_port(const struct lcore_conf *qconf, struct rte_mbuf *pkt,
 	uint32_t dst_ipv4, uint8_t portid)
 {
-	uint8_t next_hop;
+	uint32_t next_hop_ipv4;
+	uint32_t next_hop_ipv6;
 	struct ipv6_hdr *ipv6_hdr;
 	struct ether_hdr *eth_hdr;
 
 	if (RTE_ETH_IS_IPV4_HDR(pkt->packet_type)) {
 		if (rte_lpm_lookup(qconf->ipv4_lookup_struct, dst_ipv4,
-				&next_hop) != 0)
-			next_hop = portid;
+				&next_hop_ipv4) != 0)
+			next_hop_ipv4 = portid;
+		return next_hop_ipv4;
 	} else if (RTE_ETH_IS_IPV6_HDR(pkt->packet_type)) {
 		eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
 		ipv6_hdr = (struct ipv6_hdr *)(eth_hdr + 1);
 		if (rte_lpm6_lookup(qconf->ipv6_lookup_struct,
-				ipv6_hdr->dst_addr, &next_hop) != 0)
-			next_hop = portid;
-	} else {
-		next_hop = portid;
+				ipv6_hdr->dst_addr, &next_hop_ipv6) != 0)
+			next_hop_ipv6 = portid;
+		return next_hop_ipv6;
 	}
 
-	return next_hop;
+	return portid;
 }
 
 static inline void
-process_packet(struct lcore_conf *qconf, struct rte_mbuf *pkt,
-	uint16_t *dst_port, uint8_t portid)
+process_packet(struct rte_mbuf *pkt, uint16_t *dst_port)
 {
 	struct ether_hdr *eth_hdr;
 	struct ipv4_hdr *ipv4_hdr;
-	uint32_t dst_ipv4;
-	uint16_t dp;
 	__m128i te, ve;
 
 	eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
 	ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
 
-	dst_ipv4 = ipv4_hdr->dst_addr;
-	dst_ipv4 = rte_be_to_cpu_32(dst_ipv4);
-	dp = get_dst_port(qconf, pkt, dst_ipv4, portid);
-
 	te = _mm_load_si128((__m128i *)eth_hdr);
-	ve = val_eth[dp];
+	ve = val_eth[dst_port[0]];
 
-	dst_port[0] = dp;
 	rfc1812_process(ipv4_hdr, dst_port, pkt->packet_type);
 
 	te =  _mm_blend_epi16(te, ve, MASK_ETH);
@@ -1231,68 +1225,42 @@ process_packet(struct lcore_conf *qconf, struct rte_mbuf *pkt,
 }
 
 /*
- * Read packet_type and destination IPV4 addresses from 4 mbufs.
- */
-static inline void
-processx4_step1(struct rte_mbuf *pkt[FWDSTEP],
-		__m128i *dip,
-		uint32_t *ipv4_flag)
-{
-	struct ipv4_hdr *ipv4_hdr;
-	struct ether_hdr *eth_hdr;
-	uint32_t x0, x1, x2, x3;
-
-	eth_hdr = rte_pktmbuf_mtod(pkt[0], struct ether_hdr *);
-	ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
-	x0 = ipv4_hdr->dst_addr;
-	ipv4_flag[0] = pkt[0]->packet_type & RTE_PTYPE_L3_IPV4;
-
-	eth_hdr = rte_pktmbuf_mtod(pkt[1], struct ether_hdr *);
-	ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
-	x1 = ipv4_hdr->dst_addr;
-	ipv4_flag[0] &= pkt[1]->packet_type;
-
-	eth_hdr = rte_pktmbuf_mtod(pkt[2], struct ether_hdr *);
-	ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
-	x2 = ipv4_hdr->dst_addr;
-	ipv4_flag[0] &= pkt[2]->packet_type;
-
-	eth_hdr = rte_pktmbuf_mtod(pkt[3], struct ether_hdr *);
-	ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
-	x3 = ipv4_hdr->dst_addr;
-	ipv4_flag[0] &= pkt[3]->packet_type;
-
-	dip[0] = _mm_set_epi32(x3, x2, x1, x0);
-}
-
-/*
- * Lookup into LPM for destination port.
+ * Lookup destination ports for the whole burst: destination IPV4 addresses
+ * are looked up with one call into LPM, using the widest method available.
  * If lookup fails, use incoming port (portid) as destination port.
  */
 static inline void
-processx4_step2(const struct lcore_conf *qconf,
-		__m128i dip,
-		uint32_t ipv4_flag,
+process_burst_lookup(const struct lcore_conf *qconf,
+		struct rte_mbuf *pkt[],
+		uint32_t num,
 		uint8_t portid,
-		struct rte_mbuf *pkt[FWDSTEP],
-		uint16_t dprt[FWDSTEP])
+		uint16_t dprt[])
 {
-	rte_xmm_t dst;
-	const  __m128i bswap_mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
-						4, 5, 6, 7, 0, 1, 2, 3);
+	struct ipv4_hdr *ipv4_hdr;
+	struct ether_hdr *eth_hdr;
+	uint32_t i, ipv4_flag;
+	uint32_t dip[MAX_PKT_BURST];
+	uint32_t hop[MAX_PKT_BURST];
+
+	ipv4_flag = RTE_PTYPE_L3_IPV4;
+	for (i = 0; i != num; i++) {
+		eth_hdr = rte_pktmbuf_mtod(pkt[i], struct ether_hdr *);
+		ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
+		dip[i] = rte_be_to_cpu_32(ipv4_hdr->dst_addr);
+		ipv4_flag &= pkt[i]->packet_type;
+	}
 
-	/* Byte swap 4 IPV4 addresses. */
-	dip = _mm_shuffle_epi8(dip, bswap_mask);
+	rte_lpm_lookup_burst(qconf->ipv4_lookup_struct, dip, hop, num, portid);
 
-	/* if all 4 packets are IPV4. */
+	/* if all packets are IPV4. */
 	if (likely(ipv4_flag)) {
-		rte_lpm_lookupx4(qconf->ipv4_lookup_struct, dip, dprt, portid);
+		for (i = 0; i != num; i++)
+			dprt[i] = hop[i];
 	} else {
-		dst.x = dip;
-		dprt[0] = get_dst_port(qconf, pkt[0], dst.u32[0], portid);
-		dprt[1] = get_dst_port(qconf, pkt[1], dst.u32[1], portid);
-		dprt[2] = get_dst_port(qconf, pkt[2], dst.u32[2], portid);
-		dprt[3] = get_dst_port(qconf, pkt[3], dst.u32[3], portid);
+		for (i = 0; i != num; i++)
+			dprt[i] = RTE_ETH_IS_IPV4_HDR(pkt[i]->packet_type) ?
+				hop[i] :
+				get_dst_port(qconf, pkt[i], dip[i], portid);
 	}
 }
 
@@ -1528,8 +1496,6 @@ main_loop(__attribute__((unused)) void *dummy)
 	uint16_t dlp;
 	uint16_t *lp;
 	uint16_t dst_port[MAX_PKT_BURST];
-	__m128i dip[MAX_PKT_BURST / FWDSTEP];
-	uint32_t ipv4_flag[MAX_PKT_BURST / FWDSTEP];
 	uint16_t pnum[MAX_PKT_BURST + 1];
 #endif
 
@@ -1641,19 +1607,8 @@ main_loop(__attribute__((unused)) void *dummy)
 			}
 #elif (APP_LOOKUP_METHOD == APP_LOOKUP_LPM)
 
-			k = RTE_ALIGN_FLOOR(nb_rx, FWDSTEP);
-			for (j = 0; j != k; j += FWDSTEP) {
-				processx4_step1(&pkts_burst[j],
-					&dip[j / FWDSTEP],
-					&ipv4_flag[j / FWDSTEP]);
-			}
-
-			k = RTE_ALIGN_FLOOR(nb_rx, FWDSTEP);
-			for (j = 0; j != k; j += FWDSTEP) {
-				processx4_step2(qconf, dip[j / FWDSTEP],
-					ipv4_flag[j / FWDSTEP], portid,
-					&pkts_burst[j], &dst_port[j]);
-			}
+			process_burst_lookup(qconf, pkts_burst, nb_rx, portid,
+				dst_port);
 
 			/*
 			 * Finish packet processing and group consecutive
@@ -1715,18 +1670,15 @@ main_loop(__attribute__((unused)) void *dummy)
 			/* Process up to last 3 packets one by one. */
 			switch (nb_rx % FWDSTEP) {
 			case 3:
-				process_packet(qconf, pkts_burst[j],
-					dst_port + j, portid);
+				process_packet(pkts_burst[j], dst_port + j);
 				GROUP_PORT_STEP(dlp, dst_port, lp, pnum, j);
 				j++;
 			case 2:
-				process_packet(qconf, pkts_burst[j],
-					dst_port + j, portid);
+				process_packet(pkts_burst[j], dst_port + j);
 				GROUP_PORT_STEP(dlp, dst_port, lp, pnum, j);
 				j++;
 			case 1:
-				process_packet(qconf, pkts_burst[j],
-					dst_port + j, portid);
+				process_packet(pkts_burst[j], dst_port + j);
 				GROUP_PORT_STEP(dlp, dst_port, lp, pnum, j);
 				j++;
 			}
@@ -2382,14 +2334,18 @@ static void
 setup_lpm(int socketid)
 {
 	struct rte_lpm6_config config;
+	struct rte_lpm_config config_ipv4;
 	unsigned i;
 	int ret;
 	char s[64];
 
 	/* create the LPM table */
+	config_ipv4.max_rules = IPV4_L3FWD_LPM_MAX_RULES;
+	config_ipv4.number_tbl8s = IPV4_L3FWD_LPM_NUMBER_TBL8S;
+	config_ipv4.flags = 0;
 	snprintf(s, sizeof(s), "IPV4_L3FWD_LPM_%d", socketid);
 	ipv4_l3fwd_lookup_struct[socketid] = rte_lpm_create(s, socketid,
-				IPV4_L3FWD_LPM_MAX_RULES, 0);
+				&config_ipv4);
 	if (ipv4_l3fwd_lookup_struct[socketid] == NULL)
 		rte_exit(EXIT_FAILURE, "Unable to create the l3fwd LPM table"
 				" on socket %d\n", socketid);
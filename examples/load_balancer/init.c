@@ -152,6 +152,12 @@ app_init_lpm_tables(void)
 	unsigned socket, lcore;
 
 	/* Init the LPM tables */
+	struct rte_lpm_config lpm_config;
+
+	lpm_config.max_rules = APP_MAX_LPM_RULES;
+	lpm_config.number_tbl8s = APP_LPM_NUMBER_TBL8S;
+	lpm_config.flags = 0;
+
 	for (socket = 0; socket < APP_MAX_SOCKETS; socket ++) {
 		char name[32];
 		uint32_t rule;
@@ -165,8 +171,7 @@ app_init_lpm_tables(void)
 		app.lpm_tables[socket] = rte_lpm_create(
 			name,
 			socket,
-			APP_MAX_LPM_RULES,
-			0);
+			&lpm_config);
 		if (app.lpm_tables[socket] == NULL) {
 			rte_panic("Unable to create LPM table on socket %u\n", socket);
 		}
@@ -165,10 +165,6 @@ enum {
 	RTE_ACL_UNUSED_TRIE = 0x80000000
 };
 
-
-/** MAX number of tries per one ACL context.*/
-#define RTE_ACL_MAX_TRIES	8
-
 /** Max number of characters in PM name.*/
 #define RTE_ACL_NAMESIZE	32
 
@@ -206,11 +202,22 @@ struct rte_acl_ctx {
 	void               *mem;
 	size_t              mem_sz;
 	struct rte_acl_config config; /* copy of build config. */
+	struct rte_acl_build_report report; /* stats of the last build. */
 };
 
 int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size);
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t num_threads);
+
+typedef void (*acl_job_t)(void *arg, uint32_t n);
+
+/*
+ * Run job(arg, n) for each n in [0, num) on up to num_threads threads,
+ * the calling one included. Returns when all the jobs are completed.
+ */
+void acl_run_jobs(acl_job_t job, void *arg, uint32_t num,
+	uint32_t num_threads);
 
 typedef int (*rte_acl_classify_t)
 (const struct rte_acl_ctx *, const uint8_t **, uint32_t *, uint32_t, uint32_t);
@@ -230,6 +237,10 @@ int
 rte_acl_classify_avx2(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories);
 
+int
+rte_acl_classify_avx512(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -31,7 +31,10 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
+
 #include <rte_acl.h>
+#include <rte_atomic.h>
 #include "tb_mem.h"
 #include "acl.h"
 
@@ -45,6 +48,9 @@
 #define NODE_MAX	0x4000
 #define NODE_MIN	0x800
 
+/* number of builds bisecting the node limit, once the tries fit max_size */
+#define NODE_REFINE	2
+
 /* TALLY are statistics per field */
 enum {
 	TALLY_0 = 0,        /* number of rules that are 0% or more wild. */
@@ -106,6 +112,7 @@ struct acl_build_context {
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  num_threads;
 	struct tb_mem_pool        pool;
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
@@ -114,6 +121,24 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* contexts the tries were rebuilt with, when not this one. */
+	struct acl_build_context  *trie_bcx[RTE_ACL_MAX_TRIES];
+};
+
+/* Rebuild of the tries for the split rule sets. */
+struct acl_rebuild {
+	struct acl_build_context  *context;
+	struct rte_acl_build_rule **rule_sets;
+	int32_t                   rc[RTE_ACL_MAX_TRIES];
+};
+
+/* Jobs shared by the build threads. */
+struct acl_jobs {
+	acl_job_t     job;
+	void         *arg;
+	uint32_t      num;
+	rte_atomic32_t next;
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1242,6 +1267,137 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+static void *
+acl_jobs_run(void *arg)
+{
+	uint32_t n;
+	struct acl_jobs *jobs;
+
+	jobs = arg;
+	for (n = rte_atomic32_add_return(&jobs->next, 1) - 1; n < jobs->num;
+			n = rte_atomic32_add_return(&jobs->next, 1) - 1)
+		jobs->job(jobs->arg, n);
+
+	return NULL;
+}
+
+void
+acl_run_jobs(acl_job_t job, void *arg, uint32_t num, uint32_t num_threads)
+{
+	uint32_t i, n;
+	struct acl_jobs jobs;
+	pthread_t tid[RTE_ACL_MAX_TRIES];
+
+	jobs.job = job;
+	jobs.arg = arg;
+	jobs.num = num;
+	rte_atomic32_init(&jobs.next);
+
+	num_threads = RTE_MIN(num_threads, num);
+	num_threads = RTE_MIN(num_threads, RTE_DIM(tid) + 1);
+
+	/* if a thread can't be created, the others do its share. */
+	n = 0;
+	for (i = 1; i < num_threads; i++) {
+		if (pthread_create(&tid[n], NULL, acl_jobs_run, &jobs) == 0)
+			n++;
+	}
+
+	acl_jobs_run(&jobs);
+
+	for (i = 0; i != n; i++)
+		pthread_join(tid[i], NULL);
+}
+
+static void
+acl_build_init(struct acl_build_context *bcx, const struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t node_max)
+{
+	memset(bcx, 0, sizeof(*bcx));
+	bcx->acx = ctx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	bcx->cfg = *cfg;
+	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
+		typeof(bcx->category_mask));
+	bcx->node_max = node_max;
+	bcx->num_threads = RTE_MAX(cfg->num_threads, 1U);
+}
+
+static void
+acl_rebuild_trie(void *arg, uint32_t n)
+{
+	int32_t rc;
+	struct acl_rebuild *rb;
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *last;
+
+	rb = arg;
+	bcx = rb->context->trie_bcx[n];
+
+	/* private context: its pool fails back to this thread. */
+	if (bcx != rb->context) {
+		rc = sigsetjmp(bcx->pool.fail, 0);
+		if (rc != 0) {
+			rb->rc[n] = rc;
+			return;
+		}
+	}
+
+	last = build_one_trie(bcx, rb->rule_sets, n, INT32_MAX);
+	if (bcx->bld_tries[n].trie == NULL || last != NULL) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		rb->rc[n] = -ENOMEM;
+	} else
+		rb->rc[n] = 0;
+}
+
+/*
+ * Rebuild the first num tries with their rule sets,
+ * each one with a private context when there is more than one thread.
+ */
+static int
+acl_rebuild_tries(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t num)
+{
+	uint32_t n;
+	struct acl_rebuild rb;
+	struct acl_build_context *bcx;
+
+	rb.context = context;
+	rb.rule_sets = rule_sets;
+
+	for (n = 0; n != num; n++) {
+		if (context->num_threads > 1) {
+			bcx = acl_build_alloc(context, 1, sizeof(*bcx));
+			acl_build_init(bcx, context->acx, &context->cfg,
+				INT32_MAX);
+		} else
+			bcx = context;
+		context->trie_bcx[n] = bcx;
+	}
+
+	acl_run_jobs(acl_rebuild_trie, &rb, num, context->num_threads);
+
+	for (n = 0; n != num; n++) {
+		if (rb.rc[n] != 0)
+			return rb.rc[n];
+
+		bcx = context->trie_bcx[n];
+		if (bcx != context) {
+			context->tries[n] = bcx->tries[n];
+			context->bld_tries[n] = bcx->bld_tries[n];
+			memcpy(context->data_indexes[n], bcx->data_indexes[n],
+				sizeof(context->data_indexes[n]));
+			context->tries[n].data_index =
+				context->data_indexes[n];
+			context->num_nodes += bcx->num_nodes;
+		}
+	}
+
+	return 0;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
@@ -1291,6 +1447,7 @@ acl_build_tries(struct acl_build_context *context,
 		rule_sets[num_tries] = last->next;
 		last->next = NULL;
 		acl_free_node(context, context->bld_tries[n].trie);
+		context->bld_tries[n].trie = NULL;
 
 		/* Create a new copy of config for remaining rules. */
 		config = acl_build_alloc(context, 1, sizeof(*config));
@@ -1300,21 +1457,15 @@ acl_build_tries(struct acl_build_context *context,
 		for (head = rule_sets[num_tries]; head != NULL;
 				head = head->next)
 			head->config = config;
-
-		/*
-		 * Rebuild the trie for the reduced rule-set.
-		 * Don't try to split it any further.
-		 */
-		last = build_one_trie(context, rule_sets, n, INT32_MAX);
-		if (context->bld_tries[n].trie == NULL || last != NULL) {
-			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
-			return -ENOMEM;
-		}
-
 	}
 
 	context->num_tries = num_tries;
-	return 0;
+
+	/*
+	 * Rebuild the tries for the reduced rule-sets.
+	 * They don't depend on each other, so do it in parallel.
+	 */
+	return acl_rebuild_tries(context, rule_sets, num_tries - 1);
 }
 
 static void
@@ -1411,14 +1562,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	int32_t rc;
 
 	/* setup build context. */
-	memset(bcx, 0, sizeof(*bcx));
-	bcx->acx = ctx;
-	bcx->pool.alignment = ACL_POOL_ALIGN;
-	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
-	bcx->cfg = *cfg;
-	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
-		typeof(bcx->category_mask));
-	bcx->node_max = node_max;
+	acl_build_init(bcx, ctx, cfg, node_max);
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1445,6 +1589,22 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	return rc;
 }
 
+/*
+ * Release the memory of the build context and of the private contexts
+ * the tries were rebuilt with.
+ */
+static void
+acl_build_free_pools(struct acl_build_context *bcx)
+{
+	uint32_t n;
+
+	for (n = 0; n != RTE_DIM(bcx->trie_bcx); n++) {
+		if (bcx->trie_bcx[n] != NULL && bcx->trie_bcx[n] != bcx)
+			tb_free_pool(&bcx->trie_bcx[n]->pool);
+	}
+	tb_free_pool(&bcx->pool);
+}
+
 /*
  * Check that parameters for acl_build() are valid.
  */
@@ -1488,13 +1648,55 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	return 0;
 }
 
+/*
+ * Build the tries splitting the rules with the given node limit,
+ * and generate the run-time structures if they fit in max_size.
+ * On failure, the run-time structures of the context are not changed.
+ */
+static int
+acl_build_gen(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	uint32_t node_max, size_t max_size)
+{
+	int32_t rc;
+	struct acl_build_context bcx;
+
+	ctx->report.node_max = node_max;
+	ctx->report.max_size = cfg->max_size;
+	ctx->report.num_builds++;
+
+	/* perform build phase. */
+	rc = acl_bld(&bcx, ctx, cfg, node_max);
+
+	if (rc == 0) {
+		/* allocate and fill run-time  structures. */
+		rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
+			bcx.num_tries, bcx.cfg.num_categories,
+			RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
+			sizeof(ctx->data_indexes[0]), max_size,
+			bcx.num_threads);
+		if (rc == 0) {
+			/* set data indexes. */
+			acl_set_data_indexes(ctx);
+
+			/* copy in build config. */
+			ctx->config = *cfg;
+		}
+	}
+
+	acl_build_log(&bcx);
+
+	/* cleanup after build. */
+	acl_build_free_pools(&bcx);
+	return rc;
+}
+
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	int32_t rc;
-	uint32_t n;
-	size_t max_size;
-	struct acl_build_context bcx;
+	uint32_t i, n, hi;
+	void *mem;
+	struct rte_acl_build_report report;
 
 	rc = acl_check_bld_param(ctx, cfg);
 	if (rc != 0)
@@ -1502,38 +1704,41 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 
 	acl_build_reset(ctx);
 
-	if (cfg->max_size == 0) {
-		n = NODE_MIN;
-		max_size = SIZE_MAX;
-	} else {
-		n = NODE_MAX;
-		max_size = cfg->max_size;
+	/* no limit, smaller tries are faster to build. */
+	if (cfg->max_size == 0)
+		return acl_build_gen(ctx, cfg, NODE_MIN, SIZE_MAX);
+
+	/*
+	 * Fewer tries are faster to classify, but bigger.
+	 * Halve the node limit until the tries fit max_size ...
+	 */
+	hi = 0;
+	for (n = NODE_MAX;; n /= 2) {
+		rc = acl_build_gen(ctx, cfg, n, cfg->max_size);
+		if (rc != -ERANGE || n / 2 < NODE_MIN)
+			break;
+		hi = n;
 	}
 
-	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
+	/*
+	 * ... then bisect between the limit that fits and the one that
+	 * doesn't, keeping the biggest tries that fit.
+	 */
+	for (i = 0; rc == 0 && hi != 0 && i != NODE_REFINE; i++) {
 
-		/* perform build phase. */
-		rc = acl_bld(&bcx, ctx, cfg, n);
+		mem = ctx->mem;
+		report = ctx->report;
 
+		rc = acl_build_gen(ctx, cfg, (n + hi) / 2, cfg->max_size);
 		if (rc == 0) {
-			/* allocate and fill run-time  structures. */
-			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
-				bcx.num_tries, bcx.cfg.num_categories,
-				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
-				sizeof(ctx->data_indexes[0]), max_size);
-			if (rc == 0) {
-				/* set data indexes. */
-				acl_set_data_indexes(ctx);
-
-				/* copy in build config. */
-				ctx->config = *cfg;
-			}
+			rte_free(mem);
+			n = (n + hi) / 2;
+		} else {
+			report.num_builds = ctx->report.num_builds;
+			ctx->report = report;
+			hi = (n + hi) / 2;
+			rc = 0;
 		}
-
-		acl_build_log(&bcx);
-
-		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
 	}
 
 	return rc;
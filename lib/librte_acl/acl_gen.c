@@ -49,6 +49,7 @@ struct acl_node_counters {
 	int32_t quad_vectors;
 	int32_t dfa;
 	int32_t dfa_gr64;
+	int32_t depth;
 };
 
 struct rte_acl_indices {
@@ -59,6 +60,19 @@ struct rte_acl_indices {
 	int32_t match_start;
 };
 
+/*
+ * Per trie counters and indices: each trie gets its own part of every
+ * node area, so the tries can be counted and generated in parallel.
+ */
+struct acl_gen_tries {
+	struct rte_acl_bld_trie *node_bld_trie;
+	uint64_t *node_array;
+	uint64_t no_match;
+	uint32_t num_categories;
+	struct acl_node_counters counts[RTE_ACL_MAX_TRIES];
+	struct rte_acl_indices indices[RTE_ACL_MAX_TRIES];
+};
+
 static void
 acl_gen_log_stats(const struct rte_acl_ctx *ctx,
 	const struct acl_node_counters *counts,
@@ -247,18 +261,23 @@ acl_count_fanout(struct rte_acl_node *node)
  */
 static void
 acl_count_trie_types(struct acl_node_counters *counts,
-	struct rte_acl_node *node, uint64_t no_match, int force_dfa)
+	struct rte_acl_node *node, uint64_t no_match, int force_dfa,
+	int32_t depth)
 {
 	uint32_t n;
 	int num_ptrs;
 	uint64_t dfa[RTE_ACL_DFA_SIZE];
 
-	/* skip if this node has been counted */
+	/*
+	 * skip if this node has been counted,
+	 * all the paths to a node consume the same number of input bytes.
+	 */
 	if (node->node_type != (uint32_t)RTE_ACL_NODE_UNDEFINED)
 		return;
 
 	if (node->match_flag != 0 || node->num_ptrs == 0) {
 		counts->match++;
+		counts->depth = RTE_MAX(counts->depth, depth);
 		node->node_type = RTE_ACL_NODE_MATCH;
 		return;
 	}
@@ -298,7 +317,7 @@ acl_count_trie_types(struct acl_node_counters *counts,
 	for (n = 0; n < node->num_ptrs; n++) {
 		if (node->ptrs[n].ptr != NULL)
 			acl_count_trie_types(counts, node->ptrs[n].ptr,
-				no_match, 0);
+				no_match, 0, depth + 1);
 	}
 }
 
@@ -443,21 +462,50 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+static void
+acl_count_trie(void *arg, uint32_t n)
+{
+	struct acl_gen_tries *gt;
+
+	gt = arg;
+	memset(&gt->counts[n], 0, sizeof(gt->counts[n]));
+	acl_count_trie_types(&gt->counts[n], gt->node_bld_trie[n].trie,
+		gt->no_match, 1, 0);
+}
+
+static void
+acl_gen_trie(void *arg, uint32_t n)
+{
+	struct acl_gen_tries *gt;
+
+	gt = arg;
+	acl_gen_node(gt->node_bld_trie[n].trie, gt->node_array, gt->no_match,
+		&gt->indices[n], gt->num_categories);
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
-	struct rte_acl_indices *indices,
-	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	struct rte_acl_indices *indices, struct acl_gen_tries *gt,
+	uint32_t num_tries, uint32_t num_threads)
 {
 	uint32_t n;
+	struct rte_acl_indices *ti;
+	const struct acl_node_counters *tc;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
+	acl_run_jobs(acl_count_trie, gt, num_tries, num_threads);
+
 	for (n = 0; n < num_tries; n++) {
-		acl_count_trie_types(counts, node_bld_trie[n].trie,
-			no_match, 1);
+		tc = &gt->counts[n];
+		counts->match += tc->match;
+		counts->single += tc->single;
+		counts->quad += tc->quad;
+		counts->quad_vectors += tc->quad_vectors;
+		counts->dfa += tc->dfa;
+		counts->dfa_gr64 += tc->dfa_gr64;
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -468,6 +516,58 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 	indices->match_start = RTE_ALIGN(indices->match_start,
 		(XMM_SIZE / sizeof(uint64_t)));
 	indices->match_index = 1;
+
+	/*
+	 * Each trie starts where the previous one ends,
+	 * same layout as when generating the tries one after another.
+	 */
+	for (n = 0; n < num_tries; n++) {
+		ti = &gt->indices[n];
+		tc = &gt->counts[n];
+		*ti = *indices;
+		indices->dfa_index += tc->dfa_gr64 * RTE_ACL_DFA_GR64_SIZE;
+		indices->quad_index += tc->quad_vectors;
+		indices->single_index += tc->single;
+		indices->match_index += tc->match;
+	}
+}
+
+/*
+ * Fill the build report of the context with the node counts of each trie.
+ */
+static void
+acl_gen_report(struct rte_acl_ctx *ctx, const struct rte_acl_trie *trie,
+	const struct acl_gen_tries *gt, uint32_t num_tries, size_t total_size)
+{
+	uint32_t n;
+	struct rte_acl_trie_report *tr;
+	const struct acl_node_counters *tc;
+
+	ctx->report.num_tries = num_tries;
+	ctx->report.mem_sz = total_size;
+
+	for (n = 0; n != num_tries; n++) {
+		tr = &ctx->report.trie[n];
+		tc = &gt->counts[n];
+
+		tr->num_rules = trie[n].count;
+		tr->depth = tc->depth;
+		tr->num_dfa = tc->dfa;
+		tr->num_dfa_gr64 = tc->dfa_gr64;
+		tr->num_quad = tc->quad;
+		tr->num_quad_vectors = tc->quad_vectors;
+		tr->num_single = tc->single;
+		tr->num_match = tc->match;
+		tr->dfa_mem = tc->dfa_gr64 * RTE_ACL_DFA_GR64_SIZE *
+			sizeof(uint64_t);
+		tr->quad_mem = tc->quad_vectors * sizeof(uint64_t);
+		tr->single_mem = tc->single * sizeof(uint64_t);
+		tr->match_mem = tc->match *
+			sizeof(struct rte_acl_match_results);
+	}
+
+	for (; n != RTE_DIM(ctx->report.trie); n++)
+		memset(&ctx->report.trie[n], 0, sizeof(ctx->report.trie[n]));
 }
 
 /*
@@ -476,7 +576,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size)
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t num_threads)
 {
 	void *mem;
 	size_t total_size;
@@ -485,12 +586,17 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_match_results *match;
 	struct acl_node_counters counts;
 	struct rte_acl_indices indices;
+	struct acl_gen_tries gt;
 
 	no_match = RTE_ACL_NODE_MATCH;
 
+	gt.node_bld_trie = node_bld_trie;
+	gt.no_match = no_match;
+	gt.num_categories = num_categories;
+
 	/* Fill counts and indices arrays from the nodes. */
-	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+	acl_calc_counts_indices(&counts, &indices, &gt, num_tries,
+		num_threads);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -498,6 +604,8 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		(counts.match + 1) * sizeof(struct rte_acl_match_results) +
 		XMM_SIZE;
 
+	acl_gen_report(ctx, trie, &gt, num_tries, total_size);
+
 	if (total_size > max_size) {
 		RTE_LOG(DEBUG, ACL,
 			"Gen phase for ACL ctx \"%s\" exceeds max_size limit, "
@@ -534,11 +642,10 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	match = ((struct rte_acl_match_results *)(node_array + match_index));
 	memset(match, 0, sizeof(*match));
 
-	for (n = 0; n < num_tries; n++) {
-
-		acl_gen_node(node_bld_trie[n].trie, node_array, no_match,
-			&indices, num_categories);
+	gt.node_array = node_array;
+	acl_run_jobs(acl_gen_trie, &gt, num_tries, num_threads);
 
+	for (n = 0; n < num_tries; n++) {
 		if (node_bld_trie[n].trie->node_index == no_match)
 			trie[n].root_index = 0;
 		else
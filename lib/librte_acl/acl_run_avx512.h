@@ -0,0 +1,240 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "acl_run_sse.h"
+
+/*
+ * Same layout as the SSE/AVX2 constants, repeated in each 128-bit lane,
+ * as the byte shuffles don't cross them.
+ */
+#define	ZMM_SHUFFLE_INPUT	\
+	_mm512_set4_epi32(0x0c0c0c0c, 0x08080808, 0x04040404, 0x00000000)
+#define	ZMM_RANGE_BASE		\
+	_mm512_set4_epi32(0xffffff0c, 0xffffff08, 0xffffff04, 0xffffff00)
+
+#define	ZMM_FLOWS	(sizeof(__m512i) / sizeof(uint32_t))
+
+/*
+ * Process 16 transitions in parallel.
+ * tr_lo contains low 32 bits for 16 transitions.
+ * tr_hi contains high 32 bits for 16 transitions.
+ * next_input contains up to 4 input bytes for 16 flows.
+ * AVX512 comparisons produce masks rather than vectors, so unlike
+ * ACL_TR_CALC_ADDR(), the quad range boundaries below the input byte
+ * are counted from a compare mask, and DFA and QUAD/SINGLE offsets are
+ * blended with a mask.
+ */
+static inline __attribute__((always_inline)) __m512i
+transition16(__m512i next_input, const uint64_t *trans,
+	__m512i *tr_lo, __m512i *tr_hi)
+{
+	const int32_t *tr;
+	__m512i addr, in, node_type, r, t;
+	__m512i dfa_ofs, quad_ofs, index_mask, ones_8;
+	__mmask16 dfa_msk;
+	__mmask64 quad_msk;
+
+	tr = (const int32_t *)(uintptr_t)trans;
+	index_mask = _mm512_set1_epi32(RTE_ACL_NODE_INDEX);
+	ones_8 = _mm512_set1_epi8(1);
+
+	in = _mm512_shuffle_epi8(next_input, ZMM_SHUFFLE_INPUT);
+
+	/* Calc node type and node addr */
+	node_type = _mm512_andnot_si512(index_mask, *tr_lo);
+	addr = _mm512_and_si512(index_mask, *tr_lo);
+
+	/* mask for DFA type(0) nodes */
+	dfa_msk = _mm512_cmpeq_epi32_mask(node_type, _mm512_setzero_si512());
+
+	/* DFA calculations. */
+	r = _mm512_srli_epi32(in, 30);
+	r = _mm512_add_epi8(r, ZMM_RANGE_BASE);
+	t = _mm512_srli_epi32(in, 24);
+	r = _mm512_shuffle_epi8(*tr_hi, r);
+
+	dfa_ofs = _mm512_sub_epi32(t, r);
+
+	/* QUAD/SINGLE calculations. */
+	quad_msk = _mm512_cmpgt_epi8_mask(in, *tr_hi);
+	t = _mm512_maskz_mov_epi8(quad_msk, ones_8);
+	t = _mm512_maddubs_epi16(t, ones_8);
+	quad_ofs = _mm512_madd_epi16(t, _mm512_set1_epi16(1));
+
+	/* blend DFA and QUAD/SINGLE, calculate address for next transitions */
+	t = _mm512_mask_blend_epi32(dfa_msk, quad_ofs, dfa_ofs);
+	addr = _mm512_add_epi32(addr, t);
+
+	/* load lower 32 bits of 16 transactions at once. */
+	*tr_lo = _mm512_i32gather_epi32(addr, tr, sizeof(trans[0]));
+
+	next_input = _mm512_srli_epi32(next_input, CHAR_BIT);
+
+	/* load high 32 bits of 16 transactions at once. */
+	*tr_hi = _mm512_i32gather_epi32(addr, tr + 1, sizeof(trans[0]));
+
+	return next_input;
+}
+
+static inline __mmask16
+acl_match_mask_avx512x16(__m512i tr_lo)
+{
+	__m512i match_mask;
+
+	match_mask = _mm512_set1_epi32(RTE_ACL_NODE_MATCH);
+	return _mm512_cmpeq_epi32_mask(_mm512_and_si512(match_mask, tr_lo),
+		match_mask);
+}
+
+/*
+ * Process matches for 16 flows: only the flows at a match node
+ * are resolved and restarted with their next trie.
+ */
+static inline void
+acl_match_check_avx512x16(const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows, uint32_t slot,
+	__m512i *tr_lo, __m512i *tr_hi)
+{
+	uint32_t i;
+	uint64_t tr;
+	__mmask16 msk;
+	uint32_t lo[ZMM_FLOWS], hi[ZMM_FLOWS];
+
+	msk = acl_match_mask_avx512x16(*tr_lo);
+
+	while (msk != 0) {
+
+		_mm512_storeu_si512(lo, *tr_lo);
+		_mm512_storeu_si512(hi, *tr_hi);
+
+		do {
+			i = __builtin_ctz(msk);
+			msk &= msk - 1;
+
+			/*
+			 * Low 32bits of the transition are enough
+			 * to process the match.
+			 */
+			tr = acl_match_check(lo[i], slot + i, ctx, parms,
+				flows, resolve_priority_sse);
+			lo[i] = (uint32_t)tr;
+			hi[i] = tr >> (sizeof(uint32_t) * CHAR_BIT);
+		} while (msk != 0);
+
+		*tr_lo = _mm512_loadu_si512(lo);
+		*tr_hi = _mm512_loadu_si512(hi);
+		msk = acl_match_mask_avx512x16(*tr_lo);
+	}
+}
+
+/*
+ * Execute trie traversal for num_zmm * 16 flows in parallel.
+ */
+static inline __attribute__((always_inline)) int
+search_avx512(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories,
+	uint32_t num_zmm)
+{
+	uint32_t i, k, n;
+	uint64_t index;
+	struct acl_flow_data flows;
+	struct completion cmplt[MAX_SEARCHES_AVX32];
+	struct parms parms[MAX_SEARCHES_AVX32];
+	uint32_t lo[ZMM_FLOWS], hi[ZMM_FLOWS];
+	int32_t in[ZMM_FLOWS];
+	__m512i input[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	__m512i tr_lo[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+	__m512i tr_hi[MAX_SEARCHES_AVX32 / ZMM_FLOWS];
+
+	n = num_zmm * ZMM_FLOWS;
+
+	acl_set_flow(&flows, cmplt, n, data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (k = 0; k != num_zmm; k++) {
+		for (i = 0; i != ZMM_FLOWS; i++) {
+			cmplt[k * ZMM_FLOWS + i].count = 0;
+			index = acl_start_next_trie(&flows, parms,
+				k * ZMM_FLOWS + i, ctx);
+			lo[i] = (uint32_t)index;
+			hi[i] = index >> (sizeof(uint32_t) * CHAR_BIT);
+		}
+		tr_lo[k] = _mm512_loadu_si512(lo);
+		tr_hi[k] = _mm512_loadu_si512(hi);
+	}
+
+	 /* Check for any matches. */
+	for (k = 0; k != num_zmm; k++)
+		acl_match_check_avx512x16(ctx, parms, &flows, k * ZMM_FLOWS,
+			&tr_lo[k], &tr_hi[k]);
+
+	while (flows.started > 0) {
+
+		/* Gather 4 bytes of input data for each flow. */
+		for (k = 0; k != num_zmm; k++) {
+			for (i = 0; i != ZMM_FLOWS; i++)
+				in[i] = GET_NEXT_4BYTES(parms,
+					k * ZMM_FLOWS + i);
+			input[k] = _mm512_loadu_si512(in);
+		}
+
+		for (i = 0; i != sizeof(uint32_t); i++) {
+			for (k = 0; k != num_zmm; k++)
+				input[k] = transition16(input[k], flows.trans,
+					&tr_lo[k], &tr_hi[k]);
+		}
+
+		 /* Check for any matches. */
+		for (k = 0; k != num_zmm; k++)
+			acl_match_check_avx512x16(ctx, parms, &flows,
+				k * ZMM_FLOWS, &tr_lo[k], &tr_hi[k]);
+	}
+
+	return 0;
+}
+
+static inline int
+search_avx512x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512(ctx, data, results, total_packets, categories,
+		MAX_SEARCHES_AVX16 / ZMM_FLOWS);
+}
+
+static inline int
+search_avx512x32(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	return search_avx512(ctx, data, results, total_packets, categories,
+		MAX_SEARCHES_AVX32 / ZMM_FLOWS);
+}
@@ -55,11 +55,26 @@ rte_acl_classify_avx2(__rte_unused const struct rte_acl_ctx *ctx,
 	return -ENOTSUP;
 }
 
+/*
+ * If the compiler doesn't support AVX512 instructions,
+ * then the dummy one would be used instead for AVX512 classify method.
+ */
+int __attribute__ ((weak))
+rte_acl_classify_avx512(__rte_unused const struct rte_acl_ctx *ctx,
+	__rte_unused const uint8_t **data,
+	__rte_unused uint32_t *results,
+	__rte_unused uint32_t num,
+	__rte_unused uint32_t categories)
+{
+	return -ENOTSUP;
+}
+
 static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_DEFAULT] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SCALAR] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SSE] = rte_acl_classify_sse,
 	[RTE_ACL_CLASSIFY_AVX2] = rte_acl_classify_avx2,
+	[RTE_ACL_CLASSIFY_AVX512] = rte_acl_classify_avx512,
 };
 
 /* by default, use always available scalar code path. */
@@ -72,34 +87,72 @@ rte_acl_set_default_classify(enum rte_acl_classify_alg alg)
 	rte_acl_default_classify = alg;
 }
 
+/*
+ * Check that the given classify method can run on this CPU
+ * with this build of the library.
+ */
+static int
+acl_check_alg(enum rte_acl_classify_alg alg)
+{
+	switch (alg) {
+	case RTE_ACL_CLASSIFY_DEFAULT:
+	case RTE_ACL_CLASSIFY_SCALAR:
+		return 0;
+	case RTE_ACL_CLASSIFY_SSE:
+		return (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1) > 0) ?
+			0 : -ENOTSUP;
+	case RTE_ACL_CLASSIFY_AVX2:
+#ifdef CC_AVX2_SUPPORT
+		return (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0) ?
+			0 : -ENOTSUP;
+#else
+		return -ENOTSUP;
+#endif
+	case RTE_ACL_CLASSIFY_AVX512:
+#ifdef CC_AVX512_SUPPORT
+		return (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0) ?
+			0 : -ENOTSUP;
+#else
+		return -ENOTSUP;
+#endif
+	default:
+		return -EINVAL;
+	}
+}
+
 extern int
 rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 {
+	int rc;
+
 	if (ctx == NULL || (uint32_t)alg >= RTE_DIM(classify_fns))
 		return -EINVAL;
 
+	rc = acl_check_alg(alg);
+	if (rc != 0)
+		return rc;
+
 	ctx->alg = alg;
 	return 0;
 }
 
 /*
  * Select highest available classify method as default one.
- * Note that CLASSIFY_AVX2 should be set as a default only
- * if both conditions are met:
- * at build time compiler supports AVX2 and target cpu supports AVX2.
+ * Note that CLASSIFY_AVX2 and CLASSIFY_AVX512 should be set as a default
+ * only if both conditions are met:
+ * at build time compiler supports them and target cpu supports them.
  */
 static void __attribute__((constructor))
 rte_acl_init(void)
 {
 	enum rte_acl_classify_alg alg = RTE_ACL_CLASSIFY_DEFAULT;
 
-#ifdef CC_AVX2_SUPPORT
-	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+	if (acl_check_alg(RTE_ACL_CLASSIFY_AVX512) == 0)
+		alg = RTE_ACL_CLASSIFY_AVX512;
+	else if (acl_check_alg(RTE_ACL_CLASSIFY_AVX2) == 0)
 		alg = RTE_ACL_CLASSIFY_AVX2;
-	else if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
-#else
-	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
-#endif
+	else if (acl_check_alg(RTE_ACL_CLASSIFY_SSE) == 0)
 		alg = RTE_ACL_CLASSIFY_SSE;
 
 	rte_acl_set_default_classify(alg);
@@ -326,6 +379,263 @@ rte_acl_reset(struct rte_acl_ctx *ctx)
 	}
 }
 
+#define	ACL_SAVE_MAGIC		0x4c434152	/* "RACL" */
+#define	ACL_SAVE_VERSION	2
+
+/* Trie metadata of a saved ACL context. */
+struct acl_save_trie {
+	uint32_t type;
+	uint32_t count;
+	uint32_t root_index;
+	uint32_t data_index;      /* offset in the data indexes. */
+	uint32_t num_data_indexes;
+};
+
+/*
+ * Header of a saved ACL context, followed by its run-time memory.
+ * The fields up to num_categories describe the format of the file and
+ * must match the ones of the library loading it.
+ */
+struct acl_save_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t hdr_size;
+	uint32_t dfa_size;
+	uint32_t quad_size;
+	uint32_t max_categories;
+	uint32_t match_size;
+	uint32_t alg;
+	uint32_t num_categories;
+	uint32_t num_tries;
+	uint32_t match_index;
+	uint32_t trans_ofs;       /* offset of the transitions, in bytes. */
+	uint64_t no_match;
+	uint64_t idle;
+	uint64_t mem_sz;
+	struct acl_save_trie trie[RTE_ACL_MAX_TRIES];
+	struct rte_acl_config config;
+	struct rte_acl_build_report report;
+};
+
+static void
+acl_save_hdr_init(struct acl_save_hdr *hdr)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->magic = ACL_SAVE_MAGIC;
+	hdr->version = ACL_SAVE_VERSION;
+	hdr->hdr_size = sizeof(*hdr);
+	hdr->dfa_size = RTE_ACL_DFA_SIZE;
+	hdr->quad_size = RTE_ACL_QUAD_SIZE;
+	hdr->max_categories = RTE_ACL_MAX_CATEGORIES;
+	hdr->match_size = sizeof(struct rte_acl_match_results);
+}
+
+int
+rte_acl_save(const struct rte_acl_ctx *ctx, FILE *f)
+{
+	uint32_t i;
+	struct acl_save_hdr hdr;
+
+	if (ctx == NULL || f == NULL || ctx->mem == NULL)
+		return -EINVAL;
+
+	acl_save_hdr_init(&hdr);
+	hdr.alg = ctx->alg;
+	hdr.num_categories = ctx->num_categories;
+	hdr.num_tries = ctx->num_tries;
+	hdr.match_index = ctx->match_index;
+	hdr.trans_ofs = (uintptr_t)ctx->trans_table - (uintptr_t)ctx->mem;
+	hdr.no_match = ctx->no_match;
+	hdr.idle = ctx->idle;
+	hdr.mem_sz = ctx->mem_sz;
+	hdr.config = ctx->config;
+	hdr.report = ctx->report;
+
+	for (i = 0; i != ctx->num_tries; i++) {
+		hdr.trie[i].type = ctx->trie[i].type;
+		hdr.trie[i].count = ctx->trie[i].count;
+		hdr.trie[i].root_index = ctx->trie[i].root_index;
+		hdr.trie[i].data_index = ctx->trie[i].data_index -
+			ctx->data_indexes;
+		hdr.trie[i].num_data_indexes = ctx->trie[i].num_data_indexes;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+			fwrite(ctx->mem, ctx->mem_sz, 1, f) != 1) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, failed to write %zu "
+			"bytes\n", ctx->name, sizeof(hdr) + ctx->mem_sz);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * Check that the header read matches this library, and that the
+ * offsets it contains are within the run-time memory.
+ */
+static int
+acl_check_save_hdr(const struct rte_acl_ctx *ctx,
+	const struct acl_save_hdr *hdr)
+{
+	uint32_t i;
+	uint64_t match_ofs, num_data_indexes;
+	struct acl_save_hdr ref;
+
+	acl_save_hdr_init(&ref);
+	if (memcmp(hdr, &ref, offsetof(struct acl_save_hdr, alg)) != 0) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, invalid file header, "
+			"magic: %#x, version: %u\n",
+			ctx->name, hdr->magic, hdr->version);
+		return -EINVAL;
+	}
+
+	num_data_indexes = hdr->trans_ofs / sizeof(ctx->data_indexes[0]);
+	match_ofs = hdr->trans_ofs + (uint64_t)hdr->match_index *
+		sizeof(ctx->trans_table[0]);
+
+	if (hdr->num_categories == 0 ||
+			hdr->num_categories > RTE_ACL_MAX_CATEGORIES ||
+			hdr->num_tries == 0 ||
+			hdr->num_tries > RTE_ACL_MAX_TRIES ||
+			hdr->trans_ofs % RTE_CACHE_LINE_SIZE != 0 ||
+			(size_t)hdr->mem_sz != hdr->mem_sz ||
+			match_ofs + sizeof(struct rte_acl_match_results) >
+			hdr->mem_sz)
+		goto invalid;
+
+	for (i = 0; i != hdr->num_tries; i++) {
+		if (hdr->trie[i].num_data_indexes > RTE_ACL_MAX_FIELDS ||
+				(uint64_t)hdr->trie[i].data_index +
+				hdr->trie[i].num_data_indexes >
+				num_data_indexes)
+			goto invalid;
+	}
+
+	return 0;
+
+invalid:
+	RTE_LOG(ERR, ACL, "ACL context: %s, invalid file contents\n",
+		ctx->name);
+	return -EINVAL;
+}
+
+int
+rte_acl_load(struct rte_acl_ctx *ctx, FILE *f)
+{
+	int32_t rc;
+	uint32_t i;
+	void *mem;
+	struct acl_save_hdr hdr;
+
+	if (ctx == NULL || f == NULL)
+		return -EINVAL;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, failed to read file "
+			"header\n", ctx->name);
+		return -EIO;
+	}
+
+	rc = acl_check_save_hdr(ctx, &hdr);
+	if (rc != 0)
+		return rc;
+
+	/* the same method as on the host the context was saved on. */
+	rc = acl_check_alg(hdr.alg);
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, classify method %u "
+			"is not supported\n", ctx->name, hdr.alg);
+		return rc;
+	}
+
+	mem = rte_malloc_socket(ctx->name, hdr.mem_sz, RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (mem == NULL) {
+		RTE_LOG(ERR, ACL,
+			"allocation of %" PRIu64 " bytes on socket %d "
+			"for %s failed\n",
+			hdr.mem_sz, ctx->socket_id, ctx->name);
+		return -ENOMEM;
+	}
+
+	if (fread(mem, hdr.mem_sz, 1, f) != 1) {
+		RTE_LOG(ERR, ACL, "ACL context: %s, failed to read %" PRIu64
+			" bytes\n", ctx->name, hdr.mem_sz);
+		rte_free(mem);
+		return -EIO;
+	}
+
+	/* replace the run-time structures, the rules are left as they are. */
+	rte_free(ctx->mem);
+
+	ctx->alg = hdr.alg;
+	ctx->num_categories = hdr.num_categories;
+	ctx->num_tries = hdr.num_tries;
+	ctx->match_index = hdr.match_index;
+	ctx->no_match = hdr.no_match;
+	ctx->idle = hdr.idle;
+	ctx->mem = mem;
+	ctx->mem_sz = hdr.mem_sz;
+	ctx->data_indexes = mem;
+	ctx->trans_table = (uint64_t *)((uintptr_t)mem + hdr.trans_ofs);
+	ctx->config = hdr.config;
+	ctx->report = hdr.report;
+
+	memset(ctx->trie, 0, sizeof(ctx->trie));
+	for (i = 0; i != hdr.num_tries; i++) {
+		ctx->trie[i].type = hdr.trie[i].type;
+		ctx->trie[i].count = hdr.trie[i].count;
+		ctx->trie[i].root_index = hdr.trie[i].root_index;
+		ctx->trie[i].data_index = ctx->data_indexes +
+			hdr.trie[i].data_index;
+		ctx->trie[i].num_data_indexes = hdr.trie[i].num_data_indexes;
+	}
+
+	return 0;
+}
+
+static void
+acl_dump_report(const struct rte_acl_build_report *rep)
+{
+	uint32_t i;
+	const struct rte_acl_trie_report *tr;
+
+	if (rep->num_builds == 0)
+		return;
+
+	printf("  build: node_max=%"PRIu32", builds=%"PRIu32
+		", mem_sz=%zu, max_size=%zu\n",
+		rep->node_max, rep->num_builds, rep->mem_sz, rep->max_size);
+
+	for (i = 0; i != rep->num_tries; i++) {
+		tr = &rep->trie[i];
+		printf("  trie %"PRIu32": rules=%"PRIu32", depth=%"PRIu32
+			", dfa=%"PRIu32"/%"PRIu32"/%zu"
+			", quad=%"PRIu32"/%"PRIu32"/%zu"
+			", single=%"PRIu32"/%zu, match=%"PRIu32"/%zu\n",
+			i, tr->num_rules, tr->depth,
+			tr->num_dfa, tr->num_dfa_gr64, tr->dfa_mem,
+			tr->num_quad, tr->num_quad_vectors, tr->quad_mem,
+			tr->num_single, tr->single_mem,
+			tr->num_match, tr->match_mem);
+	}
+}
+
+int
+rte_acl_get_build_report(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_report *report)
+{
+	if (ctx == NULL || report == NULL)
+		return -EINVAL;
+
+	if (ctx->report.num_builds == 0)
+		return -ENOENT;
+
+	*report = ctx->report;
+	return 0;
+}
+
 /*
  * Dump ACL context to the stdout.
  */
@@ -342,6 +652,7 @@ rte_acl_dump(const struct rte_acl_ctx *ctx)
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
 	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
 	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	acl_dump_report(&ctx->report);
 }
 
 /*
@@ -53,6 +53,9 @@ extern "C" {
 #define RTE_ACL_MAX_LEVELS 64
 #define RTE_ACL_MAX_FIELDS 64
 
+/** MAX number of tries per one ACL context.*/
+#define RTE_ACL_MAX_TRIES	8
+
 union rte_acl_field_types {
 	uint8_t  u8;
 	uint16_t u16;
@@ -95,7 +98,15 @@ struct rte_acl_config {
 	struct rte_acl_field_def defs[RTE_ACL_MAX_FIELDS];
 	/**< array of field definitions. */
 	size_t max_size;
-	/**< max memory limit for internal run-time structures. */
+	/**<
+	 * max memory limit for internal run-time structures.
+	 * Zero means no limit: the rules are split in small tries,
+	 * which is the fastest to build.
+	 * Otherwise the rules are split in as few tries as fit the limit,
+	 * which is the fastest to classify but needs several builds.
+	 */
+	uint32_t num_threads;
+	/**< number of threads to build with, 0 means the calling one only. */
 };
 
 /**
@@ -237,6 +248,9 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 /**
  * Analyze set of rules and build required internal run-time structures.
  * This function is not multi-thread safe.
+ * When cfg->num_threads is greater than 1, the tries are built and
+ * generated on up to that many threads, the calling one included.
+ * The result does not depend on the number of threads.
  *
  * @param ctx
  *   ACL context to build.
@@ -251,6 +265,103 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Run-time structures of one trie of a built ACL context.
+ */
+struct rte_acl_trie_report {
+	uint32_t num_rules;        /**< number of rules in the trie. */
+	uint32_t depth;            /**< max transitions from root to match. */
+	uint32_t num_dfa;          /**< number of DFA nodes. */
+	uint32_t num_dfa_gr64;     /**< number of DFA 64-transition groups. */
+	uint32_t num_quad;         /**< number of quad range nodes. */
+	uint32_t num_quad_vectors; /**< number of quad range transitions. */
+	uint32_t num_single;       /**< number of single transition nodes. */
+	uint32_t num_match;        /**< number of match nodes. */
+	size_t dfa_mem;            /**< bytes used by DFA nodes. */
+	size_t quad_mem;           /**< bytes used by quad range nodes. */
+	size_t single_mem;         /**< bytes used by single nodes. */
+	size_t match_mem;          /**< bytes used by match results. */
+};
+
+/**
+ * Report of the last build of an ACL context.
+ * When rte_acl_build() fails with -ERANGE, it describes the last
+ * attempt, and mem_sz is the memory that attempt required.
+ */
+struct rte_acl_build_report {
+	uint32_t num_tries;  /**< number of tries the rules were split in. */
+	uint32_t node_max;   /**< node limit per trie used for the split. */
+	uint32_t num_builds; /**< number of builds performed. */
+	size_t mem_sz;       /**< run-time memory, in bytes. */
+	size_t max_size;     /**< memory limit of the build config. */
+	struct rte_acl_trie_report trie[RTE_ACL_MAX_TRIES];
+	/**< per trie report, the first num_tries are valid. */
+};
+
+/**
+ * Get the report of the last build of an ACL context, or of the build
+ * of the context saved with rte_acl_save() when it was loaded.
+ *
+ * @param ctx
+ *   ACL context to get the report of.
+ * @param report
+ *   Pointer to the structure to fill.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if the context was not built or loaded.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_get_build_report(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_report *report);
+
+/**
+ * Write the run-time structures of a built ACL context to a file:
+ * transitions, match results and trie metadata, with a header
+ * recording the format version and the classify method of the context.
+ * The rules of the context are not saved.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to save, rte_acl_build() or rte_acl_load() must have
+ *   completed successfully for it.
+ * @param f
+ *   File to write to, at its current position.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the context is not built.
+ *   - -EIO if the write failed.
+ *   - Zero if operation completed successfully.
+ */
+int
+rte_acl_save(const struct rte_acl_ctx *ctx, FILE *f);
+
+/**
+ * Load the run-time structures written by rte_acl_save() into an ACL
+ * context, in memory on the socket of the context, replacing the ones
+ * it was built with. The context then classifies as the saved one did,
+ * with the same classify method. The rules of the context are left
+ * unchanged.
+ * The file is validated against the format of this library,
+ * but its contents are trusted otherwise.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to load into.
+ * @param f
+ *   File to read from, at its current position.
+ * @return
+ *   - -EINVAL if the parameters or the file header are invalid.
+ *   - -ENOTSUP if the classify method of the saved context is not
+ *     supported on this CPU; rte_acl_set_ctx_classify() can select
+ *     a portable method before saving.
+ *   - -EIO if the read failed.
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - Zero if operation completed successfully; on failure,
+ *     the context is not changed.
+ */
+int
+rte_acl_load(struct rte_acl_ctx *ctx, FILE *f);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -270,6 +381,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_SCALAR = 1,  /**< generic implementation. */
 	RTE_ACL_CLASSIFY_SSE = 2,     /**< requires SSE4.1 support. */
 	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
+	RTE_ACL_CLASSIFY_AVX512 = 4,  /**< requires AVX512F/BW support. */
 	RTE_ACL_CLASSIFY_NUM          /* should always be the last one. */
 };
 
@@ -351,14 +463,16 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx,
 
 /*
  * Override the default classifier function for a given ACL context.
+ * The method is only selected when it can run on the given CPU,
+ * otherwise the context keeps classifying with its current one.
  * @param ctx
  *   ACL context to change classify function for.
  * @param alg
  *   New default classify algorithm for given ACL context.
- *   It is the caller responsibility to ensure that the value refers to the
- *   existing algorithm, and that it could be run on the given CPU.
  * @return
  *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the algorithm is not supported by the CPU, or was not
+ *     built in because the compiler doesn't support it.
  *   - Zero if operation completed successfully.
  */
 extern int
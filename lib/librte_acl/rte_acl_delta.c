@@ -0,0 +1,809 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rte_acl.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_rcu_qsbr.h>
+
+#include "rte_acl_delta.h"
+
+/* Slot states. */
+#define	ACL_DELTA_LIVE		0x1 /* rule not deleted */
+#define	ACL_DELTA_MAIN		0x2 /* rule built into the main context */
+#define	ACL_DELTA_NEXT		0x4 /* rule built into the merged context */
+#define	ACL_DELTA_SHADOW	0x8 /* main rule overlapping a deleted one */
+
+/* Number of input buffers classified through the delta context at once. */
+#define	ACL_DELTA_BURST		64
+
+/* Length of the suffix appended to the name of the contexts. */
+#define	ACL_DELTA_SUFFIX_LEN	11
+
+/*
+ * Contexts used by the classifying threads. A new view is published on
+ * each update, and the previous one is freed once the threads are done
+ * with it.
+ */
+struct acl_delta_view {
+	struct rte_acl_ctx *main;  /* NULL when empty */
+	struct rte_acl_ctx *delta; /* NULL when empty */
+	uint32_t num_delta;        /* number of rules in the delta context */
+	uint64_t deleted[0];       /* slots deleted from the main context */
+};
+
+/*
+ * Rules are kept in slots. The contexts are built with the slot index
+ * plus one as userdata, which is mapped back to the user userdata and
+ * priority of the rule when classifying.
+ */
+struct rte_acl_delta {
+	char name[RTE_ACL_NAMESIZE];
+	int32_t socket_id;
+	uint32_t rule_sz;
+	uint32_t max_rules;
+	uint32_t max_delta;
+	uint32_t gen;                /* suffix of the next context name */
+	struct rte_acl_config cfg;
+	struct rte_rcu_qsbr *v;
+	struct acl_delta_view *view;
+	rte_spinlock_t lock;         /* serializes updates and merge commit */
+	rte_atomic32_t merging;
+	uint8_t *rules;              /* rule of each slot */
+	uint32_t *userdata;          /* user userdata of each slot */
+	int32_t *priority;           /* priority of each slot */
+	uint8_t *state;              /* state of each slot */
+	uint8_t *saved;              /* states before the current update */
+	uint32_t *free_slots;
+	uint32_t num_free;
+	uint32_t *pending;           /* slots freed once the view is replaced */
+	uint32_t num_pending;
+	uint32_t *list;              /* slots of the delta context */
+	uint32_t *hash;              /* slot plus one of each live userdata */
+	uint32_t hash_mask;
+	uint32_t hash_shift;
+};
+
+static inline struct rte_acl_rule *
+acl_delta_rule(const struct rte_acl_delta *d, uint32_t slot)
+{
+	return (struct rte_acl_rule *)(d->rules + (size_t)slot * d->rule_sz);
+}
+
+static inline int
+acl_delta_deleted(const struct acl_delta_view *view, uint32_t slot)
+{
+	return (view->deleted[slot / 64] >> (slot % 64)) & 1;
+}
+
+/*
+ * Open addressing hash of the live rules by userdata,
+ * with linear probing.
+ */
+static inline uint32_t
+acl_delta_hash_idx(const struct rte_acl_delta *d, uint32_t userdata)
+{
+	return (userdata * UINT32_C(0x9e3779b1)) >> d->hash_shift;
+}
+
+/* Bucket holding a userdata, or the empty bucket to insert it into. */
+static uint32_t *
+acl_delta_hash_find(const struct rte_acl_delta *d, uint32_t userdata)
+{
+	uint32_t i, s;
+
+	for (i = acl_delta_hash_idx(d, userdata); ;
+			i = (i + 1) & d->hash_mask) {
+		s = d->hash[i];
+		if (s == 0 || d->userdata[s - 1] == userdata)
+			return d->hash + i;
+	}
+}
+
+static void
+acl_delta_hash_del(struct rte_acl_delta *d, uint32_t *bucket)
+{
+	uint32_t i, j, k, s;
+
+	i = bucket - d->hash;
+	for (j = (i + 1) & d->hash_mask; d->hash[j] != 0;
+			j = (j + 1) & d->hash_mask) {
+		s = d->hash[j];
+		k = acl_delta_hash_idx(d, d->userdata[s - 1]);
+
+		/* move the entry to the hole, unless its home is after it. */
+		if ((j > i && (k <= i || k > j)) ||
+				(j < i && k <= i && k > j)) {
+			d->hash[i] = s;
+			i = j;
+		}
+	}
+	d->hash[i] = 0;
+}
+
+static uint64_t
+acl_delta_field_value(const union rte_acl_field_types *f, uint8_t size)
+{
+	switch (size) {
+	case sizeof(uint8_t):
+		return f->u8;
+	case sizeof(uint16_t):
+		return f->u16;
+	case sizeof(uint32_t):
+		return f->u32;
+	default:
+		return f->u64;
+	}
+}
+
+/*
+ * Check whether some input matches both rules with a common category.
+ */
+static int
+acl_delta_overlap(const struct rte_acl_config *cfg,
+	const struct rte_acl_rule *a, const struct rte_acl_rule *b)
+{
+	uint32_t n;
+	uint64_t va, vb, ma, mb, msk;
+	const struct rte_acl_field_def *def;
+	const struct rte_acl_field *fa, *fb;
+
+	if ((a->data.category_mask & b->data.category_mask) == 0)
+		return 0;
+
+	for (n = 0; n != cfg->num_fields; n++) {
+		def = cfg->defs + n;
+		fa = a->field + def->field_index;
+		fb = b->field + def->field_index;
+
+		va = acl_delta_field_value(&fa->value, def->size);
+		vb = acl_delta_field_value(&fb->value, def->size);
+
+		switch (def->type) {
+		case RTE_ACL_FIELD_TYPE_RANGE:
+			ma = acl_delta_field_value(&fa->mask_range, def->size);
+			mb = acl_delta_field_value(&fb->mask_range, def->size);
+			if (va > mb || vb > ma)
+				return 0;
+			break;
+		case RTE_ACL_FIELD_TYPE_MASK:
+			msk = RTE_LEN2MASK(def->size * CHAR_BIT, uint64_t);
+			ma = RTE_ACL_MASKLEN_TO_BITMASK(
+				(uint64_t)fa->mask_range.u32, def->size) & msk;
+			mb = RTE_ACL_MASKLEN_TO_BITMASK(
+				(uint64_t)fb->mask_range.u32, def->size) & msk;
+			if (((va ^ vb) & ma & mb) != 0)
+				return 0;
+			break;
+		default:
+			ma = acl_delta_field_value(&fa->mask_range, def->size);
+			mb = acl_delta_field_value(&fb->mask_range, def->size);
+			if (((va ^ vb) & ma & mb) != 0)
+				return 0;
+			break;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Copy into the delta context the live main rules overlapping
+ * a rule deleted from the main context.
+ */
+static void
+acl_delta_shadow(struct rte_acl_delta *d, uint32_t slot)
+{
+	uint32_t i;
+	const uint8_t mask = ACL_DELTA_LIVE | ACL_DELTA_MAIN | ACL_DELTA_SHADOW;
+	const struct rte_acl_rule *r;
+
+	r = acl_delta_rule(d, slot);
+	for (i = 0; i != d->max_rules; i++) {
+		if ((d->state[i] & mask) == (ACL_DELTA_LIVE | ACL_DELTA_MAIN) &&
+				acl_delta_overlap(&d->cfg, r,
+				acl_delta_rule(d, i)))
+			d->state[i] |= ACL_DELTA_SHADOW;
+	}
+}
+
+static int
+acl_delta_check_rule(const struct rte_acl_rule_data *rd)
+{
+	if ((RTE_LEN2MASK(RTE_ACL_MAX_CATEGORIES, typeof(rd->category_mask)) &
+			rd->category_mask) == 0 ||
+			rd->priority > RTE_ACL_MAX_PRIORITY ||
+			rd->priority < RTE_ACL_MIN_PRIORITY ||
+			rd->userdata == RTE_ACL_INVALID_USERDATA)
+		return -EINVAL;
+	return 0;
+}
+
+/*
+ * Create and build a context with the rules of the given slots.
+ */
+static struct rte_acl_ctx *
+acl_delta_ctx_build(const struct rte_acl_delta *d, uint32_t gen,
+	const uint32_t *list, uint32_t num, uint32_t max_num, int32_t *rc)
+{
+	uint32_t i;
+	struct rte_acl_ctx *ctx;
+	struct rte_acl_param prm;
+	char name[RTE_ACL_NAMESIZE + ACL_DELTA_SUFFIX_LEN];
+
+	snprintf(name, sizeof(name), "%s_%u", d->name, gen);
+	if (rte_acl_find_existing(name) != NULL) {
+		*rc = -EEXIST;
+		return NULL;
+	}
+
+	prm.name = name;
+	prm.socket_id = d->socket_id;
+	prm.rule_size = d->rule_sz;
+	prm.max_rule_num = max_num;
+
+	ctx = rte_acl_create(&prm);
+	if (ctx == NULL) {
+		*rc = -ENOMEM;
+		return NULL;
+	}
+
+	*rc = 0;
+	for (i = 0; i != num && *rc == 0; i++)
+		*rc = rte_acl_add_rules(ctx, acl_delta_rule(d, list[i]), 1);
+
+	if (*rc == 0)
+		*rc = rte_acl_build(ctx, &d->cfg);
+
+	if (*rc != 0) {
+		RTE_LOG(ERR, ACL, "%s(%s): build of %u rules failed, "
+			"error code: %d\n", __func__, d->name, num, *rc);
+		rte_acl_free(ctx);
+		return NULL;
+	}
+
+	return ctx;
+}
+
+/* Wait until the classifying threads are done with the previous view. */
+static void
+acl_delta_sync(struct rte_acl_delta *d)
+{
+	if (d->v != NULL)
+		rte_rcu_qsbr_synchronize(d->v, RTE_RCU_QSBR_THRID_INVALID);
+}
+
+static void
+acl_delta_view_free(struct acl_delta_view *view, int free_main)
+{
+	if (view == NULL)
+		return;
+	if (free_main)
+		rte_acl_free(view->main);
+	rte_acl_free(view->delta);
+	rte_free(view);
+}
+
+/*
+ * Build the delta context from the current slot states and
+ * publish it with the given main context.
+ */
+static int
+acl_delta_publish(struct rte_acl_delta *d, struct rte_acl_ctx *main)
+{
+	int32_t rc;
+	uint32_t i, n;
+	uint8_t st;
+	struct acl_delta_view *nv, *old;
+
+	nv = rte_zmalloc_socket(d->name, sizeof(*nv) +
+		RTE_ALIGN_CEIL(d->max_rules, 64) / CHAR_BIT,
+		RTE_CACHE_LINE_SIZE, d->socket_id);
+	if (nv == NULL)
+		return -ENOMEM;
+
+	n = 0;
+	for (i = 0; i != d->max_rules; i++) {
+		st = d->state[i];
+		if ((st & ACL_DELTA_LIVE) != 0 && ((st & ACL_DELTA_MAIN) == 0 ||
+				(st & ACL_DELTA_SHADOW) != 0))
+			d->list[n++] = i;
+		else if ((st & (ACL_DELTA_LIVE | ACL_DELTA_MAIN)) ==
+				ACL_DELTA_MAIN)
+			nv->deleted[i / 64] |= UINT64_C(1) << (i % 64);
+	}
+
+	if (n > d->max_delta) {
+		rte_free(nv);
+		return -ENOSPC;
+	}
+
+	if (n != 0) {
+		nv->delta = acl_delta_ctx_build(d, d->gen++, d->list, n, n,
+			&rc);
+		if (nv->delta == NULL) {
+			rte_free(nv);
+			return rc;
+		}
+	}
+
+	nv->main = main;
+	nv->num_delta = n;
+
+	old = d->view;
+	rte_wmb();
+	d->view = nv;
+
+	acl_delta_sync(d);
+	acl_delta_view_free(old, old->main != main);
+
+	/* the previous view was the last one to use these slots. */
+	for (i = 0; i != d->num_pending; i++)
+		d->free_slots[d->num_free++] = d->pending[i];
+	d->num_pending = 0;
+
+	return 0;
+}
+
+static void
+acl_delta_save(struct rte_acl_delta *d)
+{
+	memcpy(d->saved, d->state, d->max_rules);
+}
+
+/*
+ * Roll back a failed update to the saved slot states.
+ */
+static void
+acl_delta_restore(struct rte_acl_delta *d, uint32_t num_free,
+	uint32_t num_pending)
+{
+	uint32_t i;
+	uint8_t cur, old;
+
+	for (i = 0; i != d->max_rules; i++) {
+		old = d->saved[i];
+		cur = d->state[i];
+		if (((old ^ cur) & ACL_DELTA_LIVE) != 0) {
+			if ((cur & ACL_DELTA_LIVE) != 0)
+				acl_delta_hash_del(d,
+					acl_delta_hash_find(d,
+					d->userdata[i]));
+			else
+				*acl_delta_hash_find(d, d->userdata[i]) = i + 1;
+		}
+		d->state[i] = old;
+	}
+
+	d->num_free = num_free;
+	d->num_pending = num_pending;
+}
+
+static int
+acl_delta_add(struct rte_acl_delta *d, const struct rte_acl_rule *rules,
+	uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, num_free, num_pending, slot, *bucket;
+	const struct rte_acl_rule *rv;
+	struct rte_acl_rule *r;
+
+	if (num > d->num_free)
+		return -ENOSPC;
+
+	acl_delta_save(d);
+	num_free = d->num_free;
+	num_pending = d->num_pending;
+
+	rc = 0;
+	for (i = 0; i != num; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * d->rule_sz);
+
+		bucket = acl_delta_hash_find(d, rv->data.userdata);
+		if (*bucket != 0) {
+			rc = -EEXIST;
+			break;
+		}
+
+		slot = d->free_slots[--d->num_free];
+		r = acl_delta_rule(d, slot);
+		memcpy(r, rv, d->rule_sz);
+		r->data.userdata = slot + 1;
+
+		d->userdata[slot] = rv->data.userdata;
+		d->priority[slot] = rv->data.priority;
+		d->state[slot] = ACL_DELTA_LIVE;
+		*bucket = slot + 1;
+	}
+
+	if (rc == 0)
+		rc = acl_delta_publish(d, d->view->main);
+	if (rc != 0)
+		acl_delta_restore(d, num_free, num_pending);
+
+	return rc;
+}
+
+int
+rte_acl_delta_add_rules(struct rte_acl_delta *d,
+	const struct rte_acl_rule *rules, uint32_t num)
+{
+	int32_t rc;
+	uint32_t i;
+	const struct rte_acl_rule *rv;
+
+	if (d == NULL || rules == NULL)
+		return -EINVAL;
+
+	for (i = 0; i != num; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * d->rule_sz);
+		rc = acl_delta_check_rule(&rv->data);
+		if (rc != 0) {
+			RTE_LOG(ERR, ACL, "%s(%s): rule #%u is invalid\n",
+				__func__, d->name, i + 1);
+			return rc;
+		}
+	}
+
+	rte_spinlock_lock(&d->lock);
+	rc = acl_delta_add(d, rules, num);
+	rte_spinlock_unlock(&d->lock);
+
+	return rc;
+}
+
+static int
+acl_delta_del(struct rte_acl_delta *d, const uint32_t *userdata, uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, num_free, num_pending, slot, *bucket;
+	uint8_t st;
+
+	acl_delta_save(d);
+	num_free = d->num_free;
+	num_pending = d->num_pending;
+
+	rc = 0;
+	for (i = 0; i != num; i++) {
+		bucket = acl_delta_hash_find(d, userdata[i]);
+		if (*bucket == 0) {
+			rc = -ENOENT;
+			break;
+		}
+
+		slot = *bucket - 1;
+		acl_delta_hash_del(d, bucket);
+
+		st = d->state[slot] & ~ACL_DELTA_LIVE;
+		d->state[slot] = st;
+
+		if ((st & ACL_DELTA_MAIN) != 0)
+			acl_delta_shadow(d, slot);
+		/* the rule is not built into any main context, drop it. */
+		else if ((st & ACL_DELTA_NEXT) == 0) {
+			d->state[slot] = 0;
+			d->pending[d->num_pending++] = slot;
+		}
+	}
+
+	if (rc == 0)
+		rc = acl_delta_publish(d, d->view->main);
+	if (rc != 0)
+		acl_delta_restore(d, num_free, num_pending);
+
+	return rc;
+}
+
+int
+rte_acl_delta_del_rules(struct rte_acl_delta *d, const uint32_t *userdata,
+	uint32_t num)
+{
+	int32_t rc;
+
+	if (d == NULL || userdata == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&d->lock);
+	rc = acl_delta_del(d, userdata, num);
+	rte_spinlock_unlock(&d->lock);
+
+	return rc;
+}
+
+/*
+ * Switch to a new main context built with the rules marked ACL_DELTA_NEXT.
+ * The delta context gets the rules updated during the build.
+ */
+static int
+acl_delta_commit(struct rte_acl_delta *d, struct rte_acl_ctx *main)
+{
+	int32_t rc;
+	uint32_t i, num_free, num_pending;
+	uint8_t st;
+
+	acl_delta_save(d);
+	num_free = d->num_free;
+	num_pending = d->num_pending;
+
+	for (i = 0; i != d->max_rules; i++) {
+		st = d->state[i] & ~(ACL_DELTA_MAIN | ACL_DELTA_SHADOW);
+		if ((st & ACL_DELTA_NEXT) != 0)
+			st = (st & ~ACL_DELTA_NEXT) | ACL_DELTA_MAIN;
+		d->state[i] = st;
+
+		/* deleted before the build started. */
+		if (st == 0 && d->saved[i] != 0)
+			d->pending[d->num_pending++] = i;
+	}
+
+	/* deleted during the build. */
+	for (i = 0; i != d->max_rules; i++) {
+		if ((d->state[i] & (ACL_DELTA_LIVE | ACL_DELTA_MAIN)) ==
+				ACL_DELTA_MAIN)
+			acl_delta_shadow(d, i);
+	}
+
+	rc = acl_delta_publish(d, main);
+	if (rc != 0)
+		acl_delta_restore(d, num_free, num_pending);
+
+	return rc;
+}
+
+int
+rte_acl_delta_merge(struct rte_acl_delta *d)
+{
+	int32_t rc;
+	uint32_t i, n, gen, *list;
+	uint8_t st;
+	struct rte_acl_ctx *main;
+
+	if (d == NULL)
+		return -EINVAL;
+
+	if (rte_atomic32_test_and_set(&d->merging) == 0)
+		return -EBUSY;
+
+	list = rte_malloc_socket(NULL, d->max_rules * sizeof(list[0]), 0,
+		d->socket_id);
+	if (list == NULL) {
+		rte_atomic32_clear(&d->merging);
+		return -ENOMEM;
+	}
+
+	/* mark the rules to build, they are kept until the build is over. */
+	rte_spinlock_lock(&d->lock);
+	n = 0;
+	for (i = 0; i != d->max_rules; i++) {
+		if ((d->state[i] & ACL_DELTA_LIVE) != 0) {
+			d->state[i] |= ACL_DELTA_NEXT;
+			list[n++] = i;
+		}
+	}
+	gen = d->gen++;
+	rte_spinlock_unlock(&d->lock);
+
+	/* build without the lock held, the slots marked do not change. */
+	rc = 0;
+	main = NULL;
+	if (n != 0)
+		main = acl_delta_ctx_build(d, gen, list, n, n, &rc);
+
+	rte_spinlock_lock(&d->lock);
+
+	if (rc == 0)
+		rc = acl_delta_commit(d, main);
+
+	/*
+	 * Drop the build marks, and the rules only kept for the build, which
+	 * are not used by the current view anymore.
+	 */
+	if (rc != 0) {
+		rte_acl_free(main);
+		for (i = 0; i != d->max_rules; i++) {
+			st = d->state[i];
+			if ((st & ACL_DELTA_NEXT) != 0) {
+				st &= ~ACL_DELTA_NEXT;
+				d->state[i] = st;
+				if (st == 0)
+					d->free_slots[d->num_free++] = i;
+			}
+		}
+	}
+
+	rte_spinlock_unlock(&d->lock);
+
+	rte_free(list);
+	rte_atomic32_clear(&d->merging);
+	return rc;
+}
+
+uint32_t
+rte_acl_delta_count(const struct rte_acl_delta *d)
+{
+	return d->view->num_delta;
+}
+
+int
+rte_acl_delta_classify(const struct rte_acl_delta *d, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	int32_t rc;
+	uint32_t i, j, k, m, n, x, *res;
+	const struct acl_delta_view *view;
+	uint32_t tmp[ACL_DELTA_BURST * RTE_ACL_MAX_CATEGORIES];
+
+	if (d == NULL || data == NULL || results == NULL ||
+			categories == 0 || categories > RTE_ACL_MAX_CATEGORIES ||
+			(categories != 1 && ((RTE_ACL_RESULTS_MULTIPLIER - 1) &
+			categories) != 0))
+		return -EINVAL;
+
+	view = d->view;
+
+	if (view->main != NULL) {
+		rc = rte_acl_classify(view->main, data, results, num,
+			categories);
+		if (rc != 0)
+			return rc;
+	} else
+		memset(results, 0, sizeof(results[0]) * num * categories);
+
+	memset(tmp, 0, sizeof(tmp));
+
+	for (i = 0; i != num; i += n) {
+		n = RTE_MIN(num - i, (uint32_t)ACL_DELTA_BURST);
+		k = n * categories;
+		res = results + i * categories;
+
+		if (view->delta != NULL)
+			rte_acl_classify(view->delta, data + i, tmp, n,
+				categories);
+
+		/* keep the highest priority match of both contexts. */
+		for (j = 0; j != k; j++) {
+			m = res[j];
+			x = tmp[j];
+			if (m != 0 && acl_delta_deleted(view, m - 1))
+				m = 0;
+			if (x != 0 && (m == 0 ||
+					d->priority[x - 1] > d->priority[m - 1]))
+				m = x;
+			res[j] = (m != 0) ? d->userdata[m - 1] :
+				RTE_ACL_INVALID_USERDATA;
+		}
+	}
+
+	return 0;
+}
+
+void
+rte_acl_delta_free(struct rte_acl_delta *d)
+{
+	if (d == NULL)
+		return;
+
+	acl_delta_view_free(d->view, 1);
+	rte_free(d->hash);
+	rte_free(d->list);
+	rte_free(d->pending);
+	rte_free(d->free_slots);
+	rte_free(d->saved);
+	rte_free(d->state);
+	rte_free(d->priority);
+	rte_free(d->userdata);
+	rte_free(d->rules);
+	rte_free(d);
+}
+
+struct rte_acl_delta *
+rte_acl_delta_create(const struct rte_acl_delta_param *param)
+{
+	uint32_t i, hash_sz;
+	struct rte_acl_delta *d;
+	int socket_id;
+
+	if (param == NULL || param->name == NULL || param->cfg == NULL ||
+			strlen(param->name) >=
+			RTE_ACL_NAMESIZE - ACL_DELTA_SUFFIX_LEN ||
+			param->rule_size < sizeof(struct rte_acl_rule) ||
+			param->max_rule_num == 0 ||
+			param->max_rule_num > RTE_ACL_MAX_INDEX / 2 ||
+			param->max_delta_rule_num == 0 ||
+			param->cfg->num_fields > RTE_ACL_MAX_FIELDS) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	socket_id = param->socket_id;
+	d = rte_zmalloc_socket("ACL_DELTA", sizeof(*d), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (d == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(d->name, sizeof(d->name), "%s", param->name);
+	d->socket_id = socket_id;
+	d->rule_sz = param->rule_size;
+	d->max_rules = param->max_rule_num;
+	d->max_delta = param->max_delta_rule_num;
+	d->cfg = *param->cfg;
+	d->v = param->v;
+	rte_spinlock_init(&d->lock);
+	rte_atomic32_init(&d->merging);
+
+	hash_sz = rte_align32pow2(d->max_rules * 2);
+	d->hash_mask = hash_sz - 1;
+	d->hash_shift = sizeof(uint32_t) * CHAR_BIT - __builtin_ctz(hash_sz);
+
+	d->rules = rte_zmalloc_socket(NULL, (size_t)d->max_rules * d->rule_sz,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	d->userdata = rte_zmalloc_socket(NULL,
+		d->max_rules * sizeof(d->userdata[0]), 0, socket_id);
+	d->priority = rte_zmalloc_socket(NULL,
+		d->max_rules * sizeof(d->priority[0]), 0, socket_id);
+	d->state = rte_zmalloc_socket(NULL, d->max_rules, 0, socket_id);
+	d->saved = rte_zmalloc_socket(NULL, d->max_rules, 0, socket_id);
+	d->free_slots = rte_zmalloc_socket(NULL,
+		d->max_rules * sizeof(d->free_slots[0]), 0, socket_id);
+	d->pending = rte_zmalloc_socket(NULL,
+		d->max_rules * sizeof(d->pending[0]), 0, socket_id);
+	d->list = rte_zmalloc_socket(NULL,
+		d->max_rules * sizeof(d->list[0]), 0, socket_id);
+	d->hash = rte_zmalloc_socket(NULL, hash_sz * sizeof(d->hash[0]), 0,
+		socket_id);
+	d->view = rte_zmalloc_socket(NULL, sizeof(*d->view) +
+		RTE_ALIGN_CEIL(d->max_rules, 64) / CHAR_BIT,
+		RTE_CACHE_LINE_SIZE, socket_id);
+
+	if (d->rules == NULL || d->userdata == NULL || d->priority == NULL ||
+			d->state == NULL || d->saved == NULL ||
+			d->free_slots == NULL || d->pending == NULL ||
+			d->list == NULL || d->hash == NULL || d->view == NULL) {
+		RTE_LOG(ERR, ACL, "%s(%s): allocation for %u rules failed\n",
+			__func__, param->name, d->max_rules);
+		rte_acl_delta_free(d);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* lowest slots are used first. */
+	for (i = 0; i != d->max_rules; i++)
+		d->free_slots[i] = d->max_rules - 1 - i;
+	d->num_free = d->max_rules;
+
+	return d;
+}
@@ -0,0 +1,217 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_ACL_DELTA_H_
+#define _RTE_ACL_DELTA_H_
+
+/**
+ * @file
+ *
+ * RTE ACL incremental updates.
+ *
+ * An ACL delta object classifies with two ACL contexts: a main context
+ * holding a large, rarely rebuilt, rule set and a small delta context
+ * rebuilt on each update. Added rules go into the delta context. A rule
+ * deleted from the main context is masked out of its results, and the
+ * main rules overlapping it are copied into the delta context, so that
+ * the next best match is still found. rte_acl_delta_merge() rebuilds the
+ * main context with all the rules, without blocking the updates, and
+ * empties the delta context.
+ *
+ * Classification results are the ones of a single context built with
+ * all the rules, provided that the rules matching the same input with
+ * the same category have different priorities.
+ */
+
+#include <rte_acl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rte_rcu_qsbr;
+struct rte_acl_delta;
+
+/**
+ * Parameters used when creating an ACL delta object.
+ */
+struct rte_acl_delta_param {
+	const char *name;         /**< Name of the ACL delta object. */
+	int         socket_id;    /**< Socket ID to allocate memory for. */
+	uint32_t    rule_size;    /**< Size of each rule. */
+	uint32_t    max_rule_num; /**< Maximum number of rules. */
+	uint32_t    max_delta_rule_num;
+	/**< Maximum number of rules in the delta context. */
+	const struct rte_acl_config *cfg;
+	/**< Build configuration of the contexts. */
+	struct rte_rcu_qsbr *v;
+	/**<
+	 * QSBR variable the classifying threads report quiescent states to,
+	 * used to free the replaced contexts. If NULL, the updates must not
+	 * run concurrently with rte_acl_delta_classify().
+	 */
+};
+
+/**
+ * Create a new ACL delta object, with no rules.
+ *
+ * @param param
+ *   Parameters used to create and initialise the ACL delta object.
+ * @return
+ *   Pointer to ACL delta object, or NULL on error, with error code set
+ *   in rte_errno. Possible rte_errno errors include:
+ *   - EINVAL - invalid parameter passed to function
+ *   - ENOMEM - no appropriate memory area found
+ */
+struct rte_acl_delta *
+rte_acl_delta_create(const struct rte_acl_delta_param *param);
+
+/**
+ * De-allocate all memory used by an ACL delta object.
+ *
+ * @param d
+ *   ACL delta object to free
+ */
+void
+rte_acl_delta_free(struct rte_acl_delta *d);
+
+/**
+ * Add rules to an ACL delta object and rebuild its delta context.
+ * This function is not multi-thread safe with other updates, but can run
+ * concurrently with rte_acl_delta_merge() and rte_acl_delta_classify().
+ *
+ * @param d
+ *   ACL delta object to add rules to.
+ * @param rules
+ *   Array of rules to add, in the format described for rte_acl_add_rules().
+ *   The userdata of each rule identifies it and must be unique.
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if a rule with the same userdata exists.
+ *   - -ENOSPC if there is no space for these rules, in the object or
+ *     in the delta context.
+ *   - -ENOMEM if the delta context can not be built.
+ *   - Zero if operation completed successfully.
+ *   On error, no rule is added.
+ */
+int
+rte_acl_delta_add_rules(struct rte_acl_delta *d,
+	const struct rte_acl_rule *rules, uint32_t num);
+
+/**
+ * Delete rules from an ACL delta object and rebuild its delta context.
+ * This function is not multi-thread safe with other updates, but can run
+ * concurrently with rte_acl_delta_merge() and rte_acl_delta_classify().
+ *
+ * @param d
+ *   ACL delta object to delete rules from.
+ * @param userdata
+ *   Array of the userdata of the rules to delete.
+ * @param num
+ *   Number of elements in the input array.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if a rule is not found.
+ *   - -ENOSPC if the main rules overlapping the deleted ones do not fit
+ *     in the delta context.
+ *   - -ENOMEM if the delta context can not be built.
+ *   - Zero if operation completed successfully.
+ *   On error, no rule is deleted.
+ */
+int
+rte_acl_delta_del_rules(struct rte_acl_delta *d, const uint32_t *userdata,
+	uint32_t num);
+
+/**
+ * Rebuild the main context with all the rules and empty the delta context.
+ * The build itself does not block the updates nor the classification, so
+ * it is expected to run in a background control thread.
+ *
+ * @param d
+ *   ACL delta object to merge.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EBUSY if another merge is in progress.
+ *   - -ENOSPC if the rules updated during the build do not fit
+ *     in the delta context.
+ *   - Negative error code of rte_acl_build() if the build failed.
+ *   - Zero if operation completed successfully.
+ *   On error, the main context is left unchanged.
+ */
+int
+rte_acl_delta_merge(struct rte_acl_delta *d);
+
+/**
+ * Get the number of rules in the delta context. The object should be
+ * merged when it gets close to the maximum number of delta rules.
+ *
+ * @param d
+ *   ACL delta object.
+ * @return
+ *   Number of rules in the delta context.
+ */
+uint32_t
+rte_acl_delta_count(const struct rte_acl_delta *d);
+
+/**
+ * Perform search for a matching rule for each input data buffer, through
+ * the main and the delta contexts. See rte_acl_classify() for details.
+ * The calling thread must not report a quiescent state to the QSBR
+ * variable of the object while this function is running.
+ *
+ * @param d
+ *   ACL delta object to search with.
+ * @param data
+ *   Array of pointers to input data buffers to perform search.
+ * @param results
+ *   Array of search results, *categories* results per each input data buffer.
+ * @param num
+ *   Number of elements in the input data buffers array.
+ * @param categories
+ *   Number of maximum possible matches for each input buffer, one possible
+ *   match per category.
+ * @return
+ *   zero on successful completion.
+ *   -EINVAL for incorrect arguments.
+ */
+int
+rte_acl_delta_classify(const struct rte_acl_delta *d, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_ACL_DELTA_H_ */
@@ -0,0 +1,227 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_memzone.h>
+
+#include "rte_bitrate.h"
+
+#define MZ_RTE_BITRATE_STATS "RTE_BITRATE_STATS"
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_BITRATE RTE_LOGTYPE_USER1
+
+/* Weight in percent of the newest sample in the moving average */
+#define BITRATE_EWMA_ALPHA_PERCENT 20
+
+/* Per port state, only written by the lcore calling rte_stats_bitrate_calc */
+struct bitrate_port {
+	/** Odd while the published rates are being updated */
+	volatile uint32_t seq;
+	struct rte_stats_bitrate rates; /**< Published rates */
+
+	uint64_t first_tsc;    /**< Time of the first calculation */
+	uint64_t first_ibytes; /**< RX bytes at the first calculation */
+	uint64_t first_obytes; /**< TX bytes at the first calculation */
+	uint64_t last_tsc;     /**< Time of the last calculation */
+	uint64_t last_ibytes;  /**< RX bytes at the last calculation */
+	uint64_t last_obytes;  /**< TX bytes at the last calculation */
+} __rte_cache_aligned;
+
+struct rte_stats_bitrates {
+	uint64_t tsc_hz;
+	struct bitrate_port port[RTE_MAX_ETHPORTS];
+};
+
+struct rte_stats_bitrates *
+rte_stats_bitrate_create(void)
+{
+	const struct rte_memzone *mz;
+	struct rte_stats_bitrates *bitrate_data;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+		rte_errno = E_RTE_SECONDARY;
+		return NULL;
+	}
+
+	if (rte_memzone_lookup(MZ_RTE_BITRATE_STATS) != NULL) {
+		rte_errno = EEXIST;
+		return NULL;
+	}
+
+	mz = rte_memzone_reserve(MZ_RTE_BITRATE_STATS, sizeof(*bitrate_data),
+			rte_socket_id(), 0);
+	if (mz == NULL) {
+		RTE_LOG(ERR, BITRATE, "Cannot reserve memory zone\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	bitrate_data = mz->addr;
+	memset(bitrate_data, 0, sizeof(*bitrate_data));
+	bitrate_data->tsc_hz = rte_get_tsc_hz();
+
+	return bitrate_data;
+}
+
+void
+rte_stats_bitrate_free(struct rte_stats_bitrates *bitrate_data)
+{
+	const struct rte_memzone *mz;
+
+	if (bitrate_data == NULL)
+		return;
+
+	mz = rte_memzone_lookup(MZ_RTE_BITRATE_STATS);
+	if (mz != NULL && mz->addr == bitrate_data)
+		rte_memzone_free(mz);
+}
+
+static inline uint64_t
+bitrate_bps(uint64_t bytes, uint64_t cycles, uint64_t tsc_hz)
+{
+	if (cycles == 0)
+		return 0;
+	return (uint64_t)((double)bytes * 8 * tsc_hz / cycles);
+}
+
+static inline void
+bitrate_ewma(uint64_t *ewma, uint64_t bps)
+{
+	int64_t delta = bps - *ewma;
+
+	*ewma += delta * BITRATE_EWMA_ALPHA_PERCENT / 100;
+}
+
+int
+rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
+		uint8_t port_id)
+{
+	struct bitrate_port *port;
+	struct rte_stats_bitrate rates;
+	struct rte_eth_stats eth_stats;
+	uint64_t now, cur_ibits, cur_obits;
+	int ret;
+
+	if (bitrate_data == NULL || port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	ret = rte_eth_stats_get(port_id, &eth_stats);
+	if (ret != 0)
+		return ret;
+
+	now = rte_rdtsc();
+	port = &bitrate_data->port[port_id];
+
+	/* first sample, or the counters were reset: restart from scratch */
+	if (port->first_tsc == 0 || eth_stats.ibytes < port->last_ibytes ||
+			eth_stats.obytes < port->last_obytes) {
+		port->first_tsc = now;
+		port->first_ibytes = eth_stats.ibytes;
+		port->first_obytes = eth_stats.obytes;
+		port->last_tsc = now;
+		port->last_ibytes = eth_stats.ibytes;
+		port->last_obytes = eth_stats.obytes;
+		return 0;
+	}
+
+	cur_ibits = bitrate_bps(eth_stats.ibytes - port->last_ibytes,
+			now - port->last_tsc, bitrate_data->tsc_hz);
+	cur_obits = bitrate_bps(eth_stats.obytes - port->last_obytes,
+			now - port->last_tsc, bitrate_data->tsc_hz);
+
+	rates = port->rates;
+	rates.mean_ibits = bitrate_bps(eth_stats.ibytes - port->first_ibytes,
+			now - port->first_tsc, bitrate_data->tsc_hz);
+	rates.mean_obits = bitrate_bps(eth_stats.obytes - port->first_obytes,
+			now - port->first_tsc, bitrate_data->tsc_hz);
+	if (rates.ewma_ibits == 0 && rates.ewma_obits == 0) {
+		rates.ewma_ibits = cur_ibits;
+		rates.ewma_obits = cur_obits;
+	} else {
+		bitrate_ewma(&rates.ewma_ibits, cur_ibits);
+		bitrate_ewma(&rates.ewma_obits, cur_obits);
+	}
+	if (cur_ibits > rates.peak_ibits)
+		rates.peak_ibits = cur_ibits;
+	if (cur_obits > rates.peak_obits)
+		rates.peak_obits = cur_obits;
+
+	port->last_tsc = now;
+	port->last_ibytes = eth_stats.ibytes;
+	port->last_obytes = eth_stats.obytes;
+
+	/* publish, readers retry while seq is odd or has changed */
+	port->seq++;
+	rte_wmb();
+	port->rates = rates;
+	rte_wmb();
+	port->seq++;
+
+	return 0;
+}
+
+int
+rte_stats_bitrate_get(uint8_t port_id, struct rte_stats_bitrate *stats)
+{
+	const struct rte_memzone *mz;
+	const struct bitrate_port *port;
+	struct rte_stats_bitrates *bitrate_data;
+	uint32_t seq;
+
+	if (stats == NULL || port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	mz = rte_memzone_lookup(MZ_RTE_BITRATE_STATS);
+	if (mz == NULL)
+		return -ENOENT;
+
+	bitrate_data = mz->addr;
+	port = &bitrate_data->port[port_id];
+	do {
+		seq = port->seq;
+		rte_rmb();
+		*stats = port->rates;
+		rte_rmb();
+	} while ((seq & 1) != 0 || seq != port->seq);
+
+	return 0;
+}
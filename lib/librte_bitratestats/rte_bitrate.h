@@ -0,0 +1,125 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_BITRATE_H_
+#define _RTE_BITRATE_H_
+
+/**
+ * @file
+ * RTE bitrate statistics
+ *
+ * Library to compute the mean, exponentially weighted moving average (EWMA)
+ * and peak bit rates of ethdev ports from their cumulative byte counters.
+ *
+ * One lcore periodically calls rte_stats_bitrate_calc() for each port; the
+ * other lcores are not involved. Results are published in shared memory so
+ * that a secondary process can read them with rte_stats_bitrate_get().
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bit rates of a port, in bits per second. */
+struct rte_stats_bitrate {
+	uint64_t mean_ibits; /**< Mean RX rate since the first calculation. */
+	uint64_t mean_obits; /**< Mean TX rate since the first calculation. */
+	uint64_t ewma_ibits; /**< Moving average of the RX rate. */
+	uint64_t ewma_obits; /**< Moving average of the TX rate. */
+	uint64_t peak_ibits; /**< Highest RX rate between two calculations. */
+	uint64_t peak_obits; /**< Highest TX rate between two calculations. */
+};
+
+/** Bitrate statistics data structure, shared between processes. */
+struct rte_stats_bitrates;
+
+/**
+ * Allocate the bitrate statistics structure in shared memory. Must be called
+ * from the primary process.
+ *
+ * @return
+ *   Pointer to the structure, or NULL on error with rte_errno set:
+ *    - E_RTE_SECONDARY - function was called from a secondary process
+ *    - EEXIST - the structure was already allocated
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_stats_bitrates *rte_stats_bitrate_create(void);
+
+/**
+ * Free the bitrate statistics structure.
+ *
+ * @param bitrate_data
+ *   Pointer returned by rte_stats_bitrate_create().
+ */
+void rte_stats_bitrate_free(struct rte_stats_bitrates *bitrate_data);
+
+/**
+ * Sample the counters of a port and update its bit rates.
+ *
+ * This is meant to be called periodically, e.g. once per second, from a
+ * single lcore. The elapsed time between two calls is measured, so the
+ * period does not need to be exact.
+ *
+ * @param bitrate_data
+ *   Pointer returned by rte_stats_bitrate_create().
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - <0: Error returned by rte_eth_stats_get().
+ */
+int rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
+		uint8_t port_id);
+
+/**
+ * Retrieve the bit rates of a port. Can be called from any process.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param stats
+ *   A pointer to a structure to be filled with the bit rates.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ *   - -ENOENT: Bitrate statistics are not allocated.
+ */
+int rte_stats_bitrate_get(uint8_t port_id, struct rte_stats_bitrate *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BITRATE_H_ */
@@ -34,33 +34,23 @@
 #include <stdio.h>
 #include <sys/queue.h>
 #include <string.h>
+#include <errno.h>
 #include <rte_mbuf.h>
+#include <rte_cycles.h>
 #include <rte_memory.h>
 #include <rte_memzone.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_eal_memconfig.h>
 #include "rte_distributor.h"
+#include "rte_distributor_private.h"
 
 #define NO_FLAGS 0
 #define RTE_DISTRIB_PREFIX "DT_"
 
-/* we will use the bottom four bits of pointer for flags, shifting out
- * the top four bits to make room (since a 64-bit pointer actually only uses
- * 48 bits). An arithmetic-right-shift will then appropriately restore the
- * original pointer value with proper sign extension into the top bits. */
-#define RTE_DISTRIB_FLAG_BITS 4
-#define RTE_DISTRIB_FLAGS_MASK (0x0F)
-#define RTE_DISTRIB_NO_BUF 0       /**< empty flags: no buffer requested */
-#define RTE_DISTRIB_GET_BUF (1)    /**< worker requests a buffer, returns old */
-#define RTE_DISTRIB_RETURN_BUF (2) /**< worker returns a buffer, no request */
-
 #define RTE_DISTRIB_BACKLOG_SIZE 8
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
 
-#define RTE_DISTRIB_MAX_RETURNS 128
-#define RTE_DISTRIB_RETURNS_MASK (RTE_DISTRIB_MAX_RETURNS - 1)
-
 /**
  * Maximum number of workers allowed.
  * Be aware of increasing the limit, becaus it is limited by how we track
@@ -86,11 +76,28 @@ struct rte_distributor_backlog {
 	int64_t pkts[RTE_DISTRIB_BACKLOG_SIZE];
 };
 
-struct rte_distributor_returned_pkts {
-	unsigned start;
-	unsigned count;
-	struct rte_mbuf *mbufs[RTE_DISTRIB_MAX_RETURNS];
-};
+/* statistics updated by a worker, on their own cache lines */
+struct rte_distributor_worker_stats {
+	uint64_t idle_polls;
+	uint64_t wait_cycles;
+	uint64_t wait_hist[RTE_DISTRIB_STATS_WAIT_HIST];
+} __rte_cache_aligned;
+
+#ifdef RTE_DISTRIBUTOR_STATS_COLLECT
+
+#define DISTRIB_STATS_ADD(d, wkr, name, n) ((d)->stats[wkr].name += (n))
+#define DISTRIB_STATS_BACKLOG_ADD(d, wkr) \
+	((d)->stats[wkr].backlog_hist[(d)->backlog[wkr].count - 1]++)
+#define DISTRIB_WORKER_STATS_ADD(d, wkr, name, n) \
+	((d)->worker_stats[wkr].name += (n))
+
+#else
+
+#define DISTRIB_STATS_ADD(d, wkr, name, n) do {} while (0)
+#define DISTRIB_STATS_BACKLOG_ADD(d, wkr) do {} while (0)
+#define DISTRIB_WORKER_STATS_ADD(d, wkr, name, n) do {} while (0)
+
+#endif
 
 struct rte_distributor {
 	TAILQ_ENTRY(rte_distributor) next;    /**< Next in list. */
@@ -111,6 +118,13 @@ struct rte_distributor {
 	union rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
 
 	struct rte_distributor_returned_pkts returns;
+
+	struct rte_distributor_stats stats[RTE_DISTRIB_MAX_WORKERS];
+		/**< Statistics updated by the distributor */
+	struct rte_distributor_worker_stats worker_stats[RTE_DISTRIB_MAX_WORKERS];
+		/**< Statistics updated by the workers */
+	struct rte_distributor_worker_stats cleared[RTE_DISTRIB_MAX_WORKERS];
+		/**< Worker statistics at the last clear */
 };
 
 TAILQ_HEAD(rte_distributor_list, rte_distributor);
@@ -139,8 +153,10 @@ rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned worker_id)
 {
 	union rte_distributor_buffer *buf = &d->bufs[worker_id];
-	if (buf->bufptr64 & RTE_DISTRIB_GET_BUF)
+	if (buf->bufptr64 & RTE_DISTRIB_GET_BUF) {
+		DISTRIB_WORKER_STATS_ADD(d, worker_id, idle_polls, 1);
 		return NULL;
+	}
 
 	/* since bufptr64 is signed, this should be an arithmetic shift */
 	int64_t ret = buf->bufptr64 >> RTE_DISTRIB_FLAG_BITS;
@@ -152,9 +168,27 @@ rte_distributor_get_pkt(struct rte_distributor *d,
 		unsigned worker_id, struct rte_mbuf *oldpkt)
 {
 	struct rte_mbuf *ret;
+#ifdef RTE_DISTRIBUTOR_STATS_COLLECT
+	uint64_t start, wait;
+	unsigned bucket;
+
+	rte_distributor_request_pkt(d, worker_id, oldpkt);
+	start = rte_rdtsc();
+	while ((ret = rte_distributor_poll_pkt(d, worker_id)) == NULL)
+		rte_pause();
+	wait = rte_rdtsc() - start;
+
+	/* log2 histogram of the wait durations */
+	bucket = (wait == 0) ? 0 : 64 - __builtin_clzll(wait);
+	if (bucket >= RTE_DISTRIB_STATS_WAIT_HIST)
+		bucket = RTE_DISTRIB_STATS_WAIT_HIST - 1;
+	DISTRIB_WORKER_STATS_ADD(d, worker_id, wait_cycles, wait);
+	DISTRIB_WORKER_STATS_ADD(d, worker_id, wait_hist[bucket], 1);
+#else
 	rte_distributor_request_pkt(d, worker_id, oldpkt);
 	while ((ret = rte_distributor_poll_pkt(d, worker_id)) == NULL)
 		rte_pause();
+#endif
 	return ret;
 }
 
@@ -191,18 +225,6 @@ backlog_pop(struct rte_distributor_backlog *bl)
 	return bl->pkts[bl->start++ & RTE_DISTRIB_BACKLOG_MASK];
 }
 
-/* stores a packet returned from a worker inside the returns array */
-static inline void
-store_return(uintptr_t oldbuf, struct rte_distributor *d,
-		unsigned *ret_start, unsigned *ret_count)
-{
-	/* store returns in a circular buffer - code is branch-free */
-	d->returns.mbufs[(*ret_start + *ret_count) & RTE_DISTRIB_RETURNS_MASK]
-			= (void *)oldbuf;
-	*ret_start += (*ret_count == RTE_DISTRIB_RETURNS_MASK) & !!(oldbuf);
-	*ret_count += (*ret_count != RTE_DISTRIB_RETURNS_MASK) & !!(oldbuf);
-}
-
 static inline void
 handle_worker_shutdown(struct rte_distributor *d, unsigned wkr)
 {
@@ -258,10 +280,11 @@ process_returns(struct rte_distributor *d)
 
 		if (data & RTE_DISTRIB_GET_BUF) {
 			flushed++;
-			if (d->backlog[wkr].count)
+			if (d->backlog[wkr].count) {
 				d->bufs[wkr].bufptr64 =
 						backlog_pop(&d->backlog[wkr]);
-			else {
+				DISTRIB_STATS_ADD(d, wkr, handled_pkts, 1);
+			} else {
 				d->bufs[wkr].bufptr64 = RTE_DISTRIB_GET_BUF;
 				d->in_flight_tags[wkr] = 0;
 				d->in_flight_bitmask &= ~(1UL << wkr);
@@ -272,7 +295,7 @@ process_returns(struct rte_distributor *d)
 			oldbuf = data >> RTE_DISTRIB_FLAG_BITS;
 		}
 
-		store_return(oldbuf, d, &ret_start, &ret_count);
+		store_return(oldbuf, &d->returns, &ret_start, &ret_count);
 	}
 
 	d->returns.start = ret_start;
@@ -293,6 +316,7 @@ rte_distributor_process(struct rte_distributor *d,
 	uint32_t new_tag = 0;
 	unsigned ret_start = d->returns.start,
 			ret_count = d->returns.count;
+	unsigned held_idx __rte_unused = num_mbufs;
 
 	if (unlikely(num_mbufs == 0))
 		return process_returns(d);
@@ -337,8 +361,19 @@ rte_distributor_process(struct rte_distributor *d,
 				next_mb = NULL;
 				unsigned worker = __builtin_ctzl(match);
 				if (add_to_backlog(&d->backlog[worker],
-						next_value) < 0)
+						next_value) < 0) {
 					next_idx--;
+					/* count the packet once, not each
+					 * retry */
+					if (next_idx != held_idx)
+						DISTRIB_STATS_ADD(d, worker,
+							backlog_full, 1);
+					held_idx = next_idx;
+				} else {
+					DISTRIB_STATS_ADD(d, worker,
+							pinned_pkts, 1);
+					DISTRIB_STATS_BACKLOG_ADD(d, worker);
+				}
 			}
 		}
 
@@ -355,6 +390,7 @@ rte_distributor_process(struct rte_distributor *d,
 				d->in_flight_bitmask |= (1UL << wkr);
 				next_mb = NULL;
 			}
+			DISTRIB_STATS_ADD(d, wkr, handled_pkts, 1);
 			oldbuf = data >> RTE_DISTRIB_FLAG_BITS;
 		} else if (data & RTE_DISTRIB_RETURN_BUF) {
 			handle_worker_shutdown(d, wkr);
@@ -362,7 +398,7 @@ rte_distributor_process(struct rte_distributor *d,
 		}
 
 		/* store returns in a circular buffer */
-		store_return(oldbuf, d, &ret_start, &ret_count);
+		store_return(oldbuf, &d->returns, &ret_start, &ret_count);
 
 		if (++wkr == d->num_workers)
 			wkr = 0;
@@ -375,9 +411,10 @@ rte_distributor_process(struct rte_distributor *d,
 
 			int64_t oldbuf = d->bufs[wkr].bufptr64 >>
 					RTE_DISTRIB_FLAG_BITS;
-			store_return(oldbuf, d, &ret_start, &ret_count);
+			store_return(oldbuf, &d->returns, &ret_start, &ret_count);
 
 			d->bufs[wkr].bufptr64 = backlog_pop(&d->backlog[wkr]);
+			DISTRIB_STATS_ADD(d, wkr, handled_pkts, 1);
 		}
 
 	d->returns.start = ret_start;
@@ -443,6 +480,41 @@ rte_distributor_clear_returns(struct rte_distributor *d)
 #endif
 }
 
+/* reads the statistics of a worker */
+int
+rte_distributor_stats_read(struct rte_distributor *d, unsigned worker_id,
+		struct rte_distributor_stats *stats, int clear)
+{
+	struct rte_distributor_worker_stats now;
+	const struct rte_distributor_worker_stats *old;
+	unsigned i;
+
+	if (d == NULL || worker_id >= d->num_workers)
+		return -EINVAL;
+
+	/* the worker counters are never reset, as the worker may be updating
+	 * them, the values at the last clear are subtracted instead */
+	now = *(volatile struct rte_distributor_worker_stats *)
+			&d->worker_stats[worker_id];
+	old = &d->cleared[worker_id];
+
+	if (stats != NULL) {
+		*stats = d->stats[worker_id];
+		stats->idle_polls = now.idle_polls - old->idle_polls;
+		stats->wait_cycles = now.wait_cycles - old->wait_cycles;
+		for (i = 0; i < RTE_DISTRIB_STATS_WAIT_HIST; i++)
+			stats->wait_hist[i] = now.wait_hist[i] -
+					old->wait_hist[i];
+	}
+
+	if (clear) {
+		memset(&d->stats[worker_id], 0, sizeof(d->stats[worker_id]));
+		d->cleared[worker_id] = now;
+	}
+
+	return 0;
+}
+
 /* creates a distributor instance */
 struct rte_distributor *
 rte_distributor_create(const char *name,
@@ -459,6 +531,8 @@ rte_distributor_create(const char *name,
 	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
 	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_WORKERS >
 				sizeof(d->in_flight_bitmask) * CHAR_BIT);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_STATS_BACKLOG_HIST !=
+				RTE_DISTRIB_BACKLOG_SIZE);
 
 	if (name == NULL || num_workers >= RTE_DISTRIB_MAX_WORKERS) {
 		rte_errno = EINVAL;
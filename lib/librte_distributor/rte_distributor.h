@@ -46,11 +46,38 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #define RTE_DISTRIBUTOR_NAMESIZE 32 /**< Length of name for instance */
 
+#define RTE_DISTRIB_STATS_BACKLOG_HIST 8 /**< Buckets of backlog histogram */
+#define RTE_DISTRIB_STATS_WAIT_HIST 32   /**< Buckets of wait histogram */
+
 struct rte_distributor;
 struct rte_mbuf;
 
+/**
+ * Statistics of a worker of a distributor, collected when the
+ * CONFIG_RTE_DISTRIBUTOR_STATS_COLLECT option is enabled, zero otherwise.
+ */
+struct rte_distributor_stats {
+	uint64_t handled_pkts;  /**< Packets passed to the worker */
+	uint64_t pinned_pkts;
+	/**< Packets queued in the worker backlog as their tag was in flight */
+	uint64_t backlog_full;
+	/**< Packets held back as the worker backlog was full */
+	uint64_t idle_polls;
+	/**< Polls of the worker which found no packet */
+	uint64_t wait_cycles;
+	/**< Cycles spent by the worker waiting in rte_distributor_get_pkt() */
+	uint64_t backlog_hist[RTE_DISTRIB_STATS_BACKLOG_HIST];
+	/**< Pinned packets, per number of packets already in the backlog */
+	uint64_t wait_hist[RTE_DISTRIB_STATS_WAIT_HIST];
+	/**< Calls to rte_distributor_get_pkt(), per wait duration: bucket 0
+	 * counts the waits of 0 cycles, bucket n > 0 the waits of 2^(n-1) to
+	 * 2^n - 1 cycles, the last bucket all the longer waits */
+};
+
 /**
  * Function to create a new distributor instance
  *
@@ -150,6 +177,26 @@ rte_distributor_flush(struct rte_distributor *d);
 void
 rte_distributor_clear_returns(struct rte_distributor *d);
 
+/**
+ * Read the statistics of a worker, and optionally clear them.
+ *
+ * This should only be called on the same lcore as rte_distributor_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number
+ * @param stats
+ *   Where to store the statistics, can be NULL to only clear them
+ * @param clear
+ *   If non-zero, the statistics of the worker are reset after being read
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int
+rte_distributor_stats_read(struct rte_distributor *d, unsigned worker_id,
+		struct rte_distributor_stats *stats, int clear);
+
 /*  *** APIS to be called on the worker lcores ***  */
 /*
  * The following APIs are the public APIs which are designed for use on
@@ -0,0 +1,564 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <sys/queue.h>
+#include <string.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_errno.h>
+#include <rte_string_fns.h>
+#include <rte_eal_memconfig.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+#include <rte_vect.h>
+#endif
+#include "rte_distributor.h"
+#include "rte_distributor_burst.h"
+#include "rte_distributor_private.h"
+
+#define NO_FLAGS 0
+#define RTE_DISTRIB_BURST_PREFIX "DTB_"
+
+/* tags of a worker: the packets in flight, then the backlog */
+#define RTE_DIST_BURST_TAGS (RTE_DIST_BURST_SIZE * 2)
+
+/**
+ * Buffers used to pass the packets between the distributor and a worker.
+ * The packets to the worker and the packets returned by it are on separate
+ * cache lines, each followed by a padding line to prevent adjacent
+ * cache-line prefetches. The first entry of each line also holds the flags
+ * of the exchange, so it is written last.
+ */
+struct rte_distributor_burst_buffer {
+	volatile int64_t bufptr64[RTE_DIST_BURST_SIZE] __rte_cache_aligned;
+	int64_t pad1 __rte_cache_aligned;
+	volatile int64_t retptr64[RTE_DIST_BURST_SIZE] __rte_cache_aligned;
+	int64_t pad2 __rte_cache_aligned;
+};
+
+/**
+ * State of a worker, only used on the distributor lcore.
+ */
+struct rte_distributor_burst_worker {
+	uint32_t tags[RTE_DIST_BURST_TAGS];   /**< in flight, then backlog */
+	int64_t backlog[RTE_DIST_BURST_SIZE]; /**< packets queued */
+	unsigned in_flight;    /**< packets given to the worker */
+	unsigned count;        /**< packets in the backlog */
+	unsigned ready;        /**< the worker waits for packets */
+	unsigned active;       /**< the worker requests packets */
+} __rte_cache_aligned;
+
+struct rte_distributor_burst {
+	TAILQ_ENTRY(rte_distributor_burst) next;    /**< Next in list. */
+
+	char name[RTE_DISTRIBUTOR_NAMESIZE];  /**< Name of the ring. */
+	unsigned num_workers;                 /**< Number of workers polling */
+	unsigned next_wkr;                    /**< Next worker for a new flow */
+	unsigned shutdowns;                   /**< Worker shutdowns handled */
+
+	struct rte_distributor_burst_worker *workers;
+	struct rte_distributor_burst_buffer *bufs;
+
+	struct rte_distributor_returned_pkts returns;
+} __rte_cache_aligned;
+
+TAILQ_HEAD(rte_distributor_burst_list, rte_distributor_burst);
+
+static struct rte_tailq_elem rte_distributor_burst_tailq = {
+	.name = "RTE_DISTRIBUTOR_BURST",
+};
+EAL_REGISTER_TAILQ(rte_distributor_burst_tailq)
+
+/**** APIs called by workers ****/
+
+/* writes the returned packets, then the flags telling the distributor */
+static inline void
+write_returns(struct rte_distributor_burst_buffer *buf,
+		struct rte_mbuf **oldpkt, unsigned count, int64_t flags)
+{
+	unsigned i;
+
+	/* wait for the distributor to read the previous returns */
+	while (unlikely(buf->retptr64[0] &
+			(RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		rte_pause();
+
+	for (i = RTE_DIST_BURST_SIZE - 1; i > 0; i--)
+		buf->retptr64[i] = (i < count) ?
+			(((int64_t)(uintptr_t)oldpkt[i]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF :
+			0;
+	if (count != 0)
+		flags |= (((int64_t)(uintptr_t)oldpkt[0]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+	buf->retptr64[0] = flags;
+}
+
+void
+rte_distributor_burst_request_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count)
+{
+	write_returns(&d->bufs[worker_id], oldpkt, count, RTE_DISTRIB_GET_BUF);
+}
+
+int
+rte_distributor_burst_poll_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **pkts)
+{
+	struct rte_distributor_burst_buffer *buf = &d->bufs[worker_id];
+	unsigned i;
+	int64_t data;
+
+	if (!(buf->bufptr64[0] & RTE_DISTRIB_VALID_BUF))
+		return 0;
+
+	/* take the packets, and clear the entries for the next burst */
+	for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+		data = buf->bufptr64[i];
+		if (!(data & RTE_DISTRIB_VALID_BUF))
+			break;
+		/* since bufptr64 is signed, this should be an arithmetic
+		 * shift */
+		pkts[i] = (struct rte_mbuf *)((uintptr_t)(data >>
+				RTE_DISTRIB_FLAG_BITS));
+		buf->bufptr64[i] = 0;
+	}
+	return i;
+}
+
+int
+rte_distributor_burst_get_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount)
+{
+	int count;
+
+	rte_distributor_burst_request_pkt(d, worker_id, oldpkt, retcount);
+	while ((count = rte_distributor_burst_poll_pkt(d, worker_id,
+			pkts)) == 0)
+		rte_pause();
+	return count;
+}
+
+int
+rte_distributor_burst_return_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num)
+{
+	write_returns(&d->bufs[worker_id], oldpkt, num,
+		RTE_DISTRIB_RETURN_BUF);
+	return 0;
+}
+
+/**** APIs called on distributor core ***/
+
+/*
+ * for each of the n tags, find the worker that has the same tag in flight
+ * or in its backlog: match[i] is set to that worker + 1, and left to 0
+ * if there is none.
+ */
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+static inline void
+find_match(const struct rte_distributor_burst *d, const uint32_t *tags,
+		unsigned n, uint32_t *match)
+{
+	const struct rte_distributor_burst_worker *w;
+	__m128i t0, t1, t2, t3, v;
+	unsigned wkr, i, valid, m;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		w = &d->workers[wkr];
+		valid = ((1 << w->in_flight) - 1) |
+			(((1 << w->count) - 1) << RTE_DIST_BURST_SIZE);
+		if (valid == 0)
+			continue;
+
+		t0 = _mm_load_si128((const __m128i *)&w->tags[0]);
+		t1 = _mm_load_si128((const __m128i *)&w->tags[4]);
+		t2 = _mm_load_si128((const __m128i *)&w->tags[8]);
+		t3 = _mm_load_si128((const __m128i *)&w->tags[12]);
+
+		for (i = 0; i < n; i++) {
+			v = _mm_set1_epi32(tags[i]);
+			m = _mm_movemask_ps(_mm_castsi128_ps(
+					_mm_cmpeq_epi32(t0, v))) |
+				_mm_movemask_ps(_mm_castsi128_ps(
+					_mm_cmpeq_epi32(t1, v))) << 4 |
+				_mm_movemask_ps(_mm_castsi128_ps(
+					_mm_cmpeq_epi32(t2, v))) << 8 |
+				_mm_movemask_ps(_mm_castsi128_ps(
+					_mm_cmpeq_epi32(t3, v))) << 12;
+			if (m & valid)
+				match[i] = wkr + 1;
+		}
+	}
+}
+#else
+static inline void
+find_match(const struct rte_distributor_burst *d, const uint32_t *tags,
+		unsigned n, uint32_t *match)
+{
+	const struct rte_distributor_burst_worker *w;
+	unsigned wkr, i, j;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		w = &d->workers[wkr];
+		for (i = 0; i < n; i++) {
+			for (j = 0; j < w->in_flight; j++)
+				if (w->tags[j] == tags[i])
+					match[i] = wkr + 1;
+			for (j = 0; j < w->count; j++)
+				if (w->tags[RTE_DIST_BURST_SIZE + j] == tags[i])
+					match[i] = wkr + 1;
+		}
+	}
+}
+#endif
+
+/* passes the backlog of a worker waiting for packets to it */
+static void
+release(struct rte_distributor_burst *d, unsigned wkr)
+{
+	struct rte_distributor_burst_worker *w = &d->workers[wkr];
+	struct rte_distributor_burst_buffer *buf = &d->bufs[wkr];
+	unsigned i;
+
+	/* the worker cleared the entries when it took the last burst */
+	for (i = w->count - 1; i > 0; i--)
+		buf->bufptr64[i] = w->backlog[i] | RTE_DISTRIB_VALID_BUF;
+
+	memcpy(&w->tags[0], &w->tags[RTE_DIST_BURST_SIZE],
+		w->count * sizeof(w->tags[0]));
+	w->in_flight = w->count;
+	w->count = 0;
+	w->ready = 0;
+
+	buf->bufptr64[0] = w->backlog[0] | RTE_DISTRIB_VALID_BUF;
+}
+
+/* passes their backlog to all the workers waiting for packets */
+static void
+release_all(struct rte_distributor_burst *d)
+{
+	unsigned wkr;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		if (d->workers[wkr].count != 0 && d->workers[wkr].ready)
+			release(d, wkr);
+}
+
+/* a worker returned its packets without requesting more: its backlog is
+ * distributed again to the other workers */
+static void
+handle_worker_shutdown(struct rte_distributor_burst *d, unsigned wkr)
+{
+	struct rte_distributor_burst_worker *w = &d->workers[wkr];
+	struct rte_mbuf *pkts[RTE_DIST_BURST_SIZE];
+	unsigned i, count = w->count;
+
+	w->active = 0;
+	w->ready = 0;
+	d->shutdowns++;
+	if (likely(count == 0))
+		return;
+
+	for (i = 0; i < count; i++)
+		pkts[i] = (void *)((uintptr_t)(w->backlog[i] >>
+				RTE_DISTRIB_FLAG_BITS));
+	w->count = 0;
+
+	/* recursive call, the tags are still set in the mbufs */
+	rte_distributor_burst_process(d, pkts, count);
+}
+
+/* collects the packets returned by the workers, and the requests of those
+ * waiting for packets; returns the number of requests */
+static unsigned
+handle_requests(struct rte_distributor_burst *d)
+{
+	struct rte_distributor_burst_buffer *buf;
+	struct rte_distributor_burst_worker *w;
+	unsigned wkr, i, requests = 0;
+	int64_t data, ret;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		buf = &d->bufs[wkr];
+		data = buf->retptr64[0];
+		if (!(data & (RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+			continue;
+
+		for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+			ret = (i == 0) ? data : buf->retptr64[i];
+			if (ret & RTE_DISTRIB_VALID_BUF)
+				store_return(ret >> RTE_DISTRIB_FLAG_BITS,
+					&d->returns, &d->returns.start,
+					&d->returns.count);
+		}
+
+		/* the packets given to the worker are completed */
+		w = &d->workers[wkr];
+		w->in_flight = 0;
+
+		/* let the worker write its next returns */
+		buf->retptr64[0] = 0;
+
+		if (data & RTE_DISTRIB_GET_BUF) {
+			w->ready = 1;
+			w->active = 1;
+			requests++;
+		} else
+			handle_worker_shutdown(d, wkr);
+	}
+
+	return requests;
+}
+
+/* picks the next active worker with room in its backlog for a new flow,
+ * waiting for one if needed */
+static unsigned
+next_worker(struct rte_distributor_burst *d)
+{
+	struct rte_distributor_burst_worker *w;
+	unsigned i, wkr;
+
+	for (;;) {
+		for (i = 0; i < d->num_workers; i++) {
+			wkr = d->next_wkr;
+			if (++d->next_wkr == d->num_workers)
+				d->next_wkr = 0;
+			w = &d->workers[wkr];
+			if (w->active && w->count < RTE_DIST_BURST_SIZE)
+				return wkr;
+		}
+		/* no worker started yet, or all backlogs are full */
+		handle_requests(d);
+		release_all(d);
+	}
+}
+
+/* adds a packet to the backlog of a worker, first passing the backlog to the
+ * worker if it is full; returns the worker the packet was added to */
+static unsigned
+add_to_backlog(struct rte_distributor_burst *d, unsigned wkr,
+		struct rte_mbuf *mb, uint32_t tag)
+{
+	struct rte_distributor_burst_worker *w;
+	uint32_t match;
+
+	for (;;) {
+		w = &d->workers[wkr];
+		/* the worker shut down while we waited for it, its backlog
+		 * may have moved the flow to another worker */
+		if (unlikely(!w->active)) {
+			match = 0;
+			find_match(d, &tag, 1, &match);
+			wkr = (match != 0) ? match - 1 : next_worker(d);
+		} else if (w->count < RTE_DIST_BURST_SIZE)
+			break;
+		else if (w->ready)
+			release(d, wkr);
+		else
+			handle_requests(d);
+	}
+
+	w->backlog[w->count] = ((int64_t)(uintptr_t)mb) <<
+			RTE_DISTRIB_FLAG_BITS;
+	w->tags[RTE_DIST_BURST_SIZE + w->count] = tag;
+	w->count++;
+	return wkr;
+}
+
+/* process a set of packets to distribute them to workers */
+int
+rte_distributor_burst_process(struct rte_distributor_burst *d,
+		struct rte_mbuf **mbufs, unsigned num_mbufs)
+{
+	uint32_t tags[RTE_DIST_BURST_SIZE];
+	uint32_t match[RTE_DIST_BURST_SIZE];
+	unsigned next_idx, i, j, n, wkr, added, req, shutdowns;
+
+	req = handle_requests(d);
+	if (unlikely(num_mbufs == 0)) {
+		release_all(d);
+		return req;
+	}
+
+	for (next_idx = 0; next_idx < num_mbufs; next_idx += n) {
+		n = RTE_MIN(num_mbufs - next_idx, (unsigned)RTE_DIST_BURST_SIZE);
+
+		/*
+		 * User is advocated to set tag value for each
+		 * mbuf before calling rte_distributor_burst_process.
+		 * User defined tags are used to identify flows,
+		 * or sessions.
+		 */
+		for (i = 0; i < n; i++) {
+			tags[i] = mbufs[next_idx + i]->hash.usr;
+			match[i] = 0;
+		}
+		find_match(d, tags, n, match);
+
+		for (i = 0; i < n; i++) {
+			shutdowns = d->shutdowns;
+			wkr = (match[i] != 0) ? match[i] - 1 : next_worker(d);
+			added = add_to_backlog(d, wkr, mbufs[next_idx + i],
+				tags[i]);
+
+			if (unlikely(d->shutdowns != shutdowns)) {
+				/* the backlog of a worker shutting down was
+				 * distributed again, so the flows of the next
+				 * packets may have moved */
+				for (j = i + 1; j < n; j++)
+					match[j] = 0;
+				find_match(d, &tags[i + 1], n - i - 1,
+					&match[i + 1]);
+			} else if (match[i] == 0)
+				/* the next packets of a new flow follow it */
+				for (j = i + 1; j < n; j++)
+					if (tags[j] == tags[i])
+						match[j] = added + 1;
+		}
+	}
+
+	/* to finish, pass their backlog to the workers that are ready */
+	release_all(d);
+
+	return num_mbufs;
+}
+
+/* return to the caller, packets returned from workers */
+int
+rte_distributor_burst_returned_pkts(struct rte_distributor_burst *d,
+		struct rte_mbuf **mbufs, unsigned max_mbufs)
+{
+	struct rte_distributor_returned_pkts *returns = &d->returns;
+	unsigned retval = (max_mbufs < returns->count) ?
+			max_mbufs : returns->count;
+	unsigned i;
+
+	for (i = 0; i < retval; i++) {
+		unsigned idx = (returns->start + i) & RTE_DISTRIB_RETURNS_MASK;
+		mbufs[i] = returns->mbufs[idx];
+	}
+	returns->start += i;
+	returns->count -= i;
+
+	return retval;
+}
+
+/* return the number of packets in-flight in a distributor, i.e. packets
+ * being workered on or queued up in a backlog. */
+static inline unsigned
+total_outstanding(const struct rte_distributor_burst *d)
+{
+	unsigned wkr, total_outstanding = 0;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		total_outstanding += d->workers[wkr].in_flight +
+			d->workers[wkr].count;
+
+	return total_outstanding;
+}
+
+/* flush the distributor, so that there are no outstanding packets in flight or
+ * queued up. */
+int
+rte_distributor_burst_flush(struct rte_distributor_burst *d)
+{
+	const unsigned flushed = total_outstanding(d);
+
+	while (total_outstanding(d) > 0)
+		rte_distributor_burst_process(d, NULL, 0);
+
+	return flushed;
+}
+
+/* clears the internal returns array in the distributor */
+void
+rte_distributor_burst_clear_returns(struct rte_distributor_burst *d)
+{
+	d->returns.start = d->returns.count = 0;
+#ifndef __OPTIMIZE__
+	memset(d->returns.mbufs, 0, sizeof(d->returns.mbufs));
+#endif
+}
+
+/* creates a burst distributor instance */
+struct rte_distributor_burst *
+rte_distributor_burst_create(const char *name,
+		unsigned socket_id,
+		unsigned num_workers)
+{
+	struct rte_distributor_burst *d;
+	struct rte_distributor_burst_list *distributor_list;
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	const struct rte_memzone *mz;
+	size_t sz;
+
+	/* compilation-time checks */
+	RTE_BUILD_BUG_ON((sizeof(*d) & RTE_CACHE_LINE_MASK) != 0);
+	RTE_BUILD_BUG_ON(RTE_DIST_BURST_SIZE != 8);
+
+	if (name == NULL || num_workers == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* the state of the workers and their buffers follow the instance */
+	sz = sizeof(*d) + num_workers *
+		(sizeof(d->workers[0]) + sizeof(d->bufs[0]));
+
+	snprintf(mz_name, sizeof(mz_name), RTE_DISTRIB_BURST_PREFIX"%s", name);
+	mz = rte_memzone_reserve(mz_name, sz, socket_id, NO_FLAGS);
+	if (mz == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	d = mz->addr;
+	memset(d, 0, sz);
+	snprintf(d->name, sizeof(d->name), "%s", name);
+	d->num_workers = num_workers;
+	d->workers = (struct rte_distributor_burst_worker *)(d + 1);
+	d->bufs = (struct rte_distributor_burst_buffer *)
+		(d->workers + num_workers);
+
+	distributor_list = RTE_TAILQ_CAST(rte_distributor_burst_tailq.head,
+					  rte_distributor_burst_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_INSERT_TAIL(distributor_list, d, next);
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return d;
+}
@@ -0,0 +1,258 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_DISTRIBUTOR_BURST_H_
+#define _RTE_DISTRIBUTOR_BURST_H_
+
+/**
+ * @file
+ * RTE burst distributor
+ *
+ * The burst distributor passes packets to workers in bursts of up to
+ * RTE_DIST_BURST_SIZE packets per cache line exchange, with the same flow
+ * affinity and dynamic load balancing as the distributor of
+ * rte_distributor.h: no two packets with the same tag are processed at the
+ * same time. The tags in flight are compared with vector instructions, and
+ * the number of workers is not limited by the size of a bitmask.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of packets passed to or from a worker at once. */
+#define RTE_DIST_BURST_SIZE 8
+
+struct rte_distributor_burst;
+struct rte_mbuf;
+
+/**
+ * Function to create a new burst distributor instance
+ *
+ * Reserves the memory needed for the distributor operation and
+ * initializes the distributor to work with the configured number of workers.
+ *
+ * @param name
+ *   The name to be given to the distributor instance.
+ * @param socket_id
+ *   The NUMA node on which the memory is to be allocated
+ * @param num_workers
+ *   The maximum number of workers that will request packets from this
+ *   distributor
+ * @return
+ *   The newly created distributor instance, or NULL with rte_errno set:
+ *   - EINVAL: invalid name or number of workers
+ *   - ENOMEM: the memory could not be reserved
+ */
+struct rte_distributor_burst *
+rte_distributor_burst_create(const char *name, unsigned socket_id,
+		unsigned num_workers);
+
+/*  *** APIS to be called on the distributor lcore ***  */
+/*
+ * As for the single packet distributor, these functions are designed for use
+ * on a single lcore, which cannot also be a worker of the same instance.
+ */
+
+/**
+ * Process a set of packets by distributing them among workers that request
+ * packets. The distributor will ensure that no two packets that have the
+ * same flow id, or tag, in the mbuf will be processed at the same time.
+ *
+ * The packets with a tag in flight are queued for the worker processing it,
+ * the others go to the workers in turn. The packets queued for a worker
+ * are passed to it at once, as soon as it requests packets.
+ *
+ * This is not multi-thread safe and should only be called on a single lcore.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param mbufs
+ *   The mbufs to be distributed
+ * @param num_mbufs
+ *   The number of mbufs in the mbufs array
+ * @return
+ *   The number of mbufs processed.
+ */
+int
+rte_distributor_burst_process(struct rte_distributor_burst *d,
+		struct rte_mbuf **mbufs, unsigned num_mbufs);
+
+/**
+ * Get a set of mbufs that have been returned to the distributor by workers
+ *
+ * This should only be called on the same lcore as
+ * rte_distributor_burst_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param mbufs
+ *   The mbufs pointer array to be filled in
+ * @param max_mbufs
+ *   The size of the mbufs array
+ * @return
+ *   The number of mbufs returned in the mbufs array.
+ */
+int
+rte_distributor_burst_returned_pkts(struct rte_distributor_burst *d,
+		struct rte_mbuf **mbufs, unsigned max_mbufs);
+
+/**
+ * Flush the distributor component, so that there are no in-flight or
+ * backlogged packets awaiting processing
+ *
+ * This should only be called on the same lcore as
+ * rte_distributor_burst_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @return
+ *   The number of queued/in-flight packets that were completed by this call.
+ */
+int
+rte_distributor_burst_flush(struct rte_distributor_burst *d);
+
+/**
+ * Clears the array of returned packets used as the source for the
+ * rte_distributor_burst_returned_pkts() API call.
+ *
+ * This should only be called on the same lcore as
+ * rte_distributor_burst_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ */
+void
+rte_distributor_burst_clear_returns(struct rte_distributor_burst *d);
+
+/*  *** APIS to be called on the worker lcores ***  */
+/*
+ * Each worker lcore uses a unique worker id. A worker processes all the
+ * packets of a burst before requesting the next one: requesting packets
+ * marks all the packets previously given to the worker as completed.
+ */
+
+/**
+ * API called by a worker to get a new burst of packets to process. All the
+ * packets previously given to the worker are assumed to have completed
+ * processing, and may be optionally returned to the distributor via the
+ * oldpkt parameter.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   An array of RTE_DIST_BURST_SIZE entries, filled with the new packets.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param retcount
+ *   The number of packets in oldpkt, at most RTE_DIST_BURST_SIZE.
+ * @return
+ *   The number of new packets in pkts, at least one.
+ */
+int
+rte_distributor_burst_get_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount);
+
+/**
+ * API called by a worker to return completed packets without requesting
+ * new packets, for example, because a worker thread is shutting down
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets being processed by the worker
+ * @param num
+ *   The number of packets in oldpkt, at most RTE_DIST_BURST_SIZE.
+ */
+int
+rte_distributor_burst_return_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num);
+
+/**
+ * API called by a worker to request a new burst of packets to process.
+ * All the packets previously given to the worker are assumed to have
+ * completed processing, and may be optionally returned to the distributor
+ * via the oldpkt parameter.
+ * Unlike rte_distributor_burst_get_pkt(), this function does not wait for
+ * new packets to be provided by the distributor.
+ *
+ * NOTE: after calling this function, rte_distributor_burst_poll_pkt() should
+ * be used to poll for the packets requested, until it returns them.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param count
+ *   The number of packets in oldpkt, at most RTE_DIST_BURST_SIZE.
+ */
+void
+rte_distributor_burst_request_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count);
+
+/**
+ * API called by a worker to check for new packets that were previously
+ * requested by a call to rte_distributor_burst_request_pkt(). It does not
+ * wait for the new packets to be available, but returns 0 if the request
+ * has not yet been fulfilled by the distributor.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   An array of RTE_DIST_BURST_SIZE entries, filled with the new packets.
+ *
+ * @return
+ *   The number of new packets in pkts, or 0 if no packet is yet available.
+ */
+int
+rte_distributor_burst_poll_pkt(struct rte_distributor_burst *d,
+		unsigned worker_id, struct rte_mbuf **pkts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
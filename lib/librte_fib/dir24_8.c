@@ -0,0 +1,489 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_log.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_atomic.h>
+#include <rte_prefetch.h>
+
+#include <rte_rib.h>
+#include "rte_fib.h"
+#include "dir24_8.h"
+
+#define RTE_LOGTYPE_FIB RTE_LOGTYPE_USER1
+
+#define DIR24_8_TBL24_NUM_ENT		(1 << 24)
+#define DIR24_8_TBL8_GRP_NUM_ENT	256U
+#define DIR24_8_EXT_ENT			1
+
+/*
+ * Table entries are 1, 2, 4 or 8 bytes wide. The least significant bit of
+ * a tbl24 entry tells whether it holds a next hop or the index of a tbl8
+ * group, in the other bits.
+ */
+struct dir24_8_tbl {
+	uint32_t number_tbl8s;     /* Total number of tbl8 groups. */
+	uint32_t rsvd_tbl8s;       /* Number of reserved tbl8 groups. */
+	uint32_t tbl8_free_count;  /* Number of free tbl8 groups. */
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	uint64_t def_nh;
+	void *tbl8;
+	uint32_t *tbl8_free;       /* Stack of free tbl8 group indexes. */
+	uint64_t tbl24[0] __rte_cache_aligned;
+};
+
+static inline uint64_t
+get_max_nh(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	return (UINT64_C(1) << ((8 << nh_sz) - 1)) - 1;
+}
+
+static inline void *
+get_tbl24_p(struct dir24_8_tbl *dp, uint32_t ip, uint8_t nh_sz)
+{
+	return (void *)&((uint8_t *)dp->tbl24)[(ip >> 8) << nh_sz];
+}
+
+static inline uint64_t
+get_entry(const void *tbl, uint64_t idx, enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return ((const uint8_t *)tbl)[idx];
+	case RTE_FIB_DIR24_8_2B:
+		return ((const uint16_t *)tbl)[idx];
+	case RTE_FIB_DIR24_8_4B:
+		return ((const uint32_t *)tbl)[idx];
+	default:
+		return ((const uint64_t *)tbl)[idx];
+	}
+}
+
+/* Each entry is written with a single store of its own width. */
+static inline void
+set_entries(void *tbl, uint64_t idx, uint64_t val,
+	enum rte_fib_dir24_8_nh_sz nh_sz, uint64_t n)
+{
+	uint64_t i;
+
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		for (i = 0; i < n; i++)
+			((uint8_t *)tbl)[idx + i] = (uint8_t)val;
+		break;
+	case RTE_FIB_DIR24_8_2B:
+		for (i = 0; i < n; i++)
+			((uint16_t *)tbl)[idx + i] = (uint16_t)val;
+		break;
+	case RTE_FIB_DIR24_8_4B:
+		for (i = 0; i < n; i++)
+			((uint32_t *)tbl)[idx + i] = (uint32_t)val;
+		break;
+	default:
+		for (i = 0; i < n; i++)
+			((uint64_t *)tbl)[idx + i] = val;
+		break;
+	}
+}
+
+#define LOOKUP_FUNC(suffix, type, bulk_prefetch, nh_sz)			\
+static void								\
+dir24_8_lookup_bulk_##suffix(void *p, const uint32_t *ips,		\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;		\
+	uint64_t tmp;							\
+	uint32_t i;							\
+	uint32_t prefetch_offset =					\
+		RTE_MIN((unsigned int)bulk_prefetch, n);		\
+									\
+	for (i = 0; i < prefetch_offset; i++)				\
+		rte_prefetch0(get_tbl24_p(dp, ips[i], nh_sz));		\
+	for (i = 0; i < (n - prefetch_offset); i++) {			\
+		rte_prefetch0(get_tbl24_p(dp,				\
+			ips[i + prefetch_offset], nh_sz));		\
+		tmp = ((type *)dp->tbl24)[ips[i] >> 8];			\
+		if (unlikely((tmp & DIR24_8_EXT_ENT) ==			\
+				DIR24_8_EXT_ENT))			\
+			tmp = ((type *)dp->tbl8)[(uint8_t)ips[i] +	\
+				((tmp >> 1) * DIR24_8_TBL8_GRP_NUM_ENT)]; \
+		next_hops[i] = tmp >> 1;				\
+	}								\
+	for (; i < n; i++) {						\
+		tmp = ((type *)dp->tbl24)[ips[i] >> 8];			\
+		if (unlikely((tmp & DIR24_8_EXT_ENT) ==			\
+				DIR24_8_EXT_ENT))			\
+			tmp = ((type *)dp->tbl8)[(uint8_t)ips[i] +	\
+				((tmp >> 1) * DIR24_8_TBL8_GRP_NUM_ENT)]; \
+		next_hops[i] = tmp >> 1;				\
+	}								\
+}
+
+LOOKUP_FUNC(1b, uint8_t, 5, RTE_FIB_DIR24_8_1B)
+LOOKUP_FUNC(2b, uint16_t, 6, RTE_FIB_DIR24_8_2B)
+LOOKUP_FUNC(4b, uint32_t, 15, RTE_FIB_DIR24_8_4B)
+LOOKUP_FUNC(8b, uint64_t, 12, RTE_FIB_DIR24_8_8B)
+
+rte_fib_lookup_fn_t
+dir24_8_get_lookup_fn(struct rte_fib_conf *conf)
+{
+	switch (conf->dir24_8.nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+/*
+ * Allocate a tbl8 group and fill it with the tbl24 entry it replaces, so
+ * that the lookups see the same next hops once it is linked.
+ */
+static int64_t
+tbl8_alloc(struct dir24_8_tbl *dp, uint64_t tbl24_ent)
+{
+	uint64_t tbl8_idx;
+
+	if (dp->tbl8_free_count == 0)
+		return -ENOSPC;
+
+	tbl8_idx = dp->tbl8_free[--dp->tbl8_free_count];
+	set_entries(dp->tbl8, tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT,
+			tbl24_ent | DIR24_8_EXT_ENT, dp->nh_sz,
+			DIR24_8_TBL8_GRP_NUM_ENT);
+	return tbl8_idx;
+}
+
+/* Replace a tbl8 group holding a single next hop by a tbl24 entry. */
+static void
+tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
+{
+	uint64_t base = tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT;
+	uint64_t nh;
+	uint32_t i;
+
+	nh = get_entry(dp->tbl8, base, dp->nh_sz);
+	for (i = 1; i < DIR24_8_TBL8_GRP_NUM_ENT; i++) {
+		if (get_entry(dp->tbl8, base + i, dp->nh_sz) != nh)
+			return;
+	}
+
+	set_entries(dp->tbl24, ip >> 8, nh & ~(uint64_t)DIR24_8_EXT_ENT,
+			dp->nh_sz, 1);
+	dp->tbl8_free[dp->tbl8_free_count++] = tbl8_idx;
+}
+
+/* Set n next hops of a /24, starting at ip, in its tbl8 group. */
+static int
+tbl8_fill(struct dir24_8_tbl *dp, uint32_t ip, uint32_t n, uint64_t next_hop)
+{
+	uint64_t tbl24_ent;
+	int64_t tbl8_idx;
+
+	tbl24_ent = get_entry(dp->tbl24, ip >> 8, dp->nh_sz);
+	if ((tbl24_ent & DIR24_8_EXT_ENT) != DIR24_8_EXT_ENT) {
+		tbl8_idx = tbl8_alloc(dp, tbl24_ent);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		/* The group must be filled before it is linked. */
+		rte_wmb();
+		set_entries(dp->tbl24, ip >> 8,
+				(tbl8_idx << 1) | DIR24_8_EXT_ENT, dp->nh_sz, 1);
+	} else
+		tbl8_idx = tbl24_ent >> 1;
+
+	set_entries(dp->tbl8, tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT + (ip & 0xff),
+			(next_hop << 1) | DIR24_8_EXT_ENT, dp->nh_sz, n);
+	tbl8_recycle(dp, ip, tbl8_idx);
+	return 0;
+}
+
+/*
+ * Set the next hop of the addresses from ledge to redge excluded. The
+ * bounds are 64-bit so that the range may end at 2^32.
+ */
+static int
+install_to_fib(struct dir24_8_tbl *dp, uint64_t ledge, uint64_t redge,
+	uint64_t next_hop)
+{
+	uint64_t l24 = RTE_ALIGN_CEIL(ledge, DIR24_8_TBL8_GRP_NUM_ENT);
+	uint64_t r24 = RTE_ALIGN_FLOOR(redge, DIR24_8_TBL8_GRP_NUM_ENT);
+	int ret;
+
+	/* Range inside a single /24 */
+	if (l24 > r24)
+		return tbl8_fill(dp, ledge, redge - ledge, next_hop);
+
+	if (ledge != l24) {
+		ret = tbl8_fill(dp, ledge, l24 - ledge, next_hop);
+		if (ret != 0)
+			return ret;
+	}
+	if (r24 != l24)
+		set_entries(dp->tbl24, l24 >> 8, next_hop << 1, dp->nh_sz,
+				(r24 - l24) >> 8);
+	if (redge != r24)
+		return tbl8_fill(dp, r24, redge - r24, next_hop);
+	return 0;
+}
+
+/*
+ * Set the next hop of ip/depth, except for the parts covered by more
+ * specific routes, which are skipped in increasing address order.
+ */
+static int
+modify_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib_node *tmp = NULL;
+	uint64_t ledge, redge;
+	uint32_t tmp_ip = 0;
+	uint8_t tmp_depth = 0;
+	int ret;
+
+	ledge = ip;
+	do {
+		tmp = rte_rib_get_nxt(rib, ip, depth, tmp,
+				RTE_RIB_GET_NXT_COVER);
+		if (tmp != NULL) {
+			rte_rib_get_ip(tmp, &tmp_ip);
+			rte_rib_get_depth(tmp, &tmp_depth);
+			redge = tmp_ip;
+		} else
+			redge = (uint64_t)ip + (UINT64_C(1) << (32 - depth));
+
+		if (ledge != redge) {
+			ret = install_to_fib(dp, ledge, redge, next_hop);
+			if (ret != 0)
+				return ret;
+		}
+		if (tmp != NULL)
+			ledge = (uint64_t)tmp_ip +
+				(UINT64_C(1) << (32 - tmp_depth));
+	} while (tmp != NULL);
+
+	return 0;
+}
+
+/* Whether the /24 of ip holds routes longer than 24 bits. */
+static inline int
+has_tbl8_routes(struct rte_rib *rib, uint32_t ip)
+{
+	return rte_rib_get_nxt(rib, ip, 24, NULL,
+			RTE_RIB_GET_NXT_COVER) != NULL;
+}
+
+int
+dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	struct dir24_8_tbl *dp;
+	struct rte_rib *rib;
+	struct rte_rib_node *node, *parent;
+	uint64_t par_nh, node_nh;
+	int reserve = 0;
+	int ret;
+
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib_get_dp(fib);
+	rib = rte_fib_get_rib(fib);
+
+	if (next_hop > get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+	node = rte_rib_lookup_exact(rib, ip, depth);
+
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			if (ret == 0)
+				rte_rib_set_nh(node, next_hop);
+			return ret;
+		}
+
+		/*
+		 * A route longer than 24 bits needs a tbl8 group, unless
+		 * its /24 already has one. Reserving the group here ensures
+		 * that modify_fib() never runs out of groups half way.
+		 */
+		if ((depth > 24) && !has_tbl8_routes(rib, ip)) {
+			if (dp->rsvd_tbl8s >= dp->number_tbl8s)
+				return -ENOSPC;
+			reserve = 1;
+		}
+
+		node = rte_rib_insert(rib, ip, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib_set_nh(node, next_hop);
+
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != next_hop) {
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			if (ret != 0) {
+				rte_rib_remove(rib, ip, depth);
+				return ret;
+			}
+		}
+		dp->rsvd_tbl8s += reserve;
+		return 0;
+
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		rte_rib_get_nh(node, &node_nh);
+		if (par_nh != node_nh) {
+			ret = modify_fib(dp, rib, ip, depth, par_nh);
+			if (ret != 0)
+				return ret;
+		}
+
+		rte_rib_remove(rib, ip, depth);
+		if ((depth > 24) && !has_tbl8_routes(rib, ip))
+			dp->rsvd_tbl8s--;
+		return 0;
+
+	default:
+		break;
+	}
+
+	return -EINVAL;
+}
+
+void *
+dir24_8_create(const char *name, int socket_id, struct rte_fib_conf *conf)
+{
+	char mem_name[RTE_FIB_NAMESIZE];
+	struct dir24_8_tbl *dp;
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	uint64_t def_nh;
+	uint32_t num_tbl8, i;
+
+	if ((name == NULL) || (conf == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	nh_sz = conf->dir24_8.nh_sz;
+	num_tbl8 = conf->dir24_8.num_tbl8;
+	def_nh = conf->default_nh;
+
+	/* The group index is stored in an entry, like a next hop. */
+	if ((nh_sz < RTE_FIB_DIR24_8_1B) || (nh_sz > RTE_FIB_DIR24_8_8B) ||
+			(num_tbl8 == 0) || (num_tbl8 - 1 > get_max_nh(nh_sz)) ||
+			(def_nh > get_max_nh(nh_sz))) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "DP_%s", name);
+	dp = rte_zmalloc_socket(mem_name, sizeof(struct dir24_8_tbl) +
+			((uint64_t)DIR24_8_TBL24_NUM_ENT << nh_sz),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	dp->tbl8 = rte_zmalloc_socket(NULL,
+			((uint64_t)DIR24_8_TBL8_GRP_NUM_ENT * num_tbl8) << nh_sz,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	dp->tbl8_free = rte_zmalloc_socket(NULL,
+			sizeof(uint32_t) * num_tbl8, 0, socket_id);
+	if ((dp->tbl8 == NULL) || (dp->tbl8_free == NULL)) {
+		RTE_LOG(ERR, FIB, "FIB tbl8 memory allocation failed\n");
+		rte_free(dp->tbl8);
+		rte_free(dp->tbl8_free);
+		rte_free(dp);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	if (def_nh != 0)
+		set_entries(dp->tbl24, 0, def_nh << 1, nh_sz,
+				DIR24_8_TBL24_NUM_ENT);
+
+	dp->nh_sz = nh_sz;
+	dp->def_nh = def_nh;
+	dp->number_tbl8s = num_tbl8;
+
+	/* The lowest group indexes are allocated first. */
+	for (i = 0; i < num_tbl8; i++)
+		dp->tbl8_free[i] = num_tbl8 - 1 - i;
+	dp->tbl8_free_count = num_tbl8;
+
+	return dp;
+}
+
+void
+dir24_8_free(void *p)
+{
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
+
+	if (dp == NULL)
+		return;
+	rte_free(dp->tbl8_free);
+	rte_free(dp->tbl8);
+	rte_free(dp);
+}
@@ -0,0 +1,238 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_FIB_H_
+#define _RTE_FIB_H_
+
+/**
+ * @file
+ * RTE Forwarding Information Base (FIB)
+ *
+ * IPv4 longest prefix match table split in two parts:
+ *  - a RIB (see rte_rib.h) holding the routes for the control plane, where
+ *    routes are added and deleted in a time independent of the number of
+ *    routes,
+ *  - a data plane structure, built incrementally from the RIB, which is
+ *    only used for lookups. Its algorithm is chosen when the FIB is
+ *    created.
+ *
+ * The routes are updated by a single thread at a time.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of characters in FIB name. */
+#define RTE_FIB_NAMESIZE	32
+
+/** Maximum depth value possible for IPv4 FIB. */
+#define RTE_FIB_MAXDEPTH	32
+
+struct rte_fib;
+struct rte_rib;
+
+/** Type of the data plane structure. */
+enum rte_fib_type {
+	/** No data plane structure, lookups walk the RIB. */
+	RTE_FIB_DUMMY,
+	/** DIR-24-8 table, see the LPM library. */
+	RTE_FIB_DIR24_8,
+	RTE_FIB_TYPE_MAX
+};
+
+/** Operation passed to rte_fib_modify_fn_t. */
+enum rte_fib_op {
+	RTE_FIB_ADD,
+	RTE_FIB_DEL,
+};
+
+/** Size of the next hops stored in a DIR-24-8 table. */
+enum rte_fib_dir24_8_nh_sz {
+	RTE_FIB_DIR24_8_1B,  /**< 7-bit next hops */
+	RTE_FIB_DIR24_8_2B,  /**< 15-bit next hops */
+	RTE_FIB_DIR24_8_4B,  /**< 31-bit next hops */
+	RTE_FIB_DIR24_8_8B   /**< 63-bit next hops */
+};
+
+/** Data plane bulk lookup function. */
+typedef void (*rte_fib_lookup_fn_t)(void *dp, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n);
+
+/** Data plane update function, called for each route change. */
+typedef int (*rte_fib_modify_fn_t)(struct rte_fib *fib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop, int op);
+
+/** FIB configuration structure */
+struct rte_fib_conf {
+	enum rte_fib_type type;
+	/** Next hop returned when no route matches. */
+	uint64_t default_nh;
+	/** Maximum number of routes. */
+	uint32_t max_routes;
+	/** DIR-24-8 parameters, used if type is RTE_FIB_DIR24_8. */
+	struct {
+		enum rte_fib_dir24_8_nh_sz nh_sz;
+		/** Number of tbl8 groups, one is needed per /24 holding
+		 *  routes longer than 24 bits. */
+		uint32_t num_tbl8;
+	} dir24_8;
+};
+
+/**
+ * Create a FIB object.
+ *
+ * @param name
+ *   FIB name.
+ * @param socket_id
+ *   NUMA socket ID for the FIB memory allocation.
+ * @param conf
+ *   Structure containing the configuration.
+ * @return
+ *   Handle to the FIB object on success, NULL otherwise with rte_errno set
+ *   to an appropriate value:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - a FIB with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+struct rte_fib *
+rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf);
+
+/**
+ * Find an existing FIB object and return a pointer to it.
+ *
+ * @param name
+ *   Name of the FIB object as passed to rte_fib_create().
+ * @return
+ *   Pointer to the FIB object, NULL with rte_errno set to ENOENT if it
+ *   was not found.
+ */
+struct rte_fib *
+rte_fib_find_existing(const char *name);
+
+/**
+ * Free a FIB object.
+ *
+ * @param fib
+ *   FIB object handle.
+ */
+void
+rte_fib_free(struct rte_fib *fib);
+
+/**
+ * Add a route, or change the next hop of an existing route.
+ *
+ * @param fib
+ *   FIB object handle.
+ * @param ip
+ *   Prefix of the route, in host byte order.
+ * @param depth
+ *   Depth of the route, from 0 to 32.
+ * @param next_hop
+ *   Next hop of the route. It must fit in the configured next hop size.
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOSPC - no more room for routes or tbl8 groups
+ */
+int
+rte_fib_add(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop);
+
+/**
+ * Delete a route.
+ *
+ * @param fib
+ *   FIB object handle.
+ * @param ip
+ *   Prefix of the route, in host byte order.
+ * @param depth
+ *   Depth of the route, from 0 to 32.
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -ENOENT - the route does not exist
+ */
+int
+rte_fib_delete(struct rte_fib *fib, uint32_t ip, uint8_t depth);
+
+/**
+ * Look up multiple IP addresses.
+ *
+ * @param fib
+ *   FIB object handle.
+ * @param ips
+ *   Array of IPs to be looked up, in host byte order.
+ * @param next_hops
+ *   Next hop of the most specific route matching each IP, or the default
+ *   next hop.
+ * @param n
+ *   Number of elements in the ips and next_hops arrays.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_fib_lookup_bulk(struct rte_fib *fib, const uint32_t *ips,
+	uint64_t *next_hops, int n);
+
+/**
+ * Get the data plane structure of a FIB.
+ *
+ * @param fib
+ *   FIB object handle.
+ * @return
+ *   Pointer to the data plane structure, to be passed to the lookup
+ *   function of the FIB type.
+ */
+void *
+rte_fib_get_dp(struct rte_fib *fib);
+
+/**
+ * Get the RIB of a FIB.
+ *
+ * @param fib
+ *   FIB object handle.
+ * @return
+ *   Pointer to the RIB holding the routes. It must not be modified
+ *   directly.
+ */
+struct rte_rib *
+rte_fib_get_rib(struct rte_fib *fib);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_FIB_H_ */
@@ -34,6 +34,11 @@
 #ifndef _IP_FRAG_COMMON_H_
 #define _IP_FRAG_COMMON_H_
 
+#include <errno.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
 #include "rte_ip_frag.h"
 
 /* logging macros. */
@@ -54,9 +59,16 @@ if (!(exp))	{							\
 #define IPV4_KEYLEN 1
 #define IPV6_KEYLEN 4
 
+/* table flags */
+#define	IP_FRAG_TBL_SHARED	0x1 /**< table shared by several lcores. */
+
 /* helper macros */
 #define	IP_FRAG_MBUF2DR(dr, mb)	((dr)->row[(dr)->cnt++] = (mb))
 
+/* check that the death row can hold the fragments of one more entry */
+#define	IP_FRAG_DR_HAS_ROOM(dr)	\
+	((dr)->cnt + IP_MAX_FRAG_NUM <= RTE_DIM((dr)->row))
+
 #define IPv6_KEY_BYTES(key) \
 	(key)[0], (key)[1], (key)[2], (key)[3]
 #define IPv6_KEY_BYTES_FMT \
@@ -75,6 +87,17 @@ struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	const struct ip_frag_key *key, uint64_t tms,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
 
+uint32_t ip_frag_expire(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms);
+
+uint32_t ip_frag_expire_shared(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms);
+
+struct rte_mbuf * ip_frag_process_shared(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
+		const struct ip_frag_key *key, uint64_t tms,
+		uint16_t ofs, uint16_t len, uint16_t more_frags);
+
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf * ipv4_frag_reassemble(const struct ip_frag_pkt *fp);
 struct rte_mbuf * ipv6_frag_reassemble(const struct ip_frag_pkt *fp);
@@ -106,10 +129,11 @@ ip_frag_key_invalidate(struct ip_frag_key * key)
 }
 
 /* compare two keys */
-static inline int
+static inline uint64_t
 ip_frag_key_cmp(const struct ip_frag_key * k1, const struct ip_frag_key * k2)
 {
-	uint32_t i, val;
+	uint32_t i;
+	uint64_t val;
 	val = k1->id ^ k2->id;
 	for (i = 0; i < k1->key_len; i++)
 		val |= k1->src_dst[i] ^ k2->src_dst[i];
@@ -188,5 +212,142 @@ ip_frag_chain(struct rte_mbuf *mn, struct rte_mbuf *mp)
 	mp->nb_segs = 1;
 }
 
+/*
+ * misc burst fragmentation functions
+ */
+
+#define	IP_FRAG_BULK_SZ	64 /**< mbufs allocated at once when fragmenting. */
+
+/* mbufs allocated in bulk for the fragments of a burst */
+struct ip_frag_mbuf_cache {
+	struct rte_mempool *mp;  /**< pool to allocate from. */
+	uint32_t left;           /**< mbufs still needed by the burst. */
+	uint32_t cnt;            /**< mbufs available in the cache. */
+	struct rte_mbuf *mbufs[IP_FRAG_BULK_SZ]; /**< available mbufs. */
+};
+
+static inline void
+ip_frag_mbuf_cache_init(struct ip_frag_mbuf_cache *c, struct rte_mempool *mp)
+{
+	c->mp = mp;
+	c->left = 0;
+	c->cnt = 0;
+}
+
+/* get an mbuf, refilling the cache with the mbufs the burst still needs */
+static inline struct rte_mbuf *
+ip_frag_mbuf_cache_get(struct ip_frag_mbuf_cache *c)
+{
+	struct rte_mbuf *m;
+	uint32_t n;
+
+	if (c->cnt == 0) {
+		n = RTE_MAX(RTE_MIN(c->left, (uint32_t)IP_FRAG_BULK_SZ), 1U);
+		if (rte_mempool_get_bulk(c->mp, (void **)c->mbufs, n) != 0)
+			return NULL;
+		c->cnt = n;
+		c->left -= RTE_MIN(c->left, n);
+	}
+
+	m = c->mbufs[--c->cnt];
+	RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
+	rte_mbuf_refcnt_set(m, 1);
+	rte_pktmbuf_reset(m);
+	return m;
+}
+
+/* give back the mbufs left unused by the burst */
+static inline void
+ip_frag_mbuf_cache_flush(struct ip_frag_mbuf_cache *c)
+{
+	if (c->cnt != 0)
+		rte_mempool_put_bulk(c->mp, (void **)c->mbufs, c->cnt);
+	c->cnt = 0;
+}
+
+/*
+ * Number of indirect mbufs needed to attach the payload of a packet,
+ * from offset ofs, to fragments of frag_size bytes of payload:
+ * a piece per fragment and input segment they overlap.
+ */
+static inline uint32_t
+ip_frag_nb_pieces(const struct rte_mbuf *pkt, uint32_t hdr_len,
+	uint32_t ofs, uint32_t frag_size)
+{
+	const struct rte_mbuf *seg;
+	uint32_t n, base, start, end;
+
+	n = 0;
+	base = 0;
+	for (seg = pkt; seg != NULL; seg = seg->next) {
+		end = base + seg->data_len;
+		if (seg == pkt)
+			end -= hdr_len;
+		start = RTE_MAX(base, ofs);
+		if (end > start)
+			n += (end - 1) / frag_size - start / frag_size + 1;
+		base = end;
+	}
+
+	return n;
+}
+
+/*
+ * Chain indirect mbufs attached to len bytes of the input packet to
+ * the fragment out_pkt, from segment *in_seg at offset *in_pos.
+ */
+static inline int
+ip_frag_attach_payload(struct rte_mbuf *out_pkt, struct ip_frag_mbuf_cache *c,
+	struct rte_mbuf **in_seg, uint32_t *in_pos, uint32_t len)
+{
+	struct rte_mbuf *out_seg, *prev, *seg;
+	uint32_t pos, l;
+
+	prev = out_pkt;
+	seg = *in_seg;
+	pos = *in_pos;
+
+	while (len != 0) {
+
+		/* skip the consumed (or empty) input segments */
+		while (pos == seg->data_len) {
+			seg = seg->next;
+			pos = 0;
+		}
+
+		out_seg = ip_frag_mbuf_cache_get(c);
+		if (unlikely(out_seg == NULL))
+			return -ENOMEM;
+
+		rte_pktmbuf_attach(out_seg, seg);
+		l = RTE_MIN(len, seg->data_len - pos);
+		out_seg->data_off = (uint16_t)(seg->data_off + pos);
+		out_seg->data_len = (uint16_t)l;
+
+		prev->next = out_seg;
+		prev = out_seg;
+		out_pkt->pkt_len += l;
+		out_pkt->nb_segs++;
+
+		pos += l;
+		len -= l;
+	}
+
+	*in_seg = seg;
+	*in_pos = pos;
+	return 0;
+}
+
+/*
+ * Whether the input packet can be reused as its first fragment:
+ * it has to be the only user of its one, direct, segment.
+ */
+static inline uint32_t
+ip_frag_in_place(const struct rte_mbuf *pkt, uint32_t flags)
+{
+	return (flags & RTE_IP_FRAG_F_IN_PLACE) != 0 &&
+		RTE_MBUF_DIRECT(pkt) && pkt->next == NULL &&
+		rte_mbuf_refcnt_read(pkt) == 1;
+}
 
 #endif /* _IP_FRAG_COMMON_H_ */
@@ -33,6 +33,7 @@
 
 #include <stddef.h>
 
+#include <rte_atomic.h>
 #include <rte_jhash.h>
 #ifdef RTE_MACHINE_CPUFLAG_SSE4_2
 #include <rte_hash_crc.h>
@@ -45,10 +46,20 @@
 #define	IP_FRAG_TBL_POS(tbl, sig)	\
 	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
 
+#define	IP_FRAG_TBL_LOCK(tbl, sig)	\
+	((tbl)->locks + ((sig) & (tbl)->entry_mask) / (tbl)->bucket_entries)
+
+/* entries in use of a shared table, updated atomically. */
+#define	IP_FRAG_TBL_USE_ENTRIES(tbl)	\
+	((rte_atomic32_t *)&(tbl)->use_entries)
+
 #ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
+#define	IP_FRAG_TBL_STAT_UPDATE_SHARED(s, f, v)	\
+	rte_atomic64_add((rte_atomic64_t *)&(s)->f, (v))
 #else
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
+#define	IP_FRAG_TBL_STAT_UPDATE_SHARED(s, f, v)	do {} while (0)
 #endif /* IP_FRAG_TBL_STAT */
 
 /* local frag table helper functions */
@@ -136,6 +147,16 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	*v2 = (v << 7) + (v >> 14);
 }
 
+/* different hashing methods for IPv4 and IPv6 */
+static inline void
+ip_frag_key_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+{
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(key, v1, v2);
+	else
+		ipv6_frag_hash(key, v1, v2);
+}
+
 struct rte_mbuf *
 ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
@@ -330,15 +351,19 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	return pkt;
 }
 
-struct ip_frag_pkt *
-ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
+/*
+ * Look for the key in its two buckets, and for the first free and
+ * timed-out entries in them.
+ */
+static inline struct ip_frag_pkt *
+ip_frag_bucket_lookup(struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint64_t tms, uint32_t sig1, uint32_t sig2,
 	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
 	struct ip_frag_pkt *p1, *p2;
 	struct ip_frag_pkt *empty, *old;
 	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
+	uint32_t i, assoc;
 
 	empty = NULL;
 	old = NULL;
@@ -346,15 +371,6 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	max_cycles = tbl->max_cycles;
 	assoc = tbl->bucket_entries;
 
-	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
-		return tbl->last;
-
-	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
-		ipv4_frag_hash(key, &sig1, &sig2);
-	else
-		ipv6_frag_hash(key, &sig1, &sig2);
-
 	p1 = IP_FRAG_TBL_POS(tbl, sig1);
 	p2 = IP_FRAG_TBL_POS(tbl, sig2);
 
@@ -416,3 +432,184 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	*stale = old;
 	return NULL;
 }
+
+struct ip_frag_pkt *
+ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint64_t tms,
+	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+{
+	uint32_t sig1, sig2;
+
+	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
+		return tbl->last;
+
+	ip_frag_key_hash(key, &sig1, &sig2);
+	return ip_frag_bucket_lookup(tbl, key, tms, sig1, sig2, free, stale);
+}
+
+/*
+ * All the entries have the same TTL, and are appended to the LRU list
+ * when added or reused, so that the list is ordered by expiry time:
+ * expire from its head until an entry is still valid.
+ */
+uint32_t
+ip_frag_expire(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	uint64_t tms)
+{
+	struct ip_frag_pkt *fp;
+	uint64_t max_cycles;
+	uint32_t n;
+
+	max_cycles = tbl->max_cycles;
+	n = 0;
+
+	while ((fp = TAILQ_FIRST(&tbl->lru)) != NULL &&
+			max_cycles + fp->start < tms &&
+			IP_FRAG_DR_HAS_ROOM(dr)) {
+		if (tbl->last == fp)
+			tbl->last = NULL;
+		ip_frag_tbl_del(tbl, dr, fp);
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * A shared table has no LRU list: scan its buckets under their locks,
+ * from where the previous call stopped, until all of them are scanned or
+ * the death row is full.
+ */
+uint32_t
+ip_frag_expire_shared(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms)
+{
+	struct ip_frag_pkt *fp;
+	uint64_t max_cycles;
+	uint32_t i, j, idx, nb_lines, n;
+
+	max_cycles = tbl->max_cycles;
+	nb_lines = tbl->nb_entries / tbl->bucket_entries;
+	idx = tbl->expire_idx % nb_lines;
+	n = 0;
+
+	for (i = 0; i != nb_lines && IP_FRAG_DR_HAS_ROOM(dr); i++) {
+
+		fp = tbl->pkt + idx * tbl->bucket_entries;
+
+		rte_spinlock_lock(tbl->locks + idx);
+		for (j = 0; j != tbl->bucket_entries; j++) {
+			if (ip_frag_key_is_empty(&fp[j].key) ||
+					max_cycles + fp[j].start >= tms)
+				continue;
+			if (!IP_FRAG_DR_HAS_ROOM(dr))
+				break;
+			ip_frag_free(fp + j, dr);
+			ip_frag_key_invalidate(&fp[j].key);
+			rte_atomic32_dec(IP_FRAG_TBL_USE_ENTRIES(tbl));
+			IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, del_num, 1);
+			n++;
+		}
+		rte_spinlock_unlock(tbl->locks + idx);
+
+		/* the bucket is only done with if it was scanned to the end. */
+		if (j != tbl->bucket_entries)
+			break;
+		idx = (idx + 1) % nb_lines;
+	}
+
+	tbl->expire_idx = idx;
+	return n;
+}
+
+/*
+ * Shared table counterpart of ip_frag_find() and ip_frag_process().
+ * Both buckets of the key stay locked while the fragment is processed,
+ * so that the entry is neither reclaimed nor taken by another lcore.
+ * There is no LRU list nor last entry cache to share: only the timed-out
+ * entries of the key's buckets are reclaimed.
+ */
+struct rte_mbuf *
+ip_frag_process_shared(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
+	const struct ip_frag_key *key, uint64_t tms,
+	uint16_t ofs, uint16_t len, uint16_t more_frags)
+{
+	struct ip_frag_pkt *pkt, *free, *stale;
+	rte_spinlock_t *l1, *l2, *lt;
+	uint32_t sig1, sig2;
+
+	free = NULL;
+	stale = NULL;
+
+	ip_frag_key_hash(key, &sig1, &sig2);
+
+	/* take the bucket locks in address order, to avoid deadlocks. */
+	l1 = IP_FRAG_TBL_LOCK(tbl, sig1);
+	l2 = IP_FRAG_TBL_LOCK(tbl, sig2);
+	if (l1 > l2) {
+		lt = l1;
+		l1 = l2;
+		l2 = lt;
+	}
+
+	rte_spinlock_lock(l1);
+	if (l2 != l1)
+		rte_spinlock_lock(l2);
+
+	IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, find_num, 1);
+
+	pkt = ip_frag_bucket_lookup(tbl, key, tms, sig1, sig2, &free, &stale);
+	if (pkt == NULL) {
+
+		/* timed-out entry, free it and take it over. */
+		if (stale != NULL) {
+			ip_frag_free(stale, dr);
+			IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, del_num, 1);
+			pkt = stale;
+
+		/* free entry, reserve it unless the table is full. */
+		} else if (free != NULL) {
+			if ((uint32_t)rte_atomic32_add_return(
+					IP_FRAG_TBL_USE_ENTRIES(tbl), 1) <=
+					tbl->max_entries)
+				pkt = free;
+			else {
+				rte_atomic32_dec(IP_FRAG_TBL_USE_ENTRIES(tbl));
+				IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat,
+					fail_nospace, 1);
+			}
+		}
+
+		if (pkt != NULL) {
+			pkt->key = key[0];
+			ip_frag_reset(pkt, tms);
+			IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, add_num, 1);
+		}
+
+	/* we found the flow, but it is already timed out, reuse it. */
+	} else if (tbl->max_cycles + pkt->start < tms) {
+		ip_frag_free(pkt, dr);
+		ip_frag_reset(pkt, tms);
+		IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, reuse_num, 1);
+	}
+
+	IP_FRAG_TBL_STAT_UPDATE_SHARED(&tbl->stat, fail_total, (pkt == NULL));
+
+	if (pkt == NULL) {
+		IP_FRAG_MBUF2DR(dr, mb);
+		mb = NULL;
+	} else {
+		mb = ip_frag_process(pkt, dr, mb, ofs, len, more_frags);
+
+		/* the datagram is reassembled or dropped, release the entry. */
+		if (ip_frag_key_is_empty(&pkt->key))
+			rte_atomic32_dec(IP_FRAG_TBL_USE_ENTRIES(tbl));
+	}
+
+	if (l2 != l1)
+		rte_spinlock_unlock(l2);
+	rte_spinlock_unlock(l1);
+
+	return mb;
+}
@@ -52,6 +52,7 @@ extern "C" {
 #include <rte_memory.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
+#include <rte_spinlock.h>
 
 struct rte_mbuf;
 
@@ -124,6 +125,9 @@ struct rte_ip_frag_tbl {
 	struct ip_frag_pkt *last;         /**< last used entry. */
 	struct ip_pkt_list lru;           /**< LRU list for table entries. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
+	uint32_t             flags;           /**< table flags. */
+	uint32_t             expire_idx;      /**< next bucket to expire. */
+	rte_spinlock_t      *locks;       /**< per-bucket locks, if shared. */
 	struct ip_frag_pkt pkt[0];        /**< hash table. */
 };
 
@@ -169,6 +173,60 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/*
+ * Create a new IP fragmentation table shared by several lcores.
+ *
+ * The fragments of a datagram may be passed to the reassembly functions
+ * from any lcore, which serialise on a lock per hash bucket. Each lcore
+ * should use its own death row. As the table has no LRU list, the
+ * timed-out entries are reclaimed by the lookups in their buckets or by
+ * periodic rte_ip_frag_table_expire() calls.
+ *
+ * @param bucket_num
+ *   Number of buckets in the hash table.
+ * @param bucket_entries
+ *   Number of entries per bucket (e.g. hash associativity).
+ *   Should be power of two.
+ * @param max_entries
+ *   Maximum number of entries that could be stored in the table.
+ *   The value should be less or equal then bucket_num * bucket_entries.
+ * @param max_cycles
+ *   Maximum TTL in cycles for each fragmented packet.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in the case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA constraints.
+ * @return
+ *   The pointer to the new allocated fragmentation table, on success. NULL on error.
+ */
+struct rte_ip_frag_tbl * rte_ip_frag_table_create_shared(uint32_t bucket_num,
+		uint32_t bucket_entries,  uint32_t max_entries,
+		uint64_t max_cycles, int socket_id);
+
+/*
+ * Expire the entries of an IP fragmentation table older than its TTL,
+ * putting the mbufs of their fragments on the death row.
+ * Lookups only reclaim timed-out entries they come across, so this should
+ * be called periodically, e.g. from an idle loop, to bound the mbufs held
+ * by the table when traffic stops.
+ *
+ * A private table expires its oldest entries first, at the cost of one
+ * list access per expired entry. A shared table scans its buckets, from
+ * where the previous call stopped, at most once.
+ * In both cases, the expiry stops when the death row may not hold the
+ * fragments of one more entry, and should be resumed once it is freed.
+ *
+ * @param tbl
+ *   Fragmentation table to expire entries from.
+ * @param tms
+ *   Current timestamp, in the same unit as the fragment arrival timestamps.
+ * @param dr
+ *   Death row to put the mbufs of the expired entries on.
+ * @return
+ *   Number of expired entries.
+ */
+uint32_t rte_ip_frag_table_expire(struct rte_ip_frag_tbl *tbl, uint64_t tms,
+		struct rte_ip_frag_death_row *dr);
+
 /*
  * Free allocated IP fragmentation table.
  *
@@ -210,6 +268,52 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 		struct rte_mempool *pool_direct,
 		struct rte_mempool *pool_indirect);
 
+/**
+ * IPv6 burst fragmentation.
+ *
+ * This function fragments a burst of IPv6 packets, as
+ * rte_ipv6_fragment_packet() does for each of them, with the mbufs of all
+ * the fragments allocated in bulk, and takes ownership of the input
+ * packets it fragments.
+ * The packets that fit in the MTU are placed in pkts_out unchanged.
+ * The packets are processed in order, until the fragments of one do not
+ * fit in the pkts_out array, or the mbufs run out.
+ *
+ * With the RTE_IP_FRAG_F_IN_PLACE flag, an input packet made of one
+ * direct segment not shared with anyone else, and with room for the
+ * fragment extension header in its headroom, is not attached to a new
+ * fragment, but truncated into its own first fragment, its IPv6 header
+ * being moved into the headroom in front of the fragment header.
+ *
+ * @param pkts_in
+ *   The input packets.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output fragments, in the order of the input packets.
+ * @param nb_pkts_out
+ *   On input, the size of the pkts_out array; on output, the number of
+ *   fragments placed in it.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv6
+ *   datagrams. This value includes the size of the IPv6 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @param flags
+ *   RTE_IP_FRAG_F_* flags. RTE_IP_FRAG_F_IP_CKSUM has no effect.
+ * @return
+ *   Number of input packets consumed. If less than nb_pkts_in, rte_errno
+ *   is set to ENOSPC or ENOMEM, and the packets left are still owned by
+ *   the caller.
+ */
+uint16_t rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in,
+		uint16_t nb_pkts_in, struct rte_mbuf **pkts_out,
+		uint16_t *nb_pkts_out, uint16_t mtu_size,
+		struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect, uint32_t flags);
+
 /*
  * This function implements reassembly of fragmented IPv6 packets.
  * Incoming mbuf should have its l2_len/l3_len fields setup correctly.
@@ -286,6 +390,61 @@ int32_t rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 			struct rte_mempool *pool_direct,
 			struct rte_mempool *pool_indirect);
 
+/** Reuse the input packets as their first fragment, when possible. */
+#define RTE_IP_FRAG_F_IN_PLACE	0x1
+/** Compute the IPv4 header checksums instead of requesting their offload. */
+#define RTE_IP_FRAG_F_IP_CKSUM	0x2
+
+/**
+ * IPv4 burst fragmentation.
+ *
+ * This function fragments a burst of IPv4 packets, as
+ * rte_ipv4_fragment_packet() does for each of them, with the mbufs of all
+ * the fragments allocated in bulk, and takes ownership of the input
+ * packets it fragments.
+ * The packets that fit in the MTU are placed in pkts_out unchanged,
+ * whatever their Don't Fragment flag.
+ * The packets are processed in order, until one larger than the MTU has
+ * the Don't Fragment flag set or its fragments do not fit in the pkts_out
+ * array, or the mbufs run out.
+ *
+ * With the RTE_IP_FRAG_F_IN_PLACE flag, an input packet made of one
+ * direct segment not shared with anyone else is not attached to a new
+ * fragment, but truncated into its own first fragment, its header being
+ * updated in place.
+ * With the RTE_IP_FRAG_F_IP_CKSUM flag, the header checksums are computed
+ * from a sum of the header fields common to the fragments of a packet,
+ * instead of being set to zero with PKT_TX_IP_CKSUM requested.
+ *
+ * @param pkts_in
+ *   The input packets.
+ * @param nb_pkts_in
+ *   Number of input packets.
+ * @param pkts_out
+ *   Array storing the output fragments, in the order of the input packets.
+ * @param nb_pkts_out
+ *   On input, the size of the pkts_out array; on output, the number of
+ *   fragments placed in it.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv4
+ *   datagrams. This value includes the size of the IPv4 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @param flags
+ *   RTE_IP_FRAG_F_* flags.
+ * @return
+ *   Number of input packets consumed. If less than nb_pkts_in, rte_errno
+ *   is set to ENOTSUP, ENOSPC or ENOMEM, and the packets left are still
+ *   owned by the caller.
+ */
+uint16_t rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in,
+		uint16_t nb_pkts_in, struct rte_mbuf **pkts_out,
+		uint16_t *nb_pkts_out, uint16_t mtu_size,
+		struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect, uint32_t flags);
+
 /*
  * This function implements reassembly of fragmented IPv4 packets.
  * Incoming mbufs should have its l2_len/l3_len fields setup correclty.
@@ -65,14 +65,16 @@ rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 	dr->cnt = 0;
 }
 
-/* create fragmentation table */
-struct rte_ip_frag_tbl *
-rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
-	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+/* allocate fragmentation table, with a lock per bucket if shared */
+static struct rte_ip_frag_tbl *
+ip_frag_table_alloc(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_entries, uint64_t max_cycles, int socket_id,
+	uint32_t flags)
 {
 	struct rte_ip_frag_tbl *tbl;
 	size_t sz;
 	uint64_t nb_entries;
+	uint32_t i, nb_locks;
 
 	nb_entries = rte_align32pow2(bucket_num);
 	nb_entries *= bucket_entries;
@@ -87,6 +89,11 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	}
 
 	sz = sizeof (*tbl) + nb_entries * sizeof (tbl->pkt[0]);
+	nb_locks = 0;
+	if ((flags & IP_FRAG_TBL_SHARED) != 0) {
+		nb_locks = (uint32_t)(nb_entries / bucket_entries);
+		sz += nb_locks * sizeof (tbl->locks[0]);
+	}
 	if ((tbl = rte_zmalloc_socket(__func__, sz, RTE_CACHE_LINE_SIZE,
 			socket_id)) == NULL) {
 		RTE_LOG(ERR, USER1,
@@ -104,11 +111,46 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	tbl->nb_buckets = bucket_num;
 	tbl->bucket_entries = bucket_entries;
 	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->flags = flags;
+
+	if (nb_locks != 0) {
+		tbl->locks = (rte_spinlock_t *)(tbl->pkt + tbl->nb_entries);
+		for (i = 0; i != nb_locks; i++)
+			rte_spinlock_init(&tbl->locks[i]);
+	}
 
 	TAILQ_INIT(&(tbl->lru));
 	return tbl;
 }
 
+/* create fragmentation table */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+{
+	return ip_frag_table_alloc(bucket_num, bucket_entries, max_entries,
+		max_cycles, socket_id, 0);
+}
+
+/* create fragmentation table shared by several lcores */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_shared(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+{
+	return ip_frag_table_alloc(bucket_num, bucket_entries, max_entries,
+		max_cycles, socket_id, IP_FRAG_TBL_SHARED);
+}
+
+/* expire timed-out entries of frag table */
+uint32_t
+rte_ip_frag_table_expire(struct rte_ip_frag_tbl *tbl, uint64_t tms,
+	struct rte_ip_frag_death_row *dr)
+{
+	if ((tbl->flags & IP_FRAG_TBL_SHARED) != 0)
+		return ip_frag_expire_shared(tbl, dr, tms);
+	return ip_frag_expire(tbl, dr, tms);
+}
+
 /* dump frag table statistics to file */
 void
 rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
@@ -37,6 +37,7 @@
 #include <rte_memcpy.h>
 #include <rte_mempool.h>
 #include <rte_debug.h>
+#include <rte_errno.h>
 
 #include "ip_frag_common.h"
 
@@ -69,6 +70,24 @@ static inline void __free_fragments(struct rte_mbuf *mb[], uint32_t num)
 		rte_pktmbuf_free(mb[i]);
 }
 
+/*
+ * Set the header checksum of a fragment from the partial sum of the
+ * header fields common to all fragments, or request its offload.
+ */
+static inline void __cksum_ipv4hdr_frag(struct rte_mbuf *m,
+		struct ipv4_hdr *hdr, uint32_t sum, uint32_t sw_cksum)
+{
+	if (sw_cksum != 0) {
+		sum += hdr->total_length;
+		sum += hdr->fragment_offset;
+		sum = __rte_raw_cksum_reduce(sum);
+		hdr->hdr_checksum = (uint16_t)((sum == 0xffff) ? sum : ~sum);
+	} else
+		m->ol_flags |= PKT_TX_IP_CKSUM;
+
+	m->l3_len = sizeof(struct ipv4_hdr);
+}
+
 /**
  * IPv4 fragmentation.
  *
@@ -207,3 +226,185 @@ rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+/*
+ * Fragment one packet of a burst, with mbufs from the burst caches.
+ * If in_place is set, the input packet is its own first fragment: its
+ * header is only rewritten once the payload of the other fragments is
+ * attached, and the header of the other fragments is built from a copy.
+ */
+static inline int32_t
+ipv4_fragment_one(struct rte_mbuf *pkt_in, struct rte_mbuf **pkts_out,
+	uint16_t mtu_size, struct ip_frag_mbuf_cache *direct,
+	struct ip_frag_mbuf_cache *indirect, uint32_t in_place,
+	uint32_t sw_cksum)
+{
+	struct rte_mbuf *in_seg, *out_pkt;
+	struct ipv4_hdr hdr, *in_hdr, *out_hdr;
+	uint32_t in_seg_data_pos, frag_size, payload_len, ofs, len, n, sum;
+	uint16_t flag_offset;
+
+	frag_size = mtu_size - sizeof(struct ipv4_hdr);
+
+	in_hdr = rte_pktmbuf_mtod(pkt_in, struct ipv4_hdr *);
+	rte_memcpy(&hdr, in_hdr, sizeof(hdr));
+	flag_offset = rte_be_to_cpu_16(hdr.fragment_offset);
+	payload_len = pkt_in->pkt_len - sizeof(hdr);
+
+	/* the fields that differ between fragments are set to 0 anyway. */
+	sum = 0;
+	if (sw_cksum != 0) {
+		hdr.total_length = 0;
+		hdr.fragment_offset = 0;
+		hdr.hdr_checksum = 0;
+		sum = __rte_raw_cksum(&hdr, sizeof(hdr), 0);
+	}
+
+	ofs = in_place ? RTE_MIN(frag_size, payload_len) : 0;
+	n = in_place;
+	in_seg = pkt_in;
+	in_seg_data_pos = sizeof(hdr) + ofs;
+
+	while (ofs != payload_len) {
+
+		out_pkt = ip_frag_mbuf_cache_get(direct);
+		if (unlikely(out_pkt == NULL))
+			goto fail;
+
+		/* Reserve space for the IP header that will be built later */
+		out_pkt->data_len = sizeof(struct ipv4_hdr);
+		out_pkt->pkt_len = sizeof(struct ipv4_hdr);
+
+		len = RTE_MIN(frag_size, payload_len - ofs);
+		if (unlikely(ip_frag_attach_payload(out_pkt, indirect, &in_seg,
+				&in_seg_data_pos, len) != 0)) {
+			rte_pktmbuf_free(out_pkt);
+			goto fail;
+		}
+
+		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv4_hdr *);
+		__fill_ipv4hdr_frag(out_hdr, &hdr, (uint16_t)out_pkt->pkt_len,
+			flag_offset, (uint16_t)ofs, ofs + len != payload_len);
+		__cksum_ipv4hdr_frag(out_pkt, out_hdr, sum, sw_cksum);
+
+		pkts_out[n++] = out_pkt;
+		ofs += len;
+	}
+
+	if (in_place) {
+		len = RTE_MIN(frag_size, payload_len);
+		__fill_ipv4hdr_frag(in_hdr, &hdr,
+			(uint16_t)(sizeof(hdr) + len), flag_offset, 0,
+			len != payload_len);
+		__cksum_ipv4hdr_frag(pkt_in, in_hdr, sum, sw_cksum);
+		pkt_in->data_len = (uint16_t)(sizeof(hdr) + len);
+		pkt_in->pkt_len = pkt_in->data_len;
+		pkts_out[0] = pkt_in;
+	}
+
+	return n;
+
+fail:
+	__free_fragments(pkts_out + in_place, n - in_place);
+	return -ENOMEM;
+}
+
+/**
+ * IPv4 burst fragmentation.
+ *
+ * The fragments and payload pieces of the whole burst are counted first,
+ * so that their mbufs are then allocated in bulk.
+ */
+uint16_t
+rte_ipv4_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect,
+	uint32_t flags)
+{
+	struct ip_frag_mbuf_cache direct, indirect;
+	struct rte_mbuf *pkt;
+	struct ipv4_hdr *in_hdr;
+	uint32_t i, nb_in, nb_out, nb_frags, frag_size, payload_len, in_place;
+	int32_t ret;
+	int err;
+
+	frag_size = (uint16_t)(mtu_size - sizeof(struct ipv4_hdr));
+
+	/* Fragment size should be a multiply of 8. */
+	IP_FRAG_ASSERT((frag_size & IPV4_HDR_FO_MASK) == 0);
+
+	ip_frag_mbuf_cache_init(&direct, pool_direct);
+	ip_frag_mbuf_cache_init(&indirect, pool_indirect);
+
+	/* count the mbufs needed by the packets that can be fragmented. */
+	err = 0;
+	nb_out = 0;
+	for (nb_in = 0; nb_in != nb_pkts_in; nb_in++) {
+		pkt = pkts_in[nb_in];
+
+		/* packets that fit in the MTU are passed through. */
+		if (pkt->pkt_len <= mtu_size) {
+			if (unlikely(nb_out == *nb_pkts_out)) {
+				err = ENOSPC;
+				break;
+			}
+			nb_out++;
+			continue;
+		}
+
+		in_hdr = rte_pktmbuf_mtod(pkt, struct ipv4_hdr *);
+
+		/* If Don't Fragment flag is set */
+		if (unlikely((rte_be_to_cpu_16(in_hdr->fragment_offset) &
+				IPV4_HDR_DF_MASK) != 0)) {
+			err = ENOTSUP;
+			break;
+		}
+
+		payload_len = pkt->pkt_len - sizeof(struct ipv4_hdr);
+		nb_frags = (payload_len + frag_size - 1) / frag_size;
+		if (unlikely(nb_out + nb_frags > *nb_pkts_out)) {
+			err = ENOSPC;
+			break;
+		}
+
+		in_place = ip_frag_in_place(pkt, flags);
+		direct.left += nb_frags - in_place;
+		indirect.left += ip_frag_nb_pieces(pkt,
+			sizeof(struct ipv4_hdr), in_place ? frag_size : 0,
+			frag_size);
+		nb_out += nb_frags;
+	}
+
+	nb_out = 0;
+	for (i = 0; i != nb_in; i++) {
+		pkt = pkts_in[i];
+		if (pkt->pkt_len <= mtu_size) {
+			pkts_out[nb_out++] = pkt;
+			continue;
+		}
+
+		in_place = ip_frag_in_place(pkt, flags);
+
+		ret = ipv4_fragment_one(pkt, pkts_out + nb_out, mtu_size,
+			&direct, &indirect, in_place,
+			flags & RTE_IP_FRAG_F_IP_CKSUM);
+		if (unlikely(ret < 0)) {
+			err = -ret;
+			break;
+		}
+
+		/* the fragments hold references to the input segments. */
+		if (in_place == 0)
+			rte_pktmbuf_free(pkt);
+		nb_out += ret;
+	}
+
+	ip_frag_mbuf_cache_flush(&direct);
+	ip_frag_mbuf_cache_flush(&indirect);
+
+	*nb_pkts_out = (uint16_t)nb_out;
+	if (err != 0)
+		rte_errno = err;
+	return (uint16_t)i;
+}
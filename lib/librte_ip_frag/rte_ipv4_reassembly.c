@@ -147,6 +147,11 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	/* shared table: find and process the entry under its bucket locks. */
+	if ((tbl->flags & IP_FRAG_TBL_SHARED) != 0)
+		return ip_frag_process_shared(tbl, dr, mb, &key, tms,
+			ip_ofs, ip_len, ip_flag);
+
 	/* try to find/add entry into the fragment's table. */
 	if ((fp = ip_frag_find(tbl, dr, &key, tms)) == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
@@ -35,6 +35,7 @@
 #include <errno.h>
 
 #include <rte_memcpy.h>
+#include <rte_errno.h>
 
 #include "ip_frag_common.h"
 
@@ -66,9 +67,8 @@ __fill_ipv6hdr_frag(struct ipv6_hdr *dst,
 	fh = (struct ipv6_extension_fragment *) ++dst;
 	fh->next_header = src->proto;
 	fh->reserved1   = 0;
-	fh->frag_offset = rte_cpu_to_be_16(fofs);
-	fh->reserved2   = 0;
-	fh->more_frags  = rte_cpu_to_be_16(mf);
+	fh->frag_data   = rte_cpu_to_be_16((fofs & ~IPV6_HDR_FO_MASK) |
+		(mf << IPV6_HDR_MF_SHIFT));
 	fh->id = 0;
 }
 
@@ -80,6 +80,15 @@ __free_fragments(struct rte_mbuf *mb[], uint32_t num)
 		rte_pktmbuf_free(mb[i]);
 }
 
+/* the fragment header of the first fragment goes into the headroom */
+static inline uint32_t
+ipv6_frag_in_place(const struct rte_mbuf *pkt, uint32_t flags)
+{
+	return ip_frag_in_place(pkt, flags) &&
+		rte_pktmbuf_headroom(pkt) >=
+			sizeof(struct ipv6_extension_fragment);
+}
+
 /**
  * IPv6 fragmentation.
  *
@@ -213,3 +222,167 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 
 	return out_pkt_pos;
 }
+
+/*
+ * Fragment one packet of a burst, with mbufs from the burst caches.
+ * If in_place is set, the input packet is its own first fragment: its
+ * header is moved into the headroom to make room for the fragment
+ * header, once the payload of the other fragments is attached.
+ */
+static inline int32_t
+ipv6_fragment_one(struct rte_mbuf *pkt_in, struct rte_mbuf **pkts_out,
+	uint16_t mtu_size, struct ip_frag_mbuf_cache *direct,
+	struct ip_frag_mbuf_cache *indirect, uint32_t in_place)
+{
+	struct rte_mbuf *in_seg, *out_pkt;
+	struct ipv6_hdr hdr, *out_hdr;
+	uint32_t in_seg_data_pos, hdr_len, frag_size, payload_len;
+	uint32_t ofs, len, n;
+
+	hdr_len = sizeof(struct ipv6_hdr) +
+		sizeof(struct ipv6_extension_fragment);
+	frag_size = mtu_size - hdr_len;
+
+	rte_memcpy(&hdr, rte_pktmbuf_mtod(pkt_in, struct ipv6_hdr *),
+		sizeof(hdr));
+	payload_len = pkt_in->pkt_len - sizeof(hdr);
+
+	ofs = in_place ? RTE_MIN(frag_size, payload_len) : 0;
+	n = in_place;
+	in_seg = pkt_in;
+	in_seg_data_pos = sizeof(hdr) + ofs;
+
+	while (ofs != payload_len) {
+
+		out_pkt = ip_frag_mbuf_cache_get(direct);
+		if (unlikely(out_pkt == NULL))
+			goto fail;
+
+		/* Reserve space for the IP header that will be built later */
+		out_pkt->data_len = (uint16_t)hdr_len;
+		out_pkt->pkt_len = hdr_len;
+
+		len = RTE_MIN(frag_size, payload_len - ofs);
+		if (unlikely(ip_frag_attach_payload(out_pkt, indirect, &in_seg,
+				&in_seg_data_pos, len) != 0)) {
+			rte_pktmbuf_free(out_pkt);
+			goto fail;
+		}
+
+		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv6_hdr *);
+		__fill_ipv6hdr_frag(out_hdr, &hdr,
+			(uint16_t)(out_pkt->pkt_len - sizeof(hdr)),
+			(uint16_t)ofs, ofs + len != payload_len);
+
+		pkts_out[n++] = out_pkt;
+		ofs += len;
+	}
+
+	if (in_place) {
+		len = RTE_MIN(frag_size, payload_len);
+		out_hdr = (struct ipv6_hdr *)rte_pktmbuf_prepend(pkt_in,
+			sizeof(struct ipv6_extension_fragment));
+		__fill_ipv6hdr_frag(out_hdr, &hdr,
+			(uint16_t)(hdr_len - sizeof(hdr) + len), 0,
+			len != payload_len);
+		pkt_in->data_len = (uint16_t)(hdr_len + len);
+		pkt_in->pkt_len = pkt_in->data_len;
+		pkts_out[0] = pkt_in;
+	}
+
+	return n;
+
+fail:
+	__free_fragments(pkts_out + in_place, n - in_place);
+	return -ENOMEM;
+}
+
+/**
+ * IPv6 burst fragmentation.
+ *
+ * The fragments and payload pieces of the whole burst are counted first,
+ * so that their mbufs are then allocated in bulk.
+ */
+uint16_t
+rte_ipv6_fragment_burst(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect,
+	uint32_t flags)
+{
+	struct ip_frag_mbuf_cache direct, indirect;
+	struct rte_mbuf *pkt;
+	uint32_t i, nb_in, nb_out, nb_frags, frag_size, payload_len, in_place;
+	int32_t ret;
+	int err;
+
+	frag_size = (uint16_t)(mtu_size - sizeof(struct ipv6_hdr) -
+		sizeof(struct ipv6_extension_fragment));
+
+	/* Fragment size should be a multiple of 8. */
+	IP_FRAG_ASSERT((frag_size & IPV6_HDR_FO_MASK) == 0);
+
+	ip_frag_mbuf_cache_init(&direct, pool_direct);
+	ip_frag_mbuf_cache_init(&indirect, pool_indirect);
+
+	/* count the mbufs needed by the packets that fit in pkts_out. */
+	err = 0;
+	nb_out = 0;
+	for (nb_in = 0; nb_in != nb_pkts_in; nb_in++) {
+		pkt = pkts_in[nb_in];
+
+		/* packets that fit in the MTU are passed through. */
+		if (pkt->pkt_len <= mtu_size) {
+			if (unlikely(nb_out == *nb_pkts_out)) {
+				err = ENOSPC;
+				break;
+			}
+			nb_out++;
+			continue;
+		}
+
+		payload_len = pkt->pkt_len - sizeof(struct ipv6_hdr);
+		nb_frags = (payload_len + frag_size - 1) / frag_size;
+		if (unlikely(nb_out + nb_frags > *nb_pkts_out)) {
+			err = ENOSPC;
+			break;
+		}
+
+		in_place = ipv6_frag_in_place(pkt, flags);
+		direct.left += nb_frags - in_place;
+		indirect.left += ip_frag_nb_pieces(pkt,
+			sizeof(struct ipv6_hdr), in_place ? frag_size : 0,
+			frag_size);
+		nb_out += nb_frags;
+	}
+
+	nb_out = 0;
+	for (i = 0; i != nb_in; i++) {
+		pkt = pkts_in[i];
+		if (pkt->pkt_len <= mtu_size) {
+			pkts_out[nb_out++] = pkt;
+			continue;
+		}
+
+		in_place = ipv6_frag_in_place(pkt, flags);
+
+		ret = ipv6_fragment_one(pkt, pkts_out + nb_out, mtu_size,
+			&direct, &indirect, in_place);
+		if (unlikely(ret < 0)) {
+			err = -ret;
+			break;
+		}
+
+		/* the fragments hold references to the input segments. */
+		if (in_place == 0)
+			rte_pktmbuf_free(pkt);
+		nb_out += ret;
+	}
+
+	ip_frag_mbuf_cache_flush(&direct);
+	ip_frag_mbuf_cache_flush(&indirect);
+
+	*nb_pkts_out = (uint16_t)nb_out;
+	if (err != 0)
+		rte_errno = err;
+	return (uint16_t)i;
+}
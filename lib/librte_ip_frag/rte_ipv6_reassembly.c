@@ -185,6 +185,11 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
 		tbl->use_entries);
 
+	/* shared table: find and process the entry under its bucket locks. */
+	if ((tbl->flags & IP_FRAG_TBL_SHARED) != 0)
+		return ip_frag_process_shared(tbl, dr, mb, &key, tms, ip_ofs, ip_len,
+			MORE_FRAGS(frag_hdr->frag_data));
+
 	/* try to find/add entry into the fragment's table. */
 	fp = ip_frag_find(tbl, dr, &key, tms);
 	if (fp == NULL) {
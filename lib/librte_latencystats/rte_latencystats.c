@@ -0,0 +1,438 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+
+#include "rte_latencystats.h"
+
+#define MZ_RTE_LATENCY_STATS "RTE_LATENCY_STATS"
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_LATENCY_STATS RTE_LOGTYPE_USER1
+
+/* Weight of a new sample in the jitter estimate, as in RFC 3550 */
+#define LATENCY_JITTER_SHIFT 4
+
+/* Per TX queue statistics, only written by the lcore doing TX on it */
+struct latency_txq {
+	uint64_t samples;  /**< Number of measured packets */
+	uint64_t total;    /**< Sum of measured latencies, in TSC cycles */
+	uint64_t min;      /**< Minimum latency, in TSC cycles */
+	uint64_t max;      /**< Maximum latency, in TSC cycles */
+	uint64_t jitter;   /**< Smoothed latency variation, in TSC cycles */
+	uint64_t prev;     /**< Last measured latency, in TSC cycles */
+	volatile uint32_t reset_req; /**< Incremented to request a reset */
+	volatile uint32_t reset_ack; /**< Set to reset_req once reset is done */
+} __rte_cache_aligned;
+
+/* Per RX queue sampling state, private to the primary process */
+struct latency_rxq {
+	uint64_t next_tsc; /**< Packets received from then on are sampled */
+} __rte_cache_aligned;
+
+/* Layout of the shared memzone */
+struct latency_stats_shared {
+	uint64_t tsc_hz;     /**< TSC frequency of the primary process */
+	uint64_t samp_intvl; /**< Sampling interval, in TSC cycles */
+	uint16_t nb_txq[RTE_MAX_ETHPORTS];   /**< Measured TX queues per port */
+	uint32_t txq_base[RTE_MAX_ETHPORTS]; /**< Index of first TX queue */
+	struct latency_txq txq[0] __rte_cache_aligned;
+};
+
+static const struct rte_memzone *latency_mz;
+static struct latency_stats_shared *glob_stats;
+
+static struct latency_rxq *rxq_state[RTE_MAX_ETHPORTS];
+static struct rte_eth_rxtx_callback
+	*rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+static struct rte_eth_rxtx_callback
+	*tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+
+static uint16_t
+add_time_stamps(uint8_t port_id __rte_unused, uint16_t qid __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *user_cb)
+{
+	struct latency_rxq *rxq = user_cb;
+	uint64_t now;
+	uint16_t i;
+
+	if (nb_pkts == 0)
+		return 0;
+
+	now = rte_rdtsc();
+	if (glob_stats->samp_intvl == 0) {
+		for (i = 0; i < nb_pkts; i++) {
+			pkts[i]->timestamp = now;
+			pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
+		}
+		return nb_pkts;
+	}
+	if (now < rxq->next_tsc)
+		return nb_pkts;
+
+	/* only the first packet of the burst is sampled */
+	pkts[0]->timestamp = now;
+	pkts[0]->ol_flags |= PKT_RX_TIMESTAMP;
+	rxq->next_tsc = now + glob_stats->samp_intvl;
+
+	return nb_pkts;
+}
+
+static inline void
+latency_txq_update(struct latency_txq *txq, uint64_t latency)
+{
+	uint64_t diff;
+
+	if (unlikely(txq->reset_req != txq->reset_ack)) {
+		txq->samples = 0;
+		txq->total = 0;
+		txq->jitter = 0;
+		txq->reset_ack = txq->reset_req;
+	}
+
+	if (txq->samples == 0) {
+		txq->min = latency;
+		txq->max = latency;
+	} else {
+		if (latency < txq->min)
+			txq->min = latency;
+		if (latency > txq->max)
+			txq->max = latency;
+
+		diff = latency > txq->prev ? latency - txq->prev :
+			txq->prev - latency;
+		if (diff > txq->jitter)
+			txq->jitter += (diff - txq->jitter) >>
+				LATENCY_JITTER_SHIFT;
+		else
+			txq->jitter -= (txq->jitter - diff) >>
+				LATENCY_JITTER_SHIFT;
+	}
+	txq->prev = latency;
+	txq->total += latency;
+	txq->samples++;
+}
+
+static uint16_t
+calc_latency(uint8_t port_id __rte_unused, uint16_t qid __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_cb)
+{
+	struct latency_txq *txq = user_cb;
+	uint64_t now = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if ((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0)
+			continue;
+
+		if (now == 0)
+			now = rte_rdtsc();
+		/* do not measure the packet again if it is sent twice */
+		pkts[i]->ol_flags &= ~PKT_RX_TIMESTAMP;
+		latency_txq_update(txq, now - pkts[i]->timestamp);
+	}
+
+	return nb_pkts;
+}
+
+/* Attach to the shared statistics area, e.g. from a secondary process */
+static struct latency_stats_shared *
+latency_stats_lookup(void)
+{
+	const struct rte_memzone *mz;
+
+	if (glob_stats != NULL)
+		return glob_stats;
+
+	mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
+	if (mz == NULL)
+		return NULL;
+
+	latency_mz = mz;
+	glob_stats = mz->addr;
+	return glob_stats;
+}
+
+static void
+latency_stats_remove_cbs(void)
+{
+	uint8_t pid;
+	uint16_t qid;
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		for (qid = 0; qid < RTE_MAX_QUEUES_PER_PORT; qid++) {
+			if (rx_cbs[pid][qid] != NULL) {
+				rte_eth_remove_rx_callback(pid, qid,
+						rx_cbs[pid][qid]);
+				rte_free(rx_cbs[pid][qid]);
+				rx_cbs[pid][qid] = NULL;
+			}
+			if (tx_cbs[pid][qid] != NULL) {
+				rte_eth_remove_tx_callback(pid, qid,
+						tx_cbs[pid][qid]);
+				rte_free(tx_cbs[pid][qid]);
+				tx_cbs[pid][qid] = NULL;
+			}
+		}
+		rte_free(rxq_state[pid]);
+		rxq_state[pid] = NULL;
+	}
+}
+
+int
+rte_latencystats_init(uint64_t samp_intvl)
+{
+	const struct rte_memzone *mz;
+	struct latency_stats_shared *stats;
+	struct rte_eth_dev *dev;
+	uint32_t nb_txq_total = 0;
+	uint8_t pid;
+	uint16_t qid;
+	size_t size;
+	int ret;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -EPERM;
+
+	if (latency_stats_lookup() != NULL) {
+		RTE_LOG(ERR, LATENCY_STATS, "Latency stats already enabled\n");
+		return -EEXIST;
+	}
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		if (!rte_eth_dev_is_valid_port(pid))
+			continue;
+		nb_txq_total += rte_eth_devices[pid].data->nb_tx_queues;
+	}
+
+	size = sizeof(*stats) + nb_txq_total * sizeof(stats->txq[0]);
+	mz = rte_memzone_reserve(MZ_RTE_LATENCY_STATS, size, rte_socket_id(),
+			0);
+	if (mz == NULL) {
+		RTE_LOG(ERR, LATENCY_STATS, "Cannot reserve memory zone\n");
+		return -ENOMEM;
+	}
+
+	stats = mz->addr;
+	memset(stats, 0, size);
+	stats->tsc_hz = rte_get_tsc_hz();
+	stats->samp_intvl = samp_intvl * stats->tsc_hz / 1000000000ULL;
+	latency_mz = mz;
+	glob_stats = stats;
+
+	nb_txq_total = 0;
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		if (!rte_eth_dev_is_valid_port(pid))
+			continue;
+		dev = &rte_eth_devices[pid];
+
+		rxq_state[pid] = rte_zmalloc("LATENCY_STATS_RXQ",
+			dev->data->nb_rx_queues * sizeof(struct latency_rxq),
+			RTE_CACHE_LINE_SIZE);
+		if (rxq_state[pid] == NULL && dev->data->nb_rx_queues != 0) {
+			RTE_LOG(ERR, LATENCY_STATS,
+				"Cannot allocate RX state for port %u\n", pid);
+			ret = -ENOMEM;
+			goto err;
+		}
+
+		for (qid = 0; qid < dev->data->nb_rx_queues; qid++) {
+			rx_cbs[pid][qid] = rte_eth_add_rx_callback(pid, qid,
+				add_time_stamps, &rxq_state[pid][qid]);
+			if (rx_cbs[pid][qid] == NULL) {
+				RTE_LOG(ERR, LATENCY_STATS, "Cannot add RX "
+					"callback on port %u queue %u\n",
+					pid, qid);
+				ret = -rte_errno;
+				goto err;
+			}
+		}
+
+		stats->txq_base[pid] = nb_txq_total;
+		stats->nb_txq[pid] = dev->data->nb_tx_queues;
+		for (qid = 0; qid < dev->data->nb_tx_queues; qid++) {
+			tx_cbs[pid][qid] = rte_eth_add_tx_callback(pid, qid,
+				calc_latency, &stats->txq[nb_txq_total + qid]);
+			if (tx_cbs[pid][qid] == NULL) {
+				RTE_LOG(ERR, LATENCY_STATS, "Cannot add TX "
+					"callback on port %u queue %u\n",
+					pid, qid);
+				ret = -rte_errno;
+				goto err;
+			}
+		}
+		nb_txq_total += dev->data->nb_tx_queues;
+	}
+
+	return 0;
+
+err:
+	latency_stats_remove_cbs();
+	rte_memzone_free(mz);
+	latency_mz = NULL;
+	glob_stats = NULL;
+	return ret;
+}
+
+int
+rte_latencystats_uninit(void)
+{
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY || glob_stats == NULL)
+		return -ENOENT;
+
+	latency_stats_remove_cbs();
+	rte_memzone_free(latency_mz);
+	latency_mz = NULL;
+	glob_stats = NULL;
+
+	return 0;
+}
+
+static inline uint64_t
+cycles_to_ns(const struct latency_stats_shared *stats, uint64_t cycles)
+{
+	return cycles * 1000000000ULL / stats->tsc_hz;
+}
+
+/* Snapshot of a TX queue, with a pending reset taken into account */
+static void
+latency_txq_read(const struct latency_txq *txq, struct latency_txq *snap)
+{
+	*snap = *txq;
+	if (snap->reset_req != snap->reset_ack)
+		snap->samples = 0;
+}
+
+static void
+latency_stats_fill(const struct latency_stats_shared *shared,
+		const struct latency_txq *sum, struct rte_latencystats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	if (sum->samples == 0)
+		return;
+
+	stats->samples = sum->samples;
+	stats->min_ns = cycles_to_ns(shared, sum->min);
+	stats->avg_ns = cycles_to_ns(shared, sum->total / sum->samples);
+	stats->max_ns = cycles_to_ns(shared, sum->max);
+	stats->jitter_ns = cycles_to_ns(shared, sum->jitter);
+}
+
+int
+rte_latencystats_queue_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats)
+{
+	struct latency_stats_shared *shared = latency_stats_lookup();
+	struct latency_txq snap;
+
+	if (shared == NULL)
+		return -ENOENT;
+	if (stats == NULL || port_id >= RTE_MAX_ETHPORTS ||
+			queue_id >= shared->nb_txq[port_id])
+		return -EINVAL;
+
+	latency_txq_read(&shared->txq[shared->txq_base[port_id] + queue_id],
+			&snap);
+	latency_stats_fill(shared, &snap, stats);
+
+	return 0;
+}
+
+int
+rte_latencystats_get(uint8_t port_id, struct rte_latencystats *stats)
+{
+	struct latency_stats_shared *shared = latency_stats_lookup();
+	struct latency_txq snap, sum;
+	uint64_t jitter_sum = 0;
+	uint16_t qid;
+
+	if (shared == NULL)
+		return -ENOENT;
+	if (stats == NULL || port_id >= RTE_MAX_ETHPORTS ||
+			shared->nb_txq[port_id] == 0)
+		return -EINVAL;
+
+	memset(&sum, 0, sizeof(sum));
+	for (qid = 0; qid < shared->nb_txq[port_id]; qid++) {
+		latency_txq_read(&shared->txq[shared->txq_base[port_id] + qid],
+				&snap);
+		if (snap.samples == 0)
+			continue;
+
+		if (sum.samples == 0 || snap.min < sum.min)
+			sum.min = snap.min;
+		if (snap.max > sum.max)
+			sum.max = snap.max;
+		sum.samples += snap.samples;
+		sum.total += snap.total;
+		/* jitter of the port is the sample weighted queue average */
+		jitter_sum += snap.jitter * snap.samples;
+	}
+	if (sum.samples != 0)
+		sum.jitter = jitter_sum / sum.samples;
+
+	latency_stats_fill(shared, &sum, stats);
+
+	return 0;
+}
+
+int
+rte_latencystats_reset(uint8_t port_id)
+{
+	struct latency_stats_shared *shared = latency_stats_lookup();
+	uint16_t qid;
+
+	if (shared == NULL)
+		return -ENOENT;
+	if (port_id >= RTE_MAX_ETHPORTS || shared->nb_txq[port_id] == 0)
+		return -EINVAL;
+
+	/* the TX lcore clears its own counters on its next sample */
+	for (qid = 0; qid < shared->nb_txq[port_id]; qid++)
+		shared->txq[shared->txq_base[port_id] + qid].reset_req++;
+
+	return 0;
+}
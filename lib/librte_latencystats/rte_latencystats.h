@@ -0,0 +1,152 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LATENCYSTATS_H_
+#define _RTE_LATENCYSTATS_H_
+
+/**
+ * @file
+ * RTE latency stats
+ *
+ * Library to measure the time packets spend inside the application, from
+ * the moment they are received on an ethdev RX queue until they are handed
+ * to an ethdev TX queue. Packets are time stamped by an RX callback and the
+ * latency is computed by a TX callback, so this works with any PMD.
+ *
+ * To keep the overhead low, only one packet per sampling interval is time
+ * stamped on each RX queue. The time stamp is stored in mbuf->timestamp and
+ * flagged with PKT_RX_TIMESTAMP.
+ *
+ * Statistics are kept per TX queue in shared memory, so that a secondary
+ * process (e.g. proc_info) can read them while the primary is forwarding.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Latency statistics of a port or queue. */
+struct rte_latencystats {
+	uint64_t samples;   /**< Number of packets measured. */
+	uint64_t min_ns;    /**< Minimum latency in nanoseconds. */
+	uint64_t avg_ns;    /**< Average latency in nanoseconds. */
+	uint64_t max_ns;    /**< Maximum latency in nanoseconds. */
+	uint64_t jitter_ns; /**< Latency variation (RFC 3550) in nanoseconds. */
+};
+
+/**
+ * Start measuring latency on all configured ports.
+ *
+ * RX and TX callbacks are registered on every queue of the ports that are
+ * configured when this function is called, and the shared statistics area is
+ * reserved. Must be called from the primary process.
+ *
+ * @param samp_intvl
+ *   Sampling interval in nanoseconds: at most one packet is time stamped per
+ *   RX queue in each interval. 0 means every packet is measured.
+ * @return
+ *   - 0: Success.
+ *   - -EEXIST: Latency stats are already enabled.
+ *   - -EPERM: Called from a secondary process.
+ *   - -ENOMEM: Not enough memory for the shared statistics area.
+ *   - -ENOTSUP: RX/TX callbacks are not supported.
+ */
+int rte_latencystats_init(uint64_t samp_intvl);
+
+/**
+ * Stop measuring latency.
+ *
+ * The callbacks registered by rte_latencystats_init() are removed and the
+ * shared statistics area is released. As for rte_eth_remove_rx_callback(),
+ * this must only be called when no RX/TX burst is in progress on the
+ * measured queues, e.g. after the ports have been stopped.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: Latency stats are not enabled.
+ */
+int rte_latencystats_uninit(void);
+
+/**
+ * Retrieve the latency statistics of a port, aggregated over all its
+ * TX queues. Can be called from a secondary process.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param stats
+ *   A pointer to a structure to be filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters or port not measured.
+ *   - -ENOENT: Latency stats are not enabled.
+ */
+int rte_latencystats_get(uint8_t port_id, struct rte_latencystats *stats);
+
+/**
+ * Retrieve the latency statistics of a single TX queue. Can be called from
+ * a secondary process.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The TX queue on which the packets were measured.
+ * @param stats
+ *   A pointer to a structure to be filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters or queue not measured.
+ *   - -ENOENT: Latency stats are not enabled.
+ */
+int rte_latencystats_queue_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats);
+
+/**
+ * Clear the latency statistics of a port. Can be called from a secondary
+ * process. A sample taken concurrently on the port may be lost.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid port.
+ *   - -ENOENT: Latency stats are not enabled.
+ */
+int rte_latencystats_reset(uint8_t port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LATENCYSTATS_H_ */
@@ -0,0 +1,63 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LPM_BURST_H_
+#define _LPM_BURST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*rte_lpm_lookup_burst_t)
+(const struct rte_lpm *, const uint32_t *, uint32_t *, unsigned, uint32_t);
+
+/*
+ * Different implementations of LPM burst lookup.
+ */
+int
+rte_lpm_lookup_burst_scalar(const struct rte_lpm *lpm, const uint32_t *ips,
+	uint32_t *next_hops, unsigned n, uint32_t defv);
+
+int
+rte_lpm_lookup_burst_sse(const struct rte_lpm *lpm, const uint32_t *ips,
+	uint32_t *next_hops, unsigned n, uint32_t defv);
+
+int
+rte_lpm_lookup_burst_avx2(const struct rte_lpm *lpm, const uint32_t *ips,
+	uint32_t *next_hops, unsigned n, uint32_t defv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LPM_BURST_H_ */
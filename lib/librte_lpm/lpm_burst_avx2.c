@@ -0,0 +1,121 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <limits.h>
+#include <x86intrin.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+
+#include "rte_lpm.h"
+#include "lpm_burst.h"
+
+/*
+ * Lookup eight IP addresses: the tbl24 entries are read with one gather,
+ * and the tbl8 entries of the extended ones with two more gathers. The
+ * tbl8 indexes can exceed 2^31, so they are gathered with 64-bit indexes.
+ */
+static inline void
+lpm_lookupx8(const struct rte_lpm *lpm, __m256i ip, uint32_t hop[8],
+	__m256i defv)
+{
+	__m256i i24, i8, i8_lo, i8_hi, grp, tbl, ext;
+	__m128i tbl_lo, tbl_hi;
+
+	const __m256i mask8 = _mm256_set1_epi32(UINT8_MAX);
+	const __m256i mask_xv = _mm256_set1_epi32(
+		RTE_LPM_VALID_EXT_ENTRY_BITMASK);
+	const __m256i mask_v = _mm256_set1_epi32(RTE_LPM_LOOKUP_SUCCESS);
+	const __m256i mask_nh = _mm256_set1_epi32(RTE_LPM_NEXT_HOP_MASK);
+
+	/* get 8 indexes for tbl24[] and extract values from it. */
+	i24 = _mm256_srli_epi32(ip, CHAR_BIT);
+	tbl = _mm256_i32gather_epi32((const int *)lpm->tbl24, i24,
+		sizeof(lpm->tbl24[0]));
+
+	/* entries pointing to a tbl8 group. */
+	ext = _mm256_cmpeq_epi32(_mm256_and_si256(tbl, mask_xv), mask_xv);
+
+	if (unlikely(!_mm256_testz_si256(ext, ext))) {
+		/* get 8 indexes for tbl8[]: group * 256 + last byte. */
+		grp = _mm256_and_si256(tbl, mask_nh);
+		i8 = _mm256_and_si256(ip, mask8);
+		i8_lo = _mm256_add_epi64(
+			_mm256_slli_epi64(_mm256_cvtepu32_epi64(
+				_mm256_castsi256_si128(grp)), CHAR_BIT),
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(i8)));
+		i8_hi = _mm256_add_epi64(
+			_mm256_slli_epi64(_mm256_cvtepu32_epi64(
+				_mm256_extracti128_si256(grp, 1)), CHAR_BIT),
+			_mm256_cvtepu32_epi64(_mm256_extracti128_si256(i8, 1)));
+
+		/* extract values from tbl8[] for the extended entries only. */
+		tbl_lo = _mm256_mask_i64gather_epi32(
+			_mm256_castsi256_si128(tbl), (const int *)lpm->tbl8,
+			i8_lo, _mm256_castsi256_si128(ext),
+			sizeof(lpm->tbl8[0]));
+		tbl_hi = _mm256_mask_i64gather_epi32(
+			_mm256_extracti128_si256(tbl, 1), (const int *)lpm->tbl8,
+			i8_hi, _mm256_extracti128_si256(ext, 1),
+			sizeof(lpm->tbl8[0]));
+
+		tbl = _mm256_inserti128_si256(_mm256_castsi128_si256(tbl_lo),
+			tbl_hi, 1);
+	}
+
+	/* next hop on lookup hit, default value otherwise. */
+	_mm256_storeu_si256((__m256i *)hop, _mm256_blendv_epi8(defv,
+		_mm256_and_si256(tbl, mask_nh),
+		_mm256_cmpeq_epi32(_mm256_and_si256(tbl, mask_v), mask_v)));
+}
+
+/*
+ * Note, that to be able to use AVX2 lookup method,
+ * both compiler and target cpu have to support AVX2 instructions.
+ */
+int
+rte_lpm_lookup_burst_avx2(const struct rte_lpm *lpm, const uint32_t *ips,
+	uint32_t *next_hops, unsigned n, uint32_t defv)
+{
+	unsigned i, k;
+	const __m256i dv = _mm256_set1_epi32(defv);
+
+	k = RTE_ALIGN_FLOOR(n, 8);
+	for (i = 0; i != k; i += 8)
+		lpm_lookupx8(lpm, _mm256_loadu_si256((const __m256i *)&ips[i]),
+			&next_hops[i], dv);
+
+	return rte_lpm_lookup_burst_sse(lpm, ips + k, next_hops + k, n - k,
+		defv);
+}
@@ -48,12 +48,14 @@
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
 #include <rte_per_lcore.h>
+#include <rte_cpuflags.h>
 #include <rte_string_fns.h>
 #include <rte_errno.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 
 #include "rte_lpm.h"
+#include "lpm_burst.h"
 
 TAILQ_HEAD(rte_lpm_list, rte_tailq_entry);
 
@@ -64,6 +66,45 @@ EAL_REGISTER_TAILQ(rte_lpm_tailq)
 
 #define MAX_DEPTH_TBL24 24
 
+/*
+ * If the compiler doesn't support AVX2 instructions,
+ * then the dummy one would be used instead for AVX2 lookup method.
+ */
+int __attribute__ ((weak))
+rte_lpm_lookup_burst_avx2(__rte_unused const struct rte_lpm *lpm,
+	__rte_unused const uint32_t *ips,
+	__rte_unused uint32_t *next_hops,
+	__rte_unused unsigned n,
+	__rte_unused uint32_t defv)
+{
+	return -ENOTSUP;
+}
+
+static const rte_lpm_lookup_burst_t lookup_burst_fns[] = {
+	[RTE_LPM_LOOKUP_DEFAULT] = rte_lpm_lookup_burst_scalar,
+	[RTE_LPM_LOOKUP_SCALAR] = rte_lpm_lookup_burst_scalar,
+	[RTE_LPM_LOOKUP_SSE] = rte_lpm_lookup_burst_sse,
+	[RTE_LPM_LOOKUP_AVX2] = rte_lpm_lookup_burst_avx2,
+};
+
+/* by default, use always available SSE code path. */
+static enum rte_lpm_lookup_alg rte_lpm_default_lookup = RTE_LPM_LOOKUP_SSE;
+
+/*
+ * Select highest available lookup method as default one.
+ * Note that LOOKUP_AVX2 should be set as a default only
+ * if both conditions are met:
+ * at build time compiler supports AVX2 and target cpu supports AVX2.
+ */
+static void __attribute__((constructor))
+rte_lpm_init(void)
+{
+#ifdef CC_AVX2_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		rte_lpm_default_lookup = RTE_LPM_LOOKUP_AVX2;
+#endif
+}
+
 enum valid_flag {
 	INVALID = 0,
 	VALID
@@ -116,6 +157,39 @@ depth_to_range(uint8_t depth)
 	return (1 << (RTE_LPM_MAX_DEPTH - depth));
 }
 
+/* Freed tbl8 group waiting for the end of its grace period. */
+struct rte_lpm_dq_entry {
+	uint64_t token;       /* Token returned when the group was freed. */
+	uint32_t tbl8_gindex; /* Index of the freed group. */
+};
+
+/* RCU reclamation state, see rte_lpm_rcu_qsbr_add(). */
+struct rte_lpm_rcu {
+	struct rte_rcu_qsbr *v;
+	enum rte_lpm_qsbr_mode mode;
+	uint32_t reclaim_thd;
+	uint32_t reclaim_max;
+	uint32_t dq_size;  /* Size of the defer queue. */
+	uint32_t dq_head;  /* Index of the oldest queued group. */
+	uint32_t dq_count; /* Number of queued groups. */
+	struct rte_lpm_dq_entry dq[0];
+};
+
+/*
+ * Write a whole table entry with a single store, so that a concurrent
+ * lookup reads either the old or the new entry, never a mix of both.
+ */
+static inline void
+tbl_entry_write(struct rte_lpm_tbl_entry *dst, struct rte_lpm_tbl_entry src)
+{
+	union {
+		struct rte_lpm_tbl_entry entry;
+		uint32_t val;
+	} u = { .entry = src };
+
+	*(volatile uint32_t *)dst = u.val;
+}
+
 /*
  * Find an existing lpm table and return a pointer to it.
  */
@@ -148,22 +222,25 @@ rte_lpm_find_existing(const char *name)
  * Allocates memory for LPM object
  */
 struct rte_lpm *
-rte_lpm_create(const char *name, int socket_id, int max_rules,
-		__rte_unused int flags)
+rte_lpm_create(const char *name, int socket_id,
+		const struct rte_lpm_config *config)
 {
 	char mem_name[RTE_LPM_NAMESIZE];
 	struct rte_lpm *lpm = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t mem_size;
+	uint64_t rules_size, tbl8s_size;
+	size_t mem_size;
 	struct rte_lpm_list *lpm_list;
+	uint32_t i;
 
 	lpm_list = RTE_TAILQ_CAST(rte_lpm_tailq.head, rte_lpm_list);
 
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 2);
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 2);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl_entry) != 4);
 
 	/* Check user arguments. */
-	if ((name == NULL) || (socket_id < -1) || (max_rules == 0)){
+	if ((name == NULL) || (socket_id < -1) || (config == NULL) ||
+			(config->max_rules == 0) || (config->number_tbl8s == 0) ||
+			(config->number_tbl8s > RTE_LPM_MAX_TBL8_NUM_GROUPS)) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
@@ -171,7 +248,19 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
 
 	/* Determine the amount of memory to allocate. */
-	mem_size = sizeof(*lpm) + (sizeof(lpm->rules_tbl[0]) * max_rules);
+	mem_size = sizeof(*lpm);
+	rules_size = sizeof(struct rte_lpm_rule) *
+			(uint64_t)config->max_rules;
+	tbl8s_size = sizeof(struct rte_lpm_tbl_entry) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+			(uint64_t)config->number_tbl8s;
+
+	/* The tables must fit in the address space on 32-bit targets. */
+	if (((size_t)rules_size != rules_size) ||
+			((size_t)tbl8s_size != tbl8s_size)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -181,13 +270,17 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 		if (strncmp(name, lpm->name, RTE_LPM_NAMESIZE) == 0)
 			break;
 	}
-	if (te != NULL)
+	lpm = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
 		goto exit;
+	}
 
 	/* allocate tailq entry */
 	te = rte_zmalloc("LPM_TAILQ_ENTRY", sizeof(*te), 0);
 	if (te == NULL) {
 		RTE_LOG(ERR, LPM, "Failed to allocate tailq entry\n");
+		rte_errno = ENOMEM;
 		goto exit;
 	}
 
@@ -196,14 +289,41 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 			RTE_CACHE_LINE_SIZE, socket_id);
 	if (lpm == NULL) {
 		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
+		rte_errno = ENOMEM;
+		rte_free(te);
+		goto exit;
+	}
+
+	lpm->rules_tbl = (struct rte_lpm_rule *)rte_zmalloc_socket(NULL,
+			rules_size, RTE_CACHE_LINE_SIZE, socket_id);
+	lpm->tbl8 = (struct rte_lpm_tbl_entry *)rte_zmalloc_socket(NULL,
+			tbl8s_size, RTE_CACHE_LINE_SIZE, socket_id);
+	lpm->tbl8_free = (uint32_t *)rte_zmalloc_socket(NULL,
+			sizeof(uint32_t) * config->number_tbl8s, 0, socket_id);
+	if ((lpm->rules_tbl == NULL) || (lpm->tbl8 == NULL) ||
+			(lpm->tbl8_free == NULL)) {
+		RTE_LOG(ERR, LPM, "LPM tables memory allocation failed\n");
+		rte_errno = ENOMEM;
+		rte_free(lpm->rules_tbl);
+		rte_free(lpm->tbl8);
+		rte_free(lpm->tbl8_free);
+		rte_free(lpm);
+		lpm = NULL;
 		rte_free(te);
 		goto exit;
 	}
 
 	/* Save user arguments. */
-	lpm->max_rules = max_rules;
+	lpm->max_rules = config->max_rules;
+	lpm->number_tbl8s = config->number_tbl8s;
+	lpm->lookup_alg = rte_lpm_default_lookup;
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
+	/* The lowest group indexes are allocated first. */
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
+
 	te->data = (void *) lpm;
 
 	TAILQ_INSERT_TAIL(lpm_list, te, next);
@@ -245,10 +365,55 @@ rte_lpm_free(struct rte_lpm *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_free(lpm->rcu);
+	rte_free(lpm->tbl8_free);
+	rte_free(lpm->tbl8);
+	rte_free(lpm->rules_tbl);
 	rte_free(lpm);
 	rte_free(te);
 }
 
+int
+rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm,
+		const struct rte_lpm_rcu_config *cfg)
+{
+	struct rte_lpm_rcu *rcu;
+	uint32_t dq_size;
+
+	if ((lpm == NULL) || (cfg == NULL) || (cfg->v == NULL) ||
+			((cfg->mode != RTE_LPM_QSBR_MODE_DQ) &&
+			 (cfg->mode != RTE_LPM_QSBR_MODE_SYNC)))
+		return -EINVAL;
+
+	if (lpm->rcu != NULL)
+		return -EEXIST;
+
+	/* The groups of the table can never overflow a queue of this size. */
+	dq_size = cfg->dq_size;
+	if ((dq_size == 0) || (dq_size > lpm->number_tbl8s))
+		dq_size = lpm->number_tbl8s;
+	if (cfg->mode == RTE_LPM_QSBR_MODE_SYNC)
+		dq_size = 0;
+
+	rcu = rte_zmalloc("LPM_RCU", sizeof(*rcu) +
+			sizeof(rcu->dq[0]) * dq_size, RTE_CACHE_LINE_SIZE);
+	if (rcu == NULL) {
+		RTE_LOG(ERR, LPM, "LPM RCU defer queue allocation failed\n");
+		return -ENOMEM;
+	}
+
+	rcu->v = cfg->v;
+	rcu->mode = cfg->mode;
+	rcu->dq_size = dq_size;
+	rcu->reclaim_thd = (cfg->reclaim_thd != 0) ? cfg->reclaim_thd :
+			RTE_LPM_RCU_DQ_RECLAIM_THD;
+	rcu->reclaim_max = (cfg->reclaim_max != 0) ? cfg->reclaim_max :
+			RTE_LPM_RCU_DQ_RECLAIM_MAX;
+	lpm->rcu = rcu;
+
+	return 0;
+}
+
 /*
  * Adds a rule to the rule table.
  *
@@ -261,7 +426,7 @@ rte_lpm_free(struct rte_lpm *lpm)
  */
 static inline int32_t
 rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-	uint8_t next_hop)
+	uint32_t next_hop)
 {
 	uint32_t rule_gindex, rule_index, last_rule;
 	int i;
@@ -379,46 +544,120 @@ rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
 }
 
 /*
- * Find, clean and allocate a tbl8.
+ * Return a tbl8 group to the stack of free groups.
+ */
+static inline void
+tbl8_put(struct rte_lpm *lpm, uint32_t tbl8_gindex)
+{
+	/* Set tbl8 group invalid */
+	lpm->tbl8[tbl8_gindex * RTE_LPM_TBL8_GROUP_NUM_ENTRIES].valid_group =
+			INVALID;
+
+	lpm->tbl8_free[lpm->tbl8_free_count++] = tbl8_gindex;
+}
+
+/*
+ * Return to the free stack, oldest first, up to max queued groups whose
+ * grace period is over. If wait is set, wait for the oldest one.
+ */
+static inline uint32_t
+tbl8_reclaim(struct rte_lpm *lpm, uint32_t max, int wait)
+{
+	struct rte_lpm_rcu *rcu = lpm->rcu;
+	struct rte_lpm_dq_entry *e;
+	uint32_t n;
+
+	for (n = 0; (n < max) && (rcu->dq_count > 0); n++) {
+		e = &rcu->dq[rcu->dq_head];
+		if (!rte_rcu_qsbr_check(rcu->v, e->token, wait && (n == 0)))
+			break;
+
+		tbl8_put(lpm, e->tbl8_gindex);
+		rcu->dq_head = (rcu->dq_head + 1) % rcu->dq_size;
+		rcu->dq_count--;
+	}
+
+	return n;
+}
+
+/*
+ * Clean and allocate a tbl8 group from the stack of free groups.
  */
 static inline int32_t
-tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
+tbl8_alloc(struct rte_lpm *lpm)
 {
 	uint32_t tbl8_gindex; /* tbl8 group index. */
-	struct rte_lpm_tbl8_entry *tbl8_entry;
-
-	/* Scan through tbl8 to find a free (i.e. INVALID) tbl8 group. */
-	for (tbl8_gindex = 0; tbl8_gindex < RTE_LPM_TBL8_NUM_GROUPS;
-			tbl8_gindex++) {
-		tbl8_entry = &tbl8[tbl8_gindex *
-		                   RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
-		/* If a free tbl8 group is found clean it and set as VALID. */
-		if (!tbl8_entry->valid_group) {
-			memset(&tbl8_entry[0], 0,
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
-					sizeof(tbl8_entry[0]));
-
-			tbl8_entry->valid_group = VALID;
-
-			/* Return group index for allocated tbl8 group. */
-			return tbl8_gindex;
-		}
-	}
+	struct rte_lpm_tbl_entry *tbl8_entry;
+
+	/* Try to reuse freed groups whose readers have moved on. */
+	if ((lpm->tbl8_free_count == 0) && (lpm->rcu != NULL) &&
+			(lpm->rcu->mode == RTE_LPM_QSBR_MODE_DQ))
+		tbl8_reclaim(lpm, lpm->rcu->reclaim_max, 0);
 
 	/* If there are no tbl8 groups free then return error. */
-	return -ENOSPC;
+	if (lpm->tbl8_free_count == 0)
+		return -ENOSPC;
+
+	tbl8_gindex = lpm->tbl8_free[--lpm->tbl8_free_count];
+	tbl8_entry = &lpm->tbl8[tbl8_gindex * RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
+
+	/*
+	 * Clean the free tbl8 group and set it as VALID. No lookup can
+	 * reach it until it is linked from tbl24.
+	 */
+	memset(&tbl8_entry[0], 0,
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+			sizeof(tbl8_entry[0]));
+
+	tbl8_entry->valid_group = VALID;
+
+	/* Return group index for allocated tbl8 group. */
+	return tbl8_gindex;
 }
 
+/*
+ * Free a tbl8 group which is not referenced from tbl24 anymore. Lookups
+ * which read the former tbl24 entry may still be reading the group, so
+ * with RCU it is reused only after their grace period.
+ */
 static inline void
-tbl8_free(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
+tbl8_free(struct rte_lpm *lpm, uint32_t tbl8_group_start)
 {
-	/* Set tbl8 group invalid*/
-	tbl8[tbl8_group_start].valid_group = INVALID;
+	struct rte_lpm_rcu *rcu = lpm->rcu;
+	uint32_t tbl8_gindex = tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+	struct rte_lpm_dq_entry *e;
+
+	if (rcu == NULL) {
+		tbl8_put(lpm, tbl8_gindex);
+		return;
+	}
+
+	if (rcu->mode == RTE_LPM_QSBR_MODE_SYNC) {
+		rte_rcu_qsbr_synchronize(rcu->v, RTE_RCU_QSBR_THRID_INVALID);
+		tbl8_put(lpm, tbl8_gindex);
+		return;
+	}
+
+	/* Make room in the defer queue if needed. */
+	if (rcu->dq_count == rcu->dq_size)
+		tbl8_reclaim(lpm, 1, 1);
+
+	/*
+	 * The tbl24 entry was rewritten before, so a lookup starting after
+	 * the token is taken cannot reach the group.
+	 */
+	e = &rcu->dq[(rcu->dq_head + rcu->dq_count) % rcu->dq_size];
+	e->token = rte_rcu_qsbr_start(rcu->v);
+	e->tbl8_gindex = tbl8_gindex;
+	rcu->dq_count++;
+
+	if (rcu->dq_count >= rcu->reclaim_thd)
+		tbl8_reclaim(lpm, rcu->reclaim_max, 0);
 }
 
 static inline int32_t
 add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl24_index, tbl24_range, tbl8_index, tbl8_group_end, i, j;
 
@@ -431,29 +670,29 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 		 * For invalid OR valid and non-extended tbl 24 entries set
 		 * entry.
 		 */
-		if (!lpm->tbl24[i].valid || (lpm->tbl24[i].ext_entry == 0 &&
+		if (!lpm->tbl24[i].valid || (lpm->tbl24[i].valid_group == 0 &&
 				lpm->tbl24[i].depth <= depth)) {
 
-			struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .next_hop = next_hop, },
+			struct rte_lpm_tbl_entry new_tbl24_entry = {
+				.next_hop = next_hop,
 				.valid = VALID,
-				.ext_entry = 0,
+				.valid_group = 0,
 				.depth = depth,
 			};
 
 			/* Setting tbl24 entry in one go to avoid race
 			 * conditions
 			 */
-			lpm->tbl24[i] = new_tbl24_entry;
+			tbl_entry_write(&lpm->tbl24[i], new_tbl24_entry);
 
 			continue;
 		}
 
-		if (lpm->tbl24[i].ext_entry == 1) {
+		if (lpm->tbl24[i].valid_group == 1) {
 			/* If tbl24 entry is valid and extended calculate the
 			 *  index into tbl8.
 			 */
-			tbl8_index = lpm->tbl24[i].tbl8_gindex *
+			tbl8_index = lpm->tbl24[i].next_hop *
 					RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 			tbl8_group_end = tbl8_index +
 					RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
@@ -461,7 +700,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 			for (j = tbl8_index; j < tbl8_group_end; j++) {
 				if (!lpm->tbl8[j].valid ||
 						lpm->tbl8[j].depth <= depth) {
-					struct rte_lpm_tbl8_entry
+					struct rte_lpm_tbl_entry
 						new_tbl8_entry = {
 						.valid = VALID,
 						.valid_group = VALID,
@@ -473,7 +712,8 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 					 * Setting tbl8 entry in one go to avoid
 					 * race conditions
 					 */
-					lpm->tbl8[j] = new_tbl8_entry;
+					tbl_entry_write(&lpm->tbl8[j],
+							new_tbl8_entry);
 
 					continue;
 				}
@@ -486,7 +726,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 
 static inline int32_t
 add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl24_index;
 	int32_t tbl8_group_index, tbl8_group_start, tbl8_group_end, tbl8_index,
@@ -497,7 +737,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 
 	if (!lpm->tbl24[tbl24_index].valid) {
 		/* Search for a free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc(lpm);
 
 		/* Check tbl8 allocation was successful. */
 		if (tbl8_group_index < 0) {
@@ -522,19 +762,21 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = (uint32_t)tbl8_group_index,
 			.valid = VALID,
-			.ext_entry = 1,
+			.valid_group = 1,
 			.depth = 0,
 		};
 
-		lpm->tbl24[tbl24_index] = new_tbl24_entry;
+		/* The tbl8 group must be complete before it is reachable. */
+		rte_wmb();
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
 
 	}/* If valid entry but not extended calculate the index into Table8. */
-	else if (lpm->tbl24[tbl24_index].ext_entry == 0) {
+	else if (lpm->tbl24[tbl24_index].valid_group == 0) {
 		/* Search for free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc(lpm);
 
 		if (tbl8_group_index < 0) {
 			return tbl8_group_index;
@@ -573,20 +815,22 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go.
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+				.next_hop = (uint32_t)tbl8_group_index,
 				.valid = VALID,
-				.ext_entry = 1,
+				.valid_group = 1,
 				.depth = 0,
 		};
 
-		lpm->tbl24[tbl24_index] = new_tbl24_entry;
+		/* The tbl8 group must be complete before it is reachable. */
+		rte_wmb();
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
 
 	}
 	else { /*
 		* If it is valid, extended entry calculate the index into tbl8.
 		*/
-		tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+		tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 		tbl8_group_start = tbl8_group_index *
 				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 		tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
@@ -595,7 +839,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 
 			if (!lpm->tbl8[i].valid ||
 					lpm->tbl8[i].depth <= depth) {
-				struct rte_lpm_tbl8_entry new_tbl8_entry = {
+				struct rte_lpm_tbl_entry new_tbl8_entry = {
 					.valid = VALID,
 					.depth = depth,
 					.next_hop = next_hop,
@@ -606,7 +850,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 				 * Setting tbl8 entry in one go to avoid race
 				 * condition
 				 */
-				lpm->tbl8[i] = new_tbl8_entry;
+				tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
 
 				continue;
 			}
@@ -621,13 +865,14 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
  */
 int
 rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	int32_t rule_index, status = 0;
 	uint32_t ip_masked;
 
 	/* Check user arguments. */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH) ||
+			(next_hop > RTE_LPM_MAX_NEXT_HOP))
 		return -EINVAL;
 
 	ip_masked = ip & depth_to_mask(depth);
@@ -665,7 +910,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop)
+uint32_t *next_hop)
 {
 	uint32_t ip_masked;
 	int32_t rule_index;
@@ -731,9 +976,12 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 		 */
 		for (i = tbl24_index; i < (tbl24_index + tbl24_range); i++) {
 
-			if (lpm->tbl24[i].ext_entry == 0 &&
+			if (lpm->tbl24[i].valid_group == 0 &&
 					lpm->tbl24[i].depth <= depth ) {
-				lpm->tbl24[i].valid = INVALID;
+				struct rte_lpm_tbl_entry entry = lpm->tbl24[i];
+
+				entry.valid = INVALID;
+				tbl_entry_write(&lpm->tbl24[i], entry);
 			}
 			else {
 				/*
@@ -742,15 +990,20 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
 				for (j = tbl8_index; j < (tbl8_index +
 					RTE_LPM_TBL8_GROUP_NUM_ENTRIES); j++) {
-
-					if (lpm->tbl8[j].depth <= depth)
-						lpm->tbl8[j].valid = INVALID;
+					struct rte_lpm_tbl_entry entry =
+							lpm->tbl8[j];
+
+					if (entry.depth <= depth) {
+						entry.valid = INVALID;
+						tbl_entry_write(&lpm->tbl8[j],
+								entry);
+					}
 				}
 			}
 		}
@@ -761,14 +1014,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 		 * associated with this rule.
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,},
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,
 			.valid = VALID,
-			.ext_entry = 0,
+			.valid_group = 0,
 			.depth = sub_rule_depth,
 		};
 
-		struct rte_lpm_tbl8_entry new_tbl8_entry = {
+		struct rte_lpm_tbl_entry new_tbl8_entry = {
 			.valid = VALID,
 			.depth = sub_rule_depth,
 			.next_hop = lpm->rules_tbl
@@ -777,9 +1030,10 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 
 		for (i = tbl24_index; i < (tbl24_index + tbl24_range); i++) {
 
-			if (lpm->tbl24[i].ext_entry == 0 &&
+			if (lpm->tbl24[i].valid_group == 0 &&
 					lpm->tbl24[i].depth <= depth ) {
-				lpm->tbl24[i] = new_tbl24_entry;
+				tbl_entry_write(&lpm->tbl24[i],
+						new_tbl24_entry);
 			}
 			else {
 				/*
@@ -788,7 +1042,7 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -796,7 +1050,8 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 					RTE_LPM_TBL8_GROUP_NUM_ENTRIES); j++) {
 
 					if (lpm->tbl8[j].depth <= depth)
-						lpm->tbl8[j] = new_tbl8_entry;
+						tbl_entry_write(&lpm->tbl8[j],
+								new_tbl8_entry);
 				}
 			}
 		}
@@ -814,7 +1069,7 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
  * thus can be recycled
  */
 static inline int32_t
-tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
+tbl8_recycle_check(struct rte_lpm_tbl_entry *tbl8, uint32_t tbl8_group_start)
 {
 	uint32_t tbl8_group_end, i;
 	tbl8_group_end = tbl8_group_start + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
@@ -874,7 +1129,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	tbl24_index = ip_masked >> 8;
 
 	/* Calculate the index into tbl8 and range. */
-	tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+	tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 	tbl8_group_start = tbl8_group_index * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 	tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
 	tbl8_range = depth_to_range(depth);
@@ -885,13 +1140,17 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 		 * rule_to_delete must be removed or modified.
 		 */
 		for (i = tbl8_index; i < (tbl8_index + tbl8_range); i++) {
-			if (lpm->tbl8[i].depth <= depth)
-				lpm->tbl8[i].valid = INVALID;
+			struct rte_lpm_tbl_entry entry = lpm->tbl8[i];
+
+			if (entry.depth <= depth) {
+				entry.valid = INVALID;
+				tbl_entry_write(&lpm->tbl8[i], entry);
+			}
 		}
 	}
 	else {
 		/* Set new tbl8 entry. */
-		struct rte_lpm_tbl8_entry new_tbl8_entry = {
+		struct rte_lpm_tbl_entry new_tbl8_entry = {
 			.valid = VALID,
 			.depth = sub_rule_depth,
 			.valid_group = lpm->tbl8[tbl8_group_start].valid_group,
@@ -904,7 +1163,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 		 */
 		for (i = tbl8_index; i < (tbl8_index + tbl8_range); i++) {
 			if (lpm->tbl8[i].depth <= depth)
-				lpm->tbl8[i] = new_tbl8_entry;
+				tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
 		}
 	}
 
@@ -917,22 +1176,26 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	tbl8_recycle_index = tbl8_recycle_check(lpm->tbl8, tbl8_group_start);
 
 	if (tbl8_recycle_index == -EINVAL){
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.valid = INVALID,
+		};
+
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
-		lpm->tbl24[tbl24_index].valid = 0;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+		tbl8_free(lpm, tbl8_group_start);
 	}
 	else if (tbl8_recycle_index > -1) {
 		/* Update tbl24 entry. */
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .next_hop = lpm->tbl8[tbl8_recycle_index].next_hop, },
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = lpm->tbl8[tbl8_recycle_index].next_hop,
 			.valid = VALID,
-			.ext_entry = 0,
+			.valid_group = 0,
 			.depth = lpm->tbl8[tbl8_recycle_index].depth,
 		};
 
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
-		lpm->tbl24[tbl24_index] = new_tbl24_entry;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+		tbl8_free(lpm, tbl8_group_start);
 	}
 
 	return 0;
@@ -1000,6 +1263,8 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 void
 rte_lpm_delete_all(struct rte_lpm *lpm)
 {
+	uint32_t i;
+
 	/* Zero rule information. */
 	memset(lpm->rule_info, 0, sizeof(lpm->rule_info));
 
@@ -1007,8 +1272,104 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
 
 	/* Zero tbl8. */
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8));
+	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0]) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
+
+	/* Free all tbl8 groups, including the ones in the defer queue. */
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
+	if (lpm->rcu != NULL) {
+		lpm->rcu->dq_head = 0;
+		lpm->rcu->dq_count = 0;
+	}
 
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(lpm->rules_tbl[0]) * lpm->max_rules);
 }
+
+int
+rte_lpm_set_lookup_alg(struct rte_lpm *lpm, enum rte_lpm_lookup_alg alg)
+{
+	if (lpm == NULL || (uint32_t)alg >= RTE_LPM_LOOKUP_NUM)
+		return -EINVAL;
+
+	if (alg == RTE_LPM_LOOKUP_DEFAULT)
+		alg = rte_lpm_default_lookup;
+
+	if (alg == RTE_LPM_LOOKUP_AVX2) {
+#ifdef CC_AVX2_SUPPORT
+		if (!rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+			return -ENOTSUP;
+#else
+		return -ENOTSUP;
+#endif
+	}
+
+	lpm->lookup_alg = alg;
+	return 0;
+}
+
+/*
+ * Looks up one address at a time.
+ */
+int
+rte_lpm_lookup_burst_scalar(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv)
+{
+	unsigned i;
+
+	for (i = 0; i != n; i++)
+		if (rte_lpm_lookup(lpm, ips[i], &next_hops[i]) != 0)
+			next_hops[i] = defv;
+
+	return 0;
+}
+
+/*
+ * Looks up four addresses at a time, then the remaining ones one by one.
+ */
+int
+rte_lpm_lookup_burst_sse(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv)
+{
+	unsigned i, k;
+
+	k = RTE_ALIGN_FLOOR(n, 4);
+	for (i = 0; i != k; i += 4)
+		rte_lpm_lookupx4(lpm,
+			_mm_loadu_si128((const __m128i *)&ips[i]),
+			&next_hops[i], defv);
+
+	return rte_lpm_lookup_burst_scalar(lpm, ips + k, next_hops + k,
+		n - k, defv);
+}
+
+int
+rte_lpm_lookup_burst_alg(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv,
+		enum rte_lpm_lookup_alg alg)
+{
+	if (lpm == NULL || ips == NULL || next_hops == NULL ||
+			(uint32_t)alg >= RTE_LPM_LOOKUP_NUM)
+		return -EINVAL;
+
+	if (alg == RTE_LPM_LOOKUP_DEFAULT)
+		alg = rte_lpm_default_lookup;
+	/* AVX2 is the default whenever both the build and the CPU allow it. */
+	else if (alg == RTE_LPM_LOOKUP_AVX2 &&
+			rte_lpm_default_lookup != RTE_LPM_LOOKUP_AVX2)
+		return -ENOTSUP;
+
+	return lookup_burst_fns[alg](lpm, ips, next_hops, n, defv);
+}
+
+int
+rte_lpm_lookup_burst(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv)
+{
+	if (lpm == NULL || ips == NULL || next_hops == NULL)
+		return -EINVAL;
+
+	return lookup_burst_fns[lpm->lookup_alg](lpm, ips, next_hops, n, defv);
+}
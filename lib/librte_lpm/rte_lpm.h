@@ -37,6 +37,15 @@
 /**
  * @file
  * RTE Longest Prefix Match (LPM)
+ *
+ * The lookup functions can be called from any number of lcores while a
+ * single control thread adds and deletes rules: table entries are updated
+ * with single stores, in an order such that a lookup never sees a partially
+ * initialized tbl8 group. A tbl8 group freed by rte_lpm_delete() can however
+ * still be read by a lookup which started before the deletion. To prevent
+ * it from being reused too early, an RCU QSBR variable must be attached with
+ * rte_lpm_rcu_qsbr_add() and the lookup threads must report their quiescent
+ * states on it.
  */
 
 #include <errno.h>
@@ -48,6 +57,7 @@
 #include <rte_memory.h>
 #include <rte_common.h>
 #include <rte_vect.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,12 +75,11 @@ extern "C" {
 /** @internal Number of entries in a tbl8 group. */
 #define RTE_LPM_TBL8_GROUP_NUM_ENTRIES  256
 
-/** @internal Total number of tbl8 groups in the tbl8. */
-#define RTE_LPM_TBL8_NUM_GROUPS         256
+/** Maximum number of tbl8 groups, limited by the size of the group index. */
+#define RTE_LPM_MAX_TBL8_NUM_GROUPS     (1 << 24)
 
-/** @internal Total number of tbl8 entries. */
-#define RTE_LPM_TBL8_NUM_ENTRIES        (RTE_LPM_TBL8_NUM_GROUPS * \
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES)
+/** Maximum next hop value, next hops are stored on 24 bits. */
+#define RTE_LPM_MAX_NEXT_HOP            ((1 << 24) - 1)
 
 /** @internal Macro to enable/disable run-time checks. */
 #if defined(RTE_LIBRTE_LPM_DEBUG)
@@ -81,57 +90,91 @@ extern "C" {
 #define RTE_LPM_RETURN_IF_TRUE(cond, retval)
 #endif
 
-/** @internal bitmask with valid and ext_entry/valid_group fields set */
-#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x0300
+/** Default threshold of the defer queue which triggers reclamation. */
+#define RTE_LPM_RCU_DQ_RECLAIM_THD      32
+
+/** Default maximum number of tbl8 groups reclaimed at once. */
+#define RTE_LPM_RCU_DQ_RECLAIM_MAX      16
+
+/** @internal bitmask with valid and valid_group fields set */
+#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x03000000
 
 /** Bitmask used to indicate successful lookup */
-#define RTE_LPM_LOOKUP_SUCCESS          0x0100
+#define RTE_LPM_LOOKUP_SUCCESS          0x01000000
+
+/** @internal Bitmask of the next hop, or tbl8 group index, in an entry */
+#define RTE_LPM_NEXT_HOP_MASK           0x00FFFFFF
 
 #if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-/** @internal Tbl24 entry structure. */
-struct rte_lpm_tbl24_entry {
-	/* Stores Next hop or group index (i.e. gindex)into tbl8. */
-	union {
-		uint8_t next_hop;
-		uint8_t tbl8_gindex;
-	};
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid     :1; /**< Validation flag. */
-	uint8_t ext_entry :1; /**< External entry. */
-	uint8_t depth     :6; /**< Rule depth. */
+/**
+ * @internal Tbl24 and tbl8 entry structure. In tbl24, valid_group is set
+ * if the entry is extended, i.e. if next_hop is the index of a tbl8 group.
+ */
+struct rte_lpm_tbl_entry {
+	/* Stores Next hop or group index (i.e. gindex) into tbl8. */
+	uint32_t next_hop    :24;
+	uint32_t valid       :1; /**< Validation flag. */
+	uint32_t valid_group :1; /**< Group validation or extended flag. */
+	uint32_t depth       :6; /**< Rule depth. */
+};
+#else
+struct rte_lpm_tbl_entry {
+	uint32_t depth       :6;
+	uint32_t valid_group :1;
+	uint32_t valid       :1;
+	uint32_t next_hop    :24;
 };
+#endif
 
-/** @internal Tbl8 entry structure. */
-struct rte_lpm_tbl8_entry {
-	uint8_t next_hop; /**< next hop. */
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid       :1; /**< Validation flag. */
-	uint8_t valid_group :1; /**< Group validation flag. */
-	uint8_t depth       :6; /**< Rule depth. */
+/** LPM configuration structure. */
+struct rte_lpm_config {
+	uint32_t max_rules;    /**< Max number of rules. */
+	uint32_t number_tbl8s; /**< Number of tbl8 groups to allocate. */
+	int flags;             /**< This field is currently unused. */
 };
-#else
-struct rte_lpm_tbl24_entry {
-	uint8_t depth       :6;
-	uint8_t ext_entry   :1;
-	uint8_t valid       :1;
-	union {
-		uint8_t tbl8_gindex;
-		uint8_t next_hop;
-	};
+
+/** Reclamation modes of the tbl8 groups freed while readers are running. */
+enum rte_lpm_qsbr_mode {
+	/**
+	 * Freed groups are queued with a grace period token and reclaimed
+	 * later, once all the readers have reported a quiescent state.
+	 */
+	RTE_LPM_QSBR_MODE_DQ = 0,
+	/** rte_lpm_delete() waits for the grace period of a freed group. */
+	RTE_LPM_QSBR_MODE_SYNC
 };
 
-struct rte_lpm_tbl8_entry {
-	uint8_t depth       :6;
-	uint8_t valid_group :1;
-	uint8_t valid       :1;
-	uint8_t next_hop;
+/** LPM RCU QSBR configuration structure. */
+struct rte_lpm_rcu_config {
+	struct rte_rcu_qsbr *v; /**< RCU QSBR variable of the readers. */
+	enum rte_lpm_qsbr_mode mode; /**< Reclamation mode. */
+	uint32_t dq_size;
+	/**< Size of the defer queue, 0 for the number of tbl8 groups. */
+	uint32_t reclaim_thd;
+	/**< Length of the defer queue from which groups are reclaimed on each
+	 *   free, 0 for RTE_LPM_RCU_DQ_RECLAIM_THD. */
+	uint32_t reclaim_max;
+	/**< Maximum number of groups reclaimed at once, 0 for
+	 *   RTE_LPM_RCU_DQ_RECLAIM_MAX. */
 };
-#endif
+
+/** @internal RCU reclamation state. */
+struct rte_lpm_rcu;
 
 /** @internal Rule structure. */
 struct rte_lpm_rule {
 	uint32_t ip; /**< Rule IP address. */
-	uint8_t  next_hop; /**< Rule next hop. */
+	uint32_t next_hop; /**< Rule next hop. */
+};
+
+/** Methods of rte_lpm_lookup_burst(). */
+enum rte_lpm_lookup_alg {
+	RTE_LPM_LOOKUP_DEFAULT = 0,
+	/**< Best method supported by the build and the CPU. */
+	RTE_LPM_LOOKUP_SCALAR = 1,  /**< One address at a time. */
+	RTE_LPM_LOOKUP_SSE = 2,     /**< Four addresses at a time. */
+	RTE_LPM_LOOKUP_AVX2 = 3,    /**< Eight addresses at a time. */
+	RTE_LPM_LOOKUP_NUM
 };
 
 /** @internal Contains metadata about the rules table. */
@@ -145,15 +188,18 @@ struct rte_lpm {
 	/* LPM metadata. */
 	char name[RTE_LPM_NAMESIZE];        /**< Name of the lpm. */
 	uint32_t max_rules; /**< Max. balanced rules per lpm. */
+	uint32_t number_tbl8s; /**< Number of tbl8 groups. */
 	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH]; /**< Rule info table. */
 
 	/* LPM Tables. */
-	struct rte_lpm_tbl24_entry tbl24[RTE_LPM_TBL24_NUM_ENTRIES] \
+	struct rte_lpm_tbl_entry tbl24[RTE_LPM_TBL24_NUM_ENTRIES] \
 			__rte_cache_aligned; /**< LPM tbl24 table. */
-	struct rte_lpm_tbl8_entry tbl8[RTE_LPM_TBL8_NUM_ENTRIES] \
-			__rte_cache_aligned; /**< LPM tbl8 table. */
-	struct rte_lpm_rule rules_tbl[0] \
-			__rte_cache_aligned; /**< LPM rules. */
+	struct rte_lpm_tbl_entry *tbl8; /**< LPM tbl8 table. */
+	struct rte_lpm_rule *rules_tbl; /**< LPM rules. */
+	uint32_t *tbl8_free; /**< Stack of the free tbl8 group indexes. */
+	uint32_t tbl8_free_count; /**< Number of free tbl8 groups. */
+	struct rte_lpm_rcu *rcu; /**< RCU reclamation, NULL if not used. */
+	enum rte_lpm_lookup_alg lookup_alg; /**< Burst lookup method. */
 };
 
 /**
@@ -163,10 +209,10 @@ struct rte_lpm {
  *   LPM object name
  * @param socket_id
  *   NUMA socket ID for LPM table memory allocation
- * @param max_rules
- *   Maximum number of LPM rules that can be added
- * @param flags
- *   This parameter is currently unused
+ * @param config
+ *   Structure containing the configuration: the maximum number of rules
+ *   and the number of tbl8 groups, which bounds the number of /24 prefixes
+ *   covered by rules longer than 24 bits. Each tbl8 group takes 1 KB.
  * @return
  *   Handle to LPM object on success, NULL otherwise with rte_errno set
  *   to an appropriate values. Possible rte_errno values include:
@@ -178,7 +224,8 @@ struct rte_lpm {
  *    - ENOMEM - no appropriate memory area found in which to create memzone
  */
 struct rte_lpm *
-rte_lpm_create(const char *name, int socket_id, int max_rules, int flags);
+rte_lpm_create(const char *name, int socket_id,
+		const struct rte_lpm_config *config);
 
 /**
  * Find an existing LPM object and return a pointer to it.
@@ -204,6 +251,31 @@ rte_lpm_find_existing(const char *name);
 void
 rte_lpm_free(struct rte_lpm *lpm);
 
+/**
+ * Attach an RCU QSBR variable to an LPM object, so that the tbl8 groups
+ * freed by rte_lpm_delete() are reused only once all the reader threads
+ * registered on the variable have reported a quiescent state.
+ *
+ * In RTE_LPM_QSBR_MODE_DQ mode, the freed groups are queued and reclaimed
+ * by later calls to rte_lpm_delete(), or by rte_lpm_add() when no free
+ * group is left; rte_lpm_add() returns -ENOSPC if no queued group can be
+ * reclaimed yet. In RTE_LPM_QSBR_MODE_SYNC mode, rte_lpm_delete() blocks
+ * until the group it frees can be reused.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameter passed to function
+ *    - -EEXIST - an RCU QSBR variable is already attached
+ *    - -ENOMEM - the defer queue could not be allocated
+ */
+int
+rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm,
+		const struct rte_lpm_rcu_config *cfg);
+
 /**
  * Add a rule to the LPM table.
  *
@@ -214,12 +286,14 @@ rte_lpm_free(struct rte_lpm *lpm);
  * @param depth
  *   Depth of the rule to be added to the LPM table
  * @param next_hop
- *   Next hop of the rule to be added to the LPM table
+ *   Next hop of the rule to be added to the LPM table, up to
+ *   RTE_LPM_MAX_NEXT_HOP
  * @return
  *   0 on success, negative value otherwise
  */
 int
-rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
+rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+		uint32_t next_hop);
 
 /**
  * Check if a rule is present in the LPM table,
@@ -238,7 +312,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop);
+uint32_t *next_hop);
 
 /**
  * Delete a rule from the LPM table.
@@ -256,7 +330,8 @@ int
 rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth);
 
 /**
- * Delete all rules from the LPM table.
+ * Delete all rules from the LPM table. The table is cleared in place, so
+ * no lookup may run concurrently.
  *
  * @param lpm
  *   LPM object handle
@@ -277,28 +352,32 @@ rte_lpm_delete_all(struct rte_lpm *lpm);
  *   -EINVAL for incorrect arguments, -ENOENT on lookup miss, 0 on lookup hit
  */
 static inline int
-rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
+rte_lpm_lookup(const struct rte_lpm *lpm, uint32_t ip, uint32_t *next_hop)
 {
 	unsigned tbl24_index = (ip >> 8);
-	uint16_t tbl_entry;
+	uint32_t tbl_entry;
+	const uint32_t *ptbl;
 
 	/* DEBUG: Check user input arguments. */
 	RTE_LPM_RETURN_IF_TRUE(((lpm == NULL) || (next_hop == NULL)), -EINVAL);
 
 	/* Copy tbl24 entry */
-	tbl_entry = *(const uint16_t *)&lpm->tbl24[tbl24_index];
+	ptbl = (const uint32_t *)&lpm->tbl24[tbl24_index];
+	tbl_entry = *ptbl;
 
 	/* Copy tbl8 entry (only if needed) */
 	if (unlikely((tbl_entry & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 		unsigned tbl8_index = (uint8_t)ip +
-				((uint8_t)tbl_entry * RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
+				((tbl_entry & RTE_LPM_NEXT_HOP_MASK) *
+				 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-		tbl_entry = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+		ptbl = (const uint32_t *)&lpm->tbl8[tbl8_index];
+		tbl_entry = *ptbl;
 	}
 
-	*next_hop = (uint8_t)tbl_entry;
+	*next_hop = tbl_entry & RTE_LPM_NEXT_HOP_MASK;
 	return (tbl_entry & RTE_LPM_LOOKUP_SUCCESS) ? 0 : -ENOENT;
 }
 
@@ -312,10 +391,10 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
  *   Array of IPs to be looked up in the LPM table
  * @param next_hops
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an array of two byte values. The most significant byte in each
+ *   This is an array of four byte values. The most significant byte in each
  *   value says whether the lookup was successful (bitmask
- *   RTE_LPM_LOOKUP_SUCCESS is set). The least significant byte is the
- *   actual next hop.
+ *   RTE_LPM_LOOKUP_SUCCESS is set). The three least significant bytes are
+ *   the actual next hop.
  * @param n
  *   Number of elements in ips (and next_hops) array to lookup. This should be a
  *   compile time constant, and divisible by 8 for best performance.
@@ -326,11 +405,12 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
 		rte_lpm_lookup_bulk_func(lpm, ips, next_hops, n)
 
 static inline int
-rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
-		uint16_t * next_hops, const unsigned n)
+rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, const unsigned n)
 {
 	unsigned i;
 	unsigned tbl24_indexes[n];
+	const uint32_t *ptbl;
 
 	/* DEBUG: Check user input arguments. */
 	RTE_LPM_RETURN_IF_TRUE(((lpm == NULL) || (ips == NULL) ||
@@ -342,24 +422,26 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
 
 	for (i = 0; i < n; i++) {
 		/* Simply copy tbl24 entry to output */
-		next_hops[i] = *(const uint16_t *)&lpm->tbl24[tbl24_indexes[i]];
+		ptbl = (const uint32_t *)&lpm->tbl24[tbl24_indexes[i]];
+		next_hops[i] = *ptbl;
 
 		/* Overwrite output with tbl8 entry if needed */
 		if (unlikely((next_hops[i] & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 				RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 			unsigned tbl8_index = (uint8_t)ips[i] +
-					((uint8_t)next_hops[i] *
+					((next_hops[i] & RTE_LPM_NEXT_HOP_MASK) *
 					 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-			next_hops[i] = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+			ptbl = (const uint32_t *)&lpm->tbl8[tbl8_index];
+			next_hops[i] = *ptbl;
 		}
 	}
 	return 0;
 }
 
 /* Mask four results. */
-#define	 RTE_LPM_MASKX4_RES	UINT64_C(0x00ff00ff00ff00ff)
+#define	 RTE_LPM_MASKX4_RES	UINT64_C(0x00ffffff00ffffff)
 
 /**
  * Lookup four IP addresses in an LPM table.
@@ -370,10 +452,10 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   Four IPs to be looked up in the LPM table
  * @param hop
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an 4 elements array of two byte values.
- *   If the lookup was succesfull for the given IP, then least significant byte
- *   of the corresponding element is the  actual next hop and the most
- *   significant byte is zero.
+ *   This is an 4 elements array of four byte values.
+ *   If the lookup was succesfull for the given IP, then least significant
+ *   three bytes of the corresponding element are the actual next hop and the
+ *   most significant byte is zero.
  *   If the lookup for the given IP failed, then corresponding element would
  *   contain default value, see description of then next parameter.
  * @param defv
@@ -381,36 +463,33 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   if lookup would fail.
  */
 static inline void
-rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
-	uint16_t defv)
+rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint32_t hop[4],
+	uint32_t defv)
 {
 	__m128i i24;
 	rte_xmm_t i8;
-	uint16_t tbl[4];
-	uint64_t idx, pt;
+	uint32_t tbl[4];
+	uint64_t idx, pt, pt2;
+	const uint32_t *ptbl;
 
 	const __m128i mask8 =
 		_mm_set_epi32(UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX);
 
 	/*
-	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 4 LPM entries
-	 * as one 64-bit value (0x0300030003000300).
+	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 2 LPM entries
+	 * as one 64-bit value (0x0300000003000000).
 	 */
 	const uint64_t mask_xv =
 		((uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 16 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 48);
+		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32);
 
 	/*
-	 * RTE_LPM_LOOKUP_SUCCESS for 4 LPM entries
-	 * as one 64-bit value (0x0100010001000100).
+	 * RTE_LPM_LOOKUP_SUCCESS for 2 LPM entries
+	 * as one 64-bit value (0x0100000001000000).
 	 */
 	const uint64_t mask_v =
 		((uint64_t)RTE_LPM_LOOKUP_SUCCESS |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 16 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 48);
+		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32);
 
 	/* get 4 indexes for tbl24[]. */
 	i24 = _mm_srli_epi32(ip, CHAR_BIT);
@@ -419,60 +498,131 @@ rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
 	idx = _mm_cvtsi128_si64(i24);
 	i24 = _mm_srli_si128(i24, sizeof(uint64_t));
 
-	tbl[0] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[1] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	ptbl = (const uint32_t *)&lpm->tbl24[(uint32_t)idx];
+	tbl[0] = *ptbl;
+	ptbl = (const uint32_t *)&lpm->tbl24[idx >> 32];
+	tbl[1] = *ptbl;
 
 	idx = _mm_cvtsi128_si64(i24);
 
-	tbl[2] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[3] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	ptbl = (const uint32_t *)&lpm->tbl24[(uint32_t)idx];
+	tbl[2] = *ptbl;
+	ptbl = (const uint32_t *)&lpm->tbl24[idx >> 32];
+	tbl[3] = *ptbl;
 
 	/* get 4 indexes for tbl8[]. */
 	i8.x = _mm_and_si128(ip, mask8);
 
 	pt = (uint64_t)tbl[0] |
-		(uint64_t)tbl[1] << 16 |
-		(uint64_t)tbl[2] << 32 |
-		(uint64_t)tbl[3] << 48;
+		(uint64_t)tbl[1] << 32;
+	pt2 = (uint64_t)tbl[2] |
+		(uint64_t)tbl[3] << 32;
 
 	/* search successfully finished for all 4 IP addresses. */
-	if (likely((pt & mask_xv) == mask_v)) {
-		uintptr_t ph = (uintptr_t)hop;
-		*(uint64_t *)ph = pt & RTE_LPM_MASKX4_RES;
+	if (likely((pt & mask_xv) == mask_v) &&
+			likely((pt2 & mask_xv) == mask_v)) {
+		*(uint64_t *)hop = pt & RTE_LPM_MASKX4_RES;
+		*(uint64_t *)(hop + 2) = pt2 & RTE_LPM_MASKX4_RES;
 		return;
 	}
 
 	if (unlikely((pt & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[0] = i8.u32[0] +
-			(uint8_t)tbl[0] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[0] = *(const uint16_t *)&lpm->tbl8[i8.u32[0]];
+			(tbl[0] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[0]];
+		tbl[0] = *ptbl;
 	}
-	if (unlikely((pt >> 16 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[1] = i8.u32[1] +
-			(uint8_t)tbl[1] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[1] = *(const uint16_t *)&lpm->tbl8[i8.u32[1]];
+			(tbl[1] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[1]];
+		tbl[1] = *ptbl;
 	}
-	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[2] = i8.u32[2] +
-			(uint8_t)tbl[2] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[2] = *(const uint16_t *)&lpm->tbl8[i8.u32[2]];
+			(tbl[2] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[2]];
+		tbl[2] = *ptbl;
 	}
-	if (unlikely((pt >> 48 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 		i8.u32[3] = i8.u32[3] +
-			(uint8_t)tbl[3] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[3] = *(const uint16_t *)&lpm->tbl8[i8.u32[3]];
+			(tbl[3] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		ptbl = (const uint32_t *)&lpm->tbl8[i8.u32[3]];
+		tbl[3] = *ptbl;
 	}
 
-	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[0] : defv;
-	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[1] : defv;
-	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[2] : defv;
-	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[3] : defv;
+	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[0] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[1] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[2] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[3] & RTE_LPM_NEXT_HOP_MASK : defv;
 }
 
+/**
+ * Select the method used by rte_lpm_lookup_burst() for an LPM table.
+ * The best method available is selected when the table is created.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param alg
+ *   Lookup method, RTE_LPM_LOOKUP_DEFAULT for the best one available
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments, -ENOTSUP if the method
+ *   is not supported by the build or by the CPU
+ */
+int
+rte_lpm_set_lookup_alg(struct rte_lpm *lpm, enum rte_lpm_lookup_alg alg);
+
+/**
+ * Lookup a burst of IP addresses in an LPM table, using the method
+ * selected for the table. The AVX2 method looks up eight addresses at
+ * a time with gathers, the SSE one four at a time with
+ * rte_lpm_lookupx4(), and the remaining addresses one by one.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param ips
+ *   Array of IPs to be looked up in the LPM table
+ * @param next_hops
+ *   Array of next hops. For each IP, the next hop of the most specific rule
+ *   found, or defv on lookup miss.
+ * @param n
+ *   Number of elements in ips (and next_hops) array to lookup
+ * @param defv
+ *   Value stored in next_hops for the IPs which do not match any rule
+ * @return
+ *   -EINVAL for incorrect arguments, otherwise 0
+ */
+int
+rte_lpm_lookup_burst(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv);
+
+/**
+ * Lookup a burst of IP addresses in an LPM table, using the given method.
+ * See rte_lpm_lookup_burst() for the parameters.
+ *
+ * @param alg
+ *   Lookup method
+ * @return
+ *   -EINVAL for incorrect arguments, -ENOTSUP if the method is not
+ *   supported by the build or by the CPU, otherwise 0
+ */
+int
+rte_lpm_lookup_burst_alg(const struct rte_lpm *lpm, const uint32_t *ips,
+		uint32_t *next_hops, unsigned n, uint32_t defv,
+		enum rte_lpm_lookup_alg alg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,7 @@
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
 #include <rte_per_lcore.h>
+#include <rte_prefetch.h>
 #include <rte_string_fns.h>
 #include <rte_errno.h>
 #include <rte_rwlock.h>
@@ -68,6 +69,12 @@
 #define BYTE_SIZE                                 8
 #define BYTES2_SIZE                              16
 
+/* Number of addresses walked in lockstep by the bulk lookup. */
+#define LOOKUP_BULK_BURST                        16
+
+/* Number of rule trie nodes allocated at once. */
+#define RULE_NODES_PER_CHUNK                   1024
+
 #define lpm6_tbl8_gindex next_hop
 
 /** Flags for setting an entry as valid/invalid. */
@@ -94,11 +101,27 @@ struct rte_lpm6_tbl_entry {
 	uint32_t ext_entry :1;   /**< External entry. */
 };
 
-/** Rules tbl entry structure. */
-struct rte_lpm6_rule {
+/**
+ * Rule trie node. The rules are kept in a path-compressed binary trie
+ * keyed by the masked IP and the depth, so that adding, finding and
+ * deleting a rule costs at most one node per bit of the prefix. Nodes
+ * which are not valid are branching points only and always have two
+ * children.
+ */
+struct rte_lpm6_rule_node {
+	struct rte_lpm6_rule_node *left;   /**< Child for a 0 bit. */
+	struct rte_lpm6_rule_node *right;  /**< Child for a 1 bit. */
+	struct rte_lpm6_rule_node *parent; /**< Parent, NULL for the root. */
 	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE]; /**< Rule IP address. */
-	uint8_t next_hop; /**< Rule next hop. */
+	uint32_t next_hop; /**< Rule next hop. */
 	uint8_t depth; /**< Rule depth. */
+	uint8_t valid; /**< Set if the node holds a rule. */
+};
+
+/** Block of rule trie nodes. */
+struct rte_lpm6_rule_chunk {
+	struct rte_lpm6_rule_chunk *next; /**< Next allocated block. */
+	struct rte_lpm6_rule_node nodes[RULE_NODES_PER_CHUNK];
 };
 
 /** LPM6 structure. */
@@ -108,10 +131,16 @@ struct rte_lpm6 {
 	uint32_t max_rules;              /**< Max number of rules. */
 	uint32_t used_rules;             /**< Used rules so far. */
 	uint32_t number_tbl8s;           /**< Number of tbl8s to allocate. */
-	uint32_t next_tbl8;              /**< Next tbl8 to be used. */
+	uint32_t tbl8_free_count;        /**< Number of free tbl8 groups. */
+	int socket_id;                   /**< Socket of the rule trie nodes. */
+
+	/* Rules. */
+	struct rte_lpm6_rule_node *rules_root; /**< Root of the rule trie. */
+	struct rte_lpm6_rule_node *free_nodes; /**< Free rule trie nodes. */
+	struct rte_lpm6_rule_chunk *chunks;    /**< Allocated node blocks. */
+	uint32_t *tbl8_free; /**< Stack of the free tbl8 group indexes. */
 
 	/* LPM Tables. */
-	struct rte_lpm6_rule *rules_tbl; /**< LPM rules. */
 	struct rte_lpm6_tbl_entry tbl24[RTE_LPM6_TBL24_NUM_ENTRIES]
 			__rte_cache_aligned; /**< LPM tbl24 table. */
 	struct rte_lpm6_tbl_entry tbl8[0]
@@ -142,6 +171,47 @@ mask_ip(uint8_t *ip, uint8_t depth)
 		}
 }
 
+/* Returns the bit of the IP address at the given position (0 is the MSB). */
+static inline int
+ip_get_bit(const uint8_t *ip, uint8_t pos)
+{
+	return (ip[pos / BYTE_SIZE] >> (BYTE_SIZE - 1 - pos % BYTE_SIZE)) & 1;
+}
+
+/* Checks whether the first depth bits of two IP addresses are equal. */
+static inline int
+ip_prefix_match(const uint8_t *ip1, const uint8_t *ip2, uint8_t depth)
+{
+	unsigned bytes = depth / BYTE_SIZE;
+	unsigned bits = depth % BYTE_SIZE;
+
+	if (memcmp(ip1, ip2, bytes) != 0)
+		return 0;
+	if (bits == 0)
+		return 1;
+	return ((ip1[bytes] ^ ip2[bytes]) &
+			(uint8_t)(UINT8_MAX << (BYTE_SIZE - bits))) == 0;
+}
+
+/* Returns the length of the common prefix of two IPs, capped to max. */
+static inline uint8_t
+ip_common_depth(const uint8_t *ip1, const uint8_t *ip2, uint8_t max)
+{
+	unsigned i, depth;
+	uint8_t diff;
+
+	for (i = 0; i < RTE_LPM6_IPV6_ADDR_SIZE; i++) {
+		diff = ip1[i] ^ ip2[i];
+		if (diff != 0) {
+			/* diff is promoted to a 32-bit int. */
+			depth = i * BYTE_SIZE + __builtin_clz(diff) - 24;
+			return (uint8_t)RTE_MIN(depth, (unsigned)max);
+		}
+	}
+
+	return max;
+}
+
 /*
  * Allocates memory for LPM object
  */
@@ -152,8 +222,9 @@ rte_lpm6_create(const char *name, int socket_id,
 	char mem_name[RTE_LPM6_NAMESIZE];
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_tailq_entry *te;
-	uint64_t mem_size, rules_size;
+	uint64_t mem_size;
 	struct rte_lpm6_list *lpm_list;
+	uint32_t i;
 
 	lpm_list = RTE_TAILQ_CAST(rte_lpm6_tailq.head, rte_lpm6_list);
 
@@ -161,7 +232,7 @@ rte_lpm6_create(const char *name, int socket_id,
 
 	/* Check user arguments. */
 	if ((name == NULL) || (socket_id < -1) || (config == NULL) ||
-			(config->max_rules == 0) ||
+			(config->max_rules == 0) || (config->number_tbl8s == 0) ||
 			config->number_tbl8s > RTE_LPM6_TBL8_MAX_NUM_GROUPS) {
 		rte_errno = EINVAL;
 		return NULL;
@@ -172,7 +243,6 @@ rte_lpm6_create(const char *name, int socket_id,
 	/* Determine the amount of memory to allocate. */
 	mem_size = sizeof(*lpm) + (sizeof(lpm->tbl8[0]) *
 			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * config->number_tbl8s);
-	rules_size = sizeof(struct rte_lpm6_rule) * config->max_rules;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -202,12 +272,13 @@ rte_lpm6_create(const char *name, int socket_id,
 		goto exit;
 	}
 
-	lpm->rules_tbl = (struct rte_lpm6_rule *)rte_zmalloc_socket(NULL,
-			(size_t)rules_size, RTE_CACHE_LINE_SIZE, socket_id);
+	lpm->tbl8_free = (uint32_t *)rte_zmalloc_socket(NULL,
+			sizeof(uint32_t) * config->number_tbl8s, 0, socket_id);
 
-	if (lpm->rules_tbl == NULL) {
+	if (lpm->tbl8_free == NULL) {
 		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
 		rte_free(lpm);
+		lpm = NULL;
 		rte_free(te);
 		goto exit;
 	}
@@ -215,8 +286,14 @@ rte_lpm6_create(const char *name, int socket_id,
 	/* Save user arguments. */
 	lpm->max_rules = config->max_rules;
 	lpm->number_tbl8s = config->number_tbl8s;
+	lpm->socket_id = socket_id;
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
+	/* Lowest group indexes are handed out first. */
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
+
 	te->data = (void *) lpm;
 
 	TAILQ_INSERT_TAIL(lpm_list, te, next);
@@ -255,6 +332,24 @@ rte_lpm6_find_existing(const char *name)
 	return l;
 }
 
+/*
+ * Releases all the rule trie nodes.
+ */
+static void
+rule_chunks_free(struct rte_lpm6 *lpm)
+{
+	struct rte_lpm6_rule_chunk *chunk;
+
+	while (lpm->chunks != NULL) {
+		chunk = lpm->chunks;
+		lpm->chunks = chunk->next;
+		rte_free(chunk);
+	}
+
+	lpm->rules_root = NULL;
+	lpm->free_nodes = NULL;
+}
+
 /*
  * Deallocates memory for given LPM table.
  */
@@ -286,49 +381,259 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rule_chunks_free(lpm);
+	rte_free(lpm->tbl8_free);
 	rte_free(lpm);
 	rte_free(te);
 }
 
 /*
- * Checks if a rule already exists in the rules table and updates
+ * Takes a rule trie node from the free list, allocating a new block of
+ * nodes when the list is empty.
+ */
+static struct rte_lpm6_rule_node *
+rule_node_alloc(struct rte_lpm6 *lpm)
+{
+	struct rte_lpm6_rule_chunk *chunk;
+	struct rte_lpm6_rule_node *node;
+	unsigned i;
+
+	if (lpm->free_nodes == NULL) {
+		chunk = rte_zmalloc_socket(NULL, sizeof(*chunk),
+				RTE_CACHE_LINE_SIZE, lpm->socket_id);
+		if (chunk == NULL)
+			return NULL;
+
+		chunk->next = lpm->chunks;
+		lpm->chunks = chunk;
+		for (i = 0; i < RULE_NODES_PER_CHUNK; i++) {
+			chunk->nodes[i].left = lpm->free_nodes;
+			lpm->free_nodes = &chunk->nodes[i];
+		}
+	}
+
+	node = lpm->free_nodes;
+	lpm->free_nodes = node->left;
+	memset(node, 0, sizeof(*node));
+
+	return node;
+}
+
+/*
+ * Returns a rule trie node to the free list.
+ */
+static inline void
+rule_node_free(struct rte_lpm6 *lpm, struct rte_lpm6_rule_node *node)
+{
+	node->left = lpm->free_nodes;
+	lpm->free_nodes = node;
+}
+
+/*
+ * Checks if a rule already exists in the rule trie and updates
  * the nexthop if so. Otherwise it adds a new rule if enough space is available.
  */
-static inline int32_t
-rule_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t next_hop, uint8_t depth)
+static int
+rule_add(struct rte_lpm6 *lpm, const uint8_t *ip, uint32_t next_hop,
+		uint8_t depth)
 {
-	uint32_t rule_index;
+	struct rte_lpm6_rule_node **slot = &lpm->rules_root;
+	struct rte_lpm6_rule_node *parent = NULL;
+	struct rte_lpm6_rule_node *cur, *node, *common;
+	uint8_t common_depth;
 
-	/* Scan through rule list to see if rule already exists. */
-	for (rule_index = 0; rule_index < lpm->used_rules; rule_index++) {
+	/* Walk down while the nodes are prefixes of the new rule. */
+	for (cur = *slot; cur != NULL && cur->depth <= depth &&
+			ip_prefix_match(cur->ip, ip, cur->depth); cur = *slot) {
 
 		/* If rule already exists update its next_hop and return. */
-		if ((memcmp (lpm->rules_tbl[rule_index].ip, ip,
-				RTE_LPM6_IPV6_ADDR_SIZE) == 0) &&
-				lpm->rules_tbl[rule_index].depth == depth) {
-			lpm->rules_tbl[rule_index].next_hop = next_hop;
+		if (cur->depth == depth) {
+			if (!cur->valid) {
+				if (lpm->used_rules == lpm->max_rules)
+					return -ENOSPC;
+				cur->valid = VALID;
+				lpm->used_rules++;
+			}
+			cur->next_hop = next_hop;
 
-			return rule_index;
+			return 0;
 		}
+
+		parent = cur;
+		slot = ip_get_bit(ip, cur->depth) ? &cur->right : &cur->left;
 	}
 
 	/*
-	 * If rule does not exist check if there is space to add a new rule to
-	 * this rule group. If there is no space return error.
+	 * If rule does not exist check if there is space to add a new rule.
+	 * If there is no space return error.
 	 */
-	if (lpm->used_rules == lpm->max_rules) {
+	if (lpm->used_rules == lpm->max_rules)
 		return -ENOSPC;
-	}
 
-	/* If there is space for the new rule add it. */
-	rte_memcpy(lpm->rules_tbl[rule_index].ip, ip, RTE_LPM6_IPV6_ADDR_SIZE);
-	lpm->rules_tbl[rule_index].next_hop = next_hop;
-	lpm->rules_tbl[rule_index].depth = depth;
+	node = rule_node_alloc(lpm);
+	if (node == NULL)
+		return -ENOMEM;
+
+	rte_memcpy(node->ip, ip, RTE_LPM6_IPV6_ADDR_SIZE);
+	node->next_hop = next_hop;
+	node->depth = depth;
+	node->valid = VALID;
+	node->parent = parent;
 
-	/* Increment the used rules counter for this rule group. */
+	if (cur != NULL) {
+		common_depth = ip_common_depth(cur->ip, ip,
+				RTE_MIN(depth, cur->depth));
+
+		if (common_depth == depth) {
+			/* The new rule is a prefix of the current node. */
+			if (ip_get_bit(cur->ip, depth))
+				node->right = cur;
+			else
+				node->left = cur;
+			cur->parent = node;
+		} else {
+			/* Both hang from a branching node on the common prefix. */
+			common = rule_node_alloc(lpm);
+			if (common == NULL) {
+				rule_node_free(lpm, node);
+				return -ENOMEM;
+			}
+
+			rte_memcpy(common->ip, ip, RTE_LPM6_IPV6_ADDR_SIZE);
+			mask_ip(common->ip, common_depth);
+			common->depth = common_depth;
+			common->parent = parent;
+			if (ip_get_bit(ip, common_depth)) {
+				common->right = node;
+				common->left = cur;
+			} else {
+				common->left = node;
+				common->right = cur;
+			}
+			node->parent = common;
+			cur->parent = common;
+			node = common;
+		}
+	}
+
+	*slot = node;
 	lpm->used_rules++;
 
-	return rule_index;
+	return 0;
+}
+
+/*
+ * Finds a rule in the rule trie.
+ * NOTE: Valid range for depth parameter is 1 .. 128 inclusive.
+ */
+static inline struct rte_lpm6_rule_node *
+rule_find(struct rte_lpm6 *lpm, const uint8_t *ip, uint8_t depth)
+{
+	struct rte_lpm6_rule_node *node = lpm->rules_root;
+
+	/* Intermediate prefixes are checked once at the end of the walk. */
+	while (node != NULL && node->depth < depth)
+		node = ip_get_bit(ip, node->depth) ? node->right : node->left;
+
+	if (node != NULL && node->depth == depth && node->valid &&
+			ip_prefix_match(node->ip, ip, depth))
+		return node;
+
+	/* If rule is not found return NULL. */
+	return NULL;
+}
+
+/*
+ * Deletes a rule from the rule trie, and the branching nodes which are
+ * no longer needed.
+ */
+static void
+rule_delete(struct rte_lpm6 *lpm, struct rte_lpm6_rule_node *node)
+{
+	struct rte_lpm6_rule_node *child, *parent, **slot;
+
+	node->valid = INVALID;
+	lpm->used_rules--;
+
+	while (node != NULL && !node->valid) {
+		if (node->left != NULL && node->right != NULL)
+			return;
+
+		child = (node->left != NULL) ? node->left : node->right;
+		parent = node->parent;
+		if (parent == NULL)
+			slot = &lpm->rules_root;
+		else if (parent->left == node)
+			slot = &parent->left;
+		else
+			slot = &parent->right;
+
+		*slot = child;
+		if (child != NULL)
+			child->parent = parent;
+		rule_node_free(lpm, node);
+
+		/* The parent kept as many children as it had. */
+		if (child != NULL)
+			return;
+		node = parent;
+	}
+}
+
+/*
+ * Takes a tbl8 group from the free stack and fills it with the entry
+ * it replaces. Returns the group index or -ENOSPC.
+ */
+static int32_t
+tbl8_alloc(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry fill)
+{
+	uint32_t tbl8_gindex, tbl8_group_start, i;
+
+	if (lpm->tbl8_free_count == 0)
+		return -ENOSPC;
+
+	tbl8_gindex = lpm->tbl8_free[--lpm->tbl8_free_count];
+	tbl8_group_start = tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+
+	for (i = 0; i < RTE_LPM6_TBL8_GROUP_NUM_ENTRIES; i++)
+		lpm->tbl8[tbl8_group_start + i] = fill;
+
+	return tbl8_gindex;
+}
+
+/*
+ * If every entry of a tbl8 group is the same final entry, stores that
+ * entry in the table entry pointing to the group and frees the group.
+ * The entry covers the first bits of the address, so it can only take
+ * the place of the group if the rule of the group is no deeper.
+ * Returns 1 if the group was freed.
+ */
+static int
+tbl8_collapse(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *entry,
+		uint8_t bits)
+{
+	const struct rte_lpm6_tbl_entry *group;
+	const uint32_t *tbl8;
+	uint32_t tbl8_gindex, first, i;
+
+	tbl8_gindex = entry->lpm6_tbl8_gindex;
+	group = &lpm->tbl8[tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+	tbl8 = (const uint32_t *)group;
+
+	if (group->ext_entry || (group->valid && group->depth > bits))
+		return 0;
+
+	first = tbl8[0];
+
+	for (i = 1; i < RTE_LPM6_TBL8_GROUP_NUM_ENTRIES; i++)
+		if (tbl8[i] != first)
+			return 0;
+
+	/* Single store, so lookups see either the group or the entry. */
+	*entry = *group;
+	lpm->tbl8_free[lpm->tbl8_free_count++] = tbl8_gindex;
+
+	return 1;
 }
 
 /*
@@ -338,7 +643,7 @@ rule_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t next_hop, uint8_t depth)
  */
 static void
 expand_rule(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl8_group_end, tbl8_gindex_next, j;
 
@@ -375,9 +680,9 @@ expand_rule(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
 static inline int
 add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 		struct rte_lpm6_tbl_entry **tbl_next, uint8_t *ip, uint8_t bytes,
-		uint8_t first_byte, uint8_t depth, uint8_t next_hop)
+		uint8_t first_byte, uint8_t depth, uint32_t next_hop)
 {
-	uint32_t tbl_index, tbl_range, tbl8_group_start, tbl8_group_end, i;
+	uint32_t tbl_index, tbl_range, i;
 	int32_t tbl8_gindex;
 	int8_t bitshift;
 	uint8_t bits_covered;
@@ -437,46 +742,19 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 	 * and calculate the index to the next table.
 	 */
 	else {
-		/* If it's invalid a new tbl8 is needed */
-		if (!tbl[tbl_index].valid) {
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
-
-			struct rte_lpm6_tbl_entry new_tbl_entry = {
-				.lpm6_tbl8_gindex = tbl8_gindex,
-				.depth = 0,
-				.valid = VALID,
-				.valid_group = VALID,
-				.ext_entry = 1,
-			};
-
-			tbl[tbl_index] = new_tbl_entry;
-		}
 		/*
-		 * If it's valid but not extended the rule that was stored *
-		 * here needs to be moved to the next table.
+		 * If it's not extended a new tbl8 is needed, holding the
+		 * rule that was stored here (if any) in all its entries.
 		 */
-		else if (tbl[tbl_index].ext_entry == 0) {
-			/* Search for free tbl8 group. */
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
-
-			tbl8_group_start = tbl8_gindex *
-					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
-			tbl8_group_end = tbl8_group_start +
-					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
-
-			/* Populate new tbl8 with tbl value. */
-			for (i = tbl8_group_start; i < tbl8_group_end; i++) {
-				lpm->tbl8[i].valid = VALID;
-				lpm->tbl8[i].depth = tbl[tbl_index].depth;
-				lpm->tbl8[i].next_hop = tbl[tbl_index].next_hop;
-				lpm->tbl8[i].ext_entry = 0;
-			}
+		if (!tbl[tbl_index].valid || tbl[tbl_index].ext_entry == 0) {
+			struct rte_lpm6_tbl_entry fill = { 0 };
+
+			if (tbl[tbl_index].valid)
+				fill = tbl[tbl_index];
+
+			tbl8_gindex = tbl8_alloc(lpm, fill);
+			if (tbl8_gindex < 0)
+				return tbl8_gindex;
 
 			/*
 			 * Update tbl entry to point to new tbl8 entry. Note: The
@@ -506,29 +784,29 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
  */
 int
 rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	struct rte_lpm6_tbl_entry *tbl;
 	struct rte_lpm6_tbl_entry *tbl_next;
-	int32_t rule_index;
 	int status;
 	uint8_t masked_ip[RTE_LPM6_IPV6_ADDR_SIZE];
 	int i;
 
 	/* Check user arguments. */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH))
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH) ||
+			(next_hop > RTE_LPM6_MAX_NEXT_HOP))
 		return -EINVAL;
 
 	/* Copy the IP and mask it to avoid modifying user's input data. */
 	memcpy(masked_ip, ip, RTE_LPM6_IPV6_ADDR_SIZE);
 	mask_ip(masked_ip, depth);
 
-	/* Add the rule to the rule table. */
-	rule_index = rule_add(lpm, masked_ip, next_hop, depth);
+	/* Add the rule to the rule trie. */
+	status = rule_add(lpm, masked_ip, next_hop, depth);
 
 	/* If there is no space available for new rule return error. */
-	if (rule_index < 0) {
-		return rule_index;
+	if (status < 0) {
+		return status;
 	}
 
 	/* Inspect the first three bytes through tbl24 on the first step. */
@@ -567,7 +845,7 @@ rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
 static inline int
 lookup_step(const struct rte_lpm6 *lpm, const struct rte_lpm6_tbl_entry *tbl,
 		const struct rte_lpm6_tbl_entry **tbl_next, uint8_t *ip,
-		uint8_t first_byte, uint8_t *next_hop)
+		uint8_t first_byte, uint32_t *next_hop)
 {
 	uint32_t tbl8_index, tbl_entry;
 
@@ -587,7 +865,7 @@ lookup_step(const struct rte_lpm6 *lpm, const struct rte_lpm6_tbl_entry *tbl,
 		return 1;
 	} else {
 		/* If not extended then we can have a match. */
-		*next_hop = (uint8_t)tbl_entry;
+		*next_hop = tbl_entry & RTE_LPM6_MAX_NEXT_HOP;
 		return (tbl_entry & RTE_LPM6_LOOKUP_SUCCESS) ? 0 : -ENOENT;
 	}
 }
@@ -596,10 +874,10 @@ lookup_step(const struct rte_lpm6 *lpm, const struct rte_lpm6_tbl_entry *tbl,
  * Looks up an IP
  */
 int
-rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
+rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint32_t *next_hop)
 {
 	const struct rte_lpm6_tbl_entry *tbl;
-	const struct rte_lpm6_tbl_entry *tbl_next;
+	const struct rte_lpm6_tbl_entry *tbl_next = NULL;
 	int status;
 	uint8_t first_byte;
 	uint32_t tbl24_index;
@@ -626,70 +904,70 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
 
 /*
  * Looks up a group of IP addresses
+ *
+ * The addresses are processed in bursts whose walks are interleaved: at
+ * each round every address of the burst which is still on an extended
+ * entry moves down one level, and the entry it will read on the next
+ * round is prefetched. The memory accesses of up to LOOKUP_BULK_BURST
+ * addresses are then in flight together instead of one dependent chain
+ * of up to 14 accesses after the other.
  */
 int
 rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
-		int16_t * next_hops, unsigned n)
+		int32_t *next_hops, unsigned n)
 {
-	unsigned i;
-	const struct rte_lpm6_tbl_entry *tbl;
-	const struct rte_lpm6_tbl_entry *tbl_next;
-	uint32_t tbl24_index;
-	uint8_t first_byte, next_hop;
-	int status;
+	const uint32_t *tbl[LOOKUP_BULK_BURST];
+	uint8_t active[LOOKUP_BULK_BURST];
+	unsigned i, j, k, burst, n_active, n_next;
+	uint32_t tbl24_index, tbl_entry;
+	uint8_t byte;
 
 	/* DEBUG: Check user input arguments. */
 	if ((lpm == NULL) || (ips == NULL) || (next_hops == NULL)) {
 		return -EINVAL;
 	}
 
-	for (i = 0; i < n; i++) {
-		first_byte = LOOKUP_FIRST_BYTE;
-		tbl24_index = (ips[i][0] << BYTES2_SIZE) |
-				(ips[i][1] << BYTE_SIZE) | ips[i][2];
-
-		/* Calculate pointer to the first entry to be inspected */
-		tbl = &lpm->tbl24[tbl24_index];
-
-		do {
-			/* Continue inspecting following levels until success or failure */
-			status = lookup_step(lpm, tbl, &tbl_next, ips[i], first_byte++,
-					&next_hop);
-			tbl = tbl_next;
-		} while (status == 1);
-
-		if (status < 0)
-			next_hops[i] = -1;
-		else
-			next_hops[i] = next_hop;
-	}
-
-	return 0;
-}
-
-/*
- * Finds a rule in rule table.
- * NOTE: Valid range for depth parameter is 1 .. 128 inclusive.
- */
-static inline int32_t
-rule_find(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
-{
-	uint32_t rule_index;
-
-	/* Scan used rules at given depth to find rule. */
-	for (rule_index = 0; rule_index < lpm->used_rules; rule_index++) {
-		/* If rule is found return the rule index. */
-		if ((memcmp (lpm->rules_tbl[rule_index].ip, ip,
-				RTE_LPM6_IPV6_ADDR_SIZE) == 0) &&
-				lpm->rules_tbl[rule_index].depth == depth) {
-
-			return rule_index;
+	for (i = 0; i < n; i += burst) {
+		burst = RTE_MIN(n - i, (unsigned)LOOKUP_BULK_BURST);
+
+		/* Calculate pointers to the first entries to be inspected */
+		for (k = 0; k < burst; k++) {
+			tbl24_index = (ips[i + k][0] << BYTES2_SIZE) |
+					(ips[i + k][1] << BYTE_SIZE) |
+					ips[i + k][2];
+			tbl[k] = (const uint32_t *)&lpm->tbl24[tbl24_index];
+			rte_prefetch0(tbl[k]);
+			active[k] = (uint8_t)k;
+		}
+		n_active = burst;
+
+		/* Move every unresolved address down one level per round. */
+		for (byte = LOOKUP_FIRST_BYTE - 1; n_active != 0; byte++) {
+			n_next = 0;
+			for (j = 0; j < n_active; j++) {
+				k = active[j];
+				tbl_entry = *tbl[k];
+
+				if ((tbl_entry & RTE_LPM6_VALID_EXT_ENTRY_BITMASK) ==
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK) {
+					tbl[k] = (const uint32_t *)&lpm->tbl8[
+						ips[i + k][byte] +
+						(tbl_entry & RTE_LPM6_TBL8_BITMASK) *
+						RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+					rte_prefetch0(tbl[k]);
+					active[n_next++] = (uint8_t)k;
+				} else if (tbl_entry & RTE_LPM6_LOOKUP_SUCCESS)
+					next_hops[i + k] = (int32_t)(tbl_entry &
+							RTE_LPM6_MAX_NEXT_HOP);
+				else
+					next_hops[i + k] = -1;
+			}
+			n_active = n_next;
 		}
 	}
 
-	/* If rule is not found return -ENOENT. */
-	return -ENOENT;
+	return 0;
 }
 
 /*
@@ -697,10 +975,10 @@ rule_find(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
  */
 int
 rte_lpm6_is_rule_present(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
-uint8_t *next_hop)
+uint32_t *next_hop)
 {
 	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
-	int32_t rule_index;
+	struct rte_lpm6_rule_node *rule;
 
 	/* Check user arguments. */
 	if ((lpm == NULL) || next_hop == NULL || ip == NULL ||
@@ -712,10 +990,10 @@ uint8_t *next_hop)
 	mask_ip(ip_masked, depth);
 
 	/* Look for the rule using rule_find. */
-	rule_index = rule_find(lpm, ip_masked, depth);
+	rule = rule_find(lpm, ip_masked, depth);
 
-	if (rule_index >= 0) {
-		*next_hop = lpm->rules_tbl[rule_index].next_hop;
+	if (rule != NULL) {
+		*next_hop = rule->next_hop;
 		return 1;
 	}
 
@@ -724,18 +1002,70 @@ uint8_t *next_hop)
 }
 
 /*
- * Delete a rule from the rule table.
- * NOTE: Valid range for depth parameter is 1 .. 128 inclusive.
+ * Replaces the table entries set by a deleted rule of the given depth,
+ * in an entry covering the first bits of the address and the tbl8 groups
+ * below it, and frees the groups which end up uniform.
  */
-static inline void
-rule_delete(struct rte_lpm6 *lpm, int32_t rule_index)
+static void
+delete_expand_rule(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *entry,
+		uint8_t bits, uint8_t depth, struct rte_lpm6_tbl_entry repl)
 {
+	uint32_t tbl8_group_start, j;
+
+	if (entry->valid && entry->ext_entry) {
+		tbl8_group_start = entry->lpm6_tbl8_gindex *
+				RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+		for (j = 0; j < RTE_LPM6_TBL8_GROUP_NUM_ENTRIES; j++)
+			delete_expand_rule(lpm, &lpm->tbl8[tbl8_group_start + j],
+					bits + BYTE_SIZE, depth, repl);
+		tbl8_collapse(lpm, entry, bits);
+	} else if (entry->valid && entry->depth == depth)
+		*entry = repl;
+}
+
+/*
+ * Removes a rule from the data structure (tbl24+tbl8s), replacing it
+ * with the given entry of its closest less specific rule.
+ */
+static void
+delete_step(struct rte_lpm6 *lpm, const uint8_t *ip, uint8_t depth,
+		struct rte_lpm6_tbl_entry repl)
+{
+	struct rte_lpm6_tbl_entry *path[RTE_LPM6_IPV6_ADDR_SIZE];
+	struct rte_lpm6_tbl_entry *tbl = lpm->tbl24;
+	uint32_t tbl_index, tbl_range, i;
+	uint8_t bits_covered = ADD_FIRST_BYTE * BYTE_SIZE;
+	unsigned n = 0;
+
+	tbl_index = (ip[0] << BYTES2_SIZE) | (ip[1] << BYTE_SIZE) | ip[2];
+
+	/* Follow the rule path down to the table holding its entries. */
+	while (depth > bits_covered) {
+		/* The path may be incomplete if adding the rule failed. */
+		if (!tbl[tbl_index].valid || !tbl[tbl_index].ext_entry)
+			break;
+
+		path[n++] = &tbl[tbl_index];
+		tbl = &lpm->tbl8[tbl[tbl_index].lpm6_tbl8_gindex *
+				RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+		tbl_index = ip[bits_covered / BYTE_SIZE];
+		bits_covered += BYTE_SIZE;
+	}
+
+	if (depth <= bits_covered) {
+		tbl_range = 1 << (bits_covered - depth);
+		for (i = tbl_index; i < tbl_index + tbl_range; i++)
+			delete_expand_rule(lpm, &tbl[i], bits_covered, depth,
+					repl);
+	}
+
 	/*
-	 * Overwrite redundant rule with last rule in group and decrement rule
-	 * counter.
+	 * Free the groups of the path which are now uniform, deepest first.
+	 * The n-th entry of the path covers the bits before its group.
 	 */
-	lpm->rules_tbl[rule_index] = lpm->rules_tbl[lpm->used_rules-1];
-	lpm->used_rules--;
+	while (n > 0 && tbl8_collapse(lpm, path[n - 1],
+			ADD_FIRST_BYTE * BYTE_SIZE + (n - 1) * BYTE_SIZE))
+		n--;
 }
 
 /*
@@ -744,9 +1074,9 @@ rule_delete(struct rte_lpm6 *lpm, int32_t rule_index)
 int
 rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
 {
-	int32_t rule_to_delete_index;
+	struct rte_lpm6_rule_node *rule, *parent;
+	struct rte_lpm6_tbl_entry repl = { 0 };
 	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
-	unsigned i;
 
 	/*
 	 * Check input arguments.
@@ -759,39 +1089,29 @@ rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
 	memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
 	mask_ip(ip_masked, depth);
 
-	/*
-	 * Find the index of the input rule, that needs to be deleted, in the
-	 * rule table.
-	 */
-	rule_to_delete_index = rule_find(lpm, ip_masked, depth);
+	/* Find the input rule, that needs to be deleted, in the rule trie. */
+	rule = rule_find(lpm, ip_masked, depth);
+	if (rule == NULL)
+		return -ENOENT;
 
 	/*
-	 * Check if rule_to_delete_index was found. If no rule was found the
-	 * function rule_find returns -ENOENT.
+	 * The closest less specific rule is the first valid ancestor in the
+	 * trie: its next hop replaces the deleted one in the tables.
 	 */
-	if (rule_to_delete_index < 0)
-		return rule_to_delete_index;
+	for (parent = rule->parent; parent != NULL && !parent->valid;
+			parent = parent->parent)
+		;
+	if (parent != NULL) {
+		repl.next_hop = parent->next_hop;
+		repl.depth = parent->depth;
+		repl.valid = VALID;
+		repl.valid_group = VALID;
+	}
 
-	/* Delete the rule from the rule table. */
-	rule_delete(lpm, rule_to_delete_index);
+	/* Delete the rule from the rule trie. */
+	rule_delete(lpm, rule);
 
-	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
-	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
-
-	/*
-	 * Add every rule again (except for the one that was removed from
-	 * the rules table).
-	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
-	}
+	delete_step(lpm, ip_masked, depth, repl);
 
 	return 0;
 }
@@ -803,8 +1123,6 @@ int
 rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE], uint8_t *depths, unsigned n)
 {
-	int32_t rule_to_delete_index;
-	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
 	unsigned i;
 
 	/*
@@ -814,45 +1132,9 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 		return -EINVAL;
 	}
 
-	for (i = 0; i < n; i++) {
-		/* Copy the IP and mask it to avoid modifying user's input data. */
-		memcpy(ip_masked, ips[i], RTE_LPM6_IPV6_ADDR_SIZE);
-		mask_ip(ip_masked, depths[i]);
-
-		/*
-		 * Find the index of the input rule, that needs to be deleted, in the
-		 * rule table.
-		 */
-		rule_to_delete_index = rule_find(lpm, ip_masked, depths[i]);
-
-		/*
-		 * Check if rule_to_delete_index was found. If no rule was found the
-		 * function rule_find returns -ENOENT.
-		 */
-		if (rule_to_delete_index < 0)
-			continue;
-
-		/* Delete the rule from the rule table. */
-		rule_delete(lpm, rule_to_delete_index);
-	}
-
-	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
-	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
-
-	/*
-	 * Add every rule again (except for the ones that were removed from
-	 * the rules table).
-	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
-	}
+	/* Rules which are not found are skipped. */
+	for (i = 0; i < n; i++)
+		rte_lpm6_delete(lpm, ips[i], depths[i]);
 
 	return 0;
 }
@@ -863,11 +1145,15 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 void
 rte_lpm6_delete_all(struct rte_lpm6 *lpm)
 {
+	uint32_t i;
+
 	/* Zero used rules counter. */
 	lpm->used_rules = 0;
 
-	/* Zero next tbl8 index. */
-	lpm->next_tbl8 = 0;
+	/* Put back all the tbl8 groups on the free stack. */
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
 
 	/* Zero tbl24. */
 	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
@@ -876,6 +1162,6 @@ rte_lpm6_delete_all(struct rte_lpm6 *lpm)
 	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0]) *
 			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
 
-	/* Delete all rules form the rules table. */
-	memset(lpm->rules_tbl, 0, sizeof(struct rte_lpm6_rule) * lpm->max_rules);
+	/* Delete all rules form the rule trie. */
+	rule_chunks_free(lpm);
 }
@@ -45,6 +45,8 @@ extern "C" {
 
 #define RTE_LPM6_MAX_DEPTH               128
 #define RTE_LPM6_IPV6_ADDR_SIZE           16
+/** Maximum next hop value, next hops are stored on 21 bits. */
+#define RTE_LPM6_MAX_NEXT_HOP             ((1 << 21) - 1)
 /** Max number of characters in LPM name. */
 #define RTE_LPM6_NAMESIZE                 32
 
@@ -54,7 +56,7 @@ struct rte_lpm6;
 /** LPM configuration structure. */
 struct rte_lpm6_config {
 	uint32_t max_rules;      /**< Max number of rules. */
-	uint32_t number_tbl8s;   /**< Number of tbl8s to allocate. */
+	uint32_t number_tbl8s;   /**< Number of tbl8s to allocate (at least 1). */
 	int flags;               /**< This field is currently unused. */
 };
 
@@ -115,13 +117,14 @@ rte_lpm6_free(struct rte_lpm6 *lpm);
  * @param depth
  *   Depth of the rule to be added to the LPM table
  * @param next_hop
- *   Next hop of the rule to be added to the LPM table
+ *   Next hop of the rule to be added to the LPM table, up to
+ *   RTE_LPM6_MAX_NEXT_HOP
  * @return
  *   0 on success, negative value otherwise
  */
 int
 rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
-		uint8_t next_hop);
+		uint32_t next_hop);
 
 /**
  * Check if a rule is present in the LPM table,
@@ -140,7 +143,7 @@ rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
  */
 int
 rte_lpm6_is_rule_present(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
-uint8_t *next_hop);
+uint32_t *next_hop);
 
 /**
  * Delete a rule from the LPM table.
@@ -197,18 +200,22 @@ rte_lpm6_delete_all(struct rte_lpm6 *lpm);
  *   -EINVAL for incorrect arguments, -ENOENT on lookup miss, 0 on lookup hit
  */
 int
-rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop);
+rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint32_t *next_hop);
 
 /**
  * Lookup multiple IP addresses in an LPM table.
  *
+ * The lookups of consecutive addresses are interleaved, so this is
+ * faster than calling rte_lpm6_lookup() for each address when the table
+ * does not fit in the CPU caches.
+ *
  * @param lpm
  *   LPM object handle
  * @param ips
  *   Array of IPs to be looked up in the LPM table
  * @param next_hops
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an array of two byte values. The next hop will be stored on
+ *   This is an array of four byte values. The next hop will be stored on
  *   each position on success; otherwise the position will be set to -1.
  * @param n
  *   Number of elements in ips (and next_hops) array to lookup.
@@ -218,7 +225,7 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop);
 int
 rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
-		int16_t * next_hops, unsigned n);
+		int32_t *next_hops, unsigned n);
 
 #ifdef __cplusplus
 }
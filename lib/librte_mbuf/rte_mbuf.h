@@ -98,6 +98,7 @@ extern "C" {
 #define PKT_RX_FDIR_ID       (1ULL << 13) /**< FD id reported if FDIR match. */
 #define PKT_RX_FDIR_FLX      (1ULL << 14) /**< Flexible bytes reported if FDIR match. */
 #define PKT_RX_QINQ_PKT      (1ULL << 15)  /**< RX packet with double VLAN stripped. */
+#define PKT_RX_TIMESTAMP     (1ULL << 16) /**< Value in mbuf->timestamp is valid. */
 /* add new RX flags here */
 
 /* add new TX flags here */
@@ -841,6 +842,9 @@ struct rte_mbuf {
 
 	/** Timesync flags for use with IEEE1588. */
 	uint16_t timesync;
+
+	/** RX time stamp in TSC cycles, valid if PKT_RX_TIMESTAMP is set. */
+	uint64_t timestamp;
 } __rte_cache_aligned;
 
 static inline uint16_t rte_pktmbuf_priv_size(struct rte_mempool *mp);
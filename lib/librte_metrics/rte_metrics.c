@@ -0,0 +1,322 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+
+#include "rte_metrics.h"
+
+#define MZ_RTE_METRICS "RTE_METRICS"
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_METRICS RTE_LOGTYPE_USER1
+
+/* Values of a port, or of the global metrics */
+struct metrics_set {
+	rte_atomic64_t value[RTE_METRICS_MAX_METRICS];
+	/** Non zero once the value was updated */
+	volatile uint8_t used[RTE_METRICS_MAX_METRICS];
+} __rte_cache_aligned;
+
+struct metrics_data {
+	rte_spinlock_t lock; /**< Serializes the registrations */
+	/** Number of registered names, updated once the names are written */
+	volatile uint16_t cnt_names;
+	struct rte_metric_name names[RTE_METRICS_MAX_METRICS];
+	/** Sets of the ports, followed by the set of the global metrics */
+	struct metrics_set sets[RTE_MAX_ETHPORTS + 1];
+};
+
+/* Registry of this process, looked up on first use in secondary processes */
+static struct metrics_data *metrics;
+
+static inline struct metrics_data *
+metrics_get(void)
+{
+	const struct rte_memzone *mz;
+
+	if (likely(metrics != NULL))
+		return metrics;
+
+	mz = rte_memzone_lookup(MZ_RTE_METRICS);
+	if (mz != NULL)
+		metrics = mz->addr;
+	return metrics;
+}
+
+static inline struct metrics_set *
+metrics_set_get(struct metrics_data *data, int port_id)
+{
+	if (port_id == RTE_METRICS_GLOBAL)
+		return &data->sets[RTE_MAX_ETHPORTS];
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS)
+		return NULL;
+	return &data->sets[port_id];
+}
+
+int
+rte_metrics_init(int socket_id)
+{
+	const struct rte_memzone *mz;
+	struct metrics_data *data;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -E_RTE_SECONDARY;
+
+	if (rte_memzone_lookup(MZ_RTE_METRICS) != NULL)
+		return -EEXIST;
+
+	mz = rte_memzone_reserve(MZ_RTE_METRICS, sizeof(*data), socket_id, 0);
+	if (mz == NULL) {
+		RTE_LOG(ERR, METRICS, "Cannot reserve memory zone\n");
+		return -ENOMEM;
+	}
+
+	data = mz->addr;
+	memset(data, 0, sizeof(*data));
+	rte_spinlock_init(&data->lock);
+	metrics = data;
+
+	return 0;
+}
+
+int
+rte_metrics_uninit(void)
+{
+	const struct rte_memzone *mz;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -E_RTE_SECONDARY;
+
+	mz = rte_memzone_lookup(MZ_RTE_METRICS);
+	if (mz == NULL)
+		return -ENOENT;
+
+	metrics = NULL;
+	return rte_memzone_free(mz);
+}
+
+static int
+metrics_find(const struct metrics_data *data, uint16_t cnt_names,
+		const char *name)
+{
+	uint16_t i;
+
+	for (i = 0; i < cnt_names; i++)
+		if (strncmp(data->names[i].name, name,
+				RTE_METRICS_MAX_NAME_LEN) == 0)
+			return i;
+	return -ENOENT;
+}
+
+int
+rte_metrics_reg_names(const char * const *names, uint16_t cnt)
+{
+	struct metrics_data *data = metrics_get();
+	uint16_t first, i, j;
+	int ret;
+
+	if (data == NULL)
+		return -ENOENT;
+	if (names == NULL || cnt == 0)
+		return -EINVAL;
+
+	for (i = 0; i < cnt; i++) {
+		if (names[i] == NULL || names[i][0] == '\0' ||
+				strnlen(names[i], RTE_METRICS_MAX_NAME_LEN) ==
+				RTE_METRICS_MAX_NAME_LEN)
+			return -EINVAL;
+		for (j = 0; j < i; j++)
+			if (strcmp(names[i], names[j]) == 0)
+				return -EEXIST;
+	}
+
+	rte_spinlock_lock(&data->lock);
+
+	first = data->cnt_names;
+	if (cnt > RTE_METRICS_MAX_METRICS - first) {
+		ret = -ENOSPC;
+		goto out;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (metrics_find(data, first, names[i]) >= 0) {
+			ret = -EEXIST;
+			goto out;
+		}
+	}
+
+	for (i = 0; i < cnt; i++)
+		strcpy(data->names[first + i].name, names[i]);
+	/* publish the names before the keys can be used */
+	rte_wmb();
+	data->cnt_names = first + cnt;
+	ret = first;
+
+out:
+	rte_spinlock_unlock(&data->lock);
+	return ret;
+}
+
+int
+rte_metrics_reg_name(const char *name)
+{
+	return rte_metrics_reg_names(&name, 1);
+}
+
+int
+rte_metrics_get_key(const char *name)
+{
+	struct metrics_data *data = metrics_get();
+
+	if (data == NULL)
+		return -ENOENT;
+	if (name == NULL)
+		return -EINVAL;
+
+	return metrics_find(data, data->cnt_names, name);
+}
+
+int
+rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity)
+{
+	struct metrics_data *data = metrics_get();
+	uint16_t cnt_names;
+
+	if (data == NULL)
+		return -ENOENT;
+
+	cnt_names = data->cnt_names;
+	rte_rmb();
+	if (names == NULL || capacity < cnt_names)
+		return cnt_names;
+
+	memcpy(names, data->names, cnt_names * sizeof(names[0]));
+	return cnt_names;
+}
+
+int
+rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity)
+{
+	struct metrics_data *data = metrics_get();
+	struct metrics_set *set;
+	uint16_t cnt_names, cnt, i;
+
+	if (data == NULL)
+		return -ENOENT;
+	set = metrics_set_get(data, port_id);
+	if (set == NULL)
+		return -EINVAL;
+
+	cnt_names = data->cnt_names;
+	cnt = 0;
+	for (i = 0; i < cnt_names; i++)
+		if (set->used[i])
+			cnt++;
+	if (values == NULL || capacity < cnt)
+		return cnt;
+
+	/* only report the metrics counted above */
+	cnt = 0;
+	for (i = 0; i < cnt_names && cnt < capacity; i++) {
+		if (!set->used[i])
+			continue;
+		values[cnt].key = i;
+		values[cnt].value = rte_atomic64_read(&set->value[i]);
+		cnt++;
+	}
+	return cnt;
+}
+
+static inline void
+metrics_set_used(struct metrics_set *set, uint16_t key)
+{
+	if (unlikely(!set->used[key])) {
+		/* make the value visible before the flag */
+		rte_wmb();
+		set->used[key] = 1;
+	}
+}
+
+int
+rte_metrics_update_values(int port_id, uint16_t key,
+		const uint64_t *values, uint32_t count)
+{
+	struct metrics_data *data = metrics_get();
+	struct metrics_set *set;
+	uint32_t i;
+
+	if (data == NULL)
+		return -ENOENT;
+	set = metrics_set_get(data, port_id);
+	if (set == NULL || values == NULL ||
+			(uint32_t)key + count > data->cnt_names)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		rte_atomic64_set(&set->value[key + i], values[i]);
+		metrics_set_used(set, key + i);
+	}
+	return 0;
+}
+
+int
+rte_metrics_update_value(int port_id, uint16_t key, uint64_t value)
+{
+	return rte_metrics_update_values(port_id, key, &value, 1);
+}
+
+int
+rte_metrics_add_value(int port_id, uint16_t key, uint64_t delta)
+{
+	struct metrics_data *data = metrics_get();
+	struct metrics_set *set;
+
+	if (data == NULL)
+		return -ENOENT;
+	set = metrics_set_get(data, port_id);
+	if (set == NULL || key >= data->cnt_names)
+		return -EINVAL;
+
+	rte_atomic64_add(&set->value[key], delta);
+	metrics_set_used(set, key);
+	return 0;
+}
@@ -0,0 +1,245 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_METRICS_H_
+#define _RTE_METRICS_H_
+
+/**
+ * @file
+ * RTE metrics
+ *
+ * Registry of named 64-bit metrics, shared between the primary and the
+ * secondary processes.
+ *
+ * Names are registered once, usually at initialization time, and identified
+ * afterwards by the key returned at registration. Each port has its own set
+ * of values, and there is one more set, RTE_METRICS_GLOBAL, for the metrics
+ * which are not related to a port. Updating a value does not take any lock,
+ * so it can be done from the data path of any lcore.
+ *
+ * The registry is stored in a memzone allocated by rte_metrics_init() in the
+ * primary process; the other functions can be called from any process.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of a metric name, including the terminating '\0'. */
+#define RTE_METRICS_MAX_NAME_LEN 64
+
+/** Maximum number of metrics which can be registered. */
+#define RTE_METRICS_MAX_METRICS 256
+
+/** Port identifier of the set of global metrics. */
+#define RTE_METRICS_GLOBAL -1
+
+/** Name of a metric. */
+struct rte_metric_name {
+	char name[RTE_METRICS_MAX_NAME_LEN]; /**< Name of the metric. */
+};
+
+/** Value of a metric. */
+struct rte_metric_value {
+	uint16_t key;   /**< Key of the metric, index in the list of names. */
+	uint64_t value; /**< Value of the metric. */
+};
+
+/**
+ * Allocate the metrics registry in shared memory. Must be called from the
+ * primary process before any other function of this library.
+ *
+ * @param socket_id
+ *   Socket to allocate the registry on, or SOCKET_ID_ANY.
+ * @return
+ *   - 0: Success.
+ *   - -E_RTE_SECONDARY: Called from a secondary process.
+ *   - -EEXIST: The registry is already allocated.
+ *   - -ENOMEM: No appropriate memory area found.
+ */
+int rte_metrics_init(int socket_id);
+
+/**
+ * Free the metrics registry. Must be called from the primary process, once
+ * no other process uses the registry.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -E_RTE_SECONDARY: Called from a secondary process.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_uninit(void);
+
+/**
+ * Register a metric.
+ *
+ * @param name
+ *   Name of the metric, unique in the registry.
+ * @return
+ *   - >=0: Key of the metric.
+ *   - -EINVAL: Invalid or too long name.
+ *   - -EEXIST: A metric with the same name is already registered.
+ *   - -ENOSPC: The registry is full.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_reg_name(const char *name);
+
+/**
+ * Register a set of metrics. The keys of the metrics are consecutive, so
+ * their values can be updated together with rte_metrics_update_values().
+ * Either all the names are registered, or none of them.
+ *
+ * @param names
+ *   Array of names of the metrics.
+ * @param cnt
+ *   Number of names in the array.
+ * @return
+ *   - >=0: Key of the first metric of the set.
+ *   - -EINVAL: Invalid or too long name.
+ *   - -EEXIST: A metric with the same name is already registered.
+ *   - -ENOSPC: The registry has not enough free entries.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_reg_names(const char * const *names, uint16_t cnt);
+
+/**
+ * Get the key of a registered metric from its name.
+ *
+ * @param name
+ *   Name of the metric.
+ * @return
+ *   - >=0: Key of the metric.
+ *   - -EINVAL: Invalid name.
+ *   - -ENOENT: No metric registered with this name, or the registry is not
+ *     allocated.
+ */
+int rte_metrics_get_key(const char *name);
+
+/**
+ * Get the names of the registered metrics. The name of the metric of key k
+ * is stored at index k of the array.
+ *
+ * @param names
+ *   Array to be filled with the names, or NULL to get the number of
+ *   registered metrics.
+ * @param capacity
+ *   Number of entries in the array.
+ * @return
+ *   - >=0: Number of registered metrics. If it is greater than the capacity,
+ *     the array is not filled.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity);
+
+/**
+ * Get the values of the metrics of a port, or of the global metrics. Only
+ * the metrics which were updated at least once for this port are returned.
+ *
+ * @param port_id
+ *   Port identifier, or RTE_METRICS_GLOBAL.
+ * @param values
+ *   Array to be filled with the keys and values, or NULL to get the number
+ *   of values.
+ * @param capacity
+ *   Number of entries in the array.
+ * @return
+ *   - >=0: Number of values. If it is greater than the capacity, the array
+ *     is not filled.
+ *   - -EINVAL: Invalid port identifier.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity);
+
+/**
+ * Set the value of a metric. Each metric of a port should be updated by a
+ * single lcore at a time; use rte_metrics_add_value() for metrics updated
+ * concurrently.
+ *
+ * @param port_id
+ *   Port identifier, or RTE_METRICS_GLOBAL.
+ * @param key
+ *   Key of the metric.
+ * @param value
+ *   New value of the metric.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid port identifier or key.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_update_value(int port_id, uint16_t key, uint64_t value);
+
+/**
+ * Set the values of several metrics with consecutive keys, typically a set
+ * registered with rte_metrics_reg_names().
+ *
+ * @param port_id
+ *   Port identifier, or RTE_METRICS_GLOBAL.
+ * @param key
+ *   Key of the first metric.
+ * @param values
+ *   Array of new values.
+ * @param count
+ *   Number of values in the array.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid port identifier or keys.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_update_values(int port_id, uint16_t key,
+		const uint64_t *values, uint32_t count);
+
+/**
+ * Atomically add a quantity to the value of a metric. It can be called by
+ * several lcores at the same time for the same metric.
+ *
+ * @param port_id
+ *   Port identifier, or RTE_METRICS_GLOBAL.
+ * @param key
+ *   Key of the metric.
+ * @param delta
+ *   Quantity to add.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid port identifier or key.
+ *   - -ENOENT: The registry is not allocated.
+ */
+int rte_metrics_add_value(int port_id, uint16_t key, uint64_t delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_METRICS_H_ */
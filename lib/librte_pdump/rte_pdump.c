@@ -0,0 +1,416 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_alarm.h>
+#include <rte_atomic.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_memzone.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_spinlock.h>
+
+#include "rte_pdump.h"
+
+#define MZ_RTE_PDUMP_CTRL "RTE_PDUMP_CTRL"
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_PDUMP RTE_LOGTYPE_USER1
+
+/* Period at which the primary process polls for requests */
+#define PDUMP_POLL_US 10000
+/* Time a requester waits for the answer of the primary process */
+#define PDUMP_TIMEOUT_MS 1000
+
+enum pdump_operation {
+	PDUMP_ENABLE = 1,
+	PDUMP_DISABLE = 2,
+};
+
+struct pdump_request {
+	uint16_t op;
+	uint16_t flags;
+	uint16_t queue;
+	uint8_t port;
+	char ring_name[RTE_RING_NAMESIZE];
+	char mp_name[RTE_MEMPOOL_NAMESIZE];
+};
+
+/*
+ * States of the request of the control area. The primary process takes a
+ * posted request before reading it, so that a requester timing out can
+ * withdraw it; once taken, the requester waits for its answer.
+ */
+enum pdump_req_state {
+	PDUMP_REQ_NONE = 0,   /**< No request, the requester owns req */
+	PDUMP_REQ_POSTED,     /**< Request posted, not seen by the primary */
+	PDUMP_REQ_TAKEN,      /**< Request being handled by the primary */
+	PDUMP_REQ_DONE,       /**< Request answered in result */
+};
+
+/* Control area shared between the primary and the capture processes */
+struct pdump_ctrl {
+	rte_spinlock_t lock;        /**< Serializes the requesting processes */
+	volatile int active;        /**< Primary process serves requests */
+	volatile uint32_t state;    /**< State of req, pdump_req_state */
+	int32_t result;             /**< Result of the last request */
+	struct pdump_request req;
+};
+
+/* Capture state of a queue, private to the primary process */
+struct pdump_rxtx_cbs {
+	struct rte_ring *ring;
+	struct rte_mempool *mp;
+	struct rte_eth_rxtx_callback *cb;
+};
+
+static struct pdump_ctrl *pdump_ctrl;
+
+static struct pdump_rxtx_cbs rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+static struct pdump_rxtx_cbs tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
+
+static inline void
+pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const struct pdump_rxtx_cbs *cbs)
+{
+	struct rte_mbuf *dup_bufs[nb_pkts];
+	struct rte_mbuf *p;
+	unsigned i, d = 0, ring_enq;
+
+	for (i = 0; i < nb_pkts; i++) {
+		p = rte_pktmbuf_clone(pkts[i], cbs->mp);
+		if (p != NULL)
+			dup_bufs[d++] = p;
+	}
+
+	ring_enq = rte_ring_enqueue_burst(cbs->ring, (void **)dup_bufs, d);
+	for (i = ring_enq; i < d; i++)
+		rte_pktmbuf_free(dup_bufs[i]);
+}
+
+static uint16_t
+pdump_rx(uint8_t port __rte_unused, uint16_t qidx __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *user_params)
+{
+	if (nb_pkts != 0)
+		pdump_copy(pkts, nb_pkts, user_params);
+	return nb_pkts;
+}
+
+static uint16_t
+pdump_tx(uint8_t port __rte_unused, uint16_t qidx __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
+{
+	if (nb_pkts != 0)
+		pdump_copy(pkts, nb_pkts, user_params);
+	return nb_pkts;
+}
+
+static void
+pdump_remove_cb(uint8_t port, uint16_t queue, int rx)
+{
+	struct pdump_rxtx_cbs *cbs = rx ? &rx_cbs[port][queue] :
+		&tx_cbs[port][queue];
+
+	if (cbs->cb == NULL)
+		return;
+
+	/*
+	 * The callback is not freed as a burst may still be running it,
+	 * see rte_eth_remove_rx_callback().
+	 */
+	if (rx)
+		rte_eth_remove_rx_callback(port, queue, cbs->cb);
+	else
+		rte_eth_remove_tx_callback(port, queue, cbs->cb);
+	cbs->cb = NULL;
+}
+
+static int
+pdump_add_cb(uint8_t port, uint16_t queue, int rx, struct rte_ring *ring,
+		struct rte_mempool *mp)
+{
+	struct pdump_rxtx_cbs *cbs = rx ? &rx_cbs[port][queue] :
+		&tx_cbs[port][queue];
+
+	cbs->ring = ring;
+	cbs->mp = mp;
+	if (rx)
+		cbs->cb = rte_eth_add_rx_callback(port, queue, pdump_rx, cbs);
+	else
+		cbs->cb = rte_eth_add_tx_callback(port, queue, pdump_tx, cbs);
+	if (cbs->cb == NULL) {
+		RTE_LOG(ERR, PDUMP, "Cannot add %s callback on port %u "
+			"queue %u\n", rx ? "RX" : "TX", port, queue);
+		return -rte_errno;
+	}
+
+	return 0;
+}
+
+/* Get the range of queues targeted by a request in one direction */
+static int
+pdump_queue_range(const struct pdump_request *req, int rx,
+		uint16_t *first, uint16_t *end)
+{
+	const struct rte_eth_dev_data *data =
+		rte_eth_devices[req->port].data;
+	uint16_t nb_queues = rx ? data->nb_rx_queues : data->nb_tx_queues;
+
+	if (req->queue == RTE_PDUMP_ALL_QUEUES) {
+		*first = 0;
+		*end = nb_queues;
+	} else if (req->queue < nb_queues) {
+		*first = req->queue;
+		*end = req->queue + 1;
+	} else
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+pdump_handle_request(const struct pdump_request *req)
+{
+	struct rte_ring *ring = NULL;
+	struct rte_mempool *mp = NULL;
+	uint16_t first[2], end[2], q;
+	int dir, ret;
+
+	if (!rte_eth_dev_is_valid_port(req->port) ||
+			(req->flags & RTE_PDUMP_FLAG_RXTX) == 0)
+		return -EINVAL;
+
+	/* dir 0 is TX and dir 1 is RX */
+	for (dir = 0; dir < 2; dir++) {
+		if ((req->flags & (dir ? RTE_PDUMP_FLAG_RX :
+				RTE_PDUMP_FLAG_TX)) == 0) {
+			first[dir] = end[dir] = 0;
+			continue;
+		}
+		if (pdump_queue_range(req, dir, &first[dir], &end[dir]) < 0)
+			return -EINVAL;
+	}
+
+	if (req->op == PDUMP_DISABLE) {
+		for (dir = 0; dir < 2; dir++)
+			for (q = first[dir]; q < end[dir]; q++)
+				pdump_remove_cb(req->port, q, dir);
+		return 0;
+	}
+
+	if (req->op != PDUMP_ENABLE)
+		return -EINVAL;
+
+	ring = rte_ring_lookup(req->ring_name);
+	mp = rte_mempool_lookup(req->mp_name);
+	if (ring == NULL || mp == NULL)
+		return -EINVAL;
+
+	for (dir = 0; dir < 2; dir++)
+		for (q = first[dir]; q < end[dir]; q++)
+			if ((dir ? rx_cbs : tx_cbs)[req->port][q].cb != NULL)
+				return -EEXIST;
+
+	for (dir = 0; dir < 2; dir++) {
+		for (q = first[dir]; q < end[dir]; q++) {
+			ret = pdump_add_cb(req->port, q, dir, ring, mp);
+			if (ret < 0)
+				goto rollback;
+		}
+	}
+
+	return 0;
+
+rollback:
+	/* remove what was added by this request, up to the failing queue */
+	end[dir] = q;
+	for (; dir >= 0; dir--)
+		for (q = first[dir]; q < end[dir]; q++)
+			pdump_remove_cb(req->port, q, dir);
+	return ret;
+}
+
+static void
+pdump_poll_requests(void *arg __rte_unused)
+{
+	struct pdump_request req;
+
+	if (!pdump_ctrl->active)
+		return;
+
+	if (rte_atomic32_cmpset(&pdump_ctrl->state, PDUMP_REQ_POSTED,
+			PDUMP_REQ_TAKEN)) {
+		rte_rmb();
+		req = pdump_ctrl->req;
+		pdump_ctrl->result = pdump_handle_request(&req);
+		rte_wmb();
+		pdump_ctrl->state = PDUMP_REQ_DONE;
+	}
+
+	rte_eal_alarm_set(PDUMP_POLL_US, pdump_poll_requests, NULL);
+}
+
+int
+rte_pdump_init(void)
+{
+	const struct rte_memzone *mz;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -EPERM;
+
+	if (pdump_ctrl != NULL && pdump_ctrl->active)
+		return -EEXIST;
+
+	mz = rte_memzone_lookup(MZ_RTE_PDUMP_CTRL);
+	if (mz == NULL) {
+		mz = rte_memzone_reserve(MZ_RTE_PDUMP_CTRL,
+				sizeof(*pdump_ctrl), rte_socket_id(), 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, PDUMP, "Cannot reserve memory zone\n");
+			return -ENOMEM;
+		}
+		memset(mz->addr, 0, sizeof(*pdump_ctrl));
+		rte_spinlock_init(&((struct pdump_ctrl *)mz->addr)->lock);
+	}
+
+	pdump_ctrl = mz->addr;
+	pdump_ctrl->active = 1;
+
+	return rte_eal_alarm_set(PDUMP_POLL_US, pdump_poll_requests, NULL);
+}
+
+int
+rte_pdump_uninit(void)
+{
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY ||
+			pdump_ctrl == NULL || !pdump_ctrl->active)
+		return -ENOENT;
+
+	pdump_ctrl->active = 0;
+	rte_eal_alarm_cancel(pdump_poll_requests, NULL);
+
+	return 0;
+}
+
+/* Post a request to the primary process and wait for its answer */
+static int
+pdump_request(const struct pdump_request *req)
+{
+	const struct rte_memzone *mz;
+	struct pdump_ctrl *ctrl;
+	int i, ret = -ETIMEDOUT;
+
+	mz = rte_memzone_lookup(MZ_RTE_PDUMP_CTRL);
+	if (mz == NULL)
+		return -ENOENT;
+	ctrl = mz->addr;
+
+	rte_spinlock_lock(&ctrl->lock);
+	if (!ctrl->active) {
+		rte_spinlock_unlock(&ctrl->lock);
+		return -ENOENT;
+	}
+
+	ctrl->req = *req;
+	rte_wmb();
+	ctrl->state = PDUMP_REQ_POSTED;
+
+	/* withdraw the request if the primary process did not take it in
+	 * time, or wait for its answer */
+	for (i = 0; ctrl->state != PDUMP_REQ_DONE; i++) {
+		if (i >= PDUMP_TIMEOUT_MS &&
+				rte_atomic32_cmpset(&ctrl->state,
+					PDUMP_REQ_POSTED, PDUMP_REQ_NONE))
+			break;
+		usleep(1000);
+	}
+	if (ctrl->state == PDUMP_REQ_DONE) {
+		rte_rmb();
+		ret = ctrl->result;
+		ctrl->state = PDUMP_REQ_NONE;
+	}
+	rte_spinlock_unlock(&ctrl->lock);
+
+	if (ret == -ETIMEDOUT)
+		RTE_LOG(ERR, PDUMP, "No answer from the primary process\n");
+
+	return ret;
+}
+
+int
+rte_pdump_enable(uint8_t port, uint16_t queue, uint32_t flags,
+		struct rte_ring *ring, struct rte_mempool *mp)
+{
+	struct pdump_request req;
+
+	if (ring == NULL || mp == NULL || port >= RTE_MAX_ETHPORTS ||
+			(flags & RTE_PDUMP_FLAG_RXTX) == 0)
+		return -EINVAL;
+
+	memset(&req, 0, sizeof(req));
+	req.op = PDUMP_ENABLE;
+	req.flags = flags;
+	req.queue = queue;
+	req.port = port;
+	snprintf(req.ring_name, sizeof(req.ring_name), "%s", ring->name);
+	snprintf(req.mp_name, sizeof(req.mp_name), "%s", mp->name);
+
+	return pdump_request(&req);
+}
+
+int
+rte_pdump_disable(uint8_t port, uint16_t queue, uint32_t flags)
+{
+	struct pdump_request req;
+
+	if (port >= RTE_MAX_ETHPORTS || (flags & RTE_PDUMP_FLAG_RXTX) == 0)
+		return -EINVAL;
+
+	memset(&req, 0, sizeof(req));
+	req.op = PDUMP_DISABLE;
+	req.flags = flags;
+	req.queue = queue;
+	req.port = port;
+
+	return pdump_request(&req);
+}
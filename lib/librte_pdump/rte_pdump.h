@@ -0,0 +1,152 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_PDUMP_H_
+#define _RTE_PDUMP_H_
+
+/**
+ * @file
+ * RTE pdump
+ *
+ * Packet capture library. It lets a secondary process capture the traffic
+ * of a running primary process without restarting it.
+ *
+ * The primary process calls rte_pdump_init() once. A capture tool running
+ * as a secondary process then asks it, through shared memory, to register
+ * RX and/or TX callbacks on some queues of a port. These callbacks clone the
+ * packets into indirect mbufs taken from a mempool provided by the capture
+ * tool, and enqueue them into a ring that the tool dequeues from.
+ *
+ * As clones share the data buffer of the original packets, the captured
+ * data is the content of the buffer when the capture tool reads it.
+ */
+
+#include <stdint.h>
+
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Capture the received packets. */
+#define RTE_PDUMP_FLAG_RX   (1 << 0)
+/** Capture the transmitted packets. */
+#define RTE_PDUMP_FLAG_TX   (1 << 1)
+/** Capture the received and transmitted packets. */
+#define RTE_PDUMP_FLAG_RXTX (RTE_PDUMP_FLAG_RX | RTE_PDUMP_FLAG_TX)
+
+/** Queue identifier selecting all the queues of a port. */
+#define RTE_PDUMP_ALL_QUEUES UINT16_MAX
+
+/**
+ * Start serving capture requests. Must be called from the primary process,
+ * after the ports have been configured.
+ *
+ * Requests are polled from an EAL alarm, so the forwarding lcores are not
+ * involved.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -EPERM: Called from a secondary process.
+ *   - -EEXIST: Already initialized.
+ *   - -ENOMEM: Not enough memory for the control area.
+ */
+int rte_pdump_init(void);
+
+/**
+ * Stop serving capture requests. Captures in progress are not disabled.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: Not initialized.
+ */
+int rte_pdump_uninit(void);
+
+/**
+ * Ask the primary process to start capturing packets of a port.
+ *
+ * Clones of the captured packets are allocated from @p mp and enqueued into
+ * @p ring; packets are not captured when either is exhausted. Both are
+ * looked up by name in the primary process. The ring must allow multiple
+ * producers when queues polled by different lcores are captured.
+ *
+ * @param port
+ *   The port identifier of the Ethernet device.
+ * @param queue
+ *   The queue to capture, or RTE_PDUMP_ALL_QUEUES.
+ * @param flags
+ *   RTE_PDUMP_FLAG_RX, RTE_PDUMP_FLAG_TX or RTE_PDUMP_FLAG_RXTX.
+ * @param ring
+ *   The ring receiving the captured packets.
+ * @param mp
+ *   The mempool from which the clones are allocated.
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: The primary process did not call rte_pdump_init().
+ *   - -ETIMEDOUT: The primary process did not take the request in time,
+ *     which was withdrawn.
+ *   - -EINVAL: Invalid parameters.
+ *   - -EEXIST: Capture already enabled on one of the queues.
+ *   - Other negative values: callback registration failed.
+ */
+int rte_pdump_enable(uint8_t port, uint16_t queue, uint32_t flags,
+		struct rte_ring *ring, struct rte_mempool *mp);
+
+/**
+ * Ask the primary process to stop capturing packets of a port.
+ *
+ * Some captured packets may still be enqueued into the ring shortly after
+ * this function returns.
+ *
+ * @param port
+ *   The port identifier of the Ethernet device.
+ * @param queue
+ *   The queue to stop capturing, or RTE_PDUMP_ALL_QUEUES.
+ * @param flags
+ *   RTE_PDUMP_FLAG_RX, RTE_PDUMP_FLAG_TX or RTE_PDUMP_FLAG_RXTX.
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: The primary process did not call rte_pdump_init().
+ *   - -ETIMEDOUT: The primary process did not take the request in time,
+ *     which was withdrawn.
+ *   - -EINVAL: Invalid parameters.
+ */
+int rte_pdump_disable(uint8_t port, uint16_t queue, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_PDUMP_H_ */
@@ -0,0 +1,187 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_atomic.h>
+
+#include "rte_rcu_qsbr.h"
+
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads)
+{
+	if (max_threads == 0)
+		return 0;
+
+	return sizeof(struct rte_rcu_qsbr) +
+		sizeof(struct rte_rcu_qsbr_cnt) * max_threads +
+		RTE_RCU_QSBR_THRID_ARRAY_SIZE(max_threads);
+}
+
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads)
+{
+	if (v == NULL || max_threads == 0)
+		return -EINVAL;
+
+	memset(v, 0, rte_rcu_qsbr_get_memsize(max_threads));
+	v->max_threads = max_threads;
+	v->num_elems = RTE_ALIGN_CEIL(max_threads,
+			RTE_RCU_QSBR_THRID_ELM_SIZE) /
+			RTE_RCU_QSBR_THRID_ELM_SIZE;
+	rte_atomic64_set(&v->token, RTE_RCU_QSBR_CNT_INIT);
+	v->acked_token = RTE_RCU_QSBR_CNT_INIT - 1;
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	volatile uint64_t *elm;
+	uint64_t old, bit;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	elm = RTE_RCU_QSBR_THRID_ARRAY_ELM(v,
+			thread_id / RTE_RCU_QSBR_THRID_ELM_SIZE);
+	bit = UINT64_C(1) << (thread_id % RTE_RCU_QSBR_THRID_ELM_SIZE);
+
+	do {
+		old = *elm;
+		if (old & bit)
+			return 0;
+	} while (rte_atomic64_cmpset(elm, old, old | bit) == 0);
+
+	rte_atomic32_inc(&v->num_threads);
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	volatile uint64_t *elm;
+	uint64_t old, bit;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	elm = RTE_RCU_QSBR_THRID_ARRAY_ELM(v,
+			thread_id / RTE_RCU_QSBR_THRID_ELM_SIZE);
+	bit = UINT64_C(1) << (thread_id % RTE_RCU_QSBR_THRID_ELM_SIZE);
+
+	do {
+		old = *elm;
+		if (!(old & bit))
+			return 0;
+	} while (rte_atomic64_cmpset(elm, old, old & ~bit) == 0);
+
+	rte_atomic32_dec(&v->num_threads);
+
+	return 0;
+}
+
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	uint64_t t;
+
+	t = rte_rcu_qsbr_start(v);
+
+	/* The calling reader would otherwise wait for itself. */
+	if (thread_id != RTE_RCU_QSBR_THRID_INVALID)
+		rte_rcu_qsbr_quiescent(v, thread_id);
+
+	rte_rcu_qsbr_check(v, t, 1);
+}
+
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v)
+{
+	volatile uint64_t *reg_thread_id;
+	uint64_t bmap;
+	uint32_t i, j;
+
+	if (f == NULL || v == NULL)
+		return -EINVAL;
+
+	fprintf(f, "QSBR variable:\n");
+	fprintf(f, "  QS variable memory size = %zu\n",
+			rte_rcu_qsbr_get_memsize(v->max_threads));
+	fprintf(f, "  Given # max threads = %u\n", v->max_threads);
+	fprintf(f, "  Current # threads = %d\n",
+			rte_atomic32_read(&v->num_threads));
+
+	fprintf(f, "  Registered thread IDs = ");
+	reg_thread_id = RTE_RCU_QSBR_THRID_ARRAY_ELM(v, 0);
+	for (i = 0; i < v->num_elems; i++, reg_thread_id++) {
+		bmap = *reg_thread_id;
+		while (bmap) {
+			j = __builtin_ctzll(bmap);
+			fprintf(f, "%u ", (uint32_t)(i *
+					RTE_RCU_QSBR_THRID_ELM_SIZE + j));
+			bmap &= ~(UINT64_C(1) << j);
+		}
+	}
+	fprintf(f, "\n");
+
+	fprintf(f, "  Token = %" PRIu64 "\n",
+			(uint64_t)rte_atomic64_read(&v->token));
+	fprintf(f, "  Least Acknowledged Token = %" PRIu64 "\n",
+			v->acked_token);
+
+	fprintf(f, "Quiescent State Counts for readers:\n");
+	reg_thread_id = RTE_RCU_QSBR_THRID_ARRAY_ELM(v, 0);
+	for (i = 0; i < v->num_elems; i++, reg_thread_id++) {
+		bmap = *reg_thread_id;
+		while (bmap) {
+			uint32_t id;
+
+			j = __builtin_ctzll(bmap);
+			id = i * RTE_RCU_QSBR_THRID_ELM_SIZE + j;
+			fprintf(f, "thread ID = %u, count = %" PRIu64 "\n",
+					id, v->qsbr_cnt[id].cnt);
+			bmap &= ~(UINT64_C(1) << j);
+		}
+	}
+
+	return 0;
+}
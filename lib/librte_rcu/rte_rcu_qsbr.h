@@ -0,0 +1,352 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RCU_QSBR_H_
+#define _RTE_RCU_QSBR_H_
+
+/**
+ * @file
+ * RTE Quiescent State Based Reclamation (QSBR)
+ *
+ * A lock-free data structure can be updated by a writer while readers
+ * access it, as long as memory removed from the structure is not freed or
+ * reused before all the readers which could still reference it are done.
+ *
+ * With QSBR, each reader thread periodically reports a quiescent state,
+ * i.e. a point where it does not hold any reference to the shared
+ * structure, typically once per iteration of its main loop. After removing
+ * an element, the writer calls rte_rcu_qsbr_start() to get a token, and
+ * may reuse the element's memory once rte_rcu_qsbr_check() reports that
+ * all the registered readers have gone through a quiescent state since.
+ *
+ * The reader side costs a single store per reported quiescent state. The
+ * readers are identified by a thread ID in the range 0 to max_threads - 1,
+ * usually the lcore ID.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Counter value of a thread which is offline. */
+#define RTE_RCU_QSBR_CNT_THR_OFFLINE 0
+
+/** Initial token value. */
+#define RTE_RCU_QSBR_CNT_INIT 1
+
+/** Thread ID meaning "not a reader thread", see rte_rcu_qsbr_synchronize(). */
+#define RTE_RCU_QSBR_THRID_INVALID 0xffffffff
+
+/** Number of thread IDs stored in one element of the registration bitmap. */
+#define RTE_RCU_QSBR_THRID_ELM_SIZE (sizeof(uint64_t) * 8)
+
+/** Size of the registration bitmap, in bytes, for max_threads threads. */
+#define RTE_RCU_QSBR_THRID_ARRAY_SIZE(max_threads) \
+	RTE_ALIGN(RTE_ALIGN_CEIL(max_threads, \
+		RTE_RCU_QSBR_THRID_ELM_SIZE) >> 3, RTE_CACHE_LINE_SIZE)
+
+/** Pointer to element i of the registration bitmap. */
+#define RTE_RCU_QSBR_THRID_ARRAY_ELM(v, i) \
+	((volatile uint64_t *)&(v)->qsbr_cnt[(v)->max_threads] + (i))
+
+/** Quiescent state counter of a reader thread. */
+struct rte_rcu_qsbr_cnt {
+	volatile uint64_t cnt;
+	/**< Last token seen by the thread, RTE_RCU_QSBR_CNT_THR_OFFLINE when
+	 *   the thread is offline. */
+} __rte_cache_aligned;
+
+/**
+ * QSBR variable.
+ *
+ * Its size depends on the maximum number of threads, see
+ * rte_rcu_qsbr_get_memsize(). The counters of the threads are followed by
+ * the bitmap of the registered threads.
+ */
+struct rte_rcu_qsbr {
+	rte_atomic64_t token __rte_cache_aligned;
+	/**< Last token returned by rte_rcu_qsbr_start(). */
+	volatile uint64_t acked_token;
+	/**< All the threads have gone through a quiescent state since this
+	 *   token was returned. */
+
+	uint32_t num_elems __rte_cache_aligned;
+	/**< Number of elements in the registration bitmap. */
+	rte_atomic32_t num_threads; /**< Number of registered threads. */
+	uint32_t max_threads; /**< Maximum number of threads. */
+
+	struct rte_rcu_qsbr_cnt qsbr_cnt[0] __rte_cache_aligned;
+	/**< Quiescent state counters, one per thread. */
+} __rte_cache_aligned;
+
+/**
+ * Return the size of the memory to allocate for a QSBR variable.
+ *
+ * @param max_threads
+ *   Maximum number of reader threads which can be registered.
+ * @return
+ *   Size in bytes, or 0 if max_threads is 0.
+ */
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads);
+
+/**
+ * Initialize a QSBR variable.
+ *
+ * @param v
+ *   QSBR variable, allocated with at least the size returned by
+ *   rte_rcu_qsbr_get_memsize() and aligned on a cache line.
+ * @param max_threads
+ *   Maximum number of reader threads which can be registered.
+ * @return
+ *   0 on success, -EINVAL if v is NULL or max_threads is 0.
+ */
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads);
+
+/**
+ * Register a reader thread. The thread is offline after registration,
+ * see rte_rcu_qsbr_thread_online().
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   ID of the thread, lower than max_threads.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, uint32_t thread_id);
+
+/**
+ * Unregister a reader thread. Its quiescent state is not waited for
+ * anymore.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   ID of the thread, lower than max_threads.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, uint32_t thread_id);
+
+/**
+ * Mark a registered reader thread online: from now on, the writers wait
+ * for its quiescent states. To be called by the thread itself before it
+ * starts accessing the shared data structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   ID of the calling thread.
+ */
+static inline void
+rte_rcu_qsbr_thread_online(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	v->qsbr_cnt[thread_id].cnt = rte_atomic64_read(&v->token);
+
+	/*
+	 * The counter must be visible to the writers before the thread
+	 * loads any pointer from the shared data structure.
+	 */
+	rte_mb();
+}
+
+/**
+ * Mark a reader thread offline: the writers do not wait for it anymore.
+ * To be called by the thread itself, for instance before blocking, while
+ * it does not hold any reference to the shared data structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   ID of the calling thread.
+ */
+static inline void
+rte_rcu_qsbr_thread_offline(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	/*
+	 * The accesses to the shared data structure must be complete
+	 * before the writers see the counter.
+	 */
+	rte_mb();
+
+	v->qsbr_cnt[thread_id].cnt = RTE_RCU_QSBR_CNT_THR_OFFLINE;
+}
+
+/**
+ * Report a quiescent state: the calling reader thread does not hold any
+ * reference to the shared data structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   ID of the calling thread, which must be online.
+ */
+static inline void
+rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, uint32_t thread_id)
+{
+	uint64_t t;
+
+	/*
+	 * The accesses to the shared data structure must be complete
+	 * before the writers see the counter.
+	 */
+	rte_mb();
+
+	t = rte_atomic64_read(&v->token);
+	v->qsbr_cnt[thread_id].cnt = t;
+}
+
+/**
+ * Start a grace period. To be called by a writer after it removed an
+ * element from the shared data structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   Token to pass to rte_rcu_qsbr_check().
+ */
+static inline uint64_t
+rte_rcu_qsbr_start(struct rte_rcu_qsbr *v)
+{
+	/*
+	 * The atomic increment also orders the removal of the element
+	 * before the new token becomes visible to the readers.
+	 */
+	return rte_atomic64_add_return(&v->token, 1);
+}
+
+/**
+ * Check whether a grace period is over, i.e. all the registered online
+ * reader threads have reported a quiescent state since the token was
+ * returned by rte_rcu_qsbr_start().
+ *
+ * @param v
+ *   QSBR variable.
+ * @param t
+ *   Token returned by rte_rcu_qsbr_start().
+ * @param wait
+ *   If true, wait until the grace period is over.
+ * @return
+ *   1 if the grace period is over, 0 otherwise.
+ */
+static inline int
+rte_rcu_qsbr_check(struct rte_rcu_qsbr *v, uint64_t t, int wait)
+{
+	uint32_t i, id;
+	uint64_t bmap, c, acked_token = UINT64_MAX;
+	volatile uint64_t *reg_thread_id;
+
+	if (likely(t <= v->acked_token))
+		return 1;
+
+	for (i = 0, reg_thread_id = RTE_RCU_QSBR_THRID_ARRAY_ELM(v, 0);
+			i < v->num_elems; i++, reg_thread_id++) {
+		bmap = *reg_thread_id;
+		id = i << 6;
+
+		while (bmap) {
+			uint32_t j = __builtin_ctzll(bmap);
+
+			c = v->qsbr_cnt[id + j].cnt;
+			while (c != RTE_RCU_QSBR_CNT_THR_OFFLINE && c < t) {
+				if (!wait)
+					return 0;
+
+				rte_pause();
+
+				/* The thread may have been unregistered. */
+				if (!(*reg_thread_id & (UINT64_C(1) << j)))
+					break;
+				c = v->qsbr_cnt[id + j].cnt;
+			}
+
+			if (c != RTE_RCU_QSBR_CNT_THR_OFFLINE &&
+					c < acked_token)
+				acked_token = c;
+
+			bmap &= ~(UINT64_C(1) << j);
+		}
+	}
+
+	/* All the threads are offline, the grace period is over for t. */
+	if (acked_token == UINT64_MAX)
+		acked_token = t;
+
+	if (acked_token > v->acked_token)
+		v->acked_token = acked_token;
+
+	return 1;
+}
+
+/**
+ * Start a grace period and wait for it to be over.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   If the caller is itself a registered online reader thread, its ID,
+ *   so that its quiescent state is reported for the new grace period.
+ *   Otherwise RTE_RCU_QSBR_THRID_INVALID.
+ */
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, uint32_t thread_id);
+
+/**
+ * Dump the state of a QSBR variable.
+ *
+ * @param f
+ *   Output stream.
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RCU_QSBR_H_ */
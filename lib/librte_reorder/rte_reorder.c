@@ -36,6 +36,7 @@
 
 #include <rte_log.h>
 #include <rte_mbuf.h>
+#include <rte_cycles.h>
 #include <rte_memzone.h>
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
@@ -50,6 +51,11 @@ static struct rte_tailq_elem rte_reorder_tailq = {
 };
 EAL_REGISTER_TAILQ(rte_reorder_tailq)
 
+static struct rte_tailq_elem rte_reorder_ms_tailq = {
+	.name = "RTE_REORDER_MS",
+};
+EAL_REGISTER_TAILQ(rte_reorder_ms_tailq)
+
 #define NO_FLAGS 0
 #define RTE_REORDER_PREFIX "RO_"
 #define RTE_REORDER_NAMESIZE 32
@@ -57,6 +63,12 @@ EAL_REGISTER_TAILQ(rte_reorder_tailq)
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_REORDER	RTE_LOGTYPE_USER1
 
+#ifdef RTE_REORDER_STATS_COLLECT
+#define REORDER_STATS_ADD(b, name, n) ((b)->stats.name += (n))
+#else
+#define REORDER_STATS_ADD(b, name, n) do {} while (0)
+#endif
+
 /* A generic circular buffer */
 struct cir_buffer {
 	unsigned int size;   /**< Number of entries that can be stored */
@@ -74,6 +86,33 @@ struct rte_reorder_buffer {
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
 	int is_initialized;
+	uint32_t max_seqn;  /**< Highest seq. number inserted in the buffer */
+	uint32_t gap_seqn;  /**< seq. number of the gap being timed */
+	uint64_t gap_tsc;   /**< time the gap was first found, 0 if none */
+	struct rte_reorder_stats stats;
+} __rte_cache_aligned;
+
+/* The window of a stream of a multi-stream reorder buffer */
+struct reorder_stream {
+	uint64_t present;   /**< bit n set if entry (head + n) is filled */
+	uint32_t min_seqn;  /**< Lowest seq. number that can be in the window */
+	uint16_t head;      /**< entry of min_seqn in the window */
+	uint8_t is_initialized;
+	uint8_t is_ready;   /**< stream is in the ready list */
+};
+
+/* The multi-stream reorder buffer data structure */
+struct rte_reorder_ms_buffer {
+	char name[RTE_REORDER_NAMESIZE];
+	unsigned int nb_streams; /**< Number of streams */
+	unsigned int window;     /**< Number of entries of a stream window */
+	unsigned int ready_head; /**< insertion point in ready list */
+	unsigned int ready_tail; /**< extraction point in ready list */
+	unsigned int nb_ready;   /**< Number of streams in ready list */
+	uint32_t *ready;         /**< streams with their next packet present */
+	struct reorder_stream *streams;
+	struct rte_mbuf **entries; /**< windows of all the streams */
+	struct cir_buffer overflow_buf; /**< entries moved out of a window */
 } __rte_cache_aligned;
 
 static void
@@ -296,6 +335,7 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 		if (order_buf->entries[order_buf->head] == NULL) {
 			order_buf->head = (order_buf->head + 1) & order_buf->mask;
 			order_head_adv++;
+			REORDER_STATS_ADD(b, skipped_seqn, 1);
 		}
 
 		/* Move all ready entries that fit to the ready_buf */
@@ -327,7 +367,7 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	struct cir_buffer *order_buf = &b->order_buf;
 
 	if (!b->is_initialized) {
-		b->min_seqn = mbuf->seqn;
+		b->min_seqn = b->max_seqn = mbuf->seqn;
 		b->is_initialized = 1;
 	}
 
@@ -361,11 +401,14 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	 */
 	if (offset < b->order_buf.size) {
 		position = (order_buf->head + offset) & order_buf->mask;
+		if (order_buf->entries[position] != NULL)
+			REORDER_STATS_ADD(b, dup_pkts, 1);
 		order_buf->entries[position] = mbuf;
 	} else if (offset < 2 * b->order_buf.size) {
 		if (rte_reorder_fill_overflow(b, offset + 1 - order_buf->size)
 				< (offset + 1 - order_buf->size)) {
 			/* Put in handling for enqueue straight to output */
+			REORDER_STATS_ADD(b, early_pkts, 1);
 			rte_errno = ENOSPC;
 			return -1;
 		}
@@ -374,9 +417,16 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 		order_buf->entries[position] = mbuf;
 	} else {
 		/* Put in handling for enqueue straight to output */
+		if ((int32_t)offset < 0)
+			REORDER_STATS_ADD(b, late_pkts, 1);
+		else
+			REORDER_STATS_ADD(b, early_pkts, 1);
 		rte_errno = ERANGE;
 		return -1;
 	}
+
+	if ((int32_t)(mbuf->seqn - b->max_seqn) > 0)
+		b->max_seqn = mbuf->seqn;
 	return 0;
 }
 
@@ -409,3 +459,366 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 
 	return drain_cnt;
 }
+
+unsigned int
+rte_reorder_drain_timeout(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned max_mbufs, uint64_t max_age,
+		uint32_t *skipped)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	unsigned int drain_cnt;
+	uint32_t skip_cnt = 0;
+	uint64_t now;
+
+	drain_cnt = rte_reorder_drain(b, mbufs, max_mbufs);
+
+	/*
+	 * The drain stopped at a gap: if packets are waiting behind it, i.e.
+	 * the highest sequence number inserted is still in the window, time
+	 * the gap, and skip it once it is too old.
+	 */
+	while (drain_cnt < max_mbufs && b->is_initialized &&
+			(int32_t)(b->max_seqn - b->min_seqn) > 0) {
+		now = rte_rdtsc();
+		if (b->gap_tsc == 0 || b->gap_seqn != b->min_seqn) {
+			b->gap_tsc = now;
+			b->gap_seqn = b->min_seqn;
+		}
+		if (now - b->gap_tsc < max_age)
+			break;
+
+		while (order_buf->entries[order_buf->head] == NULL) {
+			order_buf->head = (order_buf->head + 1) &
+					order_buf->mask;
+			b->min_seqn++;
+			skip_cnt++;
+		}
+		b->gap_tsc = 0;
+
+		drain_cnt += rte_reorder_drain(b, &mbufs[drain_cnt],
+				max_mbufs - drain_cnt);
+	}
+
+	REORDER_STATS_ADD(b, skipped_seqn, skip_cnt);
+	if (skipped != NULL)
+		*skipped = skip_cnt;
+	return drain_cnt;
+}
+
+int
+rte_reorder_stats_read(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats, int clear)
+{
+	if (b == NULL)
+		return -EINVAL;
+
+	if (stats != NULL)
+		memcpy(stats, &b->stats, sizeof(b->stats));
+
+	if (clear)
+		memset(&b->stats, 0, sizeof(b->stats));
+
+	return 0;
+}
+
+/* sets the multi-stream reorder buffer data structure in its memory area */
+static void
+rte_reorder_ms_init(struct rte_reorder_ms_buffer *b, const char *name,
+		unsigned int nb_streams, unsigned int window)
+{
+	snprintf(b->name, sizeof(b->name), "%s", name);
+	b->nb_streams = nb_streams;
+	b->window = window;
+	b->ready_head = b->ready_tail = b->nb_ready = 0;
+	/* the pointer arrays come before the ready list to stay aligned */
+	b->streams = (void *)&b[1];
+	b->entries = RTE_PTR_ADD(b->streams, nb_streams * sizeof(b->streams[0]));
+	b->overflow_buf.size = window;
+	b->overflow_buf.mask = window - 1;
+	b->overflow_buf.head = b->overflow_buf.tail = 0;
+	b->overflow_buf.entries = RTE_PTR_ADD(b->entries,
+			nb_streams * window * sizeof(b->entries[0]));
+	b->ready = RTE_PTR_ADD(b->overflow_buf.entries,
+			window * sizeof(b->overflow_buf.entries[0]));
+	memset(b->streams, 0, nb_streams * sizeof(b->streams[0]));
+}
+
+struct rte_reorder_ms_buffer *
+rte_reorder_ms_create(const char *name, unsigned socket_id,
+		unsigned int nb_streams, unsigned int window)
+{
+	struct rte_reorder_ms_buffer *b = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_reorder_list *reorder_list;
+	size_t bufsize;
+
+	reorder_list = RTE_TAILQ_CAST(rte_reorder_ms_tailq.head,
+			rte_reorder_list);
+
+	/* Check user arguments. */
+	if (!rte_is_power_of_2(window) || window < 2 ||
+			window > RTE_REORDER_MS_MAX_WINDOW) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer window"
+				" - Not a power of 2 up to %u\n",
+				RTE_REORDER_MS_MAX_WINDOW);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (nb_streams == 0 || nb_streams > UINT32_MAX / window) {
+		RTE_LOG(ERR, REORDER, "Invalid number of streams: %u\n",
+				nb_streams);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (name == NULL) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer name ptr:"
+					" NULL\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	bufsize = sizeof(*b) +
+		nb_streams * (sizeof(struct reorder_stream) + sizeof(uint32_t) +
+			(size_t)window * sizeof(struct rte_mbuf *)) +
+		window * sizeof(struct rte_mbuf *);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, reorder_list, next) {
+		b = (struct rte_reorder_ms_buffer *) te->data;
+		if (strncmp(name, b->name, RTE_REORDER_NAMESIZE) == 0)
+			break;
+	}
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		b = NULL;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("REORDER_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, REORDER, "Failed to allocate tailq entry\n");
+		rte_errno = ENOMEM;
+		b = NULL;
+		goto exit;
+	}
+
+	/* Allocate memory to store the reorder buffer structure. */
+	b = rte_zmalloc_socket("REORDER_MS_BUFFER", bufsize, 0, socket_id);
+	if (b == NULL) {
+		RTE_LOG(ERR, REORDER, "Memzone allocation failed\n");
+		rte_errno = ENOMEM;
+		rte_free(te);
+	} else {
+		rte_reorder_ms_init(b, name, nb_streams, window);
+		te->data = (void *)b;
+		TAILQ_INSERT_TAIL(reorder_list, te, next);
+	}
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return b;
+}
+
+static void
+rte_reorder_ms_free_mbufs(struct rte_reorder_ms_buffer *b)
+{
+	struct cir_buffer *overflow_buf = &b->overflow_buf;
+	const struct reorder_stream *s;
+	unsigned i, j;
+
+	for (i = 0; i < b->nb_streams; i++) {
+		s = &b->streams[i];
+		for (j = 0; j < b->window; j++)
+			if (s->present & (1ULL << j))
+				rte_pktmbuf_free(b->entries[i * b->window +
+					((s->head + j) & (b->window - 1))]);
+	}
+	for (i = overflow_buf->tail; i != overflow_buf->head;
+			i = (i + 1) & overflow_buf->mask)
+		rte_pktmbuf_free(overflow_buf->entries[i]);
+}
+
+void
+rte_reorder_ms_reset(struct rte_reorder_ms_buffer *b)
+{
+	char name[RTE_REORDER_NAMESIZE];
+
+	rte_reorder_ms_free_mbufs(b);
+	snprintf(name, sizeof(name), "%s", b->name);
+	rte_reorder_ms_init(b, name, b->nb_streams, b->window);
+}
+
+void
+rte_reorder_ms_free(struct rte_reorder_ms_buffer *b)
+{
+	struct rte_reorder_list *reorder_list;
+	struct rte_tailq_entry *te;
+
+	/* Check user arguments. */
+	if (b == NULL)
+		return;
+
+	reorder_list = RTE_TAILQ_CAST(rte_reorder_ms_tailq.head,
+			rte_reorder_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, reorder_list, next) {
+		if (te->data == (void *) b)
+			break;
+	}
+	if (te == NULL) {
+		rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+		return;
+	}
+
+	TAILQ_REMOVE(reorder_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	rte_reorder_ms_free_mbufs(b);
+
+	rte_free(b);
+	rte_free(te);
+}
+
+/* adds a stream whose next packet is present to the ready list */
+static inline void
+rte_reorder_ms_set_ready(struct rte_reorder_ms_buffer *b, unsigned int stream)
+{
+	struct reorder_stream *s = &b->streams[stream];
+
+	if (s->is_ready)
+		return;
+	s->is_ready = 1;
+	b->ready[b->ready_head] = stream;
+	if (++b->ready_head == b->nb_streams)
+		b->ready_head = 0;
+	b->nb_ready++;
+}
+
+/*
+ * Moves the window of a stream forward by n entries, the packets leaving the
+ * window being moved to the overflow buffer, and the gaps skipped. Returns
+ * the number of positions the window has moved, lower than n if the overflow
+ * buffer is full.
+ */
+static unsigned
+rte_reorder_ms_fill_overflow(struct rte_reorder_ms_buffer *b,
+		unsigned int stream, unsigned n)
+{
+	struct cir_buffer *overflow_buf = &b->overflow_buf;
+	struct reorder_stream *s = &b->streams[stream];
+	struct rte_mbuf **entries = &b->entries[stream * b->window];
+	unsigned int adv;
+
+	for (adv = 0; adv < n; adv++) {
+		if (s->present & 1) {
+			if (((overflow_buf->head + 1) & overflow_buf->mask) ==
+					overflow_buf->tail)
+				break;
+			overflow_buf->entries[overflow_buf->head] =
+					entries[s->head];
+			overflow_buf->head = (overflow_buf->head + 1) &
+					overflow_buf->mask;
+		}
+		s->present >>= 1;
+		s->head = (s->head + 1) & (b->window - 1);
+	}
+	s->min_seqn += adv;
+
+	return adv;
+}
+
+int
+rte_reorder_ms_insert(struct rte_reorder_ms_buffer *b, unsigned int stream,
+		struct rte_mbuf *mbuf)
+{
+	struct reorder_stream *s;
+	uint32_t offset, need;
+
+	if (stream >= b->nb_streams) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+	s = &b->streams[stream];
+
+	if (!s->is_initialized) {
+		s->min_seqn = mbuf->seqn;
+		s->is_initialized = 1;
+	}
+
+	/* same window handling as rte_reorder_insert(), within the stream */
+	offset = mbuf->seqn - s->min_seqn;
+	if (offset >= b->window) {
+		if (offset >= 2 * b->window) {
+			rte_errno = ERANGE;
+			return -1;
+		}
+		need = offset + 1 - b->window;
+		if (rte_reorder_ms_fill_overflow(b, stream, need) < need) {
+			rte_errno = ENOSPC;
+			return -1;
+		}
+		offset = mbuf->seqn - s->min_seqn;
+	}
+
+	b->entries[stream * b->window + ((s->head + offset) & (b->window - 1))] =
+			mbuf;
+	s->present |= 1ULL << offset;
+	if (s->present & 1)
+		rte_reorder_ms_set_ready(b, stream);
+
+	return 0;
+}
+
+unsigned int
+rte_reorder_ms_drain(struct rte_reorder_ms_buffer *b, struct rte_mbuf **mbufs,
+		unsigned max_mbufs)
+{
+	struct cir_buffer *overflow_buf = &b->overflow_buf;
+	struct rte_mbuf **entries;
+	struct reorder_stream *s;
+	unsigned int drain_cnt = 0, stream, n, i;
+
+	/* the packets moved out of their window come first */
+	while ((drain_cnt < max_mbufs) &&
+			(overflow_buf->tail != overflow_buf->head)) {
+		mbufs[drain_cnt++] = overflow_buf->entries[overflow_buf->tail];
+		overflow_buf->tail = (overflow_buf->tail + 1) &
+				overflow_buf->mask;
+	}
+
+	/* then the in-order packets at the head of the ready streams */
+	while ((drain_cnt < max_mbufs) && (b->nb_ready != 0)) {
+		stream = b->ready[b->ready_tail];
+		s = &b->streams[stream];
+		entries = &b->entries[stream * b->window];
+
+		/* number of consecutive packets from the head of the window */
+		n = (~s->present == 0) ? 64 : __builtin_ctzll(~s->present);
+		if (n > max_mbufs - drain_cnt)
+			n = max_mbufs - drain_cnt;
+		for (i = 0; i < n; i++) {
+			mbufs[drain_cnt++] = entries[s->head];
+			s->head = (s->head + 1) & (b->window - 1);
+		}
+		s->present = (n == 64) ? 0 : s->present >> n;
+		s->min_seqn += n;
+
+		/* stream not fully drained, it stays first */
+		if (s->present & 1)
+			break;
+
+		s->is_ready = 0;
+		if (++b->ready_tail == b->nb_streams)
+			b->ready_tail = 0;
+		b->nb_ready--;
+	}
+
+	return drain_cnt;
+}
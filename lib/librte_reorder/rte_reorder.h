@@ -44,12 +44,29 @@
  *
  */
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct rte_reorder_buffer;
 
+/**
+ * Statistics of a reorder buffer, collected when the
+ * CONFIG_RTE_REORDER_STATS_COLLECT option is enabled, zero otherwise.
+ */
+struct rte_reorder_stats {
+	uint64_t late_pkts;
+	/**< Packets rejected as older than the sequence window */
+	uint64_t early_pkts;
+	/**< Packets rejected as too far ahead of the sequence window */
+	uint64_t dup_pkts;
+	/**< Packets inserted at a position already holding a packet */
+	uint64_t skipped_seqn;
+	/**< Missing sequence numbers skipped by a move of the window */
+};
+
 /**
  * Create a new reorder buffer instance
  *
@@ -173,6 +190,156 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/**
+ * Fetch reordered buffers, skipping the gaps waited for too long
+ *
+ * Same as rte_reorder_drain(), except that when the next expected packet
+ * is missing while later packets are waiting in the buffer for more than
+ * max_age TSC cycles, the missing sequence numbers are skipped, and the
+ * following packets returned. These packets will be rejected as late
+ * if they arrive afterwards.
+ *
+ * The age of a gap is counted from the first call of this function which
+ * found packets waiting behind it, so it should be called regularly.
+ *
+ * @param b
+ *   Reorder buffer instance from which packets are to be drained
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @param max_age
+ *   The maximum time, in TSC cycles, to wait for a missing packet
+ * @param skipped
+ *   If not NULL, where to store the number of sequence numbers skipped
+ * @return
+ *   number of mbuf pointers written to mbufs. 0 <= N <= max_mbufs.
+ */
+unsigned int
+rte_reorder_drain_timeout(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned max_mbufs, uint64_t max_age,
+		uint32_t *skipped);
+
+/**
+ * Read the statistics of a reorder buffer, and optionally clear them.
+ *
+ * @param b
+ *   Reorder buffer instance
+ * @param stats
+ *   Where to store the statistics, can be NULL to only clear them
+ * @param clear
+ *   If non-zero, the statistics are reset after being read
+ * @return
+ *   0 on success, -EINVAL if b is NULL.
+ */
+int
+rte_reorder_stats_read(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats, int clear);
+
+/*
+ * Multi-stream reorder buffer
+ *
+ * A multi-stream reorder buffer holds a separate sequence number space, with
+ * its own window, for each of a fixed number of streams, e.g. flows. A packet
+ * missing in a stream does not delay the packets of the other streams.
+ */
+
+#define RTE_REORDER_MS_MAX_WINDOW 64 /**< Maximum window of a stream */
+
+struct rte_reorder_ms_buffer;
+
+/**
+ * Create a new multi-stream reorder buffer instance
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param nb_streams
+ *   Number of streams, the streams are numbered from 0 to nb_streams - 1
+ * @param window
+ *   Max number of elements that can be stored for each stream, a power of 2
+ *   no greater than RTE_REORDER_MS_MAX_WINDOW
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found
+ *    - EINVAL - invalid parameters
+ *    - EEXIST - a multi-stream reorder buffer with the same name exists
+ */
+struct rte_reorder_ms_buffer *
+rte_reorder_ms_create(const char *name, unsigned socket_id,
+		unsigned int nb_streams, unsigned int window);
+
+/**
+ * Reset the given multi-stream reorder buffer instance with initial values,
+ * freeing the mbufs it holds.
+ *
+ * @param b
+ *   Reorder buffer instance which has to be reset
+ */
+void
+rte_reorder_ms_reset(struct rte_reorder_ms_buffer *b);
+
+/**
+ * Free multi-stream reorder buffer instance, and the mbufs it holds.
+ *
+ * @param b
+ *   reorder buffer instance
+ */
+void
+rte_reorder_ms_free(struct rte_reorder_ms_buffer *b);
+
+/**
+ * Insert given mbuf in its stream of a multi-stream reorder buffer
+ *
+ * The mbuf must contain the sequence number of the packet in its stream.
+ * The first mbuf inserted in a stream sets the start of its window.
+ *
+ * @param b
+ *   Reorder buffer where the mbuf has to be inserted.
+ * @param stream
+ *   Stream of the packet, lower than the number of streams of the buffer
+ * @param mbuf
+ *   mbuf of packet that needs to be inserted in reorder buffer.
+ * @return
+ *   0 on success
+ *   -1 on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - EINVAL - invalid stream
+ *    - ENOSPC - Cannot move existing mbufs of the stream to accommodate the
+ *      early mbuf, but it can be accommodated by performing drain and then
+ *      insert.
+ *    - ERANGE - Too early or late mbuf which is vastly out of range of the
+ *      window of the stream.
+ */
+int
+rte_reorder_ms_insert(struct rte_reorder_ms_buffer *b, unsigned int stream,
+		struct rte_mbuf *mbuf);
+
+/**
+ * Fetch reordered buffers of all streams
+ *
+ * Returns the in-order buffers of the streams whose next expected packet
+ * has been inserted. The packets of a stream are returned in order, but
+ * the packets of different streams are interleaved. As with
+ * rte_reorder_drain(), gaps may be present in the sequence numbers of a
+ * stream when its window was moved forward by an early packet.
+ *
+ * @param b
+ *   Reorder buffer instance from which packets are to be drained
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @return
+ *   number of mbuf pointers written to mbufs. 0 <= N <= max_mbufs.
+ */
+unsigned int
+rte_reorder_ms_drain(struct rte_reorder_ms_buffer *b, struct rte_mbuf **mbufs,
+		unsigned max_mbufs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,560 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/queue.h>
+
+#include <rte_log.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_errno.h>
+#include <rte_rwlock.h>
+#include <rte_tailq.h>
+
+#include "rte_rib.h"
+
+TAILQ_HEAD(rte_rib_list, rte_tailq_entry);
+
+static struct rte_tailq_elem rte_rib_tailq = {
+	.name = "RTE_RIB",
+};
+EAL_REGISTER_TAILQ(rte_rib_tailq)
+
+#define RTE_LOGTYPE_RIB RTE_LOGTYPE_USER1
+
+#define RTE_RIB_VALID_NODE	1
+
+struct rte_rib_node {
+	struct rte_rib_node *left;
+	struct rte_rib_node *right;
+	struct rte_rib_node *parent;
+	uint32_t ip;
+	uint8_t depth;
+	uint8_t flag;
+	uint64_t nh;
+	uint64_t ext[0];
+};
+
+struct rte_rib {
+	char name[RTE_RIB_NAMESIZE];
+	struct rte_rib_node *tree;
+	struct rte_rib_node *free_nodes; /* Free nodes, linked by left. */
+	void *nodes;                     /* Node memory. */
+	size_t node_sz;
+	uint32_t cur_nodes;
+	uint32_t cur_routes;
+	uint32_t max_nodes;
+};
+
+static inline int
+is_valid_node(const struct rte_rib_node *node)
+{
+	return (node->flag & RTE_RIB_VALID_NODE) == RTE_RIB_VALID_NODE;
+}
+
+static inline int
+is_right_node(const struct rte_rib_node *node)
+{
+	return node->parent->right == node;
+}
+
+/* Check whether ip1 is covered by the ip2/depth prefix. */
+static inline int
+is_covered(uint32_t ip1, uint32_t ip2, uint8_t depth)
+{
+	return ((ip1 ^ ip2) & rte_rib_depth_to_mask(depth)) == 0;
+}
+
+/* Get the child of node on the path to ip. */
+static inline struct rte_rib_node *
+get_nxt_node(const struct rte_rib_node *node, uint32_t ip)
+{
+	if (node->depth == RTE_RIB_MAXDEPTH)
+		return NULL;
+	return (ip & (UINT32_C(1) << (31 - node->depth))) ?
+		node->right : node->left;
+}
+
+static struct rte_rib_node *
+node_alloc(struct rte_rib *rib)
+{
+	struct rte_rib_node *ent = rib->free_nodes;
+
+	if (unlikely(ent == NULL))
+		return NULL;
+	rib->free_nodes = ent->left;
+	rib->cur_nodes++;
+	return ent;
+}
+
+static void
+node_free(struct rte_rib *rib, struct rte_rib_node *ent)
+{
+	ent->left = rib->free_nodes;
+	rib->free_nodes = ent;
+	rib->cur_nodes--;
+}
+
+struct rte_rib_node *
+rte_rib_lookup(struct rte_rib *rib, uint32_t ip)
+{
+	struct rte_rib_node *cur, *prev = NULL;
+
+	if (rib == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cur = rib->tree;
+	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		if (is_valid_node(cur))
+			prev = cur;
+		cur = get_nxt_node(cur, ip);
+	}
+	return prev;
+}
+
+struct rte_rib_node *
+rte_rib_lookup_parent(struct rte_rib_node *ent)
+{
+	struct rte_rib_node *tmp;
+
+	if (ent == NULL)
+		return NULL;
+	tmp = ent->parent;
+	while ((tmp != NULL) && !is_valid_node(tmp))
+		tmp = tmp->parent;
+	return tmp;
+}
+
+static struct rte_rib_node *
+__rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *cur;
+
+	cur = rib->tree;
+	while (cur != NULL) {
+		if ((cur->ip == ip) && (cur->depth == depth) &&
+				is_valid_node(cur))
+			return cur;
+		if ((cur->depth > depth) ||
+				!is_covered(ip, cur->ip, cur->depth))
+			break;
+		cur = get_nxt_node(cur, ip);
+	}
+	return NULL;
+}
+
+struct rte_rib_node *
+rte_rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	ip &= rte_rib_depth_to_mask(depth);
+
+	return __rib_lookup_exact(rib, ip, depth);
+}
+
+/*
+ * Post-order walk of the subtree holding the prefixes covered by ip/depth.
+ * The walk never climbs above the root of this subtree, so its cost only
+ * depends on the number of covered routes.
+ */
+struct rte_rib_node *
+rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip, uint8_t depth,
+	struct rte_rib_node *last, int flag)
+{
+	struct rte_rib_node *tmp, *prev = NULL;
+
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	ip &= rte_rib_depth_to_mask(depth);
+
+	if (last == NULL) {
+		/* Find the root of the subtree. */
+		tmp = rib->tree;
+		while ((tmp != NULL) && (tmp->depth < depth))
+			tmp = get_nxt_node(tmp, ip);
+		if ((tmp != NULL) && !is_covered(tmp->ip, ip, depth))
+			tmp = NULL;
+	} else {
+		tmp = last;
+		while ((tmp->parent != NULL) &&
+				(tmp->parent->depth >= depth) &&
+				(is_right_node(tmp) ||
+				(tmp->parent->right == NULL))) {
+			tmp = tmp->parent;
+			if (is_valid_node(tmp) && (tmp->depth > depth))
+				return tmp;
+		}
+		tmp = ((tmp->parent != NULL) && (tmp->parent->depth >= depth)) ?
+			tmp->parent->right : NULL;
+	}
+
+	/* Descend to the first node of the post-order walk. */
+	while (tmp != NULL) {
+		if (is_valid_node(tmp) && (tmp->depth > depth)) {
+			prev = tmp;
+			if (flag == RTE_RIB_GET_NXT_COVER)
+				return prev;
+		}
+		tmp = (tmp->left != NULL) ? tmp->left : tmp->right;
+	}
+	return prev;
+}
+
+void
+rte_rib_remove(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *cur, *prev, *child;
+
+	cur = rte_rib_lookup_exact(rib, ip, depth);
+	if (cur == NULL)
+		return;
+
+	rib->cur_routes--;
+	cur->flag &= ~RTE_RIB_VALID_NODE;
+
+	/* Free the node and the intermediate nodes left with one child. */
+	while (!is_valid_node(cur)) {
+		if ((cur->left != NULL) && (cur->right != NULL))
+			return;
+		child = (cur->left == NULL) ? cur->right : cur->left;
+		if (child != NULL)
+			child->parent = cur->parent;
+		if (cur->parent == NULL) {
+			rib->tree = child;
+			node_free(rib, cur);
+			return;
+		}
+		if (cur->parent->left == cur)
+			cur->parent->left = child;
+		else
+			cur->parent->right = child;
+		prev = cur;
+		cur = cur->parent;
+		node_free(rib, prev);
+	}
+}
+
+struct rte_rib_node *
+rte_rib_insert(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node **tmp;
+	struct rte_rib_node *prev = NULL;
+	struct rte_rib_node *new_node = NULL;
+	struct rte_rib_node *common_node = NULL;
+	uint32_t common_prefix;
+	uint8_t common_depth;
+	int d;
+
+	if ((rib == NULL) || (depth > RTE_RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	tmp = &rib->tree;
+	ip &= rte_rib_depth_to_mask(depth);
+
+	while (*tmp != NULL) {
+		if ((ip == (*tmp)->ip) && (depth == (*tmp)->depth)) {
+			if (is_valid_node(*tmp)) {
+				rte_errno = EEXIST;
+				return NULL;
+			}
+			/* Turn an intermediate node into a route. */
+			(*tmp)->flag |= RTE_RIB_VALID_NODE;
+			(*tmp)->nh = 0;
+			rib->cur_routes++;
+			return *tmp;
+		}
+		d = (*tmp)->depth;
+		if ((d >= depth) || !is_covered(ip, (*tmp)->ip, d))
+			break;
+		prev = *tmp;
+		tmp = (ip & (UINT32_C(1) << (31 - d))) ?
+			&(*tmp)->right : &(*tmp)->left;
+	}
+
+	new_node = node_alloc(rib);
+	if (new_node == NULL) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+	new_node->left = NULL;
+	new_node->right = NULL;
+	new_node->parent = NULL;
+	new_node->ip = ip;
+	new_node->depth = depth;
+	new_node->flag = RTE_RIB_VALID_NODE;
+	new_node->nh = 0;
+
+	/* Insert as the last node of the branch. */
+	if (*tmp == NULL) {
+		*tmp = new_node;
+		new_node->parent = prev;
+		rib->cur_routes++;
+		return new_node;
+	}
+
+	/* The new node goes between prev and *tmp. */
+	common_depth = RTE_MIN(depth, (*tmp)->depth);
+	common_prefix = ip ^ (*tmp)->ip;
+	d = (common_prefix == 0) ? 32 : __builtin_clz(common_prefix);
+	common_depth = RTE_MIN(d, common_depth);
+	common_prefix = ip & rte_rib_depth_to_mask(common_depth);
+
+	if ((common_prefix == ip) && (common_depth == depth)) {
+		/* Insert as the parent of *tmp. */
+		if ((*tmp)->ip & (UINT32_C(1) << (31 - depth)))
+			new_node->right = *tmp;
+		else
+			new_node->left = *tmp;
+		new_node->parent = (*tmp)->parent;
+		(*tmp)->parent = new_node;
+		*tmp = new_node;
+	} else {
+		/* Create an intermediate node where the branches split. */
+		common_node = node_alloc(rib);
+		if (common_node == NULL) {
+			node_free(rib, new_node);
+			rte_errno = ENOSPC;
+			return NULL;
+		}
+		common_node->ip = common_prefix;
+		common_node->depth = common_depth;
+		common_node->flag = 0;
+		common_node->nh = 0;
+		common_node->parent = (*tmp)->parent;
+		new_node->parent = common_node;
+		(*tmp)->parent = common_node;
+		if ((ip & (UINT32_C(1) << (31 - common_depth))) == 0) {
+			common_node->left = new_node;
+			common_node->right = *tmp;
+		} else {
+			common_node->left = *tmp;
+			common_node->right = new_node;
+		}
+		*tmp = common_node;
+	}
+	rib->cur_routes++;
+	return new_node;
+}
+
+int
+rte_rib_get_ip(const struct rte_rib_node *node, uint32_t *ip)
+{
+	if ((node == NULL) || (ip == NULL))
+		return -EINVAL;
+	*ip = node->ip;
+	return 0;
+}
+
+int
+rte_rib_get_depth(const struct rte_rib_node *node, uint8_t *depth)
+{
+	if ((node == NULL) || (depth == NULL))
+		return -EINVAL;
+	*depth = node->depth;
+	return 0;
+}
+
+void *
+rte_rib_get_ext(struct rte_rib_node *node)
+{
+	return (node == NULL) ? NULL : &node->ext[0];
+}
+
+int
+rte_rib_get_nh(const struct rte_rib_node *node, uint64_t *nh)
+{
+	if ((node == NULL) || (nh == NULL))
+		return -EINVAL;
+	*nh = node->nh;
+	return 0;
+}
+
+int
+rte_rib_set_nh(struct rte_rib_node *node, uint64_t nh)
+{
+	if (node == NULL)
+		return -EINVAL;
+	node->nh = nh;
+	return 0;
+}
+
+struct rte_rib *
+rte_rib_create(const char *name, int socket_id,
+	const struct rte_rib_conf *conf)
+{
+	char mem_name[RTE_RIB_NAMESIZE];
+	struct rte_rib_list *rib_list;
+	struct rte_tailq_entry *te;
+	struct rte_rib *rib = NULL;
+	struct rte_rib_node *node;
+	size_t node_sz;
+	uint32_t i;
+
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	/* Check user arguments. */
+	if ((name == NULL) || (socket_id < -1) || (conf == NULL) ||
+			(conf->max_nodes == 0)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "RIB_%s", name);
+	node_sz = RTE_ALIGN_CEIL(sizeof(struct rte_rib_node) + conf->ext_sz,
+			sizeof(uint64_t));
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, rib_list, next) {
+		rib = (struct rte_rib *)te->data;
+		if (strncmp(name, rib->name, RTE_RIB_NAMESIZE) == 0)
+			break;
+	}
+	rib = NULL;
+	if (te != NULL) {
+		rte_errno = EEXIST;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("RIB_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, RIB, "Failed to allocate tailq entry\n");
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	rib = rte_zmalloc_socket(mem_name, sizeof(*rib),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (rib != NULL)
+		rib->nodes = rte_zmalloc_socket(NULL,
+				node_sz * conf->max_nodes,
+				RTE_CACHE_LINE_SIZE, socket_id);
+	if ((rib == NULL) || (rib->nodes == NULL)) {
+		RTE_LOG(ERR, RIB, "RIB memory allocation failed\n");
+		rte_errno = ENOMEM;
+		rte_free(rib);
+		rib = NULL;
+		rte_free(te);
+		goto exit;
+	}
+
+	snprintf(rib->name, sizeof(rib->name), "%s", name);
+	rib->node_sz = node_sz;
+	rib->max_nodes = conf->max_nodes;
+
+	/* Chain the free nodes, the first ones are allocated first. */
+	for (i = conf->max_nodes; i != 0; i--) {
+		node = RTE_PTR_ADD(rib->nodes, (i - 1) * node_sz);
+		node->left = rib->free_nodes;
+		rib->free_nodes = node;
+	}
+
+	te->data = (void *)rib;
+	TAILQ_INSERT_TAIL(rib_list, te, next);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return rib;
+}
+
+struct rte_rib *
+rte_rib_find_existing(const char *name)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_rib_list *rib_list;
+
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, rib_list, next) {
+		rib = (struct rte_rib *)te->data;
+		if (strncmp(name, rib->name, RTE_RIB_NAMESIZE) == 0)
+			break;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (te == NULL) {
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
+	return rib;
+}
+
+void
+rte_rib_free(struct rte_rib *rib)
+{
+	struct rte_tailq_entry *te;
+	struct rte_rib_list *rib_list;
+
+	if (rib == NULL)
+		return;
+
+	rib_list = RTE_TAILQ_CAST(rte_rib_tailq.head, rte_rib_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, rib_list, next) {
+		if (te->data == (void *)rib)
+			break;
+	}
+	if (te != NULL)
+		TAILQ_REMOVE(rib_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	rte_free(rib->nodes);
+	rte_free(rib);
+	rte_free(te);
+}
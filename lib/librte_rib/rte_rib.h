@@ -0,0 +1,302 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RIB_H_
+#define _RTE_RIB_H_
+
+/**
+ * @file
+ * RTE Routing Information Base (RIB)
+ *
+ * Control plane store of IPv4 routes, kept in a path compressed binary
+ * trie. A node is created for each route, plus at most one intermediate
+ * node per route where two branches split, so adding or deleting a route
+ * costs at most 32 node visits regardless of the number of routes.
+ *
+ * Each route holds a 64-bit next hop and an optional application defined
+ * extension area. The RIB is not meant to be used from the data path:
+ * it has no internal locking and must be updated and queried by a single
+ * thread at a time.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of characters in RIB name. */
+#define RTE_RIB_NAMESIZE	32
+
+/** Maximum depth value possible for an IPv4 route. */
+#define RTE_RIB_MAXDEPTH	32
+
+/**
+ * rte_rib_get_nxt() flags
+ */
+enum {
+	/** Return all the routes more specific than the given prefix. */
+	RTE_RIB_GET_NXT_ALL,
+	/** Return only the routes which are not covered by another route
+	 *  more specific than the given prefix. */
+	RTE_RIB_GET_NXT_COVER
+};
+
+struct rte_rib;
+struct rte_rib_node;
+
+/** RIB configuration structure */
+struct rte_rib_conf {
+	/** Size of the extension area of each node, in bytes. */
+	size_t ext_sz;
+	/** Maximum number of nodes. Up to two nodes are used per route. */
+	uint32_t max_nodes;
+};
+
+/**
+ * Get an IPv4 mask from a depth.
+ *
+ * @param depth
+ *   Prefix length, from 0 to 32.
+ * @return
+ *   IPv4 mask, in host byte order.
+ */
+static inline uint32_t
+rte_rib_depth_to_mask(uint8_t depth)
+{
+	return (uint32_t)(UINT64_MAX << (32 - depth));
+}
+
+/**
+ * Look up the longest prefix matching an IP address.
+ *
+ * @param rib
+ *   RIB object handle.
+ * @param ip
+ *   IP address to look up, in host byte order.
+ * @return
+ *   Pointer to the matching route node, NULL if no route matches.
+ */
+struct rte_rib_node *
+rte_rib_lookup(struct rte_rib *rib, uint32_t ip);
+
+/**
+ * Look up the closest less specific route.
+ *
+ * @param ent
+ *   Pointer to a route node.
+ * @return
+ *   Pointer to the longest route covering the given one, NULL if none.
+ */
+struct rte_rib_node *
+rte_rib_lookup_parent(struct rte_rib_node *ent);
+
+/**
+ * Look up a route.
+ *
+ * @param rib
+ *   RIB object handle.
+ * @param ip
+ *   Prefix of the route, in host byte order.
+ * @param depth
+ *   Depth of the route.
+ * @return
+ *   Pointer to the route node, NULL if it does not exist.
+ */
+struct rte_rib_node *
+rte_rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Iterate over the routes more specific than a given prefix, in increasing
+ * address order. A route is returned after all the routes it covers.
+ *
+ * @param rib
+ *   RIB object handle.
+ * @param ip
+ *   Prefix to iterate into, in host byte order.
+ * @param depth
+ *   Depth of the prefix.
+ * @param last
+ *   Node returned by the previous call, NULL to start the iteration.
+ * @param flag
+ *   RTE_RIB_GET_NXT_ALL or RTE_RIB_GET_NXT_COVER.
+ * @return
+ *   Pointer to the next route node, NULL at the end of the iteration.
+ */
+struct rte_rib_node *
+rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip, uint8_t depth,
+	struct rte_rib_node *last, int flag);
+
+/**
+ * Remove a route.
+ *
+ * @param rib
+ *   RIB object handle.
+ * @param ip
+ *   Prefix of the route, in host byte order.
+ * @param depth
+ *   Depth of the route.
+ */
+void
+rte_rib_remove(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Insert a route. Its next hop is set to 0.
+ *
+ * @param rib
+ *   RIB object handle.
+ * @param ip
+ *   Prefix of the route, in host byte order. The bits beyond depth are
+ *   ignored.
+ * @param depth
+ *   Depth of the route.
+ * @return
+ *   Pointer to the new route node, NULL on error with rte_errno set to:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - the route already exists
+ *    - ENOSPC - no more nodes available
+ */
+struct rte_rib_node *
+rte_rib_insert(struct rte_rib *rib, uint32_t ip, uint8_t depth);
+
+/**
+ * Get the prefix of a route.
+ *
+ * @param node
+ *   Pointer to a route node.
+ * @param ip
+ *   Pointer to the prefix to fill, in host byte order.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rib_get_ip(const struct rte_rib_node *node, uint32_t *ip);
+
+/**
+ * Get the depth of a route.
+ *
+ * @param node
+ *   Pointer to a route node.
+ * @param depth
+ *   Pointer to the depth to fill.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rib_get_depth(const struct rte_rib_node *node, uint8_t *depth);
+
+/**
+ * Get the extension area of a route.
+ *
+ * @param node
+ *   Pointer to a route node.
+ * @return
+ *   Pointer to the ext_sz bytes reserved for the application, NULL if
+ *   node is NULL.
+ */
+void *
+rte_rib_get_ext(struct rte_rib_node *node);
+
+/**
+ * Get the next hop of a route.
+ *
+ * @param node
+ *   Pointer to a route node.
+ * @param nh
+ *   Pointer to the next hop to fill.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rib_get_nh(const struct rte_rib_node *node, uint64_t *nh);
+
+/**
+ * Set the next hop of a route.
+ *
+ * @param node
+ *   Pointer to a route node.
+ * @param nh
+ *   Next hop.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int
+rte_rib_set_nh(struct rte_rib_node *node, uint64_t nh);
+
+/**
+ * Create a RIB object.
+ *
+ * @param name
+ *   RIB name.
+ * @param socket_id
+ *   NUMA socket ID for the RIB memory allocation.
+ * @param conf
+ *   Structure containing the configuration.
+ * @return
+ *   Handle to the RIB object on success, NULL otherwise with rte_errno set
+ *   to an appropriate value:
+ *    - EINVAL - invalid parameter passed to function
+ *    - EEXIST - a RIB with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+struct rte_rib *
+rte_rib_create(const char *name, int socket_id,
+	const struct rte_rib_conf *conf);
+
+/**
+ * Find an existing RIB object and return a pointer to it.
+ *
+ * @param name
+ *   Name of the RIB object as passed to rte_rib_create().
+ * @return
+ *   Pointer to the RIB object, NULL with rte_errno set to ENOENT if it
+ *   was not found.
+ */
+struct rte_rib *
+rte_rib_find_existing(const char *name);
+
+/**
+ * Free a RIB object.
+ *
+ * @param rib
+ *   RIB object handle.
+ */
+void
+rte_rib_free(struct rte_rib *rib);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RIB_H_ */
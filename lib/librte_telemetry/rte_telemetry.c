@@ -0,0 +1,711 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/queue.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_rwlock.h>
+#include <rte_tailq.h>
+#ifdef RTE_LIBRTE_METRICS
+#include <rte_metrics.h>
+#endif
+
+#include "rte_telemetry.h"
+
+/* Macros for printing using RTE_LOG */
+#define RTE_LOGTYPE_TELEMETRY RTE_LOGTYPE_USER1
+
+/* Maximum number of clients connected at the same time */
+#define TELEMETRY_MAX_CLIENTS 8
+/* Maximum length of a request, including the end of line */
+#define TELEMETRY_MAX_REQ_LEN 256
+
+/* Growing buffer holding the reply to a request */
+struct telemetry_buf {
+	char *data;
+	size_t len;
+	size_t size;
+	int error; /**< Set if the buffer could not be extended */
+};
+
+struct telemetry_client {
+	int fd;
+	size_t len; /**< Number of bytes in req */
+	char req[TELEMETRY_MAX_REQ_LEN];
+};
+
+/* Command handler. Returns an error message, or NULL if the reply was
+ * written to the buffer.
+ */
+typedef const char *(*telemetry_cb)(const char *param,
+		struct telemetry_buf *buf);
+
+struct telemetry_cmd {
+	const char *name;
+	telemetry_cb cb;
+};
+
+static struct telemetry {
+	int running;
+	int listen_fd;
+	int stop_fd[2]; /**< Pipe waking up the thread on uninit */
+	pthread_t thread;
+	struct sockaddr_un addr;
+	struct telemetry_client clients[TELEMETRY_MAX_CLIENTS];
+	struct telemetry_buf buf;
+} telemetry;
+
+static void
+telemetry_printf(struct telemetry_buf *buf, const char *fmt, ...)
+{
+	va_list ap;
+	size_t size;
+	char *data;
+	int len;
+
+	if (buf->error)
+		return;
+
+	for (;;) {
+		va_start(ap, fmt);
+		len = vsnprintf(buf->data + buf->len, buf->size - buf->len,
+				fmt, ap);
+		va_end(ap);
+		if (len < 0) {
+			buf->error = 1;
+			return;
+		}
+		if ((size_t)len < buf->size - buf->len)
+			break;
+
+		size = RTE_MAX(buf->size * 2, buf->len + len + 1);
+		data = realloc(buf->data, size);
+		if (data == NULL) {
+			buf->error = 1;
+			return;
+		}
+		buf->data = data;
+		buf->size = size;
+	}
+	buf->len += len;
+}
+
+/* Append a JSON string, escaping the characters which need it */
+static void
+telemetry_str(struct telemetry_buf *buf, const char *str)
+{
+	telemetry_printf(buf, "\"");
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\')
+			telemetry_printf(buf, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20)
+			telemetry_printf(buf, "\\u%04x", (unsigned char)*str);
+		else
+			telemetry_printf(buf, "%c", *str);
+	}
+	telemetry_printf(buf, "\"");
+}
+
+static void
+telemetry_u64(struct telemetry_buf *buf, int first, const char *name,
+		uint64_t value)
+{
+	if (!first)
+		telemetry_printf(buf, ",");
+	telemetry_str(buf, name);
+	telemetry_printf(buf, ":%"PRIu64, value);
+}
+
+static int
+telemetry_parse_port(const char *param, uint8_t *port_id)
+{
+	unsigned long val;
+	char *end;
+
+	if (param == NULL || *param == '\0')
+		return -1;
+	errno = 0;
+	val = strtoul(param, &end, 10);
+	if (errno != 0 || *end != '\0' || val >= RTE_MAX_ETHPORTS ||
+			!rte_eth_dev_is_valid_port(val))
+		return -1;
+	*port_id = val;
+	return 0;
+}
+
+static const char *
+telemetry_ethdev_list(const char *param __rte_unused,
+		struct telemetry_buf *buf)
+{
+	unsigned i;
+	int first = 1;
+
+	telemetry_printf(buf, "[");
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (!rte_eth_dev_is_valid_port(i))
+			continue;
+		telemetry_printf(buf, first ? "%u" : ",%u", i);
+		first = 0;
+	}
+	telemetry_printf(buf, "]");
+	return NULL;
+}
+
+static const char *
+telemetry_ethdev_stats(const char *param, struct telemetry_buf *buf)
+{
+	struct rte_eth_stats stats;
+	uint8_t port_id;
+
+	if (telemetry_parse_port(param, &port_id) < 0)
+		return "invalid port";
+	if (rte_eth_stats_get(port_id, &stats) < 0)
+		return "cannot get port statistics";
+
+	telemetry_printf(buf, "{");
+	telemetry_u64(buf, 1, "ipackets", stats.ipackets);
+	telemetry_u64(buf, 0, "opackets", stats.opackets);
+	telemetry_u64(buf, 0, "ibytes", stats.ibytes);
+	telemetry_u64(buf, 0, "obytes", stats.obytes);
+	telemetry_u64(buf, 0, "imissed", stats.imissed);
+	telemetry_u64(buf, 0, "ierrors", stats.ierrors);
+	telemetry_u64(buf, 0, "oerrors", stats.oerrors);
+	telemetry_u64(buf, 0, "rx_nombuf", stats.rx_nombuf);
+	telemetry_printf(buf, "}");
+	return NULL;
+}
+
+static const char *
+telemetry_ethdev_xstats(const char *param, struct telemetry_buf *buf)
+{
+	struct rte_eth_xstats *xstats;
+	uint8_t port_id;
+	int len, ret, i;
+
+	if (telemetry_parse_port(param, &port_id) < 0)
+		return "invalid port";
+
+	len = rte_eth_xstats_get(port_id, NULL, 0);
+	if (len < 0)
+		return "cannot get port extended statistics";
+	xstats = malloc(sizeof(*xstats) * (len + 1));
+	if (xstats == NULL)
+		return "out of memory";
+	ret = rte_eth_xstats_get(port_id, xstats, len);
+	if (ret < 0 || ret > len) {
+		free(xstats);
+		return "cannot get port extended statistics";
+	}
+
+	telemetry_printf(buf, "{");
+	for (i = 0; i < ret; i++)
+		telemetry_u64(buf, i == 0, xstats[i].name, xstats[i].value);
+	telemetry_printf(buf, "}");
+	free(xstats);
+	return NULL;
+}
+
+struct telemetry_walk_arg {
+	struct telemetry_buf *buf;
+	int first;
+};
+
+static void
+telemetry_mempool_walk(const struct rte_mempool *mp, void *arg)
+{
+	struct telemetry_walk_arg *walk = arg;
+
+	if (!walk->first)
+		telemetry_printf(walk->buf, ",");
+	telemetry_str(walk->buf, mp->name);
+	walk->first = 0;
+}
+
+static const char *
+telemetry_mempool_list(const char *param __rte_unused,
+		struct telemetry_buf *buf)
+{
+	struct telemetry_walk_arg walk = { buf, 1 };
+
+	telemetry_printf(buf, "[");
+	rte_mempool_walk(telemetry_mempool_walk, &walk);
+	telemetry_printf(buf, "]");
+	return NULL;
+}
+
+static const char *
+telemetry_mempool_info(const char *param, struct telemetry_buf *buf)
+{
+	struct rte_mempool *mp;
+	unsigned avail;
+
+	if (param == NULL)
+		return "missing mempool name";
+	mp = rte_mempool_lookup(param);
+	if (mp == NULL)
+		return "unknown mempool";
+
+	avail = rte_mempool_count(mp);
+	telemetry_printf(buf, "{");
+	telemetry_u64(buf, 1, "size", mp->size);
+	telemetry_u64(buf, 0, "cache_size", mp->cache_size);
+	telemetry_u64(buf, 0, "elt_size", mp->elt_size);
+	telemetry_u64(buf, 0, "avail", avail);
+	telemetry_u64(buf, 0, "in_use", mp->size - RTE_MIN(avail, mp->size));
+	telemetry_printf(buf, "}");
+	return NULL;
+}
+
+static const char *
+telemetry_ring_list(const char *param __rte_unused,
+		struct telemetry_buf *buf)
+{
+	struct rte_tailq_entry_head *ring_list;
+	struct rte_tailq_entry *te;
+	const struct rte_ring *r;
+	int first = 1;
+
+	ring_list = RTE_TAILQ_LOOKUP(RTE_TAILQ_RING_NAME,
+			rte_tailq_entry_head);
+	if (ring_list == NULL)
+		return "cannot find the list of rings";
+
+	telemetry_printf(buf, "[");
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, ring_list, next) {
+		r = te->data;
+		if (!first)
+			telemetry_printf(buf, ",");
+		telemetry_str(buf, r->name);
+		first = 0;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+	telemetry_printf(buf, "]");
+	return NULL;
+}
+
+static const char *
+telemetry_ring_info(const char *param, struct telemetry_buf *buf)
+{
+	const struct rte_ring *r;
+
+	if (param == NULL)
+		return "missing ring name";
+	r = rte_ring_lookup(param);
+	if (r == NULL)
+		return "unknown ring";
+
+	telemetry_printf(buf, "{");
+	telemetry_u64(buf, 1, "size", r->prod.size);
+	telemetry_u64(buf, 0, "count", rte_ring_count(r));
+	telemetry_u64(buf, 0, "free", rte_ring_free_count(r));
+	telemetry_u64(buf, 0, "watermark", r->prod.watermark);
+	telemetry_printf(buf, "}");
+	return NULL;
+}
+
+#ifdef RTE_LIBRTE_METRICS
+static const char *
+telemetry_metrics(const char *param, struct telemetry_buf *buf)
+{
+	struct rte_metric_value *values;
+	struct rte_metric_name *names;
+	const char *err = NULL;
+	int port_id, len, ret, i;
+	uint8_t port;
+
+	if (param != NULL && strcmp(param, "global") == 0)
+		port_id = RTE_METRICS_GLOBAL;
+	else if (telemetry_parse_port(param, &port) == 0)
+		port_id = port;
+	else
+		return "invalid port";
+
+retry:
+	len = rte_metrics_get_names(NULL, 0);
+	if (len < 0)
+		return "metrics not initialized";
+
+	names = malloc(sizeof(*names) * (len + 1));
+	values = malloc(sizeof(*values) * (len + 1));
+	if (names == NULL || values == NULL) {
+		err = "out of memory";
+		goto out;
+	}
+	ret = rte_metrics_get_values(port_id, values, len);
+	if (ret < 0) {
+		err = "cannot get metrics";
+		goto out;
+	}
+	/*
+	 * Nothing is copied when metrics were registered since the count
+	 * was read, and the value keys may then be out of the names array.
+	 */
+	if (ret > len || rte_metrics_get_names(names, len) != len) {
+		free(names);
+		free(values);
+		goto retry;
+	}
+
+	telemetry_printf(buf, "{");
+	for (i = 0; i < ret; i++)
+		telemetry_u64(buf, i == 0, names[values[i].key].name,
+				values[i].value);
+	telemetry_printf(buf, "}");
+
+out:
+	free(names);
+	free(values);
+	return err;
+}
+#endif
+
+static const char *telemetry_help(const char *param,
+		struct telemetry_buf *buf);
+
+static const struct telemetry_cmd telemetry_cmds[] = {
+	{ "/help", telemetry_help },
+	{ "/ethdev/list", telemetry_ethdev_list },
+	{ "/ethdev/stats", telemetry_ethdev_stats },
+	{ "/ethdev/xstats", telemetry_ethdev_xstats },
+	{ "/mempool/list", telemetry_mempool_list },
+	{ "/mempool/info", telemetry_mempool_info },
+	{ "/ring/list", telemetry_ring_list },
+	{ "/ring/info", telemetry_ring_info },
+#ifdef RTE_LIBRTE_METRICS
+	{ "/metrics", telemetry_metrics },
+#endif
+};
+
+static const char *
+telemetry_help(const char *param __rte_unused, struct telemetry_buf *buf)
+{
+	unsigned i;
+
+	telemetry_printf(buf, "[");
+	for (i = 0; i < RTE_DIM(telemetry_cmds); i++) {
+		if (i != 0)
+			telemetry_printf(buf, ",");
+		telemetry_str(buf, telemetry_cmds[i].name);
+	}
+	telemetry_printf(buf, "]");
+	return NULL;
+}
+
+/* Build the reply to a request in the telemetry buffer */
+static void
+telemetry_handle(char *req)
+{
+	struct telemetry_buf *buf = &telemetry.buf;
+	const struct telemetry_cmd *cmd = NULL;
+	const char *err = "unknown command";
+	char *param;
+	unsigned i;
+
+	buf->len = 0;
+	buf->error = 0;
+
+	param = strchr(req, ',');
+	if (param != NULL)
+		*param++ = '\0';
+
+	for (i = 0; i < RTE_DIM(telemetry_cmds); i++) {
+		if (strcmp(req, telemetry_cmds[i].name) == 0) {
+			cmd = &telemetry_cmds[i];
+			break;
+		}
+	}
+
+	if (cmd != NULL) {
+		telemetry_printf(buf, "{");
+		telemetry_str(buf, cmd->name);
+		telemetry_printf(buf, ":");
+		err = cmd->cb(param, buf);
+		telemetry_printf(buf, "}\n");
+		if (err == NULL && buf->error)
+			err = "out of memory";
+	}
+
+	if (err != NULL) {
+		buf->len = 0;
+		buf->error = 0;
+		telemetry_printf(buf, "{\"error\":");
+		telemetry_str(buf, err);
+		telemetry_printf(buf, "}\n");
+	}
+}
+
+static int
+telemetry_send(int fd, const char *data, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = send(fd, data, len, MSG_NOSIGNAL);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		data += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+static void
+telemetry_client_close(struct telemetry_client *client)
+{
+	close(client->fd);
+	client->fd = -1;
+	client->len = 0;
+}
+
+/* Read from a client and answer its complete requests */
+static void
+telemetry_client_read(struct telemetry_client *client)
+{
+	char *eol;
+	size_t len;
+	ssize_t ret;
+
+	ret = read(client->fd, client->req + client->len,
+			sizeof(client->req) - client->len);
+	if (ret <= 0) {
+		if (ret < 0 && errno == EINTR)
+			return;
+		telemetry_client_close(client);
+		return;
+	}
+	client->len += ret;
+
+	while ((eol = memchr(client->req, '\n', client->len)) != NULL) {
+		*eol = '\0';
+		len = eol - client->req + 1;
+		if (eol != client->req && eol[-1] == '\r')
+			eol[-1] = '\0';
+
+		telemetry_handle(client->req);
+		if (telemetry.buf.error || telemetry_send(client->fd,
+				telemetry.buf.data, telemetry.buf.len) < 0) {
+			telemetry_client_close(client);
+			return;
+		}
+
+		client->len -= len;
+		memmove(client->req, client->req + len, client->len);
+	}
+
+	/* a request cannot be longer than the buffer */
+	if (client->len == sizeof(client->req))
+		telemetry_client_close(client);
+}
+
+static void
+telemetry_accept(void)
+{
+	int fd, i;
+
+	fd = accept(telemetry.listen_fd, NULL, NULL);
+	if (fd < 0)
+		return;
+
+	for (i = 0; i < TELEMETRY_MAX_CLIENTS; i++) {
+		if (telemetry.clients[i].fd < 0) {
+			telemetry.clients[i].fd = fd;
+			telemetry.clients[i].len = 0;
+			return;
+		}
+	}
+
+	RTE_LOG(WARNING, TELEMETRY, "Too many clients, connection refused\n");
+	close(fd);
+}
+
+static void *
+telemetry_thread_main(void *arg __rte_unused)
+{
+	struct pollfd fds[TELEMETRY_MAX_CLIENTS + 2];
+	int i, n;
+
+	for (;;) {
+		fds[0].fd = telemetry.stop_fd[0];
+		fds[0].events = POLLIN;
+		fds[1].fd = telemetry.listen_fd;
+		fds[1].events = POLLIN;
+		for (i = 0; i < TELEMETRY_MAX_CLIENTS; i++) {
+			fds[i + 2].fd = telemetry.clients[i].fd;
+			fds[i + 2].events = POLLIN;
+			fds[i + 2].revents = 0;
+		}
+
+		n = poll(fds, RTE_DIM(fds), -1);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			RTE_LOG(ERR, TELEMETRY, "poll() failed: %s\n",
+				strerror(errno));
+			break;
+		}
+
+		if (fds[0].revents != 0)
+			break;
+		if (fds[1].revents & POLLIN)
+			telemetry_accept();
+		for (i = 0; i < TELEMETRY_MAX_CLIENTS; i++)
+			if (fds[i + 2].revents != 0 &&
+					telemetry.clients[i].fd >= 0)
+				telemetry_client_read(&telemetry.clients[i]);
+	}
+
+	return NULL;
+}
+
+/* Check whether a process is already listening on the socket path */
+static int
+telemetry_path_in_use(const struct sockaddr_un *addr)
+{
+	int fd, ret;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return 0;
+	ret = connect(fd, (const struct sockaddr *)addr, sizeof(*addr));
+	close(fd);
+	return ret == 0;
+}
+
+int
+rte_telemetry_init(const char *path)
+{
+	int ret, i;
+
+	if (telemetry.running)
+		return -EEXIST;
+
+	if (path == NULL)
+		path = RTE_TELEMETRY_DEFAULT_PATH;
+	memset(&telemetry.addr, 0, sizeof(telemetry.addr));
+	telemetry.addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(telemetry.addr.sun_path))
+		return -EINVAL;
+	strcpy(telemetry.addr.sun_path, path);
+
+	if (telemetry_path_in_use(&telemetry.addr))
+		return -EADDRINUSE;
+	unlink(path);
+
+	telemetry.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (telemetry.listen_fd < 0)
+		return -errno;
+	if (bind(telemetry.listen_fd, (struct sockaddr *)&telemetry.addr,
+			sizeof(telemetry.addr)) < 0 ||
+			listen(telemetry.listen_fd, TELEMETRY_MAX_CLIENTS) < 0) {
+		ret = -errno;
+		RTE_LOG(ERR, TELEMETRY, "Cannot listen on %s: %s\n",
+			path, strerror(errno));
+		goto err_listen;
+	}
+
+	if (pipe(telemetry.stop_fd) < 0) {
+		ret = -errno;
+		goto err_pipe;
+	}
+
+	for (i = 0; i < TELEMETRY_MAX_CLIENTS; i++)
+		telemetry.clients[i].fd = -1;
+
+	ret = pthread_create(&telemetry.thread, NULL, telemetry_thread_main,
+			NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, TELEMETRY, "Cannot create telemetry thread\n");
+		ret = -ret;
+		goto err_thread;
+	}
+
+	telemetry.running = 1;
+	return 0;
+
+err_thread:
+	close(telemetry.stop_fd[0]);
+	close(telemetry.stop_fd[1]);
+err_pipe:
+	unlink(path);
+err_listen:
+	close(telemetry.listen_fd);
+	return ret;
+}
+
+int
+rte_telemetry_uninit(void)
+{
+	char c = 0;
+	int i;
+
+	if (!telemetry.running)
+		return -ENOENT;
+
+	if (write(telemetry.stop_fd[1], &c, sizeof(c)) < 0)
+		RTE_LOG(ERR, TELEMETRY, "Cannot wake up telemetry thread\n");
+	pthread_join(telemetry.thread, NULL);
+
+	for (i = 0; i < TELEMETRY_MAX_CLIENTS; i++)
+		if (telemetry.clients[i].fd >= 0)
+			telemetry_client_close(&telemetry.clients[i]);
+	close(telemetry.stop_fd[0]);
+	close(telemetry.stop_fd[1]);
+	close(telemetry.listen_fd);
+	unlink(telemetry.addr.sun_path);
+
+	free(telemetry.buf.data);
+	memset(&telemetry.buf, 0, sizeof(telemetry.buf));
+	telemetry.running = 0;
+	return 0;
+}
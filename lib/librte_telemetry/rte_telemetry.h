@@ -0,0 +1,100 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_TELEMETRY_H_
+#define _RTE_TELEMETRY_H_
+
+/**
+ * @file
+ * RTE telemetry
+ *
+ * Optional control thread answering monitoring requests on a local UNIX
+ * stream socket, so that the statistics of an application can be polled
+ * by external tools without involving its lcores.
+ *
+ * A request is a line of text made of a command, optionally followed by a
+ * comma and a parameter, e.g. "/ethdev/stats,0". Each request gets a reply
+ * made of a single line of JSON, {"<command>": <data>}, or {"error": "..."}
+ * if the request cannot be served. The supported commands are:
+ *
+ *  - /help: list of the supported commands.
+ *  - /ethdev/list: identifiers of the valid ports.
+ *  - /ethdev/stats,<port>: basic statistics of a port.
+ *  - /ethdev/xstats,<port>: extended statistics of a port.
+ *  - /mempool/list: names of the mempools.
+ *  - /mempool/info,<name>: size and counts of a mempool.
+ *  - /ring/list: names of the rings.
+ *  - /ring/info,<name>: size and occupancy of a ring.
+ *  - /metrics,<port>: metrics of a port, or global metrics if the parameter
+ *    is "global" (only with the metrics library).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default path of the telemetry socket. */
+#define RTE_TELEMETRY_DEFAULT_PATH "/var/run/.rte_telemetry"
+
+/**
+ * Create the telemetry socket and start the thread serving it.
+ *
+ * The thread is not an EAL thread and inherits the CPU affinity of the
+ * calling thread, which should be the master lcore.
+ *
+ * @param path
+ *   Path of the UNIX socket, or NULL for RTE_TELEMETRY_DEFAULT_PATH. A stale
+ *   socket left at this path is removed.
+ * @return
+ *   - 0: Success.
+ *   - -EEXIST: The telemetry thread is already running.
+ *   - -EINVAL: Path too long.
+ *   - -EADDRINUSE: Another process is serving this path.
+ *   - <0: Other negative errno on socket or thread creation failure.
+ */
+int rte_telemetry_init(const char *path);
+
+/**
+ * Stop the telemetry thread, close the connections and remove the socket.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENOENT: The telemetry thread is not running.
+ */
+int rte_telemetry_uninit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TELEMETRY_H_ */
@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <assert.h>
 #include <sys/queue.h>
 
@@ -51,11 +52,59 @@
 #include <rte_branch_prediction.h>
 #include <rte_spinlock.h>
 #include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+/* timing wheel geometry: 4 levels of 256 slots, and an overflow list */
+#define WHEEL_BITS	8
+#define WHEEL_SIZE	(1U << WHEEL_BITS)
+#define WHEEL_MASK	(WHEEL_SIZE - 1)
+#define WHEEL_LEVELS	4
+#define WHEEL_OVERFLOW	(WHEEL_LEVELS * WHEEL_SIZE)
+
+/*
+ * Hierarchical timing wheel of an lcore.
+ * A timer due at tick t is in the slot (t >> (WHEEL_BITS * l)) & WHEEL_MASK
+ * of the lowest level l for which t - tick < 2^(WHEEL_BITS * (l + 1)).
+ * When tick reaches the start of a slot of an upper level, the timers of
+ * that slot are cascaded to the lower levels.
+ */
+struct timer_wheel {
+	uint64_t tick;          /**< next tick to run */
+	uint32_t num_timers;    /**< number of timers in the wheel */
+	uint32_t shift;         /**< log2 of the number of cycles per tick */
+	uint64_t bmap[WHEEL_SIZE / 64]; /**< non empty slots of level 0 */
+	struct rte_timer *slots[WHEEL_OVERFLOW + 1];
+} __rte_cache_aligned;
+
+/* maximum number of requests applied under one lock */
+#define TIMER_REQ_BURST	32
+
+/*
+ * Reset of a timer posted to the lcore that has to update its list.
+ * The timer is in CONFIG state, owned by that lcore, until it is applied.
+ */
+struct timer_request {
+	struct rte_timer *tim;
+	union rte_timer_status prev_status; /**< status before the request */
+	unsigned tim_lcore;                 /**< lcore to add the timer to */
+	uint64_t expire;
+	uint64_t period;
+	rte_timer_cb_t f;
+	void *arg;
+};
+
+/* requests posted to an lcore by the other ones */
+struct timer_requests {
+	struct rte_ring *ring;          /**< posted requests, single consumer */
+	struct rte_ring *free;          /**< free requests, single producer */
+	struct timer_request req[0];    /**< storage of the requests */
+};
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -69,39 +118,269 @@ struct priv_timer {
 
 	unsigned prev_lcore;              /**< used for lcore round robin */
 
+	struct timer_wheel *wheel;        /**< with the wheel backend */
+
+	struct timer_requests *requests;  /**< with remote requests */
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
 #endif
 } __rte_cache_aligned;
 
-/** per-lcore private info for timers */
-static struct priv_timer priv_timer[RTE_MAX_LCORE];
+/*
+ * Timer data instance: per-lcore lists of pending timers,
+ * managed independently from the other instances.
+ */
+struct rte_timer_data {
+	/** per-lcore private info for timers */
+	struct priv_timer priv_timer[RTE_MAX_LCORE];
+
+	/** backend of the lists of pending timers, skiplist or wheel */
+	enum rte_timer_backend backend;
+
+	/** size of the request rings, 0 if the lists are updated directly */
+	unsigned req_size;
+} __rte_cache_aligned;
+
+/** instance used by the functions without a timer data id */
+static struct rte_timer_data default_timer_data;
+
+/** timer data instances by id, the default one has id 0 */
+static struct rte_timer_data *timer_data[RTE_TIMER_MAX_DATA] = {
+	&default_timer_data,
+};
+
+/** lock to protect allocation of timer data ids */
+static rte_spinlock_t timer_data_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* get a timer data instance from its id, NULL if not allocated */
+static inline struct rte_timer_data *
+timer_data_get(uint32_t id)
+{
+	return (id < RTE_TIMER_MAX_DATA) ? timer_data[id] : NULL;
+}
 
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
-#define __TIMER_STAT_ADD(name, n) do {					\
+#define __TIMER_STAT_ADD(td, name, n) do {				\
 		unsigned __lcore_id = rte_lcore_id();			\
 		if (__lcore_id < RTE_MAX_LCORE)				\
-			priv_timer[__lcore_id].stats.name += (n);	\
+			(td)->priv_timer[__lcore_id].stats.name += (n);	\
 	} while(0)
 #else
-#define __TIMER_STAT_ADD(name, n) do {} while(0)
+#define __TIMER_STAT_ADD(td, name, n) do {} while(0)
 #endif
 
+/* Init the lists of a timer data instance. */
+static void
+timer_data_init(struct rte_timer_data *td)
+{
+	unsigned lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
+		rte_spinlock_init(&td->priv_timer[lcore_id].list_lock);
+		td->priv_timer[lcore_id].prev_lcore = lcore_id;
+	}
+}
+
 /* Init the timer library. */
 void
 rte_timer_subsystem_init(void)
+{
+	/* since default_timer_data is static, it's zeroed by default,
+	 * so only init some fields.
+	 */
+	timer_data_init(&default_timer_data);
+}
+
+/* Check that no timer is pending in a timer data instance */
+static int
+timer_data_busy(const struct rte_timer_data *td)
 {
 	unsigned lcore_id;
 
-	/* since priv_timer is static, it's zeroed by default, so only init some
-	 * fields.
-	 */
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
-		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
-		priv_timer[lcore_id].prev_lcore = lcore_id;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (td->priv_timer[lcore_id].pending_head.sl_next[0] != NULL ||
+				(td->priv_timer[lcore_id].wheel != NULL &&
+				td->priv_timer[lcore_id].wheel->num_timers != 0))
+			return 1;
 	}
+	return 0;
+}
+
+/* Allocate a timer data instance */
+int
+rte_timer_data_alloc(uint32_t *id)
+{
+	uint32_t i;
+	struct rte_timer_data *td;
+
+	if (id == NULL)
+		return -EINVAL;
+
+	td = rte_zmalloc("timer_data", sizeof(*td), RTE_CACHE_LINE_SIZE);
+	if (td == NULL)
+		return -ENOMEM;
+	timer_data_init(td);
+
+	rte_spinlock_lock(&timer_data_lock);
+	for (i = 0; i != RTE_TIMER_MAX_DATA && timer_data[i] != NULL; i++)
+		;
+	if (i != RTE_TIMER_MAX_DATA)
+		timer_data[i] = td;
+	rte_spinlock_unlock(&timer_data_lock);
+
+	if (i == RTE_TIMER_MAX_DATA) {
+		rte_free(td);
+		return -ENOSPC;
+	}
+
+	*id = i;
+	return 0;
+}
+
+/* Free a timer data instance */
+int
+rte_timer_data_dealloc(uint32_t id)
+{
+	unsigned lcore_id;
+	struct rte_timer_data *td;
+
+	td = timer_data_get(id);
+	if (td == NULL || td == &default_timer_data)
+		return -EINVAL;
+
+	if (timer_data_busy(td))
+		return -EBUSY;
+
+	rte_spinlock_lock(&timer_data_lock);
+	timer_data[id] = NULL;
+	rte_spinlock_unlock(&timer_data_lock);
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		rte_free(td->priv_timer[lcore_id].wheel);
+		rte_free(td->priv_timer[lcore_id].requests);
+	}
+	rte_free(td);
+	return 0;
+}
+
+/* Select the list of pending timers, while none is pending */
+int
+rte_timer_data_set_backend(uint32_t id, enum rte_timer_backend backend,
+		uint64_t tick)
+{
+	unsigned lcore_id, shift;
+	uint64_t now;
+	struct timer_wheel *w;
+	struct rte_timer_data *td;
+
+	td = timer_data_get(id);
+	if (td == NULL ||
+			(backend != RTE_TIMER_SKIPLIST &&
+			backend != RTE_TIMER_WHEEL))
+		return -EINVAL;
+
+	if (timer_data_busy(td))
+		return -EBUSY;
+
+	if (backend == RTE_TIMER_WHEEL) {
+		if (tick == 0)
+			tick = RTE_TIMER_WHEEL_TICK_DEFAULT(rte_get_timer_hz());
+		shift = (tick <= 1) ? 0 : 63 - __builtin_clzll(tick);
+		now = rte_get_timer_cycles() >> shift;
+
+		RTE_LCORE_FOREACH(lcore_id) {
+			w = td->priv_timer[lcore_id].wheel;
+			if (w == NULL) {
+				w = rte_zmalloc_socket("timer_wheel",
+					sizeof(*w), RTE_CACHE_LINE_SIZE,
+					rte_lcore_to_socket_id(lcore_id));
+				if (w == NULL)
+					return -ENOMEM;
+				td->priv_timer[lcore_id].wheel = w;
+			}
+			w->shift = shift;
+			w->tick = now;
+		}
+	}
+
+	td->backend = backend;
+	return 0;
+}
+
+/* Allocate the request rings of an lcore, and fill the free one */
+static struct timer_requests *
+timer_requests_create(unsigned size, int socket_id)
+{
+	struct timer_requests *rq;
+	ssize_t ring_sz;
+	size_t sz;
+	unsigned i;
+
+	ring_sz = rte_ring_get_memsize(size);
+	if (ring_sz < 0)
+		return NULL;
+
+	/* a ring of size entries holds size - 1 of them */
+	sz = RTE_ALIGN(sizeof(*rq) + (size - 1) * sizeof(rq->req[0]),
+		RTE_CACHE_LINE_SIZE);
+	rq = rte_zmalloc_socket("timer_requests", sz + 2 * ring_sz,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (rq == NULL)
+		return NULL;
+
+	rq->ring = (struct rte_ring *)((char *)rq + sz);
+	rq->free = (struct rte_ring *)((char *)rq->ring + ring_sz);
+	rte_ring_init(rq->ring, "timer_req", size, RING_F_SC_DEQ);
+	rte_ring_init(rq->free, "timer_req_free", size, RING_F_SP_ENQ);
+	for (i = 0; i != size - 1; i++)
+		rte_ring_sp_enqueue(rq->free, &rq->req[i]);
+
+	return rq;
+}
+
+/* Update the lists of other lcores through their request rings */
+int
+rte_timer_data_set_remote(uint32_t id, unsigned size)
+{
+	unsigned lcore_id;
+	struct timer_requests *rq;
+	struct rte_timer_data *td;
+
+	td = timer_data_get(id);
+	if (td == NULL || (size != 0 && (size < 2 || !rte_is_power_of_2(size))))
+		return -EINVAL;
+
+	if (timer_data_busy(td))
+		return -EBUSY;
+
+	td->req_size = 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		rte_free(td->priv_timer[lcore_id].requests);
+		td->priv_timer[lcore_id].requests = NULL;
+	}
+	if (size == 0)
+		return 0;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		rq = timer_requests_create(size,
+			rte_lcore_to_socket_id(lcore_id));
+		if (rq == NULL)
+			return -ENOMEM;
+		td->priv_timer[lcore_id].requests = rq;
+	}
+
+	td->req_size = size;
+	return 0;
+}
+
+/* Select the list of pending timers of the default instance */
+int
+rte_timer_subsystem_set_backend(enum rte_timer_backend backend, uint64_t tick)
+{
+	return rte_timer_data_set_backend(0, backend, tick);
 }
 
 /* Initialize the timer handle tim for use */
@@ -230,11 +509,11 @@ timer_get_skiplist_level(unsigned curr_depth)
  * are <= that time value.
  */
 static void
-timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
-		struct rte_timer **prev)
+timer_get_prev_entries(struct rte_timer_data *td, uint64_t time_val,
+		unsigned tim_lcore, struct rte_timer **prev)
 {
-	unsigned lvl = priv_timer[tim_lcore].curr_skiplist_depth;
-	prev[lvl] = &priv_timer[tim_lcore].pending_head;
+	unsigned lvl = td->priv_timer[tim_lcore].curr_skiplist_depth;
+	prev[lvl] = &td->priv_timer[tim_lcore].pending_head;
 	while(lvl != 0) {
 		lvl--;
 		prev[lvl] = prev[lvl+1];
@@ -249,15 +528,15 @@ timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
  * all skiplist levels.
  */
 static void
-timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
-		struct rte_timer **prev)
+timer_get_prev_entries_for_node(struct rte_timer_data *td,
+		struct rte_timer *tim, unsigned tim_lcore, struct rte_timer **prev)
 {
 	int i;
 	/* to get a specific entry in the list, look for just lower than the time
 	 * values, and then increment on each level individually if necessary
 	 */
-	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev);
-	for (i = priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
+	timer_get_prev_entries(td, tim->expire - 1, tim_lcore, prev);
+	for (i = td->priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
 		while (prev[i]->sl_next[i] != NULL &&
 				prev[i]->sl_next[i] != tim &&
 				prev[i]->sl_next[i]->expire <= tim->expire)
@@ -266,32 +545,24 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 }
 
 /*
- * add in list, lock if needed
- * timer must be in config state
- * timer must not be in a list
+ * add in skiplist, list must be locked
  */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+timer_skiplist_add(struct rte_timer_data *td, struct rte_timer *tim,
+		unsigned tim_lcore)
 {
-	unsigned lcore_id = rte_lcore_id();
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
-
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
-	timer_get_prev_entries(tim->expire, tim_lcore, prev);
+	timer_get_prev_entries(td, tim->expire, tim_lcore, prev);
 
 	/* now assign it a new level and add at that level */
 	const unsigned tim_level = timer_get_skiplist_level(
-			priv_timer[tim_lcore].curr_skiplist_depth);
-	if (tim_level == priv_timer[tim_lcore].curr_skiplist_depth)
-		priv_timer[tim_lcore].curr_skiplist_depth++;
+			td->priv_timer[tim_lcore].curr_skiplist_depth);
+	if (tim_level == td->priv_timer[tim_lcore].curr_skiplist_depth)
+		td->priv_timer[tim_lcore].curr_skiplist_depth++;
 
 	lvl = tim_level;
 	while (lvl > 0) {
@@ -304,60 +575,428 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 
 	/* save the lowest list entry into the expire field of the dummy hdr
 	 * NOTE: this is not atomic on 32-bit*/
-	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
+	td->priv_timer[tim_lcore].pending_head.expire = td->priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
-
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
 /*
- * del from list, lock if needed
- * timer must be in config state
- * timer must be in a list
+ * del from skiplist, list must be locked
  */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+timer_skiplist_del(struct rte_timer_data *td, struct rte_timer *tim,
+		unsigned prev_owner)
 {
-	unsigned lcore_id = rte_lcore_id();
-	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
-
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
-	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
-		priv_timer[prev_owner].pending_head.expire =
+	if (tim == td->priv_timer[prev_owner].pending_head.sl_next[0])
+		td->priv_timer[prev_owner].pending_head.expire =
 				((tim->sl_next[0] == NULL) ? 0 : tim->sl_next[0]->expire);
 
 	/* adjust pointers from previous entries to point past this */
-	timer_get_prev_entries_for_node(tim, prev_owner, prev);
-	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
+	timer_get_prev_entries_for_node(td, tim, prev_owner, prev);
+	for (i = td->priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
 		if (prev[i]->sl_next[i] == tim)
 			prev[i]->sl_next[i] = tim->sl_next[i];
 	}
 
 	/* in case we deleted last entry at a level, adjust down max level */
-	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--)
-		if (priv_timer[prev_owner].pending_head.sl_next[i] == NULL)
-			priv_timer[prev_owner].curr_skiplist_depth --;
+	for (i = td->priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--)
+		if (td->priv_timer[prev_owner].pending_head.sl_next[i] == NULL)
+			td->priv_timer[prev_owner].curr_skiplist_depth --;
 		else
 			break;
+}
+
+/*
+ * add in the wheel slot for the timer expiry, wheel must be locked
+ */
+static void
+timer_wheel_add(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint64_t expire, delta;
+	uint32_t lvl, slot;
+
+	/* round up, a timer must not run before it expires */
+	expire = (tim->expire >> w->shift) +
+		((tim->expire & ((UINT64_C(1) << w->shift) - 1)) != 0);
+	if (expire < w->tick)
+		expire = w->tick;
+	delta = expire - w->tick;
+
+	for (lvl = 0; lvl != WHEEL_LEVELS &&
+			delta >> (WHEEL_BITS * (lvl + 1)) != 0; lvl++)
+		;
+
+	if (lvl == WHEEL_LEVELS)
+		slot = WHEEL_OVERFLOW;
+	else
+		slot = lvl * WHEEL_SIZE +
+			((expire >> (WHEEL_BITS * lvl)) & WHEEL_MASK);
+
+	tim->wheel.slot = slot;
+	tim->wheel.pprev = &w->slots[slot];
+	tim->wheel.next = w->slots[slot];
+	if (tim->wheel.next != NULL)
+		tim->wheel.next->wheel.pprev = &tim->wheel.next;
+	w->slots[slot] = tim;
+
+	if (slot < WHEEL_SIZE)
+		w->bmap[slot / 64] |= UINT64_C(1) << (slot % 64);
+	w->num_timers++;
+}
+
+/*
+ * del from its wheel slot, wheel must be locked
+ */
+static void
+timer_wheel_del(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint32_t slot;
+
+	slot = tim->wheel.slot;
+	*tim->wheel.pprev = tim->wheel.next;
+	if (tim->wheel.next != NULL)
+		tim->wheel.next->wheel.pprev = tim->wheel.pprev;
+
+	if (slot < WHEEL_SIZE && w->slots[slot] == NULL)
+		w->bmap[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+	w->num_timers--;
+}
+
+/* timers taken out of the wheel by rte_timer_manage() */
+struct timer_wheel_run {
+	struct rte_timer *first;   /* running timers, through sl_next[0] */
+	struct rte_timer **last;   /* end of the running timers */
+	struct rte_timer *again;   /* timers being configured by another core */
+};
+
+/*
+ * mark the timers of a slot as running, and append them to the run list
+ */
+static void
+timer_wheel_run_slot(struct timer_wheel *w, uint32_t slot,
+	struct timer_wheel_run *run)
+{
+	struct rte_timer *tim, *next_tim;
+
+	tim = w->slots[slot];
+	w->slots[slot] = NULL;
+	if (slot < WHEEL_SIZE)
+		w->bmap[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = tim->wheel.next;
+		w->num_timers--;
+
+		if (likely(timer_set_running_state(tim) == 0)) {
+			*run->last = tim;
+			run->last = &tim->sl_next[0];
+		} else {
+			/* another core is trying to re-config this one,
+			 * it goes back in the wheel once the run is over */
+			tim->sl_next[0] = run->again;
+			run->again = tim;
+		}
+	}
+}
+
+/*
+ * re-add the timers of a slot, due at or after the current tick,
+ * to the lower levels of the wheel
+ */
+static void
+timer_wheel_cascade_slot(struct timer_wheel *w, uint32_t slot)
+{
+	struct rte_timer *tim, *next_tim;
+
+	tim = w->slots[slot];
+	w->slots[slot] = NULL;
+
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = tim->wheel.next;
+		w->num_timers--;
+		timer_wheel_add(w, tim);
+	}
+}
+
+/*
+ * the current tick starts a level 0 round: cascade the slots of the upper
+ * levels that start at that tick, from the highest one. A slot entirely
+ * due at tick now is run rather than cascaded.
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *w, uint64_t now,
+	struct timer_wheel_run *run)
+{
+	uint32_t lvl, slot;
+	uint64_t span;
+
+	for (lvl = 1; lvl != WHEEL_LEVELS &&
+			(w->tick & ((UINT64_C(1) << (WHEEL_BITS * lvl)) - 1))
+			== 0; lvl++)
+		;
+
+	if (lvl == WHEEL_LEVELS && (w->tick &
+			((UINT64_C(1) << (WHEEL_BITS * lvl)) - 1)) == 0)
+		timer_wheel_cascade_slot(w, WHEEL_OVERFLOW);
+
+	while (--lvl != 0) {
+		slot = lvl * WHEEL_SIZE +
+			((w->tick >> (WHEEL_BITS * lvl)) & WHEEL_MASK);
+		span = UINT64_C(1) << (WHEEL_BITS * lvl);
+		if (now - w->tick >= span - 1)
+			timer_wheel_run_slot(w, slot, run);
+		else
+			timer_wheel_cascade_slot(w, slot);
+	}
+}
+
+/*
+ * first non empty slot of level 0 from idx, WHEEL_SIZE if none
+ */
+static uint32_t
+timer_wheel_next_slot(const struct timer_wheel *w, uint32_t idx)
+{
+	uint32_t i;
+	uint64_t m;
+
+	i = idx / 64;
+	m = w->bmap[i] & (UINT64_MAX << (idx % 64));
+	while (m == 0) {
+		if (++i == RTE_DIM(w->bmap))
+			return WHEEL_SIZE;
+		m = w->bmap[i];
+	}
+
+	return i * 64 + __builtin_ctzll(m);
+}
+
+/*
+ * run the wheel up to tick now: take out the timers due at these ticks,
+ * wheel must be locked. Returns the ones marked as running,
+ * linked through sl_next[0].
+ */
+static struct rte_timer *
+timer_wheel_expire(struct timer_wheel *w, uint64_t now)
+{
+	uint32_t idx, last, n;
+	struct rte_timer *tim;
+	struct timer_wheel_run run;
+
+	run.first = NULL;
+	run.last = &run.first;
+	run.again = NULL;
+
+	while (w->tick <= now) {
+
+		idx = w->tick & WHEEL_MASK;
+		if (idx == 0)
+			timer_wheel_cascade(w, now, &run);
+
+		/* skip the empty slots up to the end of the round or now */
+		last = (now - w->tick < WHEEL_MASK - idx) ?
+			idx + (now - w->tick) : WHEEL_MASK;
+		n = timer_wheel_next_slot(w, idx);
+		if (n > last) {
+			w->tick += last - idx + 1;
+			continue;
+		}
+
+		w->tick += n - idx + 1;
+		timer_wheel_run_slot(w, n, &run);
+	}
+	*run.last = NULL;
+
+	for (tim = run.again; tim != NULL; tim = run.again) {
+		run.again = tim->sl_next[0];
+		timer_wheel_add(w, tim);
+	}
+
+	return run.first;
+}
+
+/*
+ * add in list, lock if needed
+ * timer must be in config state
+ * timer must not be in a list
+ */
+static void
+timer_add(struct rte_timer_data *td, struct rte_timer *tim, unsigned tim_lcore,
+		int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct timer_wheel *w;
+	uint64_t now;
 
+	/* if timer needs to be scheduled on another core, we need to
+	 * lock the list; if it is on local core, we need to lock if
+	 * we are not called from rte_timer_manage() */
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_lock(&td->priv_timer[tim_lcore].list_lock);
+
+	if (td->backend == RTE_TIMER_WHEEL) {
+		w = td->priv_timer[tim_lcore].wheel;
+
+		/* rte_timer_manage() does not run an empty wheel: move it to
+		 * the current tick, so that the idle ticks are not walked */
+		if (w->num_timers == 0) {
+			now = rte_get_timer_cycles() >> w->shift;
+			if (now > w->tick)
+				w->tick = now;
+		}
+		timer_wheel_add(w, tim);
+	} else
+		timer_skiplist_add(td, tim, tim_lcore);
+
+	if (tim_lcore != lcore_id || !local_is_locked)
+		rte_spinlock_unlock(&td->priv_timer[tim_lcore].list_lock);
+}
+
+/*
+ * del from list, lock if needed
+ * timer must be in config state
+ * timer must be in a list
+ */
+static void
+timer_del(struct rte_timer_data *td, struct rte_timer *tim,
+		union rte_timer_status prev_status, int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned prev_owner = prev_status.owner;
+
+	/* if timer needs is pending another core, we need to lock the
+	 * list; if it is on local core, we need to lock if we are not
+	 * called from rte_timer_manage() */
 	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
+		rte_spinlock_lock(&td->priv_timer[prev_owner].list_lock);
+
+	if (td->backend == RTE_TIMER_WHEEL)
+		timer_wheel_del(td->priv_timer[prev_owner].wheel, tim);
+	else
+		timer_skiplist_del(td, tim, prev_owner);
+
+	if (prev_owner != lcore_id || !local_is_locked)
+		rte_spinlock_unlock(&td->priv_timer[prev_owner].list_lock);
+}
+
+/*
+ * post the reset of a timer in CONFIG state to the request ring of the
+ * lcore that has to update its list: returns -1 if the ring has no free
+ * request, and the caller has to update the list itself.
+ */
+static int
+timer_post(struct rte_timer_data *td, struct rte_timer *tim,
+	   union rte_timer_status prev_status, unsigned post_lcore,
+	   uint64_t expire, uint64_t period,
+	   unsigned tim_lcore, rte_timer_cb_t fct, void *arg)
+{
+	struct timer_requests *rq = td->priv_timer[post_lcore].requests;
+	struct timer_request *r;
+	union rte_timer_status status;
+
+	if (rq == NULL || rte_ring_mc_dequeue(rq->free, (void **)&r) != 0)
+		return -1;
+
+	r->tim = tim;
+	r->prev_status = prev_status;
+	r->tim_lcore = tim_lcore;
+	r->expire = expire;
+	r->period = period;
+	r->f = fct;
+	r->arg = arg;
+
+	/* the timer stays in CONFIG state, owned by the lcore applying the
+	 * request, so it must be set before the request can be dequeued */
+	status.state = RTE_TIMER_CONFIG;
+	status.owner = (int16_t)post_lcore;
+	tim->status.u32 = status.u32;
+
+	/* cannot fail: there are less requests than ring entries */
+	rte_ring_mp_enqueue(rq->ring, r);
+	return 0;
+}
+
+/* add the timer of a reset request, and mark it as pending */
+static void
+timer_request_add(struct rte_timer_data *td, struct timer_request *r,
+		  int local_is_locked)
+{
+	struct rte_timer *tim = r->tim;
+	union rte_timer_status status;
+
+	tim->period = r->period;
+	tim->expire = r->expire;
+	tim->f = r->f;
+	tim->arg = r->arg;
+
+	timer_add(td, tim, r->tim_lcore, local_is_locked);
+
+	rte_wmb();
+	status.state = RTE_TIMER_PENDING;
+	status.owner = (int16_t)r->tim_lcore;
+	tim->status.u32 = status.u32;
+}
+
+/* apply the requests posted to the lcore, in bursts */
+static void
+timer_requests_apply(struct rte_timer_data *td, unsigned lcore_id)
+{
+	struct timer_requests *rq = td->priv_timer[lcore_id].requests;
+	struct timer_request *reqs[TIMER_REQ_BURST], *r;
+	unsigned i, n;
+
+	if (rq == NULL)
+		return;
+
+	while ((n = rte_ring_sc_dequeue_burst(rq->ring, (void **)reqs,
+			TIMER_REQ_BURST)) != 0) {
+
+		/* update the local list under one lock */
+		rte_spinlock_lock(&td->priv_timer[lcore_id].list_lock);
+		for (i = 0; i != n; i++) {
+			r = reqs[i];
+			if (r->prev_status.state == RTE_TIMER_PENDING)
+				timer_del(td, r->tim, r->prev_status, 1);
+			if (r->tim_lcore == lcore_id)
+				timer_request_add(td, r, 1);
+		}
+		rte_spinlock_unlock(&td->priv_timer[lcore_id].list_lock);
+
+		/* move the timers reset on other lcores */
+		for (i = 0; i != n; i++) {
+			r = reqs[i];
+			if (r->tim_lcore != lcore_id)
+				timer_request_add(td, r, 0);
+		}
+
+		rte_ring_sp_enqueue_bulk(rq->free, (void **)reqs, n);
+	}
+}
+
+/*
+ * a timer in CONFIG state owned by this lcore is held by a request posted
+ * to it: apply them, so that the lcore can update the timer.
+ */
+static inline void
+timer_requests_check(struct rte_timer_data *td, struct rte_timer *tim)
+{
+	union rte_timer_status status;
+	unsigned lcore_id = rte_lcore_id();
+
+	status.u32 = tim->status.u32;
+	if (status.state == RTE_TIMER_CONFIG &&
+			status.owner == (int16_t)lcore_id &&
+			lcore_id < RTE_MAX_LCORE)
+		timer_requests_apply(td, lcore_id);
 }
 
 /* Reset and start the timer associated with the timer handle (private func) */
 static int
-__rte_timer_reset(struct rte_timer *tim, uint64_t expire,
+__rte_timer_reset(struct rte_timer_data *td, struct rte_timer *tim,
+		  uint64_t expire,
 		  uint64_t period, unsigned tim_lcore,
 		  rte_timer_cb_t fct, void *arg,
 		  int local_is_locked)
@@ -371,31 +1010,61 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		if (lcore_id < RTE_MAX_LCORE) {
 			/* EAL thread with valid lcore_id */
 			tim_lcore = rte_get_next_lcore(
-				priv_timer[lcore_id].prev_lcore,
+				td->priv_timer[lcore_id].prev_lcore,
 				0, 1);
-			priv_timer[lcore_id].prev_lcore = tim_lcore;
+			td->priv_timer[lcore_id].prev_lcore = tim_lcore;
 		} else
 			/* non-EAL thread do not run rte_timer_manage(),
 			 * so schedule the timer on the first enabled lcore. */
 			tim_lcore = rte_get_next_lcore(LCORE_ID_ANY, 0, 1);
 	}
 
+	if (td->req_size != 0 && !local_is_locked)
+		timer_requests_check(td, tim);
+
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
 	ret = timer_set_config_state(tim, &prev_status);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(reset, 1);
+	__TIMER_STAT_ADD(td, reset, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
+		td->priv_timer[lcore_id].updated = 1;
+	}
+
+	/* with remote requests, the lists of the other lcores are updated
+	 * by them: post the reset to the lcore that has the timer in its
+	 * list, or that has to add it */
+	if (td->req_size != 0 && !local_is_locked) {
+		ret = -1;
+		if (prev_status.state == RTE_TIMER_PENDING &&
+				prev_status.owner != (int16_t)lcore_id)
+			ret = timer_post(td, tim, prev_status,
+				prev_status.owner, expire, period, tim_lcore,
+				fct, arg);
+		else if (tim_lcore != lcore_id) {
+			if (prev_status.state == RTE_TIMER_PENDING) {
+				timer_del(td, tim, prev_status, 0);
+				__TIMER_STAT_ADD(td, pending, -1);
+				prev_status.state = RTE_TIMER_STOP;
+			}
+			ret = timer_post(td, tim, prev_status, tim_lcore,
+				expire, period, tim_lcore, fct, arg);
+		}
+		if (ret == 0) {
+			if (prev_status.state == RTE_TIMER_PENDING)
+				__TIMER_STAT_ADD(td, pending, -1);
+			__TIMER_STAT_ADD(td, pending, 1);
+			return 0;
+		}
 	}
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, local_is_locked);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(td, tim, prev_status, local_is_locked);
+		__TIMER_STAT_ADD(td, pending, -1);
 	}
 
 	tim->period = period;
@@ -403,8 +1072,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	tim->f = fct;
 	tim->arg = arg;
 
-	__TIMER_STAT_ADD(pending, 1);
-	timer_add(tim, tim_lcore, local_is_locked);
+	__TIMER_STAT_ADD(td, pending, 1);
+	timer_add(td, tim, tim_lcore, local_is_locked);
 
 	/* update state: as we are in CONFIG state, only us can modify
 	 * the state so we don't need to use cmpset() here */
@@ -416,9 +1085,9 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	return 0;
 }
 
-/* Reset and start the timer associated with the timer handle tim */
-int
-rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
+/* Reset and start a timer in the lists of a timer data instance */
+static int
+timer_reset(struct rte_timer_data *td, struct rte_timer *tim, uint64_t ticks,
 		enum rte_timer_type type, unsigned tim_lcore,
 		rte_timer_cb_t fct, void *arg)
 {
@@ -434,10 +1103,33 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 	else
 		period = 0;
 
-	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
+	return __rte_timer_reset(td, tim,  cur_time + ticks, period, tim_lcore,
 			  fct, arg, 0);
 }
 
+/* Reset and start the timer associated with the timer handle tim */
+int
+rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
+		enum rte_timer_type type, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg)
+{
+	return timer_reset(&default_timer_data, tim, ticks, type, tim_lcore,
+			fct, arg);
+}
+
+/* Reset and start a timer of a timer data instance */
+int
+rte_timer_alt_reset(uint32_t id, struct rte_timer *tim, uint64_t ticks,
+		enum rte_timer_type type, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg)
+{
+	struct rte_timer_data *td = timer_data_get(id);
+
+	if (td == NULL)
+		return -EINVAL;
+	return timer_reset(td, tim, ticks, type, tim_lcore, fct, arg);
+}
+
 /* loop until rte_timer_reset() succeed */
 void
 rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
@@ -449,30 +1141,34 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 		rte_pause();
 }
 
-/* Stop the timer associated with the timer handle tim */
-int
-rte_timer_stop(struct rte_timer *tim)
+/* Stop a timer in the lists of a timer data instance */
+static int
+timer_stop(struct rte_timer_data *td, struct rte_timer *tim)
 {
 	union rte_timer_status prev_status, status;
 	unsigned lcore_id = rte_lcore_id();
 	int ret;
 
+	if (td->req_size != 0)
+		timer_requests_check(td, tim);
+
 	/* wait that the timer is in correct status before update,
 	 * and mark it as being configured */
 	ret = timer_set_config_state(tim, &prev_status);
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(stop, 1);
+	__TIMER_STAT_ADD(td, stop, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
+		td->priv_timer[lcore_id].updated = 1;
 	}
 
-	/* remove it from list */
+	/* remove it from list: stops are never posted, so that the timer
+	 * is stopped, and can be freed, when this returns */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, 0);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(td, tim, prev_status, 0);
+		__TIMER_STAT_ADD(td, pending, -1);
 	}
 
 	/* mark timer as stopped */
@@ -484,6 +1180,24 @@ rte_timer_stop(struct rte_timer *tim)
 	return 0;
 }
 
+/* Stop the timer associated with the timer handle tim */
+int
+rte_timer_stop(struct rte_timer *tim)
+{
+	return timer_stop(&default_timer_data, tim);
+}
+
+/* Stop a timer of a timer data instance */
+int
+rte_timer_alt_stop(uint32_t id, struct rte_timer *tim)
+{
+	struct rte_timer_data *td = timer_data_get(id);
+
+	if (td == NULL)
+		return -EINVAL;
+	return timer_stop(td, tim);
+}
+
 /* loop until rte_timer_stop() succeed */
 void
 rte_timer_stop_sync(struct rte_timer *tim)
@@ -499,8 +1213,39 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-void rte_timer_manage(void)
+/*
+ * run the wheel of the lcore up to the current tick:
+ * returns the timers due, marked as running, linked through sl_next[0].
+ */
+static struct rte_timer *
+timer_wheel_manage(struct rte_timer_data *td, unsigned lcore_id,
+		uint64_t *cur_time)
+{
+	uint64_t now;
+	struct timer_wheel *w;
+	struct rte_timer *run_first_tim;
+
+	w = td->priv_timer[lcore_id].wheel;
+
+	/* optimize for the case where the wheel is empty,
+	 * or the tick it has to run next is not over */
+	if (w->num_timers == 0)
+		return NULL;
+	*cur_time = rte_get_timer_cycles();
+	now = *cur_time >> w->shift;
+	if (likely(now < w->tick))
+		return NULL;
+
+	/* take out the timers due, and mark them as running */
+	rte_spinlock_lock(&td->priv_timer[lcore_id].list_lock);
+	run_first_tim = timer_wheel_expire(w, now);
+	rte_spinlock_unlock(&td->priv_timer[lcore_id].list_lock);
+	return run_first_tim;
+}
+
+/* run the expired timers of the lcore in a timer data instance */
+static void
+timer_manage(struct rte_timer_data *td)
 {
 	union rte_timer_status status;
 	struct rte_timer *tim, *next_tim;
@@ -513,9 +1258,21 @@ void rte_timer_manage(void)
 	/* timer manager only runs on EAL thread with valid lcore_id */
 	assert(lcore_id < RTE_MAX_LCORE);
 
-	__TIMER_STAT_ADD(manage, 1);
+	__TIMER_STAT_ADD(td, manage, 1);
+
+	/* apply the resets posted by the other lcores */
+	if (td->req_size != 0)
+		timer_requests_apply(td, lcore_id);
+
+	if (td->backend == RTE_TIMER_WHEEL) {
+		run_first_tim = timer_wheel_manage(td, lcore_id, &cur_time);
+		if (run_first_tim == NULL)
+			return;
+		goto run;
+	}
+
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+	if (td->priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
 		return;
 	cur_time = rte_get_timer_cycles();
 
@@ -523,30 +1280,30 @@ void rte_timer_manage(void)
 	/* on 64-bit the value cached in the pending_head.expired will be
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
+	if (likely(td->priv_timer[lcore_id].pending_head.expire > cur_time))
 		return;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_lock(&td->priv_timer[lcore_id].list_lock);
 
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	if (td->priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
+	    td->priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
+		rte_spinlock_unlock(&td->priv_timer[lcore_id].list_lock);
 		return;
 	}
 
 	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+	tim = td->priv_timer[lcore_id].pending_head.sl_next[0];
 
 	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		priv_timer[lcore_id].pending_head.sl_next[i] =
+	timer_get_prev_entries(td, cur_time, lcore_id, prev);
+	for (i = td->priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
+		td->priv_timer[lcore_id].pending_head.sl_next[i] =
 		    prev[i]->sl_next[i];
 		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
+			td->priv_timer[lcore_id].curr_skiplist_depth--;
 		prev[i] ->sl_next[i] = NULL;
 	}
 
@@ -563,31 +1320,32 @@ void rte_timer_manage(void)
 		} else {
 			/* another core is trying to re-config this one,
 			 * remove it from local expired list and put it
-			 * back on the priv_timer[] skip list */
+			 * back on the td->priv_timer[] skip list */
 			*pprev = next_tim;
-			timer_add(tim, lcore_id, 1);
+			timer_add(td, tim, lcore_id, 1);
 		}
 	}
 
 	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+	td->priv_timer[lcore_id].pending_head.expire =
+	    (td->priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
+		td->priv_timer[lcore_id].pending_head.sl_next[0]->expire;
 
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_unlock(&td->priv_timer[lcore_id].list_lock);
 
+run:
 	/* now scan expired list and call callbacks */
 	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
 		next_tim = tim->sl_next[0];
-		priv_timer[lcore_id].updated = 0;
+		td->priv_timer[lcore_id].updated = 0;
 
 		/* execute callback function with list unlocked */
 		tim->f(tim, tim->arg);
 
-		__TIMER_STAT_ADD(pending, -1);
+		__TIMER_STAT_ADD(td, pending, -1);
 		/* the timer was stopped or reloaded by the callback
 		 * function, we have nothing to do here */
-		if (priv_timer[lcore_id].updated == 1)
+		if (td->priv_timer[lcore_id].updated == 1)
 			continue;
 
 		if (tim->period == 0) {
@@ -599,21 +1357,40 @@ void rte_timer_manage(void)
 		}
 		else {
 			/* keep it in list and mark timer as pending */
-			rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+			rte_spinlock_lock(&td->priv_timer[lcore_id].list_lock);
 			status.state = RTE_TIMER_PENDING;
-			__TIMER_STAT_ADD(pending, 1);
+			__TIMER_STAT_ADD(td, pending, 1);
 			status.owner = (int16_t)lcore_id;
 			rte_wmb();
 			tim->status.u32 = status.u32;
-			__rte_timer_reset(tim, cur_time + tim->period,
+			__rte_timer_reset(td, tim, cur_time + tim->period,
 				tim->period, lcore_id, tim->f, tim->arg, 1);
-			rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+			rte_spinlock_unlock(&td->priv_timer[lcore_id].list_lock);
 		}
 	}
 }
 
-/* dump statistics about timers */
-void rte_timer_dump_stats(FILE *f)
+/* must be called periodically, run all timer that expired */
+void rte_timer_manage(void)
+{
+	timer_manage(&default_timer_data);
+}
+
+/* run the expired timers of a timer data instance */
+int
+rte_timer_alt_manage(uint32_t id)
+{
+	struct rte_timer_data *td = timer_data_get(id);
+
+	if (td == NULL)
+		return -EINVAL;
+	timer_manage(td);
+	return 0;
+}
+
+/* dump statistics about the timers of a timer data instance */
+static void
+timer_dump_stats(struct rte_timer_data *td, FILE *f)
 {
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	struct rte_timer_debug_stats sum;
@@ -621,10 +1398,10 @@ void rte_timer_dump_stats(FILE *f)
 
 	memset(&sum, 0, sizeof(sum));
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		sum.reset += priv_timer[lcore_id].stats.reset;
-		sum.stop += priv_timer[lcore_id].stats.stop;
-		sum.manage += priv_timer[lcore_id].stats.manage;
-		sum.pending += priv_timer[lcore_id].stats.pending;
+		sum.reset += td->priv_timer[lcore_id].stats.reset;
+		sum.stop += td->priv_timer[lcore_id].stats.stop;
+		sum.manage += td->priv_timer[lcore_id].stats.manage;
+		sum.pending += td->priv_timer[lcore_id].stats.pending;
 	}
 	fprintf(f, "Timer statistics:\n");
 	fprintf(f, "  reset = %"PRIu64"\n", sum.reset);
@@ -632,6 +1409,25 @@ void rte_timer_dump_stats(FILE *f)
 	fprintf(f, "  manage = %"PRIu64"\n", sum.manage);
 	fprintf(f, "  pending = %"PRIu64"\n", sum.pending);
 #else
+	RTE_SET_USED(td);
 	fprintf(f, "No timer statistics, RTE_LIBRTE_TIMER_DEBUG is disabled\n");
 #endif
 }
+
+/* dump statistics about timers */
+void rte_timer_dump_stats(FILE *f)
+{
+	timer_dump_stats(&default_timer_data, f);
+}
+
+/* dump statistics about the timers of a timer data instance */
+int
+rte_timer_alt_dump_stats(uint32_t id, FILE *f)
+{
+	struct rte_timer_data *td = timer_data_get(id);
+
+	if (td == NULL)
+		return -EINVAL;
+	timer_dump_stats(td, f);
+	return 0;
+}
@@ -59,6 +59,15 @@
  * timer. The API is based on the BSD callout(9) API with a few
  * differences.
  *
+ * The pending timers of an lcore are kept in a skiplist by default, or in
+ * a hierarchical timing wheel selected with rte_timer_subsystem_set_backend().
+ *
+ * The functions above use the lists of the default timer data instance.
+ * Independent sets of lists can be allocated with rte_timer_data_alloc(),
+ * and used with the rte_timer_alt_*() functions: a subsystem can then
+ * manage its timers at its own pace, and with its own backend, without
+ * running the timers of the application.
+ *
  * See the RTE architecture documentation for more information about the
  * design of this library.
  */
@@ -119,13 +128,32 @@ typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 
 #define MAX_SKIPLIST_DEPTH 10
 
+/**
+ * Implementations of the per-lcore lists of pending timers.
+ */
+enum rte_timer_backend {
+	RTE_TIMER_SKIPLIST = 0,
+	/**< Skiplist sorted by expiry time: O(log n) reset and stop. */
+	RTE_TIMER_WHEEL,
+	/**< Hierarchical timing wheel: O(1) reset and stop,
+	 *   expiry at the resolution of a wheel tick. */
+};
+
 /**
  * A structure describing a timer in RTE.
  */
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	union {
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/**< Skiplist links, with the skiplist backend. */
+		struct {
+			struct rte_timer *next;   /**< Next in the slot. */
+			struct rte_timer **pprev; /**< Link to this timer. */
+			uint32_t slot;            /**< Slot of the wheel. */
+		} wheel; /**< Wheel slot links, with the wheel backend. */
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t f;      /**< Callback function. */
@@ -165,6 +193,135 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/** Default number of timer cycles per wheel tick: 10 us. */
+#define RTE_TIMER_WHEEL_TICK_DEFAULT(hz) ((hz) / 100000)
+
+/**
+ * Select the implementation of the per-lcore lists of pending timers.
+ *
+ * The skiplist backend, the default one, keeps the timers sorted by
+ * expiry time: resetting or stopping a timer is O(log n), and
+ * rte_timer_manage() runs the timers as soon as they expire.
+ *
+ * The wheel backend keeps them in a hierarchical timing wheel of
+ * 4 levels of 256 slots, with an overflow list for the timers expiring
+ * more than 2^32 ticks later: resetting or stopping a timer is O(1), and
+ * rte_timer_manage() runs the timers expired at the last tick that
+ * elapsed, all in one batch. A timer never runs before its expiry time,
+ * but may run up to a tick later. It suits millions of timers that
+ * don't need a high precision, like per-flow idle timers.
+ *
+ * It must be called after rte_timer_subsystem_init(), from one lcore,
+ * while no timer is pending.
+ *
+ * @param backend
+ *   RTE_TIMER_SKIPLIST or RTE_TIMER_WHEEL.
+ * @param tick
+ *   With RTE_TIMER_WHEEL, the number of cycles (see rte_get_timer_hz())
+ *   per wheel tick, rounded down to a power of 2. Zero selects
+ *   RTE_TIMER_WHEEL_TICK_DEFAULT(). Ignored with RTE_TIMER_SKIPLIST.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid backend.
+ *   - -EBUSY: Timers are pending.
+ *   - -ENOMEM: The wheels could not be allocated.
+ */
+int rte_timer_subsystem_set_backend(enum rte_timer_backend backend,
+		uint64_t tick);
+
+/** Maximum number of timer data instances, including the default one. */
+#define RTE_TIMER_MAX_DATA 64
+
+/**
+ * Allocate a timer data instance.
+ *
+ * A timer data instance has its own per-lcore lists of pending timers,
+ * managed by rte_timer_alt_manage() independently from the lists of the
+ * default instance, that has id 0. It uses the skiplist backend until
+ * rte_timer_data_set_backend() is called.
+ *
+ * It must be called after rte_timer_subsystem_init().
+ *
+ * @param id
+ *   A pointer where the id of the new instance is stored.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: *id* is NULL.
+ *   - -ENOMEM: The instance could not be allocated.
+ *   - -ENOSPC: RTE_TIMER_MAX_DATA instances are already allocated.
+ */
+int rte_timer_data_alloc(uint32_t *id);
+
+/**
+ * Free a timer data instance allocated with rte_timer_data_alloc().
+ *
+ * @param id
+ *   The id of the instance.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid id, or the default instance.
+ *   - -EBUSY: Timers are pending in the instance.
+ */
+int rte_timer_data_dealloc(uint32_t id);
+
+/**
+ * Select the implementation of the lists of a timer data instance.
+ *
+ * See rte_timer_subsystem_set_backend(), that is the same as this function
+ * with id 0.
+ *
+ * @param id
+ *   The id of the instance.
+ * @param backend
+ *   RTE_TIMER_SKIPLIST or RTE_TIMER_WHEEL.
+ * @param tick
+ *   With RTE_TIMER_WHEEL, the number of cycles per wheel tick.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid id or backend.
+ *   - -EBUSY: Timers are pending in the instance.
+ *   - -ENOMEM: The wheels could not be allocated.
+ */
+int rte_timer_data_set_backend(uint32_t id, enum rte_timer_backend backend,
+		uint64_t tick);
+
+/**
+ * Post the resets in the lists of other lcores to their request rings.
+ *
+ * By default, resetting a timer on another lcore than the calling one
+ * takes the lock of the list of that lcore, contending with its
+ * rte_timer_manage(). With request rings, the reset is instead posted to
+ * a lock-free ring of the lcore that has the timer in its list, or that
+ * has to add it, and applied in bursts by that lcore at the start of its
+ * next rte_timer_manage() (or rte_timer_alt_manage()) call. Stops are
+ * never posted: a timer is stopped when rte_timer_stop() returns 0.
+ *
+ * Until it is applied, the timer is in the CONFIG state: it is not seen
+ * as pending, and the other resets or stops of the timer fail, except on
+ * the lcore the request was posted to, which applies its requests first.
+ * So rte_timer_reset_sync() or rte_timer_stop_sync() called on a third
+ * lcore spins until the lcore the request was posted to calls
+ * rte_timer_manage(). Likewise, the memory of a timer may not be freed
+ * or reused while a reset is posted, that is until the timer is back in
+ * the PENDING or STOP state.
+ * When a ring is full, the lists are updated directly, with the lock.
+ *
+ * It must be called from one lcore, while no timer of the instance is
+ * pending or being reset.
+ *
+ * @param id
+ *   The id of the timer data instance, 0 for the default one.
+ * @param size
+ *   The number of entries of the ring of each lcore, a power of 2, of
+ *   which size - 1 can be used; or 0 to update the lists directly.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid id or size.
+ *   - -EBUSY: Timers are pending in the instance.
+ *   - -ENOMEM: The rings could not be allocated.
+ */
+int rte_timer_data_set_remote(uint32_t id, unsigned size);
+
 /**
  * Initialize a timer handle.
  *
@@ -280,6 +437,54 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
  */
 int rte_timer_stop(struct rte_timer *tim);
 
+/**
+ * Reset and start a timer in the lists of a timer data instance.
+ *
+ * Same as rte_timer_reset(), but the timer is added to the lists of the
+ * instance *id*, and is run by rte_timer_alt_manage() of that instance.
+ * A timer must be reset and stopped with the same instance as long as it
+ * is pending; once stopped or expired, it can be used with another one.
+ *
+ * @param id
+ *   The id of the timer data instance.
+ * @param tim
+ *   The timer handle.
+ * @param ticks
+ *   The number of cycles before the callback function is called.
+ * @param type
+ *   PERIODICAL or SINGLE.
+ * @param tim_lcore
+ *   The ID of the lcore whose list the timer is added to, or
+ *   LCORE_ID_ANY for round-robin.
+ * @param fct
+ *   The callback function of the timer.
+ * @param arg
+ *   The user argument of the callback function.
+ * @return
+ *   - 0: Success; the timer is scheduled.
+ *   - (-1): Timer is in the RUNNING or CONFIG state.
+ *   - -EINVAL: Invalid id.
+ */
+int rte_timer_alt_reset(uint32_t id, struct rte_timer *tim, uint64_t ticks,
+		enum rte_timer_type type, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg);
+
+/**
+ * Stop a timer of a timer data instance.
+ *
+ * Same as rte_timer_stop(), for a timer reset with rte_timer_alt_reset().
+ *
+ * @param id
+ *   The id of the timer data instance the timer was reset with.
+ * @param tim
+ *   The timer handle.
+ * @return
+ *   - 0: Success; the timer is stopped.
+ *   - (-1): The timer is in the RUNNING or CONFIG state.
+ *   - -EINVAL: Invalid id.
+ */
+int rte_timer_alt_stop(uint32_t id, struct rte_timer *tim);
+
 
 /**
  * Loop until rte_timer_stop() succeeds.
@@ -320,6 +525,21 @@ int rte_timer_pending(struct rte_timer *tim);
  */
 void rte_timer_manage(void);
 
+/**
+ * Manage the list of the calling lcore in a timer data instance.
+ *
+ * Same as rte_timer_manage(), for the timers reset with
+ * rte_timer_alt_reset() on instance *id*. The timers of the other
+ * instances are not run.
+ *
+ * @param id
+ *   The id of the timer data instance.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid id.
+ */
+int rte_timer_alt_manage(uint32_t id);
+
 /**
  * Dump statistics about timers.
  *
@@ -328,6 +548,19 @@ void rte_timer_manage(void);
  */
 void rte_timer_dump_stats(FILE *f);
 
+/**
+ * Dump statistics about the timers of a timer data instance.
+ *
+ * @param id
+ *   The id of the timer data instance.
+ * @param f
+ *   A pointer to a file for output
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid id.
+ */
+int rte_timer_alt_dump_stats(uint32_t id, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif